@@ -179,15 +179,9 @@ while True:
                 # Если запущен api_server - команды перехватываются API сервером
                 if crsf is not None and crsf.is_initialized:
                     try:
-                        # Устанавливаем оба канала
-                        crsf.set_channel(3, int(x))
-                        print(f"📝 Команда записана: setChannel 3 {int(x)}")
-                        crsf.set_channel(4, int(y))
-                        print(f"📝 Команда записана: setChannel 4 {int(y)}")
-                        
-                        # ВАЖНО: отправляем каналы - это фактически отправляет команды в CRSF
-                        crsf.send_channels()
-                        print(f"✅ Команда отправлена: sendChannels")
+                        # Оба канала и отправка пакета - одной пачкой команд
+                        crsf.update_channels({3: int(x), 4: int(y)}, send=True)
+                        print(f"✅ Команда отправлена: каналы 3={int(x)} 4={int(y)}, sendChannels")
                         
                         # Подробный отчет о состоянии
                         print(f"🎯 Объект: центр=({obj_center_x}, {obj_center_y}), смещение=({offset_x:+d}, {offset_y:+d})")
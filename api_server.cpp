@@ -1,5 +1,10 @@
 #include "api_server.h"
 #include "config.h"
+#include "libs/http_client.h"
+#include "libs/http_server.h"
+#include "libs/telemetry_json.h"
+#include "libs/telemetry_stream.h"
+#include "libs/telemetry_wire.h"
 #include <iostream>
 #include <thread>
 #include <mutex>
@@ -12,81 +17,35 @@
 #include <sstream>
 #include <fstream>
 
-static int serverSocket = -1;
+static HttpServer* httpServer = nullptr;
 static bool serverRunning = false;
 static std::mutex serverMutex;
+static const unsigned int API_SERVER_WORKERS = 4;
 static std::mutex telemetryMutex;
 static std::string targetHost = "localhost";
 static int targetPort = 8082;
-static std::string lastTelemetryJson = "{}"; // Последняя полученная телеметрия
+// Последняя полученная телеметрия: общий буфер отдаётся на GET без копирования
+static std::shared_ptr<const std::string> lastTelemetryJson = std::make_shared<const std::string>("{}");
+// Бинарная телеметрия: последний собранный снимок (база для разностных кадров)
+// и его ключевой кадр для GET ?format=bin (строится при первом запросе)
+static TelemetryWireFrame lastWireFrame = {};
+static std::shared_ptr<const std::string> lastTelemetryBin;
+// Подписчики потока телеметрии (SSE): одна сериализация на обновление для всех клиентов
+static TelemetryStreamHub telemetryHub;
+// Постоянные соединения к интерпретатору: адрес разрешается один раз, TCP-рукопожатие — только при переподключении
+static HttpKeepAliveClient targetClient;
 
-// Отправка команды на ведомый узел через HTTP API (используя простые сокеты)
+// Отправка команды на ведомый узел через HTTP API (keep-alive соединение из пула)
 bool sendCommandToTarget(const std::string& command, const std::string& body = "") {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) {
-        std::cerr << "❌ Ошибка создания сокета для отправки команды" << std::endl;
-        return false;
-    }
-
-    // Получаем адрес целевого хоста
-    struct hostent* server = gethostbyname(targetHost.c_str());
-    if (server == nullptr) {
-        std::cerr << "❌ Ошибка разрешения имени хоста: " << targetHost << std::endl;
-        close(sock);
-        return false;
-    }
-
-    struct sockaddr_in serverAddr;
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    memcpy(&serverAddr.sin_addr.s_addr, server->h_addr, server->h_length);
-    serverAddr.sin_port = htons(targetPort);
-
-    // Устанавливаем таймаут подключения
-    // В режиме --notel используем очень короткий таймаут для быстрого ответа
-    struct timeval timeout;
-    if (g_ignore_telemetry) {
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 100000; // 100мс для режима без телеметрии
-    } else {
-        timeout.tv_sec = 2;
-        timeout.tv_usec = 0;
-    }
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-
-    if (connect(sock, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "❌ Ошибка подключения к " << targetHost << ":" << targetPort << std::endl;
-        close(sock);
-        return false;
-    }
-
-    // Формируем HTTP POST запрос
-    std::stringstream request;
-    request << "POST /api/command/" << command << " HTTP/1.1\r\n";
-    request << "Host: " << targetHost << ":" << targetPort << "\r\n";
-    request << "Content-Type: application/json\r\n";
-    request << "Content-Length: " << body.length() << "\r\n";
-    request << "Connection: close\r\n";
-    request << "\r\n";
-    request << body;
-
-    std::string requestStr = request.str();
-    if (send(sock, requestStr.c_str(), requestStr.length(), 0) < 0) {
-        std::cerr << "❌ Ошибка отправки HTTP запроса" << std::endl;
-        close(sock);
+    int status = 0;
+    if (!targetClient.post("/api/command/" + command, body, &status)) {
+        if (status == 0) {
+            std::cerr << "❌ Ошибка подключения к " << targetHost << ":" << targetPort << std::endl;
+        } else {
+            std::cerr << "❌ Ведомый узел ответил кодом " << status << std::endl;
+        }
         return false;
     }
-
-    // Читаем ответ (необязательно, но полезно для отладки)
-    char buffer[1024];
-    ssize_t bytesReceived = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        // Можно проверить статус ответа, но для простоты просто считаем успехом
-    }
-
-    close(sock);
     return true;
 }
 
@@ -175,35 +134,50 @@ bool parseSetMode(const std::string& body, std::string& mode) {
     return (mode == "joystick" || mode == "manual");
 }
 
-// Отправка HTTP ответа
-void sendHttpResponse(int clientSocket, const std::string& content, const std::string& contentType = "application/json", int statusCode = 200) {
-    std::stringstream response;
-    response << "HTTP/1.1 " << statusCode << " " << (statusCode == 200 ? "OK" : "Bad Request") << "\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
-    response << "Access-Control-Allow-Origin: *\r\n";
-    response << "Connection: close\r\n\r\n";
-    response << content;
-    
-    std::string responseStr = response.str();
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
+// Приём бинарного кадра телеметрии: сборка снимка (разностный кадр — поверх предыдущего)
+// и JSON для GET /api/telemetry и подписчиков потока
+static TelemetryWireStatus receiveBinaryTelemetry(const std::string& body, std::shared_ptr<const std::string>& json) {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    TelemetryWireStatus status = telemetry_wire_decode(reinterpret_cast<const uint8_t*>(body.data()), body.size(), lastWireFrame);
+    if (status != TELEMETRY_WIRE_OK) {
+        return status;
+    }
+    char timestamp[TELEMETRY_TIMESTAMP_MAX];
+    telemetry_json_format_time(lastWireFrame.timeOfDayMs, timestamp, sizeof(timestamp));
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = telemetry_json_encode(lastWireFrame.data, timestamp, buf, sizeof(buf));
+    json = std::make_shared<const std::string>(buf, len);
+    lastTelemetryJson = json;
+    if (body[3] & TELEMETRY_WIRE_FLAG_DELTA) {
+        lastTelemetryBin.reset();
+    } else {
+        lastTelemetryBin = std::make_shared<const std::string>(body);
+    }
+    return status;
+}
+
+// Клиент просит бинарный кадр: ?format=bin или Accept с типом кадра
+static bool wantsBinaryTelemetry(const HttpRequest& req) {
+    std::string format;
+    if (req.queryParam("format", format)) {
+        return format == "bin";
+    }
+    return req.header("accept").find(TELEMETRY_WIRE_CONTENT_TYPE) != std::string::npos;
+}
+
+// Заполнение HTTP ответа (заголовки и отправку формирует HttpServer)
+void sendHttpResponse(HttpResponse& resp, const std::string& content, const std::string& contentType = "application/json", int statusCode = 200) {
+    resp.set(statusCode, contentType, content);
 }
 
-// Обработка HTTP запросов
-void handleHttpRequest(int clientSocket, const std::string& request) {
-    std::stringstream ss(request);
-    std::string method, path, version;
-    ss >> method >> path >> version;
+// Обработка HTTP запросов (вызывается из рабочих потоков HttpServer)
+void handleHttpRequest(const HttpRequest& req, HttpResponse& resp) {
+    const std::string& method = req.method;
+    const std::string& path = req.path;
+    const std::string& body = req.body;
     
     std::cout << "🔍 Запрос: " << method << " " << path << std::endl;
     
-    // Читаем тело запроса (если есть)
-    std::string body;
-    size_t bodyPos = request.find("\r\n\r\n");
-    if (bodyPos != std::string::npos) {
-        body = request.substr(bodyPos + 4);
-    }
-    
     if (path == "/" || path == "/index.html") {
         std::string html = R"(<!DOCTYPE html>
 <html><head><title>CRSF API Server</title></head>
@@ -218,21 +192,69 @@ void handleHttpRequest(int clientSocket, const std::string& request) {
 <li>POST /api/command/sendChannels - отправка каналов</li>
 <li>POST /api/command/setMode - установка режима</li>
 <li>POST /api/telemetry - приём телеметрии от интерпретатора</li>
-<li>GET /api/telemetry - получение последней телеметрии</li>
+<li>GET /api/telemetry - получение последней телеметрии (?format=bin - бинарный кадр)</li>
+<li>GET /api/telemetry/stream?fields=channels,gps&amp;rate=10 - поток телеметрии (Server-Sent Events)</li>
+<li>GET /api/stats/stream - статистика потока телеметрии</li>
+<li>GET /api/stats/forward - статистика и гистограмма задержек пересылки команд</li>
+<li>GET /metrics - задержки пересылки команд в формате Prometheus</li>
 </ul>
 </body></html>)";
-        sendHttpResponse(clientSocket, html, "text/html");
+        sendHttpResponse(resp, html, "text/html");
     } else if (path == "/api/telemetry" && method == "POST") {
-        // Приём телеметрии от интерпретатора
+        // Приём телеметрии от интерпретатора: бинарный кадр или JSON (формат по Content-Type)
         std::cout << "📥 Получена телеметрия: " << body.length() << " байт" << std::endl;
-        std::lock_guard<std::mutex> lock(telemetryMutex);
-        lastTelemetryJson = body;
+        std::shared_ptr<const std::string> snapshot;
+        if (req.header("content-type").compare(0, strlen(TELEMETRY_WIRE_CONTENT_TYPE), TELEMETRY_WIRE_CONTENT_TYPE) == 0) {
+            TelemetryWireStatus status = receiveBinaryTelemetry(body, snapshot);
+            if (status != TELEMETRY_WIRE_OK) {
+                // 409: разностный кадр к неизвестному снимку — отправитель пришлёт ключевой
+                std::cerr << "❌ Бинарная телеметрия отклонена: " << telemetry_wire_status_text(status) << std::endl;
+                sendHttpResponse(resp, std::string("{\"status\":\"error\",\"message\":\"") + telemetry_wire_status_text(status) + "\"}",
+                                 "application/json", status == TELEMETRY_WIRE_BASE_MISMATCH ? 409 : 400);
+                return;
+            }
+        } else {
+            snapshot = std::make_shared<const std::string>(body);
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            lastTelemetryJson = snapshot;
+            lastWireFrame.valid = false;
+            lastTelemetryBin.reset();
+        }
+        telemetryHub.publish(std::move(snapshot));
         std::cout << "✅ Телеметрия сохранена" << std::endl;
-        sendHttpResponse(clientSocket, "{\"status\":\"ok\",\"message\":\"Telemetry received\"}");
+        sendHttpResponse(resp, "{\"status\":\"ok\",\"message\":\"Telemetry received\"}");
     } else if (path == "/api/telemetry" && method == "GET") {
-        // Отдача телеметрии клиенту
-        std::lock_guard<std::mutex> lock(telemetryMutex);
-        sendHttpResponse(clientSocket, lastTelemetryJson);
+        // Отдача телеметрии клиенту: JSON или ключевой бинарный кадр
+        if (wantsBinaryTelemetry(req)) {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            if (!lastWireFrame.valid) {
+                sendHttpResponse(resp, "{\"status\":\"error\",\"message\":\"Binary telemetry not available (sender uses JSON)\"}",
+                                 "application/json", 406);
+                return;
+            }
+            if (!lastTelemetryBin) {
+                uint8_t frame[TELEMETRY_WIRE_MAX];
+                size_t len = telemetry_wire_encode(lastWireFrame.data, lastWireFrame.seq, lastWireFrame.timeOfDayMs,
+                                                   nullptr, 0, frame, sizeof(frame));
+                lastTelemetryBin = std::make_shared<const std::string>(reinterpret_cast<const char*>(frame), len);
+            }
+            resp.contentType = TELEMETRY_WIRE_CONTENT_TYPE;
+            resp.sharedBody = lastTelemetryBin;
+        } else {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            resp.sharedBody = lastTelemetryJson;
+        }
+    } else if (path == "/api/telemetry/stream" && method == "GET") {
+        // Подписка на поток телеметрии вместо опроса
+        telemetryHub.subscribe(req, resp);
+    } else if (path == "/api/stats/stream" && method == "GET") {
+        sendHttpResponse(resp, telemetryHub.statsJson());
+    } else if (path == "/api/stats/forward" && method == "GET") {
+        // Задержка пересылки команд на ведомый узел (от отправки запроса до ответа интерпретатора)
+        sendHttpResponse(resp, targetClient.statsJson());
+    } else if (path == "/metrics" && method == "GET") {
+        // Та же задержка пересылки для Prometheus (этапы внутри crsf_io_rpi — на его /metrics)
+        sendHttpResponse(resp, targetClient.prometheus("crsf_forward"), "text/plain; version=0.0.4");
     } else if (path.find("/api/command/") == 0) {
         // Извлекаем имя команды из пути
         std::string command = path.substr(13); // длина "/api/command/" = 13
@@ -284,99 +306,56 @@ void handleHttpRequest(int clientSocket, const std::string& request) {
             }
         }
         
-        sendHttpResponse(clientSocket, responseJson);
+        sendHttpResponse(resp, responseJson);
     } else {
-        sendHttpResponse(clientSocket, "{\"status\":\"error\",\"message\":\"Not Found\"}", "application/json", 404);
-    }
-}
-
-// Обработка клиентских подключений
-void handleClient(int clientSocket) {
-    char buffer[8192];
-    int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        std::string request(buffer);
-        handleHttpRequest(clientSocket, request);
+        sendHttpResponse(resp, "{\"status\":\"error\",\"message\":\"Not Found\"}", "application/json", 404);
     }
-    
-    close(clientSocket);
 }
 
 // Основная функция API сервера
 void startApiServer(int port, const std::string& host, int targetPortNum) {
-    std::lock_guard<std::mutex> lock(serverMutex);
-    
-    if (serverRunning) {
-        std::cout << "⚠️ API сервер уже запущен" << std::endl;
-        return;
-    }
-    
-    targetHost = host;
-    targetPort = targetPortNum;
-    
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        std::cerr << "❌ Ошибка создания сокета" << std::endl;
-        return;
-    }
-    
-    int opt = 1;
-    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-    
-    if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "❌ Ошибка привязки к порту " << port << std::endl;
-        close(serverSocket);
-        return;
-    }
-    
-    if (listen(serverSocket, 5) < 0) {
-        std::cerr << "❌ Ошибка прослушивания порта" << std::endl;
-        close(serverSocket);
-        return;
-    }
-    
-    serverRunning = true;
-    std::cout << "🌐 API сервер запущен на порту " << port << std::endl;
-    std::cout << "📡 Целевой узел: " << targetHost << ":" << targetPort << std::endl;
-    
-    // Основной цикл сервера
-    while (serverRunning) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
+    {
+        std::lock_guard<std::mutex> lock(serverMutex);
         
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket < 0) {
-            if (serverRunning) {
-                continue;
-            } else {
-                break;
-            }
+        if (serverRunning) {
+            std::cout << "⚠️ API сервер уже запущен" << std::endl;
+            return;
+        }
+        
+        targetHost = host;
+        targetPort = targetPortNum;
+        targetClient.setTarget(targetHost, targetPort);
+        // В режиме --notel используем очень короткий таймаут для быстрого ответа
+        targetClient.setTimeoutMs(g_ignore_telemetry ? 100 : 2000);
+        
+        // Рабочих потоков больше одного: пересылка команды ждёт ответа ведомого узла
+        httpServer = new HttpServer(handleHttpRequest, API_SERVER_WORKERS);
+        if (!httpServer->listen(port)) {
+            std::cerr << "❌ Ошибка привязки к порту " << port << std::endl;
+            delete httpServer;
+            httpServer = nullptr;
+            return;
         }
         
-        std::thread clientThread(handleClient, clientSocket);
-        clientThread.detach();
+        serverRunning = true;
+        std::cout << "🌐 API сервер запущен на порту " << port << std::endl;
+        std::cout << "📡 Целевой узел: " << targetHost << ":" << targetPort << std::endl;
     }
     
-    close(serverSocket);
+    // Основной цикл сервера (до stopApiServer)
+    httpServer->run();
+    
+    std::lock_guard<std::mutex> lock(serverMutex);
+    delete httpServer;
+    httpServer = nullptr;
     serverRunning = false;
 }
 
 // Остановка API сервера
 void stopApiServer() {
     std::lock_guard<std::mutex> lock(serverMutex);
-    if (serverRunning) {
-        serverRunning = false;
-        if (serverSocket >= 0) {
-            close(serverSocket);
-            serverSocket = -1;
-        }
+    if (serverRunning && httpServer) {
+        httpServer->stop();
     }
 }
 
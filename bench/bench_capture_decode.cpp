@@ -0,0 +1,141 @@
+/**
+ * @file bench_capture_decode.cpp
+ * @brief Бенчмарк пакетного разбора записей сырого потока в таблицы (libs/crsf/capture_decode)
+ *
+ * Decode/N — разбор записи ~21 МБ (около 5 минут приёма на 420 кбод) в N потоков;
+ * время по стенным часам (UseRealTime), масштабирование — отношение bytes_per_second при N и при 1.
+ * Ускорение ограничено числом ядер: на машине с одним ядром все N дают примерно одно и то же.
+ * WriteColumns / WriteCsv — запись готовых таблиц на диск (/tmp).
+ */
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../libs/crsf/capture.h"
+#include "../libs/crsf/capture_decode.h"
+#include "../libs/crsf/channel_codec.h"
+#include "../libs/crsf/crc8.h"
+#include "../libs/crsf/crsf_protocol.h"
+
+static void appendFrame(std::vector<uint8_t>& out, uint8_t type, const uint8_t* payload, uint8_t len) {
+    Crc8 crc(0xD5);
+    uint8_t frame[CRSF_MAX_PACKET_SIZE];
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = len + 2;
+    frame[2] = type;
+    memcpy(&frame[3], payload, len);
+    frame[3 + len] = crc.calc(&frame[2], len + 1);
+    out.insert(out.end(), frame, frame + len + 4);
+}
+
+// Запись: поток полётника (на 10 кадров каналов — по кадру телеметрии каждого типа) порциями
+// по 26 байт через 620 мкс, на каждые 10 порций — ответный кадр каналов. Создаётся один раз
+static const std::string& capturePath() {
+    static std::string path;
+    if (!path.empty()) {
+        return path;
+    }
+    path = "/tmp/bench_capture_decode_" + std::to_string(getpid()) + ".cap";
+    std::vector<uint8_t> stream;
+    int us[CRSF_NUM_CHANNELS];
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE];
+    uint8_t attitude[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0x01, 0x10, 0xFE, 0x20, 0x30, 0x00};
+    const uint8_t battery[CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE] = {0x00, 0xA8, 0x00, 0x0A, 0x00, 0x05, 0x46, 0x4C};
+    const uint8_t link[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE] = {50, 52, 100, 5, 0, 4, 2, 60, 98, 3};
+    const uint8_t gps[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0x21, 0x3A, 0x5B, 0x10, 0x16, 0x6B, 0x8C, 0x20,
+                                                      0x00, 0x7D, 0x46, 0x50, 0x04, 0x4C, 12};
+    for (int block = 0; block < 40000; ++block) {
+        for (int i = 0; i < 10; ++i) {
+            for (int ch = 0; ch < CRSF_NUM_CHANNELS; ++ch) {
+                us[ch] = 1000 + (block * 37 + i * 11 + ch * 53) % 1001;
+            }
+            crsf_channels_encode(us, channels);
+            appendFrame(stream, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+        }
+        attitude[3] = static_cast<uint8_t>(block);
+        appendFrame(stream, CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+        appendFrame(stream, CRSF_FRAMETYPE_BATTERY_SENSOR, battery, sizeof(battery));
+        appendFrame(stream, CRSF_FRAMETYPE_LINK_STATISTICS, link, sizeof(link));
+        appendFrame(stream, CRSF_FRAMETYPE_GPS, gps, sizeof(gps));
+    }
+    std::vector<uint8_t> tx;
+    appendFrame(tx, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+
+    unlink(path.c_str());
+    CrsfCapture capture(64u << 20, 1000);
+    capture.open(path, CRSF_BAUDRATE);
+    uint64_t ts = 1000000000ull;
+    size_t chunks = 0;
+    for (size_t pos = 0; pos < stream.size(); pos += 26, ts += 620000) {
+        capture.record(CAPTURE_RX, ts, &stream[pos], std::min<size_t>(26, stream.size() - pos));
+        if (++chunks % 10 == 0) {
+            capture.record(CAPTURE_TX, ts + 1000, tx.data(), tx.size());
+        }
+    }
+    capture.close();
+    atexit([]() { unlink(capturePath().c_str()); });
+    return path;
+}
+
+static void BM_Decode(benchmark::State& state) {
+    CaptureFile file;
+    if (!file.open(capturePath())) {
+        state.SkipWithError("не удалось подготовить запись");
+        return;
+    }
+    unsigned int threads = static_cast<unsigned int>(state.range(0));
+    size_t rows = 0;
+    for (auto _ : state) {
+        CaptureTables tables;
+        capture_decode(file, tables, threads);
+        rows = tables.rows();
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * rows));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    state.counters["cores"] = std::thread::hardware_concurrency();
+}
+BENCHMARK(BM_Decode)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_WriteColumns(benchmark::State& state) {
+    CaptureFile file;
+    if (!file.open(capturePath())) {
+        state.SkipWithError("не удалось подготовить запись");
+        return;
+    }
+    CaptureTables tables;
+    capture_decode(file, tables);
+    std::string dir = capturePath() + ".columns";
+    for (auto _ : state) {
+        capture_write_columns(tables, dir);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tables.rows()));
+    std::string cmd = "rm -rf " + dir;
+    (void)system(cmd.c_str());
+}
+BENCHMARK(BM_WriteColumns)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_WriteCsv(benchmark::State& state) {
+    CaptureFile file;
+    if (!file.open(capturePath())) {
+        state.SkipWithError("не удалось подготовить запись");
+        return;
+    }
+    CaptureTables tables;
+    capture_decode(file, tables);
+    std::string dir = capturePath() + ".csv";
+    for (auto _ : state) {
+        capture_write_csv(tables, dir);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tables.rows()));
+    std::string cmd = "rm -rf " + dir;
+    (void)system(cmd.c_str());
+}
+BENCHMARK(BM_WriteCsv)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+/**
+ * @file bench_channel_codec.cpp
+ * @brief Бенчмарк кодека каналов (scalar / SSE2 / AVX2 / NEON)
+ * 
+ * Один кадр (путь приёма/отправки CrsfSerial) и пакет из 4096 кадров (обработка логов).
+ * Результат — кадров в секунду (items_per_second).
+ */
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../libs/crsf/channel_codec.h"
+
+static const int BATCH_FRAMES = 4096;
+
+static bool selectImpl(benchmark::State& state, ChannelCodecImpl impl) {
+    if (!channel_codec_set_impl(impl)) {
+        state.SkipWithError("реализация не поддерживается процессором");
+        return false;
+    }
+    return true;
+}
+
+static void BM_Decode(benchmark::State& state, ChannelCodecImpl impl) {
+    if (!selectImpl(state, impl)) return;
+    uint8_t payload[CRSF_CHANNELS_PAYLOAD_SIZE];
+    int us[CRSF_NUM_CHANNELS];
+    for (int i = 0; i < CRSF_NUM_CHANNELS; i++) us[i] = 1000 + i * 60;
+    crsf_channels_encode(us, payload);
+
+    for (auto _ : state) {
+        crsf_channels_decode(payload, us);
+        benchmark::DoNotOptimize(us);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Encode(benchmark::State& state, ChannelCodecImpl impl) {
+    if (!selectImpl(state, impl)) return;
+    uint8_t payload[CRSF_CHANNELS_PAYLOAD_SIZE];
+    int us[CRSF_NUM_CHANNELS];
+    for (int i = 0; i < CRSF_NUM_CHANNELS; i++) us[i] = 1000 + i * 60;
+
+    for (auto _ : state) {
+        crsf_channels_encode(us, payload);
+        benchmark::DoNotOptimize(payload);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_DecodeBatch(benchmark::State& state, ChannelCodecImpl impl) {
+    if (!selectImpl(state, impl)) return;
+    std::vector<uint16_t> us(BATCH_FRAMES * CRSF_NUM_CHANNELS);
+    for (size_t i = 0; i < us.size(); i++) us[i] = static_cast<uint16_t>(1000 + (i * 7) % 1001);
+    std::vector<uint8_t> payloads(BATCH_FRAMES * CRSF_CHANNELS_PAYLOAD_SIZE);
+    crsf_channels_encode_batch(us.data(), BATCH_FRAMES, payloads.data(), CRSF_CHANNELS_PAYLOAD_SIZE);
+
+    for (auto _ : state) {
+        crsf_channels_decode_batch(payloads.data(), CRSF_CHANNELS_PAYLOAD_SIZE, BATCH_FRAMES, us.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_FRAMES);
+}
+
+static void BM_EncodeBatch(benchmark::State& state, ChannelCodecImpl impl) {
+    if (!selectImpl(state, impl)) return;
+    std::vector<uint16_t> us(BATCH_FRAMES * CRSF_NUM_CHANNELS);
+    for (size_t i = 0; i < us.size(); i++) us[i] = static_cast<uint16_t>(1000 + (i * 7) % 1001);
+    std::vector<uint8_t> payloads(BATCH_FRAMES * CRSF_CHANNELS_PAYLOAD_SIZE);
+
+    for (auto _ : state) {
+        crsf_channels_encode_batch(us.data(), BATCH_FRAMES, payloads.data(), CRSF_CHANNELS_PAYLOAD_SIZE);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_FRAMES);
+}
+
+#define CODEC_BENCHMARKS(fn) \
+    BENCHMARK_CAPTURE(fn, scalar, CHANNEL_CODEC_SCALAR); \
+    BENCHMARK_CAPTURE(fn, sse2, CHANNEL_CODEC_SSE2); \
+    BENCHMARK_CAPTURE(fn, avx2, CHANNEL_CODEC_AVX2); \
+    BENCHMARK_CAPTURE(fn, neon, CHANNEL_CODEC_NEON)
+
+CODEC_BENCHMARKS(BM_Decode);
+CODEC_BENCHMARKS(BM_Encode);
+CODEC_BENCHMARKS(BM_DecodeBatch);
+CODEC_BENCHMARKS(BM_EncodeBatch);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+/**
+ * @file bench_crc8.cpp
+ * @brief Бенчмарк реализаций CRC8 (table / slice8 / clmul)
+ * 
+ * Пропускная способность (bytes_per_second) на размерах от кадра CRSF
+ * до мегабайтных буферов записи/воспроизведения логов.
+ */
+
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../libs/crsf/crc8.h"
+
+static void BM_Crc8(benchmark::State& state, Crc8::Impl impl) {
+    Crc8 crc(0xD5);
+    if (!crc.setImpl(impl)) {
+        state.SkipWithError("реализация не поддерживается процессором");
+        return;
+    }
+
+    std::vector<uint8_t> buf(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < buf.size(); i++) {
+        buf[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(crc.update(0, buf.data(), buf.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+// 26 — кадр каналов CRSF, 64 — максимальный кадр
+BENCHMARK_CAPTURE(BM_Crc8, table, Crc8::IMPL_TABLE)->Arg(26)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_Crc8, slice8, Crc8::IMPL_SLICE8)->Arg(26)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_Crc8, clmul, Crc8::IMPL_CLMUL)->Arg(26)->Arg(64)->Arg(4096)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
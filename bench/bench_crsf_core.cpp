@@ -0,0 +1,282 @@
+/**
+ * @file bench_crsf_core.cpp
+ * @brief Бенчмарк ядра CRSF: разбор входного потока, сборка кадров на отправку и разбор текстовых команд
+ *
+ * Parse — CrsfSerial::loop() поверх порта в памяти (MemorySerialPort): поток кадров, как от полётника
+ * (каналы, ориентация, батарея, статистика линка, GPS), отдаётся порциями по range(0) байт за read().
+ * Parse_Capture — то же с записью сырого потока в файл (libs/crsf/capture).
+ * Capture_IndexBuild / Capture_Replay — индекс кадров записи и её воспроизведение без пауз через
+ * CrsfSerial (libs/crsf/capture_replay); запись ~4 МБ из того же потока порциями по 26 байт.
+ * Garbage — поток без единого верного кадра (стоимость ресинхронизации на байт).
+ * QueuePacket — сборка кадра с CRC и запись в порт; ProcessSend — кодирование каналов и отправка.
+ * CommandFromText — разбор строк прежнего формата /tmp/crsf_command.txt (основной цикл crsf_io_rpi).
+ */
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../libs/SerialPort.h"
+#include "../libs/command_ring.h"
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/capture.h"
+#include "../libs/crsf/capture_replay.h"
+#include "../libs/crsf/channel_codec.h"
+#include "../libs/crsf/crc8.h"
+#include "../libs/crsf/crsf_protocol.h"
+
+// В crsf_io_rpi определена в globals.cpp; здесь отправка без активного линка разрешена
+bool g_ignore_telemetry = true;
+
+// Порт в памяти: чтение идёт по кругу из заготовленного потока порциями не больше chunk,
+// запись отбрасывается. Файл устройства не открывается
+class MemorySerialPort : public SerialPort {
+public:
+    MemorySerialPort(const std::vector<uint8_t>& stream, size_t chunk)
+        : SerialPort("/dev/null", CRSF_BAUDRATE), _stream(stream), _chunk(chunk), _pos(0), _read(0), _written(0) {}
+
+    int read(uint8_t* buf, size_t len) override {
+        size_t n = len < _chunk ? len : _chunk;
+        if (n > _stream.size() - _pos) {
+            n = _stream.size() - _pos;
+        }
+        memcpy(buf, &_stream[_pos], n);
+        _pos += n;
+        _read += n;
+        if (_pos == _stream.size()) {
+            _pos = 0;
+        }
+        return static_cast<int>(n);
+    }
+    int readByte(uint8_t& b) override { return read(&b, 1); }
+    int write(const uint8_t* buf, size_t len) override {
+        benchmark::DoNotOptimize(buf);
+        _written += len;
+        return static_cast<int>(len);
+    }
+    int writeByte(uint8_t b) override { return write(&b, 1); }
+
+    uint64_t bytesRead() const { return _read; }
+    uint64_t written() const { return _written; }
+
+private:
+    std::vector<uint8_t> _stream;
+    size_t _chunk;
+    size_t _pos;
+    uint64_t _read;
+    uint64_t _written;
+};
+
+static void appendFrame(std::vector<uint8_t>& out, uint8_t type, const uint8_t* payload, uint8_t len) {
+    Crc8 crc(0xD5);
+    uint8_t frame[CRSF_MAX_PACKET_SIZE];
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = len + 2;
+    frame[2] = type;
+    memcpy(&frame[3], payload, len);
+    frame[3 + len] = crc.calc(&frame[2], len + 1);
+    out.insert(out.end(), frame, frame + len + 4);
+}
+
+// Поток полётника: на 10 кадров каналов — по одному кадру телеметрии каждого типа
+static std::vector<uint8_t> telemetryStream() {
+    std::vector<uint8_t> out;
+    int us[CRSF_NUM_CHANNELS];
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE];
+    const uint8_t attitude[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0x01, 0x10, 0xFE, 0x20, 0x30, 0x00};
+    const uint8_t battery[CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE] = {0x00, 0xA8, 0x00, 0x0A, 0x00, 0x05, 0x46, 0x4C};
+    const uint8_t link[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE] = {50, 52, 100, 5, 0, 4, 2, 60, 98, 3};
+    const uint8_t gps[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0x21, 0x3A, 0x5B, 0x10, 0x16, 0x6B, 0x8C, 0x20,
+                                                      0x00, 0x7D, 0x46, 0x50, 0x04, 0x4C, 12};
+    for (int block = 0; block < 64; ++block) {
+        for (int i = 0; i < 10; ++i) {
+            for (int ch = 0; ch < CRSF_NUM_CHANNELS; ++ch) {
+                us[ch] = 1000 + (block * 37 + i * 11 + ch * 53) % 1001;
+            }
+            crsf_channels_encode(us, channels);
+            appendFrame(out, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+        }
+        appendFrame(out, CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+        appendFrame(out, CRSF_FRAMETYPE_BATTERY_SENSOR, battery, sizeof(battery));
+        appendFrame(out, CRSF_FRAMETYPE_LINK_STATISTICS, link, sizeof(link));
+        appendFrame(out, CRSF_FRAMETYPE_GPS, gps, sizeof(gps));
+    }
+    return out;
+}
+
+static void BM_Parse_TelemetryStream(benchmark::State& state) {
+    std::vector<uint8_t> stream = telemetryStream();
+    MemorySerialPort port(stream, static_cast<size_t>(state.range(0)));
+    CrsfSerial crsf(port);
+    for (auto _ : state) {
+        crsf.loop();
+    }
+    state.SetItemsProcessed(crsf.getRxFrameCount());
+    state.SetBytesProcessed(static_cast<int64_t>(port.bytesRead()));
+    state.counters["crc_errors"] = crsf.getLinkCounters().rxCrcErrors;
+}
+// 26 байт — один кадр каналов за read() (UART на 420 кбод), 256 — полное кольцо
+BENCHMARK(BM_Parse_TelemetryStream)->Arg(26)->Arg(64)->Arg(256);
+
+static void BM_Parse_TelemetryStream_Capture(benchmark::State& state) {
+    // То же с записью сырого потока: порция read() копируется в кольцо, файл пишет отдельный поток
+    std::vector<uint8_t> stream = telemetryStream();
+    MemorySerialPort port(stream, static_cast<size_t>(state.range(0)));
+    CrsfSerial crsf(port);
+    std::string path = "/tmp/bench_crsf_capture_" + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+    CrsfCapture capture;
+    if (!capture.open(path, CRSF_BAUDRATE)) {
+        state.SkipWithError("не удалось открыть файл записи");
+        return;
+    }
+    crsf.setCapture(&capture);
+    for (auto _ : state) {
+        crsf.loop();
+    }
+    crsf.setCapture(nullptr);
+    CaptureStats s = capture.stats();
+    capture.close();
+    unlink(path.c_str());
+    state.SetItemsProcessed(crsf.getRxFrameCount());
+    state.SetBytesProcessed(static_cast<int64_t>(port.bytesRead()));
+    state.counters["dropped_bytes"] = static_cast<double>(s.droppedBytes[CAPTURE_RX]);
+}
+BENCHMARK(BM_Parse_TelemetryStream_Capture)->Arg(26)->Arg(256);
+
+// Запись сырого потока для воспроизведения: поток полётника порциями по 26 байт через 620 мкс
+// (420 кбод), на каждые десять порций — ответный кадр каналов
+static bool writeCaptureFile(const std::string& path) {
+    std::vector<uint8_t> stream = telemetryStream();
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = {0};
+    std::vector<uint8_t> tx;
+    appendFrame(tx, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+    unlink(path.c_str());
+    CrsfCapture capture(32u << 20, 1000);
+    if (!capture.open(path, CRSF_BAUDRATE)) {
+        return false;
+    }
+    uint64_t ts = 1000000000ull;
+    size_t chunks = 0;
+    for (int rep = 0; rep < 128; ++rep) {
+        for (size_t pos = 0; pos < stream.size(); pos += 26, ts += 620000) {
+            capture.record(CAPTURE_RX, ts, &stream[pos], std::min<size_t>(26, stream.size() - pos));
+            if (++chunks % 10 == 0) {
+                capture.record(CAPTURE_TX, ts + 1000, tx.data(), tx.size());
+            }
+        }
+    }
+    capture.close();
+    return capture.stats().droppedBytes[CAPTURE_RX] == 0;
+}
+
+static void BM_Capture_IndexBuild(benchmark::State& state) {
+    std::string path = "/tmp/bench_crsf_replay_" + std::to_string(getpid()) + ".cap";
+    CaptureFile file;
+    if (!writeCaptureFile(path) || !file.open(path)) {
+        state.SkipWithError("не удалось подготовить запись");
+        return;
+    }
+    CaptureIndex index;
+    for (auto _ : state) {
+        index.build(file);
+        benchmark::DoNotOptimize(index.frameCount());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * index.frameCount()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * file.size()));
+    unlink(path.c_str());
+}
+BENCHMARK(BM_Capture_IndexBuild)->Unit(benchmark::kMillisecond);
+
+static void BM_Capture_Replay(benchmark::State& state) {
+    // Вся запись через CrsfSerial за итерацию: read() отдаёт до 256 байт (кольцо приёма) через границы записей
+    std::string path = "/tmp/bench_crsf_replay_" + std::to_string(getpid()) + ".cap";
+    CaptureFile file;
+    if (!writeCaptureFile(path) || !file.open(path)) {
+        state.SkipWithError("не удалось подготовить запись");
+        return;
+    }
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        CaptureReplayPort port(file);
+        CrsfSerial crsf(port);
+        while (!port.atEnd()) {
+            crsf.loop();
+        }
+        frames += crsf.getRxFrameCount();
+        bytes += port.bytesRead();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(frames));
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    unlink(path.c_str());
+}
+BENCHMARK(BM_Capture_Replay)->Unit(benchmark::kMillisecond);
+
+static void BM_Parse_Garbage(benchmark::State& state) {
+    // Байт длины всегда вне диапазона: каждый байт — шаг ресинхронизации
+    std::vector<uint8_t> stream(4096, 0xFF);
+    MemorySerialPort port(stream, 256);
+    CrsfSerial crsf(port);
+    for (auto _ : state) {
+        crsf.loop();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(crsf.getLinkCounters().rxResyncBytes));
+}
+BENCHMARK(BM_Parse_Garbage);
+
+static void BM_QueuePacket(benchmark::State& state) {
+    std::vector<uint8_t> empty(1, 0);
+    MemorySerialPort port(empty, 1);
+    CrsfSerial crsf(port);
+    std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x5A);
+    for (auto _ : state) {
+        crsf.queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_RC_CHANNELS_PACKED,
+                         payload.data(), static_cast<uint8_t>(payload.size()));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(port.written()));
+}
+// 6 байт — ATTITUDE, 22 — каналы, 60 — почти наибольшая полезная нагрузка
+BENCHMARK(BM_QueuePacket)->Arg(6)->Arg(22)->Arg(60);
+
+static void BM_ProcessSend(benchmark::State& state) {
+    std::vector<uint8_t> empty(1, 0);
+    MemorySerialPort port(empty, 1);
+    CrsfSerial crsf(port);
+    std::array<int, CRSF_NUM_CHANNELS> values;
+    for (int ch = 0; ch < CRSF_NUM_CHANNELS; ++ch) {
+        values[ch] = 1000 + ch * 61;
+    }
+    crsf.setChannels(values);
+    for (auto _ : state) {
+        crsf.setChannel(1, 1000 + static_cast<int>(state.iterations() % 1001));
+        crsf.processSend();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProcessSend);
+
+static void BM_CommandFromText(benchmark::State& state) {
+    static const char* const LINES[] = {
+        "setChannel 3 1750",
+        "setChannels 1=1500 2=1600 3=1000 4=1500 5=2000 6=1000 7=1500 8=1500 "
+        "9=1500 10=1500 11=1500 12=1500 13=1500 14=1500 15=1500 16=1500",
+        "sendChannels",
+        "setMode manual",
+    };
+    std::string line = LINES[state.range(0)];
+    CommandRecord rec;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(command_from_text(line, rec));
+        benchmark::DoNotOptimize(rec);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(line.substr(0, line.find(' ')));
+}
+BENCHMARK(BM_CommandFromText)->DenseRange(0, 3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+/**
+ * @file bench_latency_metrics.cpp
+ * @brief Стоимость замера задержки горячего пути (цель — меньше 50 нс на отсчёт)
+ *
+ * Now — только чтение CLOCK_MONOTONIC, Record — только запись в гистограмму,
+ * Sample — полный замер, как в handleByteReceived: время конца и запись отрезка.
+ * Prometheus — формирование ответа GET /metrics.
+ */
+
+#include <benchmark/benchmark.h>
+#include "../libs/latency_metrics.h"
+
+static void BM_Latency_Now(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(latency_now_ns());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Latency_Now);
+
+static void BM_Latency_Record(benchmark::State& state) {
+    HdrHistogram h;
+    uint64_t ns = 1000;
+    for (auto _ : state) {
+        h.record(ns);
+        ns = (ns * 1103515245 + 12345) & 0xFFFFF; // разные корзины, до ~1 мс
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Latency_Record);
+
+static void BM_Latency_Sample(benchmark::State& state) {
+    LatencyMetrics metrics;
+    uint64_t start = latency_now_ns();
+    for (auto _ : state) {
+        // Конец одного отрезка — начало следующего (как rx_to_crc → crc_to_dispatch)
+        uint64_t end = latency_now_ns();
+        metrics.record(LATENCY_RX_TO_CRC, start, end);
+        start = end;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Latency_Sample);
+
+static void BM_Latency_Sample_Threads(benchmark::State& state) {
+    static LatencyMetrics metrics;
+    uint64_t start = latency_now_ns();
+    for (auto _ : state) {
+        uint64_t end = latency_now_ns();
+        metrics.record(LATENCY_CMD_QUEUE, start, end);
+        start = end;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Latency_Sample_Threads)->Threads(2)->Threads(4);
+
+static void BM_Latency_Prometheus(benchmark::State& state) {
+    LatencyMetrics metrics;
+    for (unsigned int s = 0; s < LATENCY_STAGE_COUNT; ++s) {
+        for (uint64_t ns = 100; ns < 10000000; ns = ns * 3 / 2) {
+            metrics.record(static_cast<LatencyStage>(s), 1, 1 + ns);
+        }
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.prometheus());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Latency_Prometheus);
+
+BENCHMARK_MAIN();
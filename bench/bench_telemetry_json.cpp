@@ -0,0 +1,174 @@
+/**
+ * @file bench_telemetry_json.cpp
+ * @brief Бенчмарк сериализации телеметрии в JSON: std::stringstream против std::to_chars
+ *
+ * Stringstream — прежний код sendTelemetryToApiServer (crsf_api_interpreter).
+ * ToChars — telemetry_json_encode в буфер на стеке.
+ * Счётчик allocs_per_op — выделения памяти (operator new) на одну сериализацию.
+ */
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+#include "../libs/telemetry_json.h"
+
+static std::atomic<uint64_t> allocations(0);
+
+// noinline: иначе GCC после встраивания сопоставляет malloc/free с new/delete (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static SharedTelemetryData sampleTelemetry()
+{
+    SharedTelemetryData d = {};
+    d.linkUp = true;
+    d.lastReceive = 1234567;
+    for (int i = 0; i < 16; i++) {
+        d.channels[i] = 1000 + i * 60;
+    }
+    d.packetsReceived = 987654;
+    d.packetsSent = 12345;
+    d.packetsLost = 42;
+    d.latitude = 55.7512345;
+    d.longitude = 37.6184321;
+    d.altitude = 152.5;
+    d.speed = 12.75;
+    d.voltage = 16.8;
+    d.current = 23.4;
+    d.capacity = 1350.0;
+    d.remaining = 76;
+    d.roll = -3.25;
+    d.pitch = 1.5;
+    d.yaw = 179.9;
+    d.rollRaw = -5672;
+    d.pitchRaw = 2618;
+    d.yawRaw = 31398;
+    return d;
+}
+
+// Прежняя сериализация через std::stringstream
+static std::string stringstreamJson(const SharedTelemetryData& data, const std::string& timestamp)
+{
+    std::stringstream json;
+    json << "{";
+    json << "\"linkUp\":" << (data.linkUp ? "true" : "false") << ",";
+    json << "\"lastReceive\":" << data.lastReceive << ",";
+    json << "\"channels\":[";
+    for (int i = 0; i < 16; i++) {
+        if (i > 0) json << ",";
+        json << data.channels[i];
+    }
+    json << "],";
+    json << "\"packetsReceived\":" << data.packetsReceived << ",";
+    json << "\"packetsSent\":" << data.packetsSent << ",";
+    json << "\"packetsLost\":" << data.packetsLost << ",";
+    json << "\"gps\":{";
+    json << "\"latitude\":" << std::fixed << std::setprecision(6) << data.latitude << ",";
+    json << "\"longitude\":" << data.longitude << ",";
+    json << "\"altitude\":" << data.altitude << ",";
+    json << "\"speed\":" << data.speed;
+    json << "},";
+    json << "\"battery\":{";
+    json << "\"voltage\":" << data.voltage << ",";
+    json << "\"current\":" << data.current << ",";
+    json << "\"capacity\":" << data.capacity << ",";
+    json << "\"remaining\":" << static_cast<int>(data.remaining);
+    json << "},";
+    json << "\"attitude\":{";
+    json << "\"roll\":" << data.roll << ",";
+    json << "\"pitch\":" << data.pitch << ",";
+    json << "\"yaw\":" << data.yaw;
+    json << "},";
+    json << "\"attitudeRaw\":{";
+    json << "\"roll\":" << data.rollRaw << ",";
+    json << "\"pitch\":" << data.pitchRaw << ",";
+    json << "\"yaw\":" << data.yawRaw;
+    json << "},";
+    json << "\"timestamp\":\"" << timestamp << "\",";
+    json << "\"activePort\":\"UART Active\"";
+    json << "}";
+    return json.str();
+}
+
+static void reportAllocations(benchmark::State& state, uint64_t before)
+{
+    uint64_t total = allocations.load(std::memory_order_relaxed) - before;
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        static_cast<double>(total) / static_cast<double>(state.iterations()));
+}
+
+static void BM_TelemetryJson_Stringstream(benchmark::State& state)
+{
+    SharedTelemetryData data = sampleTelemetry();
+    std::string timestamp = "12:34:56.789";
+    size_t bytes = 0;
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        std::string json = stringstreamJson(data, timestamp);
+        bytes += json.size();
+        benchmark::DoNotOptimize(json.data());
+    }
+    reportAllocations(state, before);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TelemetryJson_Stringstream);
+
+static void BM_TelemetryJson_ToChars(benchmark::State& state)
+{
+    SharedTelemetryData data = sampleTelemetry();
+    char buf[TELEMETRY_JSON_MAX];
+    size_t bytes = 0;
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        size_t len = telemetry_json_encode(data, "12:34:56.789", buf, sizeof(buf));
+        bytes += len;
+        benchmark::DoNotOptimize(buf);
+        benchmark::ClobberMemory();
+    }
+    reportAllocations(state, before);
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_TelemetryJson_ToChars);
+
+// Полный путь отправки: метка времени + сериализация (метка раньше шла через std::put_time)
+static void BM_TelemetryJson_ToCharsWithTimestamp(benchmark::State& state)
+{
+    SharedTelemetryData data = sampleTelemetry();
+    char buf[TELEMETRY_JSON_MAX];
+    char timestamp[TELEMETRY_TIMESTAMP_MAX];
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        telemetry_json_timestamp(timestamp, sizeof(timestamp));
+        size_t len = telemetry_json_encode(data, timestamp, buf, sizeof(buf));
+        benchmark::DoNotOptimize(len);
+        benchmark::ClobberMemory();
+    }
+    reportAllocations(state, before);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TelemetryJson_ToCharsWithTimestamp);
+
+BENCHMARK_MAIN();
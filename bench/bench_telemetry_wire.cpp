@@ -0,0 +1,159 @@
+/**
+ * @file bench_telemetry_wire.cpp
+ * @brief Бенчмарк форматов телеметрии: JSON против бинарного кадра (ключевого и разностного)
+ *
+ * Счётчик bytes_per_frame — размер тела POST /api/telemetry в каждом формате.
+ * Разностный кадр — типичное обновление на 50 Гц: меняются 4 канала и ориентация.
+ * DecodeToJson — путь приёма в crsf_api_server: сборка снимка и JSON для GET/SSE.
+ */
+
+#include <benchmark/benchmark.h>
+#include "../libs/telemetry_json.h"
+#include "../libs/telemetry_wire.h"
+
+static SharedTelemetryData sampleTelemetry()
+{
+    SharedTelemetryData d = {};
+    d.linkUp = true;
+    d.lastReceive = 1234567;
+    for (int i = 0; i < 16; i++) {
+        d.channels[i] = 1000 + i * 60;
+    }
+    d.packetsReceived = 987654;
+    d.packetsSent = 12345;
+    d.packetsLost = 42;
+    d.latitude = 55.7512345;
+    d.longitude = 37.6184321;
+    d.altitude = 152.5;
+    d.speed = 12.75;
+    d.voltage = 16.8;
+    d.current = 23.4;
+    d.capacity = 1350.0;
+    d.remaining = 76;
+    d.roll = -3.25;
+    d.pitch = 1.5;
+    d.yaw = 179.9;
+    d.rollRaw = -5672;
+    d.pitchRaw = 2618;
+    d.yawRaw = 31398;
+    return d;
+}
+
+// Следующий снимок: стики (4 канала), ориентация и время приёма
+static SharedTelemetryData nextTelemetry(const SharedTelemetryData& prev)
+{
+    SharedTelemetryData d = prev;
+    d.lastReceive += 20;
+    for (int i = 0; i < 4; i++) {
+        d.channels[i] += 3;
+    }
+    d.roll += 0.01;
+    d.pitch -= 0.01;
+    d.yaw += 0.02;
+    d.rollRaw += 10;
+    d.pitchRaw -= 10;
+    d.yawRaw += 20;
+    return d;
+}
+
+static void BM_Json_Encode(benchmark::State& state)
+{
+    SharedTelemetryData data = sampleTelemetry();
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = 0;
+    for (auto _ : state) {
+        len = telemetry_json_encode(data, "12:34:56.789", buf, sizeof(buf));
+        benchmark::DoNotOptimize(buf);
+        benchmark::ClobberMemory();
+    }
+    state.counters["bytes_per_frame"] = static_cast<double>(len);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Json_Encode);
+
+static void BM_Wire_EncodeKeyframe(benchmark::State& state)
+{
+    SharedTelemetryData data = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = 0;
+    uint32_t seq = 0;
+    for (auto _ : state) {
+        len = telemetry_wire_encode(data, ++seq, 45296789, nullptr, 0, buf, sizeof(buf));
+        benchmark::DoNotOptimize(buf);
+        benchmark::ClobberMemory();
+    }
+    state.counters["bytes_per_frame"] = static_cast<double>(len);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wire_EncodeKeyframe);
+
+static void BM_Wire_EncodeDelta(benchmark::State& state)
+{
+    SharedTelemetryData base = sampleTelemetry();
+    SharedTelemetryData data = nextTelemetry(base);
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = 0;
+    for (auto _ : state) {
+        len = telemetry_wire_encode(data, 2, 45296809, &base, 1, buf, sizeof(buf));
+        benchmark::DoNotOptimize(buf);
+        benchmark::ClobberMemory();
+    }
+    state.counters["bytes_per_frame"] = static_cast<double>(len);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wire_EncodeDelta);
+
+static void BM_Wire_DecodeKeyframe(benchmark::State& state)
+{
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = telemetry_wire_encode(sampleTelemetry(), 1, 45296789, nullptr, 0, buf, sizeof(buf));
+    TelemetryWireFrame frame = {};
+    for (auto _ : state) {
+        TelemetryWireStatus status = telemetry_wire_decode(buf, len, frame);
+        benchmark::DoNotOptimize(status);
+        benchmark::DoNotOptimize(frame);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wire_DecodeKeyframe);
+
+static void BM_Wire_DecodeDelta(benchmark::State& state)
+{
+    SharedTelemetryData base = sampleTelemetry();
+    uint8_t key[TELEMETRY_WIRE_MAX];
+    size_t keyLen = telemetry_wire_encode(base, 1, 45296789, nullptr, 0, key, sizeof(key));
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = telemetry_wire_encode(nextTelemetry(base), 2, 45296809, &base, 1, buf, sizeof(buf));
+    TelemetryWireFrame baseFrame = {};
+    telemetry_wire_decode(key, keyLen, baseFrame);
+    TelemetryWireFrame frame;
+    for (auto _ : state) {
+        // База перед каждым кадром (копия снимка seq 1): разностный кадр применяется к ней
+        frame = baseFrame;
+        TelemetryWireStatus status = telemetry_wire_decode(buf, len, frame);
+        benchmark::DoNotOptimize(status);
+        benchmark::DoNotOptimize(frame);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wire_DecodeDelta);
+
+static void BM_Wire_DecodeToJson(benchmark::State& state)
+{
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = telemetry_wire_encode(sampleTelemetry(), 1, 45296789, nullptr, 0, buf, sizeof(buf));
+    TelemetryWireFrame frame = {};
+    char timestamp[TELEMETRY_TIMESTAMP_MAX];
+    char json[TELEMETRY_JSON_MAX];
+    for (auto _ : state) {
+        telemetry_wire_decode(buf, len, frame);
+        telemetry_json_format_time(frame.timeOfDayMs, timestamp, sizeof(timestamp));
+        size_t jsonLen = telemetry_json_encode(frame.data, timestamp, json, sizeof(json));
+        benchmark::DoNotOptimize(jsonLen);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Wire_DecodeToJson);
+
+BENCHMARK_MAIN();
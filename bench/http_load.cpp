@@ -0,0 +1,253 @@
+/**
+ * @file http_load.cpp
+ * @brief Нагрузочный тест HTTP-движка (libs/http_server)
+ *
+ * N клиентских потоков держат по одному keep-alive соединению и шлют запросы
+ * пачками по --pipeline штук (конвейер). Задержка запроса — от отправки пачки
+ * до получения его ответа целиком. В конце печатаются запросы/с и p50/p99/max
+ * по точным (отсортированным) выборкам.
+ *
+ * Без --port поднимается HttpServer в этом же процессе: отдаёт заранее
+ * сериализованный JSON размером с телеметрию через общий буфер (sharedBody).
+ * С --port нагружается внешний сервер, например crsf_api_server:
+ *   ./http_load --port 8081 --path /api/telemetry --connections 8 --duration 10
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "http_server.h"
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 0;                 // 0 — встроенный сервер
+    std::string path = "/api/telemetry";
+    int connections = 4;
+    int pipeline = 1;
+    double duration = 5.0;        // секунд
+    unsigned int workers = 2;     // рабочих потоков встроенного сервера
+};
+
+struct ClientResult {
+    std::vector<uint32_t> latencyUs;
+    uint64_t errors = 0;
+};
+
+void usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "Использование: %s [--host H] [--port P] [--path /api/telemetry]\n"
+                 "                  [--connections N] [--pipeline D] [--duration S] [--workers W]\n", argv0);
+}
+
+bool parseOptions(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--host") {
+            opt.host = value;
+        } else if (arg == "--port") {
+            opt.port = std::atoi(value);
+        } else if (arg == "--path") {
+            opt.path = value;
+        } else if (arg == "--connections") {
+            opt.connections = std::max(1, std::atoi(value));
+        } else if (arg == "--pipeline") {
+            opt.pipeline = std::max(1, std::atoi(value));
+        } else if (arg == "--duration") {
+            opt.duration = std::atof(value);
+        } else if (arg == "--workers") {
+            opt.workers = static_cast<unsigned int>(std::max(1, std::atoi(value)));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int connectTo(const Options& opt)
+{
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(opt.host.c_str(), std::to_string(opt.port).c_str(), &hints, &res) != 0 || !res) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// Прочитать один ответ (заголовки + тело по Content-Length). buffer хранит хвост следующего ответа
+bool readResponse(int fd, std::string& buffer)
+{
+    char chunk[16384];
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    std::string headers = buffer.substr(0, headerEnd);
+    for (char& c : headers) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    size_t bodyLen = 0;
+    size_t lenPos = headers.find("\r\ncontent-length:");
+    if (lenPos != std::string::npos) {
+        bodyLen = std::strtoul(headers.c_str() + lenPos + 17, nullptr, 10);
+    }
+    size_t total = headerEnd + 4 + bodyLen;
+    while (buffer.size() < total) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    bool ok = buffer.compare(0, 12, "HTTP/1.1 200") == 0;
+    buffer.erase(0, total);
+    return ok;
+}
+
+void clientLoop(const Options& opt, std::chrono::steady_clock::time_point deadline, ClientResult& result)
+{
+    int fd = connectTo(opt);
+    if (fd < 0) {
+        ++result.errors;
+        return;
+    }
+    std::string one = "GET " + opt.path + " HTTP/1.1\r\nHost: " + opt.host + "\r\n\r\n";
+    std::string batch;
+    for (int i = 0; i < opt.pipeline; ++i) {
+        batch += one;
+    }
+    std::string buffer;
+    result.latencyUs.reserve(1 << 16);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto sent = std::chrono::steady_clock::now();
+        if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size())) {
+            ++result.errors;
+            break;
+        }
+        for (int i = 0; i < opt.pipeline; ++i) {
+            if (!readResponse(fd, buffer)) {
+                ++result.errors;
+                close(fd);
+                return;
+            }
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sent).count();
+            result.latencyUs.push_back(static_cast<uint32_t>(us));
+        }
+    }
+    close(fd);
+}
+
+// Тело ответа встроенного сервера: JSON размером с типичную телеметрию
+std::string sampleTelemetryJson()
+{
+    std::string json = "{\"linkUp\":true,\"lastReceive\":123456,\"channels\":[";
+    for (int i = 0; i < 16; ++i) {
+        json += (i ? "," : "") + std::to_string(1500 + i);
+    }
+    json += "],\"packetsReceived\":1000,\"packetsSent\":1000,\"packetsLost\":0,"
+            "\"gps\":{\"latitude\":55.751244,\"longitude\":37.618423,\"altitude\":150.000000,\"speed\":0.000000},"
+            "\"battery\":{\"voltage\":12.600000,\"current\":1.200000,\"capacity\":500.000000,\"remaining\":87},"
+            "\"attitude\":{\"roll\":1.500000,\"pitch\":-0.700000,\"yaw\":180.000000},"
+            "\"timestamp\":\"12:00:00.000\",\"activePort\":\"UART Active\"}";
+    return json;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::unique_ptr<HttpServer> server;
+    if (opt.port == 0) {
+        auto body = std::make_shared<const std::string>(sampleTelemetryJson());
+        server.reset(new HttpServer([body](const HttpRequest&, HttpResponse& resp) {
+            resp.sharedBody = body;
+        }, opt.workers));
+        if (!server->listen(0) || !server->start()) {
+            std::fprintf(stderr, "не удалось запустить встроенный сервер\n");
+            return 1;
+        }
+        opt.port = server->port();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::microseconds(static_cast<int64_t>(opt.duration * 1e6));
+    std::vector<ClientResult> results(static_cast<size_t>(opt.connections));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < opt.connections; ++i) {
+        threads.emplace_back(clientLoop, std::cref(opt), deadline, std::ref(results[static_cast<size_t>(i)]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (server) {
+        server->stop();
+    }
+
+    std::vector<uint32_t> all;
+    uint64_t errors = 0;
+    for (auto& r : results) {
+        all.insert(all.end(), r.latencyUs.begin(), r.latencyUs.end());
+        errors += r.errors;
+    }
+    std::sort(all.begin(), all.end());
+    auto pct = [&all](double q) -> uint32_t {
+        if (all.empty()) {
+            return 0;
+        }
+        size_t idx = static_cast<size_t>(q * static_cast<double>(all.size() - 1) + 0.5);
+        return all[idx];
+    };
+
+    std::printf("target        %s:%d%s%s\n", opt.host.c_str(), opt.port, opt.path.c_str(), server ? " (встроенный сервер)" : "");
+    std::printf("connections   %d, pipeline %d, %.1f s\n", opt.connections, opt.pipeline, elapsed);
+    std::printf("requests      %zu (ошибок %llu)\n", all.size(), static_cast<unsigned long long>(errors));
+    std::printf("requests/s    %.0f\n", static_cast<double>(all.size()) / elapsed);
+    std::printf("latency us    p50 %u  p99 %u  max %u\n", pct(0.50), pct(0.99), all.empty() ? 0u : all.back());
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,503 @@
+/**
+ * @file pty_latency.cpp
+ * @brief Сквозная задержка crsf_io_rpi без железа: симулятор полётника на паре PTY
+ *
+ * Открывается псевдотерминал; crsf_io_rpi запускается с --port=<slave>, а этот процесс
+ * на master-стороне играет полётник: шлёт кадры каналов, ориентации, GPS, батареи и
+ * статистики линка с заданными частотами по абсолютному расписанию и читает исходящие кадры.
+ *
+ * RX → телеметрия: в кадре ATTITUDE (байты 2-3, roll) идёт сквозной номер; задержка — от
+ * write() в master до появления этого номера в разделяемой памяти (SharedTelemetry::read()).
+ * Команда → эфир: через кольцо команд (CommandRingClient) задаётся значение пробного канала
+ * (по умолчанию вместе с CMD_SEND_CHANNELS, с --tick — отправка по таймеру crsf_io_rpi);
+ * задержка — от постановки в очередь до чтения кадра RC_CHANNELS_PACKED с этим значением.
+ * Команда, значение которой не ушло в эфир до следующей, считается пропущенной.
+ *
+ * Время у всех — CLOCK_MONOTONIC (command_ring_now_ns()). В отчёте p50/p90/p99/p99.9/max
+ * по точным (отсортированным) выборкам. Области /dev/shm общие: второй crsf_io_rpi
+ * на той же машине запускать нельзя.
+ *   ./pty_latency --duration 10 --channels-hz 50 --attitude-hz 100 --command-hz 50
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "../libs/command_ring.h"
+#include "../libs/shared_telemetry.h"
+#include "../libs/crsf/channel_codec.h"
+#include "../libs/crsf/crc8.h"
+#include "../libs/crsf/crsf_protocol.h"
+
+namespace {
+
+struct Options {
+    std::string bin = "../crsf_io_rpi";
+    double duration = 5.0;        // секунд измерения (после прогрева)
+    double warmup = 0.5;          // секунд до начала замеров
+    double channelsHz = 50.0;     // 0 — кадров каналов нет, crsf_io_rpi запускается с --notel
+    double attitudeHz = 100.0;
+    double gpsHz = 10.0;
+    double batteryHz = 5.0;
+    double linkHz = 10.0;
+    double commandHz = 50.0;
+    unsigned int probeChannel = 8; // 1..16
+    bool tick = false;            // команда без CMD_SEND_CHANNELS: в эфир по таймеру отправки
+};
+
+// Выборки одного измерения (нс)
+struct Samples {
+    std::mutex mutex;
+    std::vector<uint64_t> ns;
+    uint64_t missed = 0;
+
+    void add(uint64_t v) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ns.push_back(v);
+    }
+};
+
+// Номера кадров ATTITUDE → время записи в master (кольцо больше числа кадров «в пути»)
+constexpr unsigned int PROBE_RING = 4096;
+
+struct Shared {
+    std::atomic<bool> stop{false};
+    std::atomic<bool> measuring{false};
+    // RX → телеметрия
+    std::atomic<uint64_t> attitudeSentNs[PROBE_RING];
+    // Команда → эфир: ожидаемое значение пробного канала и время постановки команды
+    std::atomic<int> pendingValue{0};     // 0 — ожидания нет
+    std::atomic<uint64_t> pendingNs{0};
+    std::atomic<int> commandedValue{1500}; // последнее заданное значение (полётник его повторяет)
+    std::atomic<uint64_t> rxFramesOut{0};  // кадров каналов от crsf_io_rpi
+    Samples telemetry;
+    Samples command;
+};
+
+void usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "Использование: %s [--bin ../crsf_io_rpi] [--duration S] [--warmup S]\n"
+                 "                  [--channels-hz F] [--attitude-hz F] [--gps-hz F] [--battery-hz F] [--link-hz F]\n"
+                 "                  [--command-hz F] [--probe-channel 1..16] [--tick]\n", argv0);
+}
+
+bool parseOptions(int argc, char* argv[], Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tick") {
+            opt.tick = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--bin") {
+            opt.bin = value;
+        } else if (arg == "--duration") {
+            opt.duration = std::atof(value);
+        } else if (arg == "--warmup") {
+            opt.warmup = std::atof(value);
+        } else if (arg == "--channels-hz") {
+            opt.channelsHz = std::atof(value);
+        } else if (arg == "--attitude-hz") {
+            opt.attitudeHz = std::atof(value);
+        } else if (arg == "--gps-hz") {
+            opt.gpsHz = std::atof(value);
+        } else if (arg == "--battery-hz") {
+            opt.batteryHz = std::atof(value);
+        } else if (arg == "--link-hz") {
+            opt.linkHz = std::atof(value);
+        } else if (arg == "--command-hz") {
+            opt.commandHz = std::atof(value);
+        } else if (arg == "--probe-channel") {
+            opt.probeChannel = static_cast<unsigned int>(std::atoi(value));
+            if (opt.probeChannel < 1 || opt.probeChannel > CRSF_NUM_CHANNELS) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return opt.attitudeHz > 0 && opt.commandHz > 0;
+}
+
+void sleepUntil(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000ull);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000ull);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+size_t buildFrame(uint8_t* frame, uint8_t type, const uint8_t* payload, uint8_t len)
+{
+    static Crc8 crc(0xD5);
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = len + 2;
+    frame[2] = type;
+    std::memcpy(&frame[3], payload, len);
+    frame[3 + len] = crc.calc(&frame[2], len + 1);
+    return len + 4u;
+}
+
+bool writeAll(int fd, const uint8_t* buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Полётник: каждый поток кадров идёт по своему абсолютному расписанию
+void flightControllerLoop(int masterFd, const Options& opt, Shared& sh)
+{
+    struct Stream {
+        uint8_t type;
+        double hz;
+        uint64_t nextNs;
+    };
+    Stream streams[] = {
+        {CRSF_FRAMETYPE_RC_CHANNELS_PACKED, opt.channelsHz, 0},
+        {CRSF_FRAMETYPE_ATTITUDE, opt.attitudeHz, 0},
+        {CRSF_FRAMETYPE_GPS, opt.gpsHz, 0},
+        {CRSF_FRAMETYPE_BATTERY_SENSOR, opt.batteryHz, 0},
+        {CRSF_FRAMETYPE_LINK_STATISTICS, opt.linkHz, 0},
+    };
+    const uint8_t battery[CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE] = {0x00, 0xA8, 0x00, 0x0A, 0x00, 0x05, 0x46, 0x4C};
+    const uint8_t link[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE] = {50, 52, 100, 5, 0, 4, 2, 60, 98, 3};
+    const uint8_t gps[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0x21, 0x3A, 0x5B, 0x10, 0x16, 0x6B, 0x8C, 0x20,
+                                                      0x00, 0x7D, 0x46, 0x50, 0x04, 0x4C, 12};
+    uint8_t frame[CRSF_MAX_PACKET_SIZE];
+    uint16_t probe = 0;
+
+    uint64_t start = command_ring_now_ns();
+    for (auto& s : streams) {
+        s.nextNs = start;
+    }
+    while (!sh.stop.load(std::memory_order_relaxed)) {
+        Stream* due = nullptr;
+        for (auto& s : streams) {
+            if (s.hz > 0 && (due == nullptr || s.nextNs < due->nextNs)) {
+                due = &s;
+            }
+        }
+        sleepUntil(due->nextNs);
+        due->nextNs += static_cast<uint64_t>(1e9 / due->hz);
+
+        size_t len = 0;
+        switch (due->type) {
+        case CRSF_FRAMETYPE_RC_CHANNELS_PACKED: {
+            // Пробный канал повторяет последнее заданное значение, чтобы не затирать команду
+            int us[CRSF_NUM_CHANNELS];
+            for (unsigned int ch = 0; ch < CRSF_NUM_CHANNELS; ++ch) {
+                us[ch] = 1500;
+            }
+            us[opt.probeChannel - 1] = sh.commandedValue.load(std::memory_order_relaxed);
+            uint8_t payload[CRSF_CHANNELS_PAYLOAD_SIZE];
+            crsf_channels_encode(us, payload);
+            len = buildFrame(frame, due->type, payload, sizeof(payload));
+            break;
+        }
+        case CRSF_FRAMETYPE_ATTITUDE: {
+            // Номер в roll (байты 2-3, big-endian); 0 не используется — начальное значение телеметрии
+            probe = static_cast<uint16_t>(probe % 30000 + 1);
+            uint8_t payload[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0x01, 0x10, 0, 0, 0x30, 0x00};
+            payload[2] = static_cast<uint8_t>(probe >> 8);
+            payload[3] = static_cast<uint8_t>(probe);
+            len = buildFrame(frame, due->type, payload, sizeof(payload));
+            break;
+        }
+        case CRSF_FRAMETYPE_GPS:
+            len = buildFrame(frame, due->type, gps, sizeof(gps));
+            break;
+        case CRSF_FRAMETYPE_BATTERY_SENSOR:
+            len = buildFrame(frame, due->type, battery, sizeof(battery));
+            break;
+        default:
+            len = buildFrame(frame, due->type, link, sizeof(link));
+            break;
+        }
+        // Время фиксируется до write(): после него crsf_io_rpi может опубликовать номер раньше,
+        // чем полётник успеет его записать
+        if (due->type == CRSF_FRAMETYPE_ATTITUDE) {
+            sh.attitudeSentNs[probe % PROBE_RING].store(command_ring_now_ns(), std::memory_order_release);
+        }
+        if (!writeAll(masterFd, frame, len)) {
+            break;
+        }
+    }
+}
+
+// Наблюдатель телеметрии: опрос seqlock без системных вызовов
+void telemetryWatchLoop(Shared& sh)
+{
+    SharedTelemetry telemetry;
+    while (!telemetry.open()) {
+        if (sh.stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint32_t lastSeq = 0;
+    int16_t lastRoll = 0;
+    SharedTelemetryData data;
+    while (!sh.stop.load(std::memory_order_relaxed)) {
+        uint32_t seq = telemetry.sequence();
+        if (seq == lastSeq || !telemetry.read(data)) {
+            continue;
+        }
+        uint64_t now = command_ring_now_ns();
+        lastSeq = seq;
+        if (data.rollRaw == lastRoll || data.rollRaw <= 0) {
+            continue;
+        }
+        lastRoll = data.rollRaw;
+        uint64_t sent = sh.attitudeSentNs[static_cast<uint16_t>(data.rollRaw) % PROBE_RING].load(std::memory_order_acquire);
+        if (sh.measuring.load(std::memory_order_relaxed) && sent != 0) {
+            sh.telemetry.add(now > sent ? now - sent : 0);
+        }
+    }
+}
+
+// Исходящие кадры crsf_io_rpi (master-сторона): ресинхронизация по адресу, проверка CRC
+void wireReadLoop(int masterFd, unsigned int probeChannel, Shared& sh)
+{
+    Crc8 crc(0xD5);
+    std::vector<uint8_t> buf;
+    uint8_t chunk[512];
+    while (!sh.stop.load(std::memory_order_relaxed)) {
+        struct pollfd pfd = {masterFd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        ssize_t n = read(masterFd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            break;
+        }
+        uint64_t now = command_ring_now_ns();
+        buf.insert(buf.end(), chunk, chunk + n);
+
+        size_t pos = 0;
+        while (buf.size() - pos >= 2) {
+            uint8_t len = buf[pos + 1];
+            if (len < 2 || len > CRSF_MAX_PACKET_SIZE - 2) {
+                ++pos;
+                continue;
+            }
+            if (buf.size() - pos < len + 2u) {
+                break;
+            }
+            uint8_t* f = &buf[pos];
+            if (crc.calc(&f[2], len - 1) != f[len + 1]) {
+                ++pos;
+                continue;
+            }
+            if (f[2] == CRSF_FRAMETYPE_RC_CHANNELS_PACKED && len - 2 == CRSF_CHANNELS_PAYLOAD_SIZE) {
+                sh.rxFramesOut.fetch_add(1, std::memory_order_relaxed);
+                int us[CRSF_NUM_CHANNELS];
+                crsf_channels_decode(&f[3], us);
+                int expected = sh.pendingValue.load(std::memory_order_acquire);
+                if (expected != 0 && us[probeChannel - 1] == expected) {
+                    uint64_t queued = sh.pendingNs.load(std::memory_order_relaxed);
+                    if (sh.pendingValue.compare_exchange_strong(expected, 0) && sh.measuring.load(std::memory_order_relaxed)) {
+                        sh.command.add(now > queued ? now - queued : 0);
+                    }
+                }
+            }
+            pos += len + 2u;
+        }
+        buf.erase(buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(pos));
+    }
+}
+
+// Команды: пробный канал 1000..1999 (кроме 1500 — значения полётника до первой команды)
+void commandLoop(CommandRingClient& client, const Options& opt, Shared& sh)
+{
+    const uint64_t period = static_cast<uint64_t>(1e9 / opt.commandHz);
+    uint64_t next = command_ring_now_ns();
+    int value = 1000;
+    while (!sh.stop.load(std::memory_order_relaxed)) {
+        sleepUntil(next);
+        next += period;
+
+        // Прошлая команда так и не ушла в эфир
+        if (sh.pendingValue.exchange(0) != 0 && sh.measuring.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(sh.command.mutex);
+            ++sh.command.missed;
+        }
+        value = value >= 1999 ? 1000 : value + 1;
+        if (value == 1500) {
+            ++value;
+        }
+
+        CommandRecord recs[2];
+        std::memset(recs, 0, sizeof(recs));
+        recs[0].type = CMD_SET_CHANNELS;
+        recs[0].mask = static_cast<uint16_t>(1u << (opt.probeChannel - 1));
+        recs[0].values[opt.probeChannel - 1] = static_cast<uint16_t>(value);
+        recs[1].type = CMD_SEND_CHANNELS;
+
+        sh.commandedValue.store(value, std::memory_order_relaxed);
+        sh.pendingNs.store(command_ring_now_ns(), std::memory_order_relaxed);
+        sh.pendingValue.store(value, std::memory_order_release);
+        if (!client.push(recs, opt.tick ? 1 : 2)) {
+            sh.pendingValue.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+pid_t spawn(const Options& opt, const char* slave)
+{
+    std::string port = std::string("--port=") + slave;
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+    // Метрики /metrics не нужны; без кадров каналов линк не поднимется — отправка разрешается явно
+    if (opt.channelsHz > 0) {
+        execl(opt.bin.c_str(), opt.bin.c_str(), port.c_str(), "--metrics-port=0", static_cast<char*>(nullptr));
+    } else {
+        execl(opt.bin.c_str(), opt.bin.c_str(), port.c_str(), "--metrics-port=0", "--notel", static_cast<char*>(nullptr));
+    }
+    std::fprintf(stderr, "не удалось запустить %s: %s\n", opt.bin.c_str(), std::strerror(errno));
+    _exit(127);
+}
+
+void report(const char* name, Samples& s)
+{
+    std::sort(s.ns.begin(), s.ns.end());
+    auto pct = [&s](double q) -> double {
+        if (s.ns.empty()) {
+            return 0.0;
+        }
+        size_t idx = static_cast<size_t>(q * static_cast<double>(s.ns.size() - 1) + 0.5);
+        return static_cast<double>(s.ns[idx]) / 1000.0;
+    };
+    std::printf("%-16s n %zu", name, s.ns.size());
+    if (s.missed) {
+        std::printf(" (пропущено %llu)", static_cast<unsigned long long>(s.missed));
+    }
+    std::printf("\n%-16s p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", "  latency us",
+                pct(0.50), pct(0.90), pct(0.99), pct(0.999), s.ns.empty() ? 0.0 : static_cast<double>(s.ns.back()) / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (masterFd < 0 || grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+        std::fprintf(stderr, "не удалось открыть PTY: %s\n", std::strerror(errno));
+        return 1;
+    }
+    const char* slave = ptsname(masterFd);
+    // Slave держим открытым сами: иначе между запуском и open() в crsf_io_rpi
+    // master получает EIO, а строковая дисциплина портит двоичные кадры
+    int slaveFd = open(slave, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slaveFd < 0 || tcgetattr(slaveFd, &tio) != 0) {
+        std::fprintf(stderr, "не удалось открыть %s: %s\n", slave, std::strerror(errno));
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slaveFd, TCSANOW, &tio);
+
+    pid_t child = spawn(opt, slave);
+    if (child < 0) {
+        std::fprintf(stderr, "fork: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    // Готовность crsf_io_rpi — кольцо команд принимает подключения (сокет есть только у живого процесса)
+    CommandRingClient client;
+    auto attachDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!client.attach()) {
+        int status;
+        if (waitpid(child, &status, WNOHANG) == child || std::chrono::steady_clock::now() > attachDeadline) {
+            std::fprintf(stderr, "crsf_io_rpi не запустился (%s)\n", opt.bin.c_str());
+            kill(child, SIGKILL);
+            waitpid(child, nullptr, 0);
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Shared sh;
+    for (auto& t : sh.attitudeSentNs) {
+        t.store(0, std::memory_order_relaxed);
+    }
+    std::thread watcher(telemetryWatchLoop, std::ref(sh));
+    std::thread reader(wireReadLoop, masterFd, opt.probeChannel, std::ref(sh));
+    std::thread fc(flightControllerLoop, masterFd, std::cref(opt), std::ref(sh));
+    std::thread commander(commandLoop, std::ref(client), std::cref(opt), std::ref(sh));
+
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(opt.warmup * 1e6)));
+    sh.measuring.store(true);
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(opt.duration * 1e6)));
+    sh.measuring.store(false);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sh.stop.store(true);
+
+    commander.join();
+    fc.join();
+    reader.join();
+    watcher.join();
+    client.close();
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+    close(slaveFd);
+    close(masterFd);
+
+    std::printf("target          %s --port=%s%s\n", opt.bin.c_str(), slave, opt.channelsHz > 0 ? "" : " --notel");
+    std::printf("rates hz        channels %.0f  attitude %.0f  gps %.0f  battery %.0f  link %.0f  command %.0f\n",
+                opt.channelsHz, opt.attitudeHz, opt.gpsHz, opt.batteryHz, opt.linkHz, opt.commandHz);
+    std::printf("measured        %.1f s, кадров каналов от crsf_io_rpi %llu, команда %s\n", elapsed,
+                static_cast<unsigned long long>(sh.rxFramesOut.load()),
+                opt.tick ? "по таймеру отправки" : "с CMD_SEND_CHANNELS");
+    report("rx->telemetry", sh.telemetry);
+    report("command->wire", sh.command);
+    return (sh.telemetry.ns.empty() || sh.command.ns.empty()) ? 1 : 0;
+}
@@ -185,8 +185,8 @@ def main(num_tests=5):
             print("    - Чтение файла основным приложением")
             print("    - Установку канала в CrsfSerial")
             print("    - Отправку пакета каналов (если включено)")
-            print("    - Запись телеметрии в файл /tmp/crsf_telemetry.dat")
-            print("    - Чтение файла Python оберткой")
+            print("    - Публикацию телеметрии в разделяемую память /dev/shm/crsf_telemetry")
+            print("    - Чтение снимка Python оберткой")
         else:
             print("\n  ✗ Бенчмарк не выполнен: ни один тест не завершился успешно")
         
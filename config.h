@@ -4,8 +4,10 @@
 #define USE_CRSF_RECV true   // включить приём CRSF на Raspberry Pi
 #define USE_CRSF_SEND true   // включить отправку телеметрии CRSF
 #define USE_LOG false    // включить журналы для отладки yaw
+#define USE_LATENCY_METRICS true  // гистограммы задержек горячего пути (GET /metrics); false — замеры не компилируются
 
 #define CRSF_BAUD 420000     // скорость CRSF
+#define METRICS_PORT 9102    // порт GET /metrics в crsf_io_rpi (--metrics-port=N, 0 — выключить)
 
 // Пути к последовательным портам Raspberry Pi для CRSF
 // Обычно: "/dev/ttyAMA0" (PL011) и "/dev/ttyS0" (miniUART)
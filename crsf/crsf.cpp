@@ -38,6 +38,43 @@ void crsfSendChannels()
   crsf->processSend(); // Асинхронная отправка через processSend
 }
 
+// Порт, уже переведённый в неблокирующий режим, и время последней попытки переоткрыть закрытый порт
+static SerialPort* nonBlockingPort = nullptr;
+static uint32_t lastReopenMs = 0;
+#define CRSF_REOPEN_INTERVAL_MS 1000
+
+int crsfGetRecvFd()
+{
+  SerialPort& port = crsf->port();
+  if (!port.isOpen()) {
+    // Порт закрыт после отключения (USB UART): переоткрываем не чаще раза в секунду
+    uint32_t now = rpi_millis();
+    if (now - lastReopenMs < CRSF_REOPEN_INTERVAL_MS) return -1;
+    lastReopenMs = now;
+    if (!port.open()) return -1;
+  }
+  // В событийном цикле read() вызывается только по готовности fd, ждать VTIME не нужно
+  if (nonBlockingPort != &port && port.setNonBlocking(true)) {
+    nonBlockingPort = &port;
+  }
+  return port.getFd();
+}
+
+void crsfCloseRecvPort()
+{
+  SerialPort& port = crsf->port();
+  if (nonBlockingPort == &port) {
+    nonBlockingPort = nullptr; // после open() порт снова блокирующий
+  }
+  port.close();
+  lastReopenMs = rpi_millis();
+}
+
+void crsfCheckTimeouts()
+{
+  crsf->checkTimeouts();
+}
+
 // Экспортируем как extern "C" для загрузки через ctypes
 extern "C" void* crsfGetActive()
 {
@@ -71,6 +108,24 @@ void loop_ch()
   crsf->loop();
 }
 
+void crsfSetPort(const char* path)
+{
+  crsfPort1.setPath(path);
+  crsfPort2.setPath("");
+}
+
+bool crsfStartCapture(const char* path)
+{
+  // Живёт до конца процесса: поток записи сбрасывает кольца каждые CAPTURE_FLUSH_MS
+  static CrsfCapture capture;
+  if (!capture.open(path, CRSF_BAUD)) {
+    return false;
+  }
+  crsf_1.setCapture(&capture);
+  crsf_2.setCapture(&capture);
+  return true;
+}
+
 void crsfInitRecv()
 {
   // Открываем последовательные порты для CRSF
@@ -98,11 +153,16 @@ void* crsfGetActive()
   return nullptr; // CRSF не инициализирован
 }
 
+void crsfSetPort(const char* path) { (void)path; }
+bool crsfStartCapture(const char* path) { (void)path; return false; }
 void crsfInitRecv() {}
 void crsfInitSend() {}
 void loop_ch() {}
 void crsfSetChannel(unsigned int ch, int value) {}
 void crsfSendChannels() {}
 void crsfTelemetrySend() {}
+int crsfGetRecvFd() { return -1; }
+void crsfCloseRecvPort() {}
+void crsfCheckTimeouts() {}
 
 #endif
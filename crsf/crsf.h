@@ -6,13 +6,25 @@
 #include "../libs/SerialPort.h"
 #include "../config.h"
 
+// Основной порт вместо CRSF_PORT_PRIMARY (например, slave-сторона PTY симулятора полётника);
+// резервный порт при этом не используется. Вызывать до crsfInitRecv()/crsfInitSend()
+void crsfSetPort(const char* path);
 void crsfInitRecv();
+// Запись сырого потока обоих портов в файл (--capture=PATH). false, если файл не открылся
+bool crsfStartCapture(const char* path);
 void crsfInitSend();
 void loop_ch();
 void crsfSetChannel(unsigned int ch, int value);
 void crsfSendChannels();
 void crsfTelemetrySend();
 
+// Для событийного цикла: fd порта активного CRSF (-1, если порт не открыт; закрытый порт
+// переоткрывается не чаще раза в секунду) и проверка таймаутов без чтения порта
+int crsfGetRecvFd();
+// Закрыть порт активного CRSF после отключения устройства (EPOLLHUP/EPOLLERR)
+void crsfCloseRecvPort();
+void crsfCheckTimeouts();
+
 // Получить указатель на активный CRSF объект
 // Экспортируется как extern "C" для загрузки через ctypes
 extern "C" void* crsfGetActive();
@@ -0,0 +1,101 @@
+// Пакетный разбор записи сырого потока CRSF (crsf_io_rpi --capture=PATH) в таблицы по типам кадров.
+//
+//   crsf_decode flight.cap out               — столбцы out/<таблица>.<столбец>.<тип> на всех ядрах
+//   crsf_decode flight.cap out --csv         — и таблицы out/<таблица>.csv
+//   crsf_decode flight.cap out --threads 1 --csv --no-columns
+//
+// Столбцы — значения фиксированной ширины подряд (little-endian), например:
+//   numpy.fromfile("out/gps.latitude.i32", dtype="<i4") / 1e7
+
+#include "libs/crsf/capture_decode.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+struct DecodeOptions {
+    std::string path;
+    std::string outDir;
+    unsigned int threads = 0;  // 0 — по числу ядер
+    bool csv = false;
+    bool columns = true;
+};
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr, "Использование: %s FILE OUTDIR [--threads N] [--csv] [--no-columns]\n", argv0);
+}
+
+static bool parseOptions(int argc, char* argv[], DecodeOptions& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            opt.csv = true;
+        } else if (arg == "--no-columns") {
+            opt.columns = false;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = static_cast<unsigned int>(atoi(argv[++i]));
+        } else if (arg.compare(0, 2, "--") == 0) {
+            return false;
+        } else if (opt.path.empty()) {
+            opt.path = arg;
+        } else if (opt.outDir.empty()) {
+            opt.outDir = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opt.path.empty() && !opt.outDir.empty();
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    DecodeOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    CaptureFile file;
+    if (!file.open(opt.path)) {
+        fprintf(stderr, "Ошибка: %s — не запись CRSF или не открывается\n", opt.path.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CaptureTables tables;
+    unsigned int threads = capture_decode(file, tables, opt.threads);
+    double decodeSeconds = secondsSince(start);
+    printf("decode        %.1f MB за %.3f s (%.1f MB/s), потоков %u\n", file.size() / 1e6, decodeSeconds,
+           decodeSeconds > 0 ? file.size() / 1e6 / decodeSeconds : 0.0, threads);
+    for (const auto& t : tables.tables) {
+        printf("  %-20s %zu\n", t.name.c_str(), t.rows);
+    }
+    printf("  %-20s %llu\n  %-20s %llu\n", "other", static_cast<unsigned long long>(tables.otherFrames),
+           "crcErrors", static_cast<unsigned long long>(tables.crcErrors));
+
+    if (opt.columns) {
+        start = std::chrono::steady_clock::now();
+        if (!capture_write_columns(tables, opt.outDir)) {
+            fprintf(stderr, "Ошибка записи столбцов в %s\n", opt.outDir.c_str());
+            return 1;
+        }
+        printf("columns       %s за %.3f s\n", opt.outDir.c_str(), secondsSince(start));
+    }
+    if (opt.csv) {
+        start = std::chrono::steady_clock::now();
+        if (!capture_write_csv(tables, opt.outDir)) {
+            fprintf(stderr, "Ошибка записи CSV в %s\n", opt.outDir.c_str());
+            return 1;
+        }
+        printf("csv           %s за %.3f s\n", opt.outDir.c_str(), secondsSince(start));
+    }
+    return 0;
+}
@@ -84,7 +84,7 @@ class CRSFRealtimeInterface:
                     "Ошибка",
                     f"Не удалось инициализировать CRSF: {e}\n\nУбедитесь, что:\n"
                     "1. Основное приложение crsf_io_rpi запущено\n"
-                    "2. Файл /tmp/crsf_telemetry.dat создаётся\n"
+                    "2. Разделяемая память /dev/shm/crsf_telemetry создаётся\n"
                     "3. Собрана pybind обёртка (crsf_native)",
                 )
                 return
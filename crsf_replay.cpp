@@ -0,0 +1,190 @@
+// Воспроизведение записи сырого потока CRSF (crsf_io_rpi --capture=PATH) через парсер CrsfSerial.
+//
+//   crsf_replay flight.cap                          — без пауз: скорость разбора и итоговая телеметрия
+//   crsf_replay flight.cap --realtime --speed 4     — в темпе записи, вчетверо быстрее
+//   crsf_replay flight.cap --from-s 120 --frames 500
+//   crsf_replay flight.cap --list 20 --type 0x1E    — кадры из индекса, без разбора
+//
+// Индекс кадров хранится рядом с записью (flight.cap.idx) и перестраивается, если запись дописана.
+
+#include "config.h"
+#include "libs/crsf/CrsfSerial.h"
+#include "libs/crsf/capture_replay.h"
+#include "libs/crsf/link_counters.h"
+#include "libs/rpi_hal.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+// g_ignore_telemetry определена в globals.cpp
+
+struct ReplayOptions {
+    std::string path;
+    bool realtime = false;
+    double speed = 1.0;
+    double fromSeconds = -1.0;   // от первой записи данных
+    long fromFrame = -1;
+    long frames = -1;            // остановиться, разобрав столько кадров RX (-1 — до конца)
+    long list = 0;               // вывести кадры из индекса вместо разбора
+    int type = -1;               // фильтр --list по типу кадра
+    bool reindex = false;
+};
+
+static void usage(const char* argv0)
+{
+    fprintf(stderr,
+            "Использование: %s FILE [--realtime] [--speed X] [--from-s S | --from-frame N] [--frames N]\n"
+            "                   [--list N] [--type 0xNN] [--reindex]\n", argv0);
+}
+
+static bool parseOptions(int argc, char* argv[], ReplayOptions& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--realtime") {
+            opt.realtime = true;
+        } else if (arg == "--reindex") {
+            opt.reindex = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--speed") {
+                opt.speed = atof(value);
+            } else if (arg == "--from-s") {
+                opt.fromSeconds = atof(value);
+            } else if (arg == "--from-frame") {
+                opt.fromFrame = atol(value);
+            } else if (arg == "--frames") {
+                opt.frames = atol(value);
+            } else if (arg == "--list") {
+                opt.list = atol(value);
+            } else if (arg == "--type") {
+                opt.type = static_cast<int>(strtol(value, nullptr, 0));
+            } else {
+                return false;
+            }
+        } else if (opt.path.empty()) {
+            opt.path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opt.path.empty();
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    ReplayOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    CaptureFile file;
+    if (!file.open(opt.path)) {
+        fprintf(stderr, "Ошибка: %s — не запись CRSF или не открывается\n", opt.path.c_str());
+        return 1;
+    }
+
+    std::string indexPath = opt.path + ".idx";
+    if (opt.reindex) {
+        unlink(indexPath.c_str());
+    }
+    auto indexStart = std::chrono::steady_clock::now();
+    CaptureIndex index;
+    index.load(file, indexPath);
+    double indexSeconds = secondsSince(indexStart);
+
+    uint64_t firstNs = file.firstTimestampNs();
+    uint64_t lastNs = index.frameCount() ? index.frame(index.frameCount() - 1).timestampNs : firstNs;
+    printf("capture       %s, %.1f MB, %.1f s записи\n", opt.path.c_str(), file.size() / 1e6, (lastNs - firstNs) / 1e9);
+    printf("index         %zu кадров за %.3f s (%s)\n", index.frameCount(), indexSeconds, indexPath.c_str());
+    uint64_t byKind[CRSF_LINK_FRAME_KINDS] = {};
+    for (const auto& e : index.frames()) {
+        if (e.direction == CAPTURE_RX) {
+            ++byKind[crsf_link_frame_kind(e.type)];
+        }
+    }
+    printf("rx frames    ");
+    for (unsigned int k = 0; k < CRSF_LINK_FRAME_KINDS; ++k) {
+        printf(" %s %llu", crsf_link_frame_kind_name(k), static_cast<unsigned long long>(byKind[k]));
+    }
+    printf("\nerrors        crc rx %llu tx %llu, потеряно при записи rx %llu tx %llu байт\n",
+           static_cast<unsigned long long>(index.crcErrors(CAPTURE_RX)),
+           static_cast<unsigned long long>(index.crcErrors(CAPTURE_TX)),
+           static_cast<unsigned long long>(index.gapBytes(CAPTURE_RX)),
+           static_cast<unsigned long long>(index.gapBytes(CAPTURE_TX)));
+
+    // Начальная позиция: по номеру кадра или по времени от начала записи
+    size_t start = 0;
+    if (opt.fromFrame >= 0) {
+        start = static_cast<size_t>(opt.fromFrame);
+    } else if (opt.fromSeconds >= 0) {
+        start = index.frameAtTime(firstNs + static_cast<uint64_t>(opt.fromSeconds * 1e9));
+    }
+
+    if (opt.list > 0) {
+        long shown = 0;
+        for (size_t i = start; i < index.frameCount() && shown < opt.list; ++i) {
+            const CaptureFrameEntry& e = index.frame(i);
+            if (opt.type >= 0 && e.type != opt.type) {
+                continue;
+            }
+            printf("%10zu  %12.6f  %s  type 0x%02X  len %u\n", i, (e.timestampNs - firstNs) / 1e9,
+                   e.direction == CAPTURE_RX ? "rx" : "tx", e.type, e.length);
+            ++shown;
+        }
+        return 0;
+    }
+
+    CaptureReplayPort port(file);
+    port.setRealtime(opt.realtime, opt.speed);
+    port.seekFrame(index, start);
+    CrsfSerial crsf(port);
+
+    auto replayStart = std::chrono::steady_clock::now();
+    while (!port.atEnd()) {
+        crsf.loop();
+        if (opt.frames >= 0 && crsf.getRxFrameCount() >= static_cast<uint32_t>(opt.frames)) {
+            break;
+        }
+        if (opt.realtime) {
+            uint64_t due = port.nextDueNs();
+            if (due > rpi_monotonic_ns()) {
+                struct timespec ts;
+                ts.tv_sec = static_cast<time_t>(due / 1000000000ull);
+                ts.tv_nsec = static_cast<long>(due % 1000000000ull);
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+            }
+        }
+    }
+    double elapsed = secondsSince(replayStart);
+
+    CrsfLinkCounters c = crsf.getLinkCounters();
+    printf("replay        с кадра %zu, %s\n", start, opt.realtime ? "в темпе записи" : "без пауз");
+    printf("parsed        %u кадров, %.1f MB за %.3f s: %.1f MB/s, %.0f кадров/с\n", c.rxFrames,
+           port.bytesRead() / 1e6, elapsed, elapsed > 0 ? port.bytesRead() / 1e6 / elapsed : 0.0,
+           elapsed > 0 ? c.rxFrames / elapsed : 0.0);
+    printf("parser        crc %u, потерь синхронизации %u (%u байт)\n", c.rxCrcErrors, c.rxLengthRejects, c.rxResyncBytes);
+
+    TelemetrySnapshot s = crsf.snapshot();
+    printf("last          battery %.1f V %.1f A %u%%, attitude %.1f/%.1f/%.1f",
+           s.batteryVoltage, s.batteryCurrent, s.batteryRemaining, s.attitudeRoll, s.attitudePitch, s.attitudeYaw);
+    if (s.gpsTimeNs != 0) {
+        printf(", gps %.6f %.6f sats %u", s.gps.latitude / 1e7, s.gps.longitude / 1e7, s.gps.satellites);
+    }
+    printf("\n");
+    return 0;
+}
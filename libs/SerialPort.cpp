@@ -17,6 +17,7 @@ SerialPort::~SerialPort() { close(); }
 
 bool SerialPort::open() {
     if (_fd >= 0) return true;
+    if (_path.empty()) return false;
     _fd = ::open(_path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (_fd < 0) {
         return false; // не удалось открыть устройство
@@ -85,12 +86,11 @@ int SerialPort::readByte(uint8_t &b) {
     return r;
 }
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не используется (используется только readByte)
-/*
 int SerialPort::read(uint8_t *buf, size_t len) {
+    // Те же правила VMIN=0/VTIME=1, что и для readByte(): 0 означает таймаут,
+    // но за один вызов забираем сразу все байты, накопленные в буфере драйвера
     return ::read(_fd, buf, len);
 }
-*/
 
 int SerialPort::write(const uint8_t *buf, size_t len) {
     return ::write(_fd, buf, len);
@@ -100,6 +100,14 @@ int SerialPort::writeByte(uint8_t b) {
     return ::write(_fd, &b, 1);
 }
 
+bool SerialPort::setNonBlocking(bool enable) {
+    if (_fd < 0) return false;
+    int flags = fcntl(_fd, F_GETFL, 0);
+    if (flags < 0) return false;
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(_fd, F_SETFL, flags) == 0;
+}
+
 void SerialPort::flush() {
     // Простая очистка буферов ввода/вывода
     ioctl(_fd, TCFLSH, TCIOFLUSH);
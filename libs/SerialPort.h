@@ -14,15 +14,23 @@ public:
     virtual ~SerialPort();
 
     bool isOpen() const { return _fd >= 0; }
+    // Сменить устройство (действует при следующем open(); пустой путь — порт не открывается)
+    void setPath(const std::string &path) { _path = path; }
+    const std::string &path() const { return _path; }
     virtual bool open();
     virtual void close();
 
     // Неблокирующее чтение/запись (по умолчанию блокирующее с таймаутами через termios)
     virtual int readByte(uint8_t &b);
+    // Пакетное чтение: один системный вызов read(2) на всё, что накопилось в драйвере (до len байт)
+    virtual int read(uint8_t *buf, size_t len);
     virtual int write(const uint8_t *buf, size_t len);
     virtual int writeByte(uint8_t b);
 
     virtual void flush();
+
+    // Перевести fd в неблокирующий режим (для работы из epoll: read() вернет -1/EAGAIN вместо ожидания VTIME)
+    bool setNonBlocking(bool enable);
     
     // Получить файловый дескриптор (для неблокирующих операций)
     int getFd() const { return _fd; }
@@ -0,0 +1,422 @@
+#include "command_ring.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+uint64_t command_ring_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Разбор целого без исключений (в отличие от std::stoi)
+static bool parse_int(const std::string& s, long& out)
+{
+    if (s.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    out = strtol(s.c_str(), &end, 10);
+    return errno == 0 && end && *end == '\0';
+}
+
+bool command_from_text(const std::string& line, CommandRecord& rec)
+{
+    memset(&rec, 0, sizeof(rec));
+
+    std::istringstream iss(line);
+    std::string cmd;
+    iss >> cmd;
+
+    if (cmd == "setChannels") {
+        // Формат: setChannels 1=1500 2=1600 3=1700 ...
+        std::string token;
+        while (iss >> token) {
+            size_t pos = token.find('=');
+            long ch, value;
+            if (pos == std::string::npos ||
+                !parse_int(token.substr(0, pos), ch) || !parse_int(token.substr(pos + 1), value)) {
+                continue;
+            }
+            if (ch >= 1 && ch <= 16 && value >= 1000 && value <= 2000) {
+                rec.mask |= static_cast<uint16_t>(1u << (ch - 1));
+                rec.values[ch - 1] = static_cast<uint16_t>(value);
+            }
+        }
+        rec.type = CMD_SET_CHANNELS;
+        return rec.mask != 0;
+    } else if (cmd == "setChannel") {
+        std::string chStr, valueStr;
+        long ch, value;
+        if (!(iss >> chStr >> valueStr) || !parse_int(chStr, ch) || !parse_int(valueStr, value)) {
+            return false;
+        }
+        if (ch < 1 || ch > 16 || value < 1000 || value > 2000) {
+            return false;
+        }
+        rec.type = CMD_SET_CHANNELS;
+        rec.mask = static_cast<uint16_t>(1u << (ch - 1));
+        rec.values[ch - 1] = static_cast<uint16_t>(value);
+        return true;
+    } else if (cmd == "sendChannels") {
+        rec.type = CMD_SEND_CHANNELS;
+        return true;
+    } else if (cmd == "setMode") {
+        std::string mode;
+        iss >> mode;
+        if (mode == "joystick" || mode == "manual") {
+            rec.type = CMD_SET_MODE;
+            rec.mode = (mode == "joystick") ? CMD_MODE_JOYSTICK : CMD_MODE_MANUAL;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string command_to_text(const CommandRecord& rec)
+{
+    switch (rec.type) {
+    case CMD_SET_CHANNELS: {
+        if (rec.mask == 0) return std::string();
+        std::string line = "setChannels";
+        for (unsigned int ch = 1; ch <= 16; ++ch) {
+            if (rec.mask & (1u << (ch - 1))) {
+                line += ' ';
+                line += std::to_string(ch);
+                line += '=';
+                line += std::to_string(rec.values[ch - 1]);
+            }
+        }
+        return line;
+    }
+    case CMD_SEND_CHANNELS:
+        return "sendChannels";
+    case CMD_SET_MODE:
+        return rec.mode == CMD_MODE_JOYSTICK ? "setMode joystick" : "setMode manual";
+    default:
+        return std::string();
+    }
+}
+
+// Адрес абстрактного unix-сокета (не создаёт файл, исчезает вместе с процессом)
+static socklen_t make_abstract_addr(const char* name, struct sockaddr_un& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t len = strlen(name);
+    if (len > sizeof(addr.sun_path) - 1) len = sizeof(addr.sun_path) - 1;
+    memcpy(addr.sun_path + 1, name, len);
+    return static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + 1 + len);
+}
+
+// ===== Потребитель =====
+
+bool CommandRingServer::create()
+{
+    if (_region) return true;
+
+    // Сокет звонка — блокировка единственного экземпляра: пока bind() не удался, область не трогаем,
+    // иначе второй запуск сбросил бы кольца работающего экземпляра
+    _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    _listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_eventFd < 0 || _listenFd < 0) {
+        close();
+        return false;
+    }
+    struct sockaddr_un addr;
+    socklen_t addrLen = make_abstract_addr(_socketName, addr);
+    if (bind(_listenFd, reinterpret_cast<struct sockaddr*>(&addr), addrLen) < 0 ||
+        listen(_listenFd, 8) < 0) {
+        close(); // скорее всего, уже запущен другой экземпляр
+        return false;
+    }
+
+    int fd = shm_open(_name, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        close();
+        return false;
+    }
+    fchmod(fd, 0666); // производители могут работать под другим пользователем
+    if (ftruncate(fd, sizeof(CommandRegion)) < 0) {
+        ::close(fd);
+        close();
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(CommandRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+    _region = static_cast<CommandRegion*>(p);
+
+    // Новое поколение: производители прежнего экземпляра переподключатся сами
+    _region->magic.store(0, std::memory_order_relaxed);
+    _region->version = COMMAND_RING_VERSION;
+    _region->slotCount = COMMAND_RING_SLOTS;
+    for (auto& slot : _region->slots) {
+        slot.owner.store(0, std::memory_order_relaxed);
+        slot.tail.store(0, std::memory_order_relaxed);
+        slot.head.store(0, std::memory_order_relaxed);
+        slot.appliedSeq.store(0, std::memory_order_relaxed);
+    }
+    _region->commandsApplied.store(0, std::memory_order_relaxed);
+    _region->lastApplyLatencyNs.store(0, std::memory_order_relaxed);
+    _region->lastWireLatencyNs.store(0, std::memory_order_relaxed);
+    _region->maxWireLatencyNs.store(0, std::memory_order_relaxed);
+    _region->generation.fetch_add(1, std::memory_order_relaxed);
+    _region->magic.store(COMMAND_RING_MAGIC, std::memory_order_release);
+    return true;
+}
+
+void CommandRingServer::close()
+{
+    if (_listenFd >= 0) {
+        ::close(_listenFd);
+        _listenFd = -1;
+    }
+    if (_eventFd >= 0) {
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+    if (_region) {
+        _region->magic.store(0, std::memory_order_release);
+        munmap(_region, sizeof(CommandRegion));
+        _region = nullptr;
+    }
+}
+
+void CommandRingServer::acceptClients()
+{
+    for (;;) {
+        int client = accept4(_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) break;
+
+        // Передаём eventfd через SCM_RIGHTS
+        char byte = 'E';
+        struct iovec iov = { &byte, 1 };
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        memset(control, 0, sizeof(control));
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &_eventFd, sizeof(int));
+        sendmsg(client, &msg, MSG_NOSIGNAL);
+        ::close(client);
+    }
+}
+
+size_t CommandRingServer::drain(const std::function<void(const CommandRecord&)>& apply)
+{
+    if (!_region) return 0;
+
+    uint64_t counter;
+    while (::read(_eventFd, &counter, sizeof(counter)) == sizeof(counter)) {
+        // Сбрасываем звонок до разбора: команды, пришедшие позже, позвонят снова
+    }
+
+    size_t applied = 0;
+    for (auto& slot : _region->slots) {
+        uint32_t head = slot.head.load(std::memory_order_relaxed);
+        uint32_t tail = slot.tail.load(std::memory_order_acquire);
+        if (head == tail) continue;
+
+        uint32_t lastSeq = 0;
+        uint64_t now = command_ring_now_ns();
+        while (head != tail) {
+            const CommandRecord& rec = slot.records[head & (COMMAND_RING_CAPACITY - 1)];
+            apply(rec);
+            lastSeq = rec.seq;
+            _region->lastApplyLatencyNs.store(now - rec.timestampNs, std::memory_order_relaxed);
+            if (_oldestUnsentNs == 0 || rec.timestampNs < _oldestUnsentNs) {
+                _oldestUnsentNs = rec.timestampNs;
+            }
+            ++head;
+            ++applied;
+        }
+        slot.head.store(head, std::memory_order_release);
+        slot.appliedSeq.store(lastSeq, std::memory_order_release);
+    }
+    if (applied) {
+        _region->commandsApplied.fetch_add(applied, std::memory_order_relaxed);
+    }
+    return applied;
+}
+
+void CommandRingServer::markSent()
+{
+    if (!_region || _oldestUnsentNs == 0) return;
+
+    uint64_t latency = command_ring_now_ns() - _oldestUnsentNs;
+    _oldestUnsentNs = 0;
+    _region->lastWireLatencyNs.store(latency, std::memory_order_relaxed);
+    if (latency > _region->maxWireLatencyNs.load(std::memory_order_relaxed)) {
+        _region->maxWireLatencyNs.store(latency, std::memory_order_relaxed);
+    }
+}
+
+// ===== Производитель =====
+
+// Номера клиентов внутри процесса: кольцо захватывает конкретный экземпляр, а не процесс
+static std::atomic<uint32_t> command_ring_next_client{1};
+
+bool CommandRingClient::attach()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return attachLocked();
+}
+
+bool CommandRingClient::attachLocked()
+{
+    if (_slot) return true;
+
+    int fd = shm_open(_name, O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(CommandRegion)) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(CommandRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    _region = static_cast<CommandRegion*>(p);
+
+    if (_region->magic.load(std::memory_order_acquire) != COMMAND_RING_MAGIC ||
+        _region->version != COMMAND_RING_VERSION ||
+        _region->slotCount != COMMAND_RING_SLOTS) {
+        closeLocked();
+        return false;
+    }
+    _generation = _region->generation.load(std::memory_order_acquire);
+
+    // Получаем eventfd потребителя
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        closeLocked();
+        return false;
+    }
+    // Зависший потребитель не должен блокировать производителя
+    struct timeval tv = { 0, 200000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_un addr;
+    socklen_t addrLen = make_abstract_addr(_socketName, addr);
+    if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), addrLen) == 0) {
+        char byte;
+        struct iovec iov = { &byte, 1 };
+        alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        struct msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) > 0) {
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                memcpy(&_eventFd, CMSG_DATA(cmsg), sizeof(int));
+            }
+        }
+    }
+    ::close(sock);
+    if (_eventFd < 0) {
+        closeLocked();
+        return false;
+    }
+
+    // Захватываем свободное кольцо или кольцо завершившегося процесса. Кольцо, занятое живым
+    // процессом, не берём, даже если это наш процесс: два производителя в одном SPSC-кольце недопустимы
+    _owner = COMMAND_RING_OWNER(getpid(), command_ring_next_client.fetch_add(1, std::memory_order_relaxed));
+    for (auto& slot : _region->slots) {
+        uint64_t owner = slot.owner.load(std::memory_order_acquire);
+        if (owner != 0 && !(kill(COMMAND_RING_OWNER_PID(owner), 0) < 0 && errno == ESRCH)) {
+            continue; // занято живым процессом
+        }
+        if (slot.owner.compare_exchange_strong(owner, _owner, std::memory_order_acq_rel)) {
+            _slot = &slot;
+            break;
+        }
+    }
+    if (!_slot) {
+        closeLocked();
+        return false;
+    }
+    return true;
+}
+
+void CommandRingClient::close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    closeLocked();
+}
+
+void CommandRingClient::closeLocked()
+{
+    if (_slot) {
+        uint64_t owner = _owner;
+        _slot->owner.compare_exchange_strong(owner, 0, std::memory_order_acq_rel);
+        _slot = nullptr;
+    }
+    if (_eventFd >= 0) {
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+    if (_region) {
+        munmap(_region, sizeof(CommandRegion));
+        _region = nullptr;
+    }
+}
+
+bool CommandRingClient::push(CommandRecord* recs, size_t count)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Потребитель перезапустился — переподключаемся к новому поколению
+    if (_slot && _region->generation.load(std::memory_order_acquire) != _generation) {
+        closeLocked();
+    }
+    if (!_slot && !attachLocked()) return false;
+
+    uint32_t tail = _slot->tail.load(std::memory_order_relaxed);
+    uint32_t head = _slot->head.load(std::memory_order_acquire);
+    if (COMMAND_RING_CAPACITY - (tail - head) < count) {
+        return false; // потребитель не успевает: команды не теряем молча
+    }
+
+    uint64_t now = command_ring_now_ns();
+    for (size_t i = 0; i < count; ++i) {
+        recs[i].seq = tail + static_cast<uint32_t>(i) + 1;
+        recs[i].timestampNs = now;
+        _slot->records[(tail + i) & (COMMAND_RING_CAPACITY - 1)] = recs[i];
+    }
+    // Вся пачка становится видна потребителю одной публикацией
+    _slot->tail.store(tail + static_cast<uint32_t>(count), std::memory_order_release);
+
+    uint64_t one = 1;
+    ssize_t r = ::write(_eventFd, &one, sizeof(one));
+    (void)r;
+    return true;
+}
+
+uint32_t CommandRingClient::appliedSeq() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slot ? _slot->appliedSeq.load(std::memory_order_acquire) : 0;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+// Канал команд в основной цикл через разделяемую память.
+// Область /dev/shm/crsf_commands содержит несколько SPSC-колец фиксированных двоичных записей:
+// каждый процесс-производитель (api_interpreter, pybind) захватывает своё кольцо,
+// потребитель один — основной цикл crsf_io_rpi. После записи производитель будит
+// потребителя через eventfd ("дверной звонок"), который получает от crsf_io_rpi
+// по unix-сокету (SCM_RIGHTS). Каждая команда несёт номер и метку времени CLOCK_MONOTONIC,
+// поэтому задержку команда→применение→эфир можно измерить.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#define COMMAND_RING_NAME "/crsf_commands"
+#define COMMAND_RING_SOCKET "crsf_commands_doorbell" // абстрактный unix-сокет
+#define COMMAND_RING_MAGIC 0x444D4343u // "CCMD"
+#define COMMAND_RING_VERSION 2
+#define COMMAND_RING_SLOTS 4        // максимум одновременных производителей (CommandRingClient)
+#define COMMAND_RING_CAPACITY 256   // записей в кольце (степень двойки)
+
+static_assert((COMMAND_RING_CAPACITY & (COMMAND_RING_CAPACITY - 1)) == 0, "COMMAND_RING_CAPACITY must be a power of two");
+
+enum CommandType : uint8_t {
+    CMD_NONE = 0,
+    CMD_SET_CHANNELS = 1,  // установить каналы из mask (setChannel — частный случай с одним битом)
+    CMD_SEND_CHANNELS = 2, // немедленно отправить пакет каналов
+    CMD_SET_MODE = 3,      // mode: 0 = manual, 1 = joystick
+};
+
+enum CommandMode : uint8_t {
+    CMD_MODE_MANUAL = 0,
+    CMD_MODE_JOYSTICK = 1,
+};
+
+// Фиксированная двоичная запись команды (64 байта — одна кэш-линия)
+struct CommandRecord {
+    uint32_t seq;          // номер команды в кольце производителя
+    uint8_t type;          // CommandType
+    uint8_t mode;          // CommandMode для CMD_SET_MODE
+    uint16_t mask;         // бит i — канал i+1 задан в values[i]
+    uint64_t timestampNs;  // CLOCK_MONOTONIC в момент постановки в очередь
+    uint16_t values[16];   // значения каналов, мкс
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(CommandRecord) == 64, "CommandRecord must be one cache line");
+
+// Одно SPSC-кольцо. tail пишет только производитель, head — только потребитель
+struct alignas(64) CommandRingSlot {
+    std::atomic<uint64_t> owner;        // 0 — кольцо свободно, иначе COMMAND_RING_OWNER(pid, номер клиента)
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) std::atomic<uint32_t> head;
+    std::atomic<uint32_t> appliedSeq;   // номер последней применённой команды
+    CommandRecord records[COMMAND_RING_CAPACITY];
+};
+
+struct CommandRegion {
+    std::atomic<uint32_t> magic;
+    uint16_t version;
+    uint16_t slotCount;
+    std::atomic<uint32_t> generation;   // меняется при каждом перезапуске потребителя
+    // Статистика задержек (пишет потребитель, читают все)
+    std::atomic<uint64_t> commandsApplied;
+    std::atomic<uint64_t> lastApplyLatencyNs; // постановка в очередь → применение
+    std::atomic<uint64_t> lastWireLatencyNs;  // постановка в очередь → отправка кадра каналов
+    std::atomic<uint64_t> maxWireLatencyNs;
+    CommandRingSlot slots[COMMAND_RING_SLOTS];
+};
+
+// Владелец кольца: pid (для проверки, жив ли процесс) и номер клиента внутри процесса —
+// у каждого CommandRingClient своё кольцо, даже если их несколько в одном процессе
+#define COMMAND_RING_OWNER(pid, client) ((static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) | (client))
+#define COMMAND_RING_OWNER_PID(owner) (static_cast<int32_t>((owner) >> 32))
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free to live in shared memory");
+
+// Текущее время CLOCK_MONOTONIC в наносекундах (общая шкала для всех процессов)
+uint64_t command_ring_now_ns();
+
+// Разбор текстовой команды прежнего формата /tmp/crsf_command.txt:
+// "setChannel 1 1500", "setChannels 1=1500 2=1600 ...", "sendChannels", "setMode manual"
+bool command_from_text(const std::string& line, CommandRecord& rec);
+// Обратное преобразование для резервного пути через файл: одна строка без '\n'.
+// Пустая строка, если у записи нет текстового вида (CMD_SET_CHANNELS без каналов, CMD_NONE)
+std::string command_to_text(const CommandRecord& rec);
+
+// Потребитель (основной цикл crsf_io_rpi)
+class CommandRingServer {
+public:
+    explicit CommandRingServer(const char* name = COMMAND_RING_NAME, const char* socketName = COMMAND_RING_SOCKET)
+        : _name(name), _socketName(socketName), _region(nullptr), _eventFd(-1), _listenFd(-1), _oldestUnsentNs(0) {}
+    ~CommandRingServer() { close(); }
+
+    CommandRingServer(const CommandRingServer&) = delete;
+    CommandRingServer& operator=(const CommandRingServer&) = delete;
+
+    // Создать область, eventfd и слушающий сокет раздачи eventfd
+    bool create();
+    void close();
+    bool isOpen() const { return _region != nullptr; }
+
+    // fd для epoll: звонок о новых командах и входящие подключения производителей
+    int doorbellFd() const { return _eventFd; }
+    int listenFd() const { return _listenFd; }
+
+    // Вызывать, когда listenFd() готов: передаёт eventfd подключившемуся производителю
+    void acceptClients();
+    // Вызывать, когда doorbellFd() готов: сбрасывает звонок и применяет все команды из всех колец
+    size_t drain(const std::function<void(const CommandRecord&)>& apply);
+    // Отметить отправку кадра каналов: фиксирует задержку до эфира для применённых команд
+    void markSent();
+
+    const CommandRegion* region() const { return _region; }
+
+private:
+    const char* _name;
+    const char* _socketName;
+    CommandRegion* _region;
+    int _eventFd;
+    int _listenFd;
+    uint64_t _oldestUnsentNs; // самая ранняя метка среди применённых, но ещё не отправленных команд
+};
+
+// Производитель (api_interpreter, pybind). Потокобезопасен внутри процесса
+class CommandRingClient {
+public:
+    explicit CommandRingClient(const char* name = COMMAND_RING_NAME, const char* socketName = COMMAND_RING_SOCKET)
+        : _name(name), _socketName(socketName), _region(nullptr), _slot(nullptr),
+          _eventFd(-1), _generation(0), _owner(0) {}
+    ~CommandRingClient() { close(); }
+
+    CommandRingClient(const CommandRingClient&) = delete;
+    CommandRingClient& operator=(const CommandRingClient&) = delete;
+
+    // Подключиться к области, захватить свободное кольцо и получить eventfd.
+    // false, если crsf_io_rpi не запущен или все кольца заняты
+    bool attach();
+    void close();
+    bool isAttached() const { return _slot != nullptr; }
+
+    // Поставить команды в очередь одной публикацией и одним звонком.
+    // Заполняет seq и timestampNs. false, если нет подключения или не хватает места
+    bool push(CommandRecord* recs, size_t count);
+    bool push(CommandRecord& rec) { return push(&rec, 1); }
+
+    // Номер последней применённой потребителем команды этого кольца
+    uint32_t appliedSeq() const;
+    const CommandRegion* region() const { return _region; }
+
+private:
+    bool attachLocked();
+    void closeLocked();
+
+    const char* _name;
+    const char* _socketName;
+    CommandRegion* _region;
+    CommandRingSlot* _slot;
+    int _eventFd;
+    uint32_t _generation;
+    uint64_t _owner;               // метка в CommandRingSlot::owner захваченного кольца
+    mutable std::mutex _mutex;
+};
@@ -1,13 +1,16 @@
 #include "CrsfSerial.h"
+#include "channel_codec.h"
+#include "frame_decode.h"
 #include "../../config.h"
 #include <cstring>
+#include <thread>
 #include <fcntl.h>
 #include <unistd.h>
 
 
 // Конструктор под Raspberry Pi: SerialPort уже открыт с нужной скоростью
 CrsfSerial::CrsfSerial(SerialPort& port, uint32_t baud) :
-    _port(port), _crc(0xd5), _baud(baud),
+    _port(port), _rxHead(0), _rxTail(0), _crc(0xd5), _baud(baud),
     _lastReceive(0), _lastChannelsPacket(0), _linkIsUp(false),
     _batteryVoltage(0.0), _batteryCurrent(0.0), _batteryCapacity(0.0), _batteryRemaining(0),
     _attitudeRoll(0.0), _attitudePitch(0.0), _attitudeYaw(0.0),
@@ -24,22 +27,40 @@ void CrsfSerial::loop()
 
 void CrsfSerial::handleSerialIn()
 {
-    // Читаем не более 32 байт за раз, чтобы не блокировать основной цикл
-    // Благодаря настройкам VMIN=0 и VTIME=1 в SerialPort.cpp, readByte() вернет 0
-    // через 0.1 сек, если нет данных, что позволяет циклу "дышать" и не блокировать API
-    for (int i = 0; i < 32; ++i) { 
-        uint8_t b;
-        int r = _port.readByte(b);
+    // Забираем всё накопленное драйвером одним read(2) прямо в кольцевой буфер.
+    // В crsf_io_rpi fd порта в O_NONBLOCK (crsfGetRecvFd) и loop() вызывается событийным циклом
+    // по готовности: без данных read() сразу возвращает -1 (EAGAIN), а не ждёт. Без O_NONBLOCK
+    // (порт открыт напрямую) действуют VMIN=0/VTIME=1 из SerialPort.cpp — возврат 0 через 0.1 сек.
+    // Второй вызов делается только если свободная область разорвана концом кольца
+    for (int i = 0; i < 2; ++i) {
+        uint32_t tail = _rxTail & (CRSF_RX_RING_SIZE - 1);
+        uint32_t space = CRSF_RX_RING_SIZE - (_rxTail - _rxHead);
+        uint32_t chunk = CRSF_RX_RING_SIZE - tail;
+        if (chunk > space) chunk = space;
+        if (chunk == 0) break;
+
+        int r = _port.read(&_rxBuf[tail], chunk);
+        _rxReadCalls.fetch_add(1, std::memory_order_relaxed);
         if (r <= 0) {
-            break; // Прерываем, если в порту больше нет данных или таймаут
+            break; // В порту больше нет данных (EAGAIN), таймаут VTIME или ошибка
         }
 
         _lastReceive = rpi_millis();
-        _rxBuf[_rxBufPos++] = b;
+        if (CrsfCapture* cap = _capture.load(std::memory_order_acquire)) {
+            cap->record(CAPTURE_RX, rpi_monotonic_ns(), &_rxBuf[tail], static_cast<size_t>(r));
+        }
+#if USE_LATENCY_METRICS == true
+        _rxBatchNs = LATENCY_NOW();
+        _rxBatchStart = _rxTail;
+        if (_rxHead == _rxTail) {
+            _rxHeadNs = _rxBatchNs; // Кольцо было пусто: кадр начинается в этой порции
+        }
+#endif
+        _rxTail += r;
         handleByteReceived();
 
-        if (_rxBufPos == CRSF_MAX_PACKET_SIZE) {
-            _rxBufPos = 0;
+        if (static_cast<uint32_t>(r) < chunk) {
+            break; // Драйвер отдал всё, что было
         }
     }
 
@@ -49,41 +70,105 @@ void CrsfSerial::handleSerialIn()
 
 void CrsfSerial::handleByteReceived()
 {
-    bool reprocess;
-    do {
-        reprocess = false;
-        if (_rxBufPos > 1) {
-            uint8_t len = _rxBuf[1];
-            // Sanity check the declared length isn't outside Type + X{1,CRSF_MAX_PAYLOAD_LEN} + CRC
-            // assumes there never will be a CRSF message that just has a type and no data (X)
-            if (len < 3 || len >(CRSF_MAX_PAYLOAD_LEN + 2)) {
-                shiftRxBuffer(1);
-                reprocess = true;
+    // Разбираем кадры прямо в кольце: сдвигаем только _rxHead, данные не копируются
+    for (;;) {
+        uint32_t avail = _rxTail - _rxHead;
+        if (avail < 2)
+            break;
+
+        uint8_t len = _rxBuf[(_rxHead + 1) & (CRSF_RX_RING_SIZE - 1)];
+        // Sanity check the declared length isn't outside Type + X{1,CRSF_MAX_PAYLOAD_LEN} + CRC
+        // assumes there never will be a CRSF message that just has a type and no data (X)
+        if (len < 3 || len > (CRSF_MAX_PAYLOAD_LEN + 2)) {
+            _rxHead += 1; // Ресинхронизация: пропускаем один байт
+            if (!_rxResyncing) {
+                _rxResyncing = true;
+                _rxLengthRejects.fetch_add(1, std::memory_order_relaxed);
             }
+            _rxResyncBytes.fetch_add(1, std::memory_order_relaxed);
+#if USE_LATENCY_METRICS == true
+            if (static_cast<int32_t>(_rxHead - _rxBatchStart) >= 0) _rxHeadNs = _rxBatchNs;
+#endif
+            continue;
+        }
 
-            else if (_rxBufPos >= (len + 2)) {
-                uint8_t inCrc = _rxBuf[2 + len - 1];
-                uint8_t crc = _crc.calc(&_rxBuf[2], len - 1);
-                if (crc == inCrc) {
-                    processPacketIn(len);
-                    shiftRxBuffer(len + 2);
-                    reprocess = true;
-                } else {
-                    // Отбрасываем ВЕСЬ битый пакет, а не один байт
-                    shiftRxBuffer(len + 2);
-                    reprocess = true;
-                }
-            }  // if complete packet
-        } // if pos > 1
-    } while (reprocess);
+        if (avail < static_cast<uint32_t>(len) + 2)
+            break; // Кадр ещё не пришёл целиком
+
+        uint8_t* frame = rxFrame(len + 2);
+        uint8_t inCrc = frame[2 + len - 1];
+        uint8_t crc = _crc.calc(&frame[2], len - 1);
+        _rxResyncing = false;
+        if (crc == inCrc) {
+            _rxFrameCount.fetch_add(1, std::memory_order_relaxed);
+            _rxFramesByKind[crsf_link_frame_kind(frame[2])].fetch_add(1, std::memory_order_relaxed);
+#if USE_LATENCY_METRICS == true
+            uint64_t crcNs = LATENCY_NOW();
+            LATENCY_RECORD(LATENCY_RX_TO_CRC, _rxHeadNs, crcNs);
+            LATENCY_START(LATENCY_RX_TO_PUBLISH, _rxHeadNs);
+            processPacketIn(frame);
+            LATENCY_RECORD(LATENCY_CRC_TO_DISPATCH, crcNs, LATENCY_NOW());
+#else
+            processPacketIn(frame);
+#endif
+        } else {
+            _rxCrcErrors.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Отбрасываем ВЕСЬ кадр (и валидный, и битый), а не один байт
+        _rxHead += len + 2;
+#if USE_LATENCY_METRICS == true
+        // Следующий кадр начинается уже в последней порции — берём её время
+        if (static_cast<int32_t>(_rxHead - _rxBatchStart) >= 0) _rxHeadNs = _rxBatchNs;
+#endif
+    }
+}
+
+// Возвращает непрерывный указатель на кадр размером size, начинающийся с _rxHead.
+// Копирование выполняется только если кадр переходит через конец кольца
+uint8_t* CrsfSerial::rxFrame(uint8_t size)
+{
+    uint32_t start = _rxHead & (CRSF_RX_RING_SIZE - 1);
+    if (start + size <= CRSF_RX_RING_SIZE)
+        return &_rxBuf[start];
+
+    uint32_t first = CRSF_RX_RING_SIZE - start;
+    memcpy(_rxFrameBuf, &_rxBuf[start], first);
+    memcpy(_rxFrameBuf + first, _rxBuf, size - first);
+    return _rxFrameBuf;
 }
 
 void CrsfSerial::checkPacketTimeout()
 {
-    // If we haven't received data in a long time, flush the buffer a byte at a time (to trigger shiftyByte)
-    if (_rxBufPos > 0 && rpi_millis() - _lastReceive > CRSF_PACKET_TIMEOUT_MS)
-        while (_rxBufPos)
-            shiftRxBuffer(1);
+    // If we haven't received data in a long time, flush the buffer
+    if (_rxTail != _rxHead && rpi_millis() - _lastReceive > CRSF_PACKET_TIMEOUT_MS) {
+        _rxHead = _rxTail;
+        _rxResyncing = false;
+        _rxBufferResets.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+CrsfLinkCounters CrsfSerial::getLinkCounters() const
+{
+    CrsfLinkCounters c;
+    c.rxFrames = _rxFrameCount.load(std::memory_order_relaxed);
+    for (unsigned int i = 0; i < CRSF_LINK_FRAME_KINDS; ++i) {
+        c.rxFramesByKind[i] = _rxFramesByKind[i].load(std::memory_order_relaxed);
+    }
+    c.rxCrcErrors = _rxCrcErrors.load(std::memory_order_relaxed);
+    c.rxLengthRejects = _rxLengthRejects.load(std::memory_order_relaxed);
+    c.rxResyncBytes = _rxResyncBytes.load(std::memory_order_relaxed);
+    c.rxBufferResets = _rxBufferResets.load(std::memory_order_relaxed);
+    c.txFrames = _txFrames.load(std::memory_order_relaxed);
+    c.txDropped = _txDropped.load(std::memory_order_relaxed);
+    c.txShortWrites = _txShortWrites.load(std::memory_order_relaxed);
+    c.txBytes = _txBytes.load(std::memory_order_relaxed);
+    return c;
+}
+
+void CrsfSerial::checkTimeouts()
+{
+    checkPacketTimeout();
+    checkLinkDown();
 }
 
 void CrsfSerial::checkLinkDown()
@@ -93,94 +178,106 @@ void CrsfSerial::checkLinkDown()
         if (onLinkDown)
             onLinkDown();
         _linkIsUp = false;
+        _telemetryNotify.post(TELEMETRY_NOTIFY_ANY); // linkUp входит в snapshot()
     }
 }
 
-void CrsfSerial::processPacketIn(uint8_t len)
+void CrsfSerial::processPacketIn(const uint8_t* frame)
 {
-    const crsf_header_t* hdr = (crsf_header_t*)_rxBuf;
+    const crsf_header_t* hdr = (const crsf_header_t*)frame;
     if (hdr->device_addr == CRSF_ADDRESS_FLIGHT_CONTROLLER) {
         switch (hdr->type) {
         case CRSF_FRAMETYPE_GPS:
             packetGps(hdr);
+            _gpsTimeNs = rpi_monotonic_ns();
             break;
         case CRSF_FRAMETYPE_RC_CHANNELS_PACKED:
             // softSerial.println("CRSF_FRAMETYPE_RC_CHANNELS_PACKED");
             packetChannelsPacked(hdr);
+            _channelsTimeNs = rpi_monotonic_ns();
             break;
         case CRSF_FRAMETYPE_LINK_STATISTICS:
             packetLinkStatistics(hdr);
+            _linkStatisticsTimeNs = rpi_monotonic_ns();
             break;
         case CRSF_FRAMETYPE_ATTITUDE:
             packetAttitude(hdr);
+            _attitudeTimeNs = rpi_monotonic_ns();
             break;
         case CRSF_FRAMETYPE_FLIGHT_MODE:
             packetFlightMode(hdr);
-            break;
+            return; // Полей телеметрии не меняет
         case CRSF_FRAMETYPE_BATTERY_SENSOR:
             packetBatterySensor(hdr);
+            _batteryTimeNs = rpi_monotonic_ns();
             break;
         default:
         // Неизвестный тип пакета
-        break;
+        return;
         }
+        publishTelemetry(hdr->type);
     } // CRSF_ADDRESS_FLIGHT_CONTROLLER
 }
 
-// Shift the bytes in the RxBuf down by cnt bytes
-void CrsfSerial::shiftRxBuffer(uint8_t cnt)
+// Копия состояния в слот писателя тройного буфера и публикация (только поток приёма)
+void CrsfSerial::publishTelemetry(uint8_t frameType)
 {
-    // If removing the whole thing, just set pos to 0
-    if (cnt >= _rxBufPos) {
-        _rxBufPos = 0;
-        return;
-    }
+    TelemetrySnapshot& s = _telemetry.back();
+    s.sequence = ++_telemetrySequence;
+    s.lastFrameType = frameType;
+    s.lastReceive = _lastReceive;
+    s.linkStatistics = _linkStatistics;
+    s.gps = _gpsSensor;
+    s.batteryVoltage = _batteryVoltage;
+    s.batteryCurrent = _batteryCurrent;
+    s.batteryCapacity = _batteryCapacity;
+    s.batteryRemaining = _batteryRemaining;
+    s.attitudeRoll = _attitudeRoll;
+    s.attitudePitch = _attitudePitch;
+    s.attitudeYaw = _attitudeYaw;
+    s.rawAttitudeRoll = _rawAttitudeBytes[1];
+    s.rawAttitudePitch = _rawAttitudeBytes[0];
+    s.rawAttitudeYaw = _rawAttitudeBytes[2];
+    s.channelsTimeNs = _channelsTimeNs;
+    s.linkStatisticsTimeNs = _linkStatisticsTimeNs;
+    s.gpsTimeNs = _gpsTimeNs;
+    s.batteryTimeNs = _batteryTimeNs;
+    s.attitudeTimeNs = _attitudeTimeNs;
+    _telemetry.publish();
+    _telemetryNotify.post(TELEMETRY_NOTIFY_KIND(crsf_link_frame_kind(frameType)));
+}
 
-    //БЕСПОЛЕЗНО: указатель onShiftyByte никогда не устанавливается
-    //if (cnt == 1 && onShiftyByte)
-    //    onShiftyByte(_rxBuf[0]);
-
-    // Otherwise do the slow shift down
-    uint8_t* src = &_rxBuf[cnt];
-    uint8_t* dst = &_rxBuf[0];
-    _rxBufPos -= cnt;
-    uint8_t left = _rxBufPos;
-    while (left--)
-        *dst++ = *src++;
+TelemetrySnapshot CrsfSerial::snapshot() const
+{
+    TelemetrySnapshot s;
+    {
+        // Мьютекс только между читателями: тройной буфер допускает одного читателя
+        std::lock_guard<std::mutex> lock(_telemetryReadMutex);
+        _telemetry.update();
+        s = _telemetry.front();
+    }
+    s.linkUp = _linkIsUp;
+    std::array<int, CRSF_NUM_CHANNELS> channels;
+    getChannels(channels);
+    for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        s.channels[i] = channels[i];
+    }
+    return s;
 }
 
 void CrsfSerial::packetChannelsPacked(const crsf_header_t* p)
 {
-    crsf_channels_t* ch = (crsf_channels_t*)&p->data;
-    
-    // Захватываем мьютекс для записи каналов
-    std::lock_guard<std::mutex> lock(_channelsMutex);
-    
-    _channels[0] = ch->ch0;
-    _channels[1] = ch->ch1;
-    _channels[2] = ch->ch2;
-    _channels[3] = ch->ch3;
-    _channels[4] = ch->ch4;
-    _channels[5] = ch->ch5;
-    _channels[6] = ch->ch6;
-    _channels[7] = ch->ch7;
-    _channels[8] = ch->ch8;
-    _channels[9] = ch->ch9;
-    _channels[10] = ch->ch10;
-    _channels[11] = ch->ch11;
-    _channels[12] = ch->ch12;
-    _channels[13] = ch->ch13;
-    _channels[14] = ch->ch14;
-    _channels[15] = ch->ch15;
-
-    // Преобразование CRSF-кода в микросекунды (1000..2000) с точным округлением
-    const int crsfDelta = (CRSF_CHANNEL_VALUE_2000 - CRSF_CHANNEL_VALUE_1000);
-    for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
-        int code = _channels[i];
-        if (code < CRSF_CHANNEL_VALUE_1000) code = CRSF_CHANNEL_VALUE_1000;
-        if (code > CRSF_CHANNEL_VALUE_2000) code = CRSF_CHANNEL_VALUE_2000;
-        int num = (code - CRSF_CHANNEL_VALUE_1000) * 1000;
-        _channels[i] = 1000 + (num + crsfDelta / 2) / crsfDelta; // округление к ближайшему
+    // Распаковка 16 x 11 бит и преобразование CRSF-кода в микросекунды (1000..2000) с точным округлением
+    int us[CRSF_NUM_CHANNELS];
+    crsf_channels_decode(p->data, us);
+
+    {
+        std::lock_guard<std::mutex> lock(_channelsWriteMutex);
+        channelsWriteBegin();
+        for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+            _channels[i].store(us[i], std::memory_order_relaxed);
+        }
+        channelsWriteEnd();
     }
 
     if (!_linkIsUp && onLinkUp)
@@ -193,6 +290,41 @@ void CrsfSerial::packetChannelsPacked(const crsf_header_t* p)
         onPacketChannels();
 }
 
+void CrsfSerial::getChannels(std::array<int, CRSF_NUM_CHANNELS>& out) const
+{
+    for (unsigned int attempt = 0;; ++attempt) {
+        uint32_t seq = _channelsSeq.load(std::memory_order_acquire);
+        if ((seq & 1) == 0) {
+            for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+                out[i] = _channels[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_channelsSeq.load(std::memory_order_relaxed) == seq) {
+                return;
+            }
+        }
+        // Запись занимает десятки наносекунд; если писатель вытеснен посреди неё — уступаем процессор
+        if (attempt >= 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void CrsfSerial::setChannels(const std::array<int, CRSF_NUM_CHANNELS>& values)
+{
+    {
+        std::lock_guard<std::mutex> lock(_channelsWriteMutex);
+        channelsWriteBegin();
+        for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+            _channels[i].store(values[i], std::memory_order_relaxed);
+        }
+        channelsWriteEnd();
+        _needSendPacket = true; // Флаг для асинхронной отправки
+    }
+    // Каналы входят в snapshot(): будим ждущих любую публикацию
+    _telemetryNotify.post(TELEMETRY_NOTIFY_ANY);
+}
+
 void CrsfSerial::packetLinkStatistics(const crsf_header_t* p)
 {
     const crsfLinkStatistics_t* link = (crsfLinkStatistics_t*)p->data;
@@ -205,25 +337,8 @@ void CrsfSerial::packetLinkStatistics(const crsf_header_t* p)
 
 void CrsfSerial::packetGps(const crsf_header_t* p)
 {
-    // Read bytes manually to handle big-endian conversion correctly
-    // Packet data is big-endian, so we construct the value directly from bytes
-    const uint8_t* data = p->data;
-    // Read int32_t as big-endian bytes: construct value directly
-    int32_t lat = ((int32_t)((uint32_t)data[0] << 24) | 
-                   ((uint32_t)data[1] << 16) | 
-                   ((uint32_t)data[2] << 8) | 
-                   (uint32_t)data[3]);
-    int32_t lon = ((int32_t)((uint32_t)data[4] << 24) | 
-                   ((uint32_t)data[5] << 16) | 
-                   ((uint32_t)data[6] << 8) | 
-                   (uint32_t)data[7]);
-    _gpsSensor.latitude = lat;
-    _gpsSensor.longitude = lon;
-    // Read uint16_t as big-endian bytes
-    _gpsSensor.groundspeed = ((uint16_t)data[8] << 8) | (uint16_t)data[9];
-    _gpsSensor.heading = ((uint16_t)data[10] << 8) | (uint16_t)data[11];
-    _gpsSensor.altitude = ((uint16_t)data[12] << 8) | (uint16_t)data[13];
-    _gpsSensor.satellites = data[14];
+    // Поля big-endian в кадре, в _gpsSensor — в порядке хоста
+    crsf_decode_gps(p->data, _gpsSensor);
 
     //БЕСПОЛЕЗНО: указатель onPacketGps никогда не устанавливается
     //if (onPacketGps)
@@ -232,22 +347,36 @@ void CrsfSerial::packetGps(const crsf_header_t* p)
 
 void CrsfSerial::write(uint8_t b)
 {
-    _port.writeByte(b);
+    CrsfCapture* cap = _capture.load(std::memory_order_acquire);
+    uint64_t ts = cap ? rpi_monotonic_ns() : 0;
+    if (_port.writeByte(b) == 1 && cap) {
+        cap->record(CAPTURE_TX, ts, &b, 1);
+    }
 }
 
-void CrsfSerial::write(const uint8_t* buf, size_t len)
+int CrsfSerial::write(const uint8_t* buf, size_t len)
 {
     // В режиме --notel запись выполняется обычным образом,
     // но проверка линка уже пропущена в queuePacket(), 
-    // поэтому блокировки не будет
-    _port.write(buf, len);
+    // поэтому блокировки не будет. Порт в O_NONBLOCK: при заполненном буфере драйвера
+    // write() не ждёт, а принимает часть пакета или возвращает -1 (EAGAIN)
+    CrsfCapture* cap = _capture.load(std::memory_order_acquire);
+    uint64_t ts = cap ? rpi_monotonic_ns() : 0;
+    int written = _port.write(buf, len);
+    // В запись попадает только то, что порт принял (время — начало write())
+    if (cap && written > 0) {
+        cap->record(CAPTURE_TX, ts, buf, static_cast<size_t>(written));
+    }
+    return written;
 }
 
 void CrsfSerial::queuePacket(uint8_t addr, uint8_t type, const void* payload, uint8_t len)
 {
     // Если включен флаг игнорирования телеметрии ИЛИ линк активен -> отправляем
-    if (!g_ignore_telemetry && !_linkIsUp)
+    if (!g_ignore_telemetry && !_linkIsUp) {
+        _txDropped.fetch_add(1, std::memory_order_relaxed);
         return;
+    }
     if (len > CRSF_MAX_PAYLOAD_LEN)
         return;
 
@@ -276,7 +405,26 @@ void CrsfSerial::queuePacket(uint8_t addr, uint8_t type, const void* payload, ui
     //         Serial.print(0, BYTE);
     //     }
     // }
-    write(buf, len + 4);
+#if USE_LATENCY_METRICS == true
+    uint64_t writeNs = LATENCY_NOW();
+    int written = write(buf, len + 4);
+    uint64_t writtenNs = LATENCY_NOW();
+    LATENCY_RECORD(LATENCY_TX_WRITE, writeNs, writtenNs);
+    if (type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
+        LATENCY_FINISH(LATENCY_CMD_TO_TX, writtenNs);
+    }
+#else
+    int written = write(buf, len + 4);
+#endif
+    // Неблокирующая запись может быть частичной: остаток кадра не дописывается — приёмник отбросит
+    // обрывок по CRC, а следующий пакет каналов уйдёт через такт. Такие записи считает txShortWrites
+    _txFrames.fetch_add(1, std::memory_order_relaxed);
+    if (written > 0) {
+        _txBytes.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+    }
+    if (written < len + 4) {
+        _txShortWrites.fetch_add(1, std::memory_order_relaxed);
+    }
     //БЕСПОЛЕЗНО: закомментированный лог
     // log_info("CRSF: отправлен пакет типа " + std::to_string(type));
 }
@@ -319,94 +467,46 @@ void CrsfSerial::processSend()
 // Приватный метод для реальной отправки пакета каналов
 void CrsfSerial::packetChannelsSend()
 {
-    static int channels[CRSF_NUM_CHANNELS];
-    const int crsfDelta = (CRSF_CHANNEL_VALUE_2000 - CRSF_CHANNEL_VALUE_1000);
-    
-    // Захватываем мьютекс для чтения каналов
-    std::lock_guard<std::mutex> lock(_channelsMutex);
-    
+    uint8_t payload[CRSF_CHANNELS_PAYLOAD_SIZE];
+    int us[CRSF_NUM_CHANNELS];
+    bool clamped = false;
+
+    // Мьютекс писателей: ограниченные значения записываются обратно
+    std::lock_guard<std::mutex> lock(_channelsWriteMutex);
+
     for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
-        int usTarget = _channels[i];
-        if (usTarget < 1000) usTarget = 1000;
-        if (usTarget > 2000) usTarget = 2000;
+        us[i] = _channels[i].load(std::memory_order_relaxed);
         // Clamp the stored value as well
-        _channels[i] = usTarget;
-
-        // Первичное кодирование (округление к ближайшему)
-        int num = (usTarget - 1000) * crsfDelta;
-        int code = CRSF_CHANNEL_VALUE_1000 + (num + 500) / 1000;
-        if (code > CRSF_CHANNEL_VALUE_2000) code = CRSF_CHANNEL_VALUE_2000;
-        if (code < CRSF_CHANNEL_VALUE_1000) code = CRSF_CHANNEL_VALUE_1000;
-
-        // Проверка: декодирование должно дать ровно usTarget
-        int decodedUs = 1000 + ((code - CRSF_CHANNEL_VALUE_1000) * 1000 + crsfDelta / 2) / crsfDelta;
-        if (decodedUs < usTarget && code < CRSF_CHANNEL_VALUE_2000) {
-            // Подправим вверх до точного совпадения, шаг обычно <= 1
-            int code2 = code + 1;
-            int decoded2 = 1000 + ((code2 - CRSF_CHANNEL_VALUE_1000) * 1000 + crsfDelta / 2) / crsfDelta;
-            if (decoded2 == usTarget) code = code2;
-        } else if (decodedUs > usTarget && code > CRSF_CHANNEL_VALUE_1000) {
-            int code2 = code - 1;
-            int decoded2 = 1000 + ((code2 - CRSF_CHANNEL_VALUE_1000) * 1000 + crsfDelta / 2) / crsfDelta;
-            if (decoded2 == usTarget) code = code2;
+        if (us[i] < 1000) { us[i] = 1000; clamped = true; }
+        if (us[i] > 2000) { us[i] = 2000; clamped = true; }
+    }
+    if (clamped) {
+        channelsWriteBegin();
+        for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+            _channels[i].store(us[i], std::memory_order_relaxed);
         }
-
-        channels[i] = code;
+        channelsWriteEnd();
     }
 
-    crsf_channels_t ch;
-    ch.ch0 = channels[0];
-    ch.ch1 = channels[1];
-    ch.ch2 = channels[2];
-    ch.ch3 = channels[3];
-    ch.ch4 = channels[4];
-    ch.ch5 = channels[5];
-    ch.ch6 = channels[6];
-    ch.ch7 = channels[7];
-    ch.ch8 = channels[8];
-    ch.ch9 = channels[9];
-    ch.ch10 = channels[10];
-    ch.ch11 = channels[11];
-    ch.ch12 = channels[12];
-    ch.ch13 = channels[13];
-    ch.ch14 = channels[14];
-    ch.ch15 = channels[15];
-
+    // Кодирование с точным round-trip (decode(encode(us)) == us) и упаковка 16 x 11 бит
+    crsf_channels_encode(us, payload);
 
     _linkIsUp = true;
-    queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, (void*)&ch, 22);
+    queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, payload, CRSF_CHANNELS_PAYLOAD_SIZE);
 }
 
 void CrsfSerial::packetAttitude(const crsf_header_t* p)
 {
     if (p->frame_size >= 6) {
-        // Читаем 6 байт ATTITUDE пакета
-        int16_t rawVal0 = be16toh(*(int16_t*)&p->data[0]);
-        int16_t rawVal2 = be16toh(*(int16_t*)&p->data[2]);
-        int16_t rawVal4 = be16toh(*(int16_t*)&p->data[4]);
-        
-        // ВНИМАНИЕ: Эти коэффициенты получены экспериментально и могут различаться 
-        // в зависимости от версии прошивки полетного контроллера (Betaflight/iNAV).
-        // Стандартная спецификация CRSF: градусы × 100, но данные не соответствуют.
-        
-        // bytes 0-1 = Pitch, bytes 2-3 = Roll (поменяны местами!)
-        // Сохраняем сырые значения (raw int16_t)
-        _rawAttitudeBytes[0] = rawVal0;  // Pitch raw
-        _rawAttitudeBytes[1] = rawVal2;  // Roll raw
-        _rawAttitudeBytes[2] = rawVal4;  // Yaw raw
-        
-        // КОНВЕРТАЦИЯ С ПРАВИЛЬНЫМ ПОРЯДКОМ
-        _attitudeRoll = rawVal2 / 175.0;    // bytes 2-3 = Roll
-        _attitudePitch = rawVal0 / 175.0;   // bytes 0-1 = Pitch
-        
-        // Yaw: конвертация с нормализацией к диапазону 0-360 градусов
-        double yawDegrees = rawVal4 / 175.0;
-        
-        // Нормализация yaw к диапазону 0-360°
-        while (yawDegrees < 0) yawDegrees += 360.0;
-        while (yawDegrees >= 360.0) yawDegrees -= 360.0;
-        
-        _attitudeYaw = yawDegrees;
+        // Коэффициенты и порядок полей (bytes 0-1 = Pitch, bytes 2-3 = Roll) — в frame_decode.h
+        CrsfAttitude a;
+        crsf_decode_attitude(p->data, a);
+        _rawAttitudeBytes[0] = a.rawPitch;
+        _rawAttitudeBytes[1] = a.rawRoll;
+        _rawAttitudeBytes[2] = a.rawYaw;
+        _attitudeRoll = a.roll;
+        _attitudePitch = a.pitch;
+        _attitudeYaw = a.yaw;
     }
 }
 
@@ -423,17 +523,12 @@ void CrsfSerial::packetBatterySensor(const crsf_header_t* p)
 {
     // BATTERY_SENSOR пакет содержит напряжение, ток, емкость
     if (p->frame_size >= 8) {
-        uint16_t voltage = be16toh(*(uint16_t*)&p->data[0]); // мВ
-        uint16_t current = be16toh(*(uint16_t*)&p->data[2]); // мА
-        // Читаем 24-битное значение емкости
-        uint32_t capacity = (p->data[4] << 16) | (p->data[5] << 8) | p->data[6]; // мАч
-        uint8_t remaining = p->data[7]; // %
-        
-        // Сохраняем данные батареи
-        _batteryVoltage = voltage / 100.0; // Конвертируем мВ в В
-        _batteryCurrent = current; // мА
-        _batteryCapacity = capacity; // мАч
-        _batteryRemaining = remaining; // %
+        CrsfBattery b;
+        crsf_decode_battery(p->data, b);
+        _batteryVoltage = b.voltage;
+        _batteryCurrent = b.current;
+        _batteryCapacity = b.capacity;
+        _batteryRemaining = b.remaining;
     }
 }
 
@@ -1,13 +1,19 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
 #include <atomic>
 #include "crc8.h"
 #include "crsf_protocol.h"
+#include "capture.h"
+#include "link_counters.h"
+#include "telemetry_snapshot.h"
 #include "../SerialPort.h"
 #include "../rpi_hal.h"
+#include "../latency_metrics.h"
+#include "../telemetry_notify.h"
 
 //БЕСПОЛЕЗНО: enum определен, но нигде не используется
 //enum eFailsafeAction { fsaNoPulses, fsaHold };
@@ -19,34 +25,51 @@ public:
 // Packet timeout where buffer is flushed if no data is received in this time
 static const unsigned int CRSF_PACKET_TIMEOUT_MS = 100;
 static const unsigned int CRSF_FAILSAFE_STAGE1_MS = 120000;  // 2 минуты вместо 60 секунд для стабильной работы
+// Размер кольцевого буфера приёма (степень двойки, индексы маскируются)
+static const unsigned int CRSF_RX_RING_SIZE = 256;
+static_assert((CRSF_RX_RING_SIZE & (CRSF_RX_RING_SIZE - 1)) == 0, "CRSF_RX_RING_SIZE must be a power of two");
+static_assert(CRSF_RX_RING_SIZE >= 2 * CRSF_MAX_PACKET_SIZE, "CRSF_RX_RING_SIZE must hold at least two frames");
 uint32_t _lastReceive; // время последнего приёма (мс), rpi_millis()
 
 // Конструктор: принимает ссылку на SerialPort и скорость
 CrsfSerial(SerialPort& port, uint32_t baud = CRSF_BAUDRATE);
 void loop();
 void write(uint8_t b);
-void write(const uint8_t* buf, size_t len);
+// Возвращает результат SerialPort::write (записано байт или -1)
+int write(const uint8_t* buf, size_t len);
 void queuePacket(uint8_t addr, uint8_t type, const void* payload, uint8_t len);
 
 // Return current channel value (1-based) in us
 int getChannel(unsigned int ch) const
 {
     if (ch >= 1 && ch <= CRSF_NUM_CHANNELS) {
-        std::lock_guard<std::mutex> lock(_channelsMutex);
-        return _channels[ch - 1];
+        // Одно значение не может быть разорвано: достаточно атомарного чтения без seqlock
+        return _channels[ch - 1].load(std::memory_order_relaxed);
     }
     return 1500; // Safe default value for invalid channel
 }
 
+// Согласованный снимок всех каналов (мкс) за одну проверку версии seqlock.
+// Читатель никогда не блокирует поток приёма/отправки
+void getChannels(std::array<int, CRSF_NUM_CHANNELS>& out) const;
+
 void setChannel(unsigned int ch, int value)
 {
     if (ch >= 1 && ch <= CRSF_NUM_CHANNELS) {
-        std::lock_guard<std::mutex> lock(_channelsMutex);
-        _channels[ch - 1] = value;
-        _needSendPacket = true; // Флаг для асинхронной отправки
+        {
+            std::lock_guard<std::mutex> lock(_channelsWriteMutex);
+            channelsWriteBegin();
+            _channels[ch - 1].store(value, std::memory_order_relaxed);
+            channelsWriteEnd();
+            _needSendPacket = true; // Флаг для асинхронной отправки
+        }
+        _telemetryNotify.post(TELEMETRY_NOTIFY_ANY); // каналы входят в snapshot()
     }
 }
 
+// Установка всех каналов одной записью: читатели видят либо старый, либо новый набор целиком
+void setChannels(const std::array<int, CRSF_NUM_CHANNELS>& values);
+
     const crsfLinkStatistics_t* getLinkStatistics() const { return &_linkStatistics; }
     const crsf_sensor_gps_t* getGpsSensor() const { return &_gpsSensor; }
     
@@ -68,14 +91,44 @@ void setChannel(unsigned int ch, int value)
     int16_t getRawAttitudeYaw() const { return _rawAttitudeBytes[2]; }
     
     bool isLinkUp() const { return _linkIsUp; }
+
+    // Согласованный снимок всей телеметрии с временем приёма каждого типа кадра.
+    // Не блокирует поток приёма; одновременные вызовы из разных потоков упорядочиваются между собой
+    TelemetrySnapshot snapshot() const;
+    // Ожидание следующей публикации snapshot() вместо опроса: поток приёма будит ждущих после каждого
+    // кадра телеметрии, записи каналов и потери линка (без ждущих — без системных вызовов).
+    // kindMask — группы кадров (TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_...)), TELEMETRY_NOTIFY_ANY — любое изменение.
+    // false — за timeoutMs (< 0 — без ограничения) публикаций не было
+    TelemetryNotifyCursor telemetryCursor() const { return _telemetryNotify.cursor(); }
+    bool waitTelemetry(TelemetryNotifyCursor& cursor, uint32_t kindMask, int timeoutMs) const
+    {
+        return _telemetryNotify.wait(cursor, kindMask, timeoutMs);
+    }
+
+    // Статистика приёма: число вызовов SerialPort::read() и число принятых кадров с верным CRC
+    uint32_t getRxReadCalls() const { return _rxReadCalls.load(std::memory_order_relaxed); }
+    uint32_t getRxFrameCount() const { return _rxFrameCount.load(std::memory_order_relaxed); }
+    // Среднее число системных вызовов чтения на один кадр (0, если кадров ещё не было)
+    double getRxReadsPerFrame() const
+    {
+        uint32_t frames = getRxFrameCount();
+        return frames ? static_cast<double>(getRxReadCalls()) / frames : 0.0;
+    }
+    // Счётчики протокола (кадры по типам, ошибки CRC, ресинхронизация, отправка).
+    // Без блокировок; отдельные счётчики читаются независимо
+    CrsfLinkCounters getLinkCounters() const;
+    // Запись сырого потока: каждая порция read() и write() уходит в capture (nullptr — выключено).
+    // Запись должна быть открыта до подключения и закрыта после отключения
+    void setCapture(CrsfCapture* capture) { _capture.store(capture, std::memory_order_release); }
+    CrsfCapture* capture() const { return _capture.load(std::memory_order_acquire); }
     //БЕСПОЛЕЗНО: функции определены, но нигде не вызываются
     //bool getPassthroughMode() const { return _passthroughMode; }
     //void setPassthroughMode(bool val, unsigned int baud = 0);
 
     // Event Handlers
-    void (*onLinkUp)();
-    void (*onLinkDown)();
-    void (*onPacketChannels)();
+    void (*onLinkUp)() = nullptr;
+    void (*onLinkDown)() = nullptr;
+    void (*onPacketChannels)() = nullptr;
     //БЕСПОЛЕЗНО: указатели на функции устанавливаются, но никогда не вызываются
     //void (*onShiftyByte)(uint8_t b);
     //void (*onPacketLinkStatistics)(crsfLinkStatistics_t* ls);
@@ -83,13 +136,42 @@ void setChannel(unsigned int ch, int value)
 
     // Асинхронная обработка отправки (вызывать из основного цикла)
     void processSend();
+    // Проверка таймаутов приёма и потери линка без чтения порта
+    // (для событийного цикла, где loop() вызывается только при наличии данных)
+    void checkTimeouts();
+    SerialPort& port() { return _port; }
     void packetAttitude(const crsf_header_t* p);
     void packetFlightMode(const crsf_header_t* p);
     void packetBatterySensor(const crsf_header_t* p);
 private:
     SerialPort& _port;
-    uint8_t _rxBuf[CRSF_MAX_PACKET_SIZE];
-    uint8_t _rxBufPos;
+    // Кольцевой буфер приёма: _rxHead — начало неразобранных данных, _rxTail — место записи.
+    // Индексы растут свободно и маскируются при обращении, поэтому _rxTail - _rxHead = заполненность
+    uint8_t _rxBuf[CRSF_RX_RING_SIZE];
+    uint32_t _rxHead;
+    uint32_t _rxTail;
+    // Линейная копия кадра, если он переходит через конец кольца
+    uint8_t _rxFrameBuf[CRSF_MAX_PACKET_SIZE];
+#if USE_LATENCY_METRICS == true
+    // Время read(), принёсшего байт _rxHead, и начало последней порции в кольце (для rx_to_crc)
+    uint64_t _rxHeadNs = 0;
+    uint64_t _rxBatchNs = 0;
+    uint32_t _rxBatchStart = 0;
+#endif
+    std::atomic<uint32_t> _rxReadCalls{0};
+    std::atomic<uint32_t> _rxFrameCount{0};
+    // Счётчики протокола: приёмные пишет только поток приёма, отправочные — queuePacket
+    std::atomic<uint32_t> _rxFramesByKind[CRSF_LINK_FRAME_KINDS] = {};
+    std::atomic<uint32_t> _rxCrcErrors{0};
+    std::atomic<uint32_t> _rxLengthRejects{0};
+    std::atomic<uint32_t> _rxResyncBytes{0};
+    std::atomic<uint32_t> _rxBufferResets{0};
+    std::atomic<uint32_t> _txFrames{0};
+    std::atomic<uint32_t> _txDropped{0};
+    std::atomic<uint32_t> _txShortWrites{0};
+    std::atomic<uint64_t> _txBytes{0};
+    bool _rxResyncing = false;  // идёт пропуск байт после потери синхронизации
+    std::atomic<CrsfCapture*> _capture{nullptr};
     Crc8 _crc;
     crsfLinkStatistics_t _linkStatistics;
     crsf_sensor_gps_t _gpsSensor;
@@ -110,19 +192,44 @@ private:
     
     uint32_t _baud;
     uint32_t _lastChannelsPacket;
-    bool _linkIsUp;
-    int _channels[CRSF_NUM_CHANNELS];
-    
-    // Мьютекс для защиты данных каналов и флаг для асинхронной отправки
-    mutable std::mutex _channelsMutex;
+    std::atomic<bool> _linkIsUp;
+
+    // Публикация телеметрии: время приёма по типам кадров (пишет только поток приёма)
+    uint64_t _channelsTimeNs = 0;
+    uint64_t _linkStatisticsTimeNs = 0;
+    uint64_t _gpsTimeNs = 0;
+    uint64_t _batteryTimeNs = 0;
+    uint64_t _attitudeTimeNs = 0;
+    uint32_t _telemetrySequence = 0;
+    mutable TripleBuffer<TelemetrySnapshot> _telemetry;
+    mutable std::mutex _telemetryReadMutex;
+    TelemetryNotifyState _telemetryNotifyState{};
+    TelemetryNotify _telemetryNotify{&_telemetryNotifyState, TELEMETRY_NOTIFY_PROCESS};
+    // Каналы (мкс) под seqlock: _channelsSeq нечётный, пока идёт запись.
+    // Мьютекс только упорядочивает писателей (приём, отправка, команды); читатели его не берут
+    std::atomic<int> _channels[CRSF_NUM_CHANNELS] = {};
+    std::atomic<uint32_t> _channelsSeq{0};
+    std::mutex _channelsWriteMutex;
     std::atomic<bool> _needSendPacket{false};
 
+    // Вызывать под _channelsWriteMutex
+    void channelsWriteBegin()
+    {
+        _channelsSeq.store(_channelsSeq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    void channelsWriteEnd()
+    {
+        _channelsSeq.store(_channelsSeq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
     void handleSerialIn();
     void handleByteReceived();
-    void shiftRxBuffer(uint8_t cnt);
-    void processPacketIn(uint8_t len);
+    uint8_t* rxFrame(uint8_t size);
+    void processPacketIn(const uint8_t* frame);
     void checkPacketTimeout();
     void checkLinkDown();
+    void publishTelemetry(uint8_t frameType);
 
     // Packet Handlers
     void packetChannelsPacked(const crsf_header_t* p);
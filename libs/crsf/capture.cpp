@@ -0,0 +1,317 @@
+#include "capture.h"
+#include "../rpi_hal.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Буфер одного write(): несколько миллисекунд трафика в обе стороны
+static const size_t CAPTURE_OUT_BYTES = 64 * 1024;
+
+static size_t roundUpPow2(size_t v)
+{
+    size_t p = 4096;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static uint64_t realtimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+CrsfCapture::CrsfCapture(size_t ringBytes, unsigned int flushMs)
+    : _ringBytes(roundUpPow2(ringBytes)), _flushMs(flushMs ? flushMs : 1), _fd(-1),
+      _out(nullptr), _outLen(0), _stop(false)
+{
+}
+
+bool CrsfCapture::open(const std::string& path, uint32_t baud)
+{
+    close();
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        CaptureFileHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, CAPTURE_MAGIC, sizeof(hdr.magic));
+        hdr.version = CAPTURE_VERSION;
+        hdr.headerSize = sizeof(CaptureFileHeader);
+        hdr.recordSize = sizeof(CaptureRecord);
+        if (::write(fd, &hdr, sizeof(hdr)) != static_cast<ssize_t>(sizeof(hdr))) {
+            ::close(fd);
+            return false;
+        }
+    } else {
+        // Дописываем только в запись того же формата
+        CaptureFileHeader hdr;
+        int rfd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        bool ok = rfd >= 0 && ::read(rfd, &hdr, sizeof(hdr)) == static_cast<ssize_t>(sizeof(hdr)) &&
+                  memcmp(hdr.magic, CAPTURE_MAGIC, sizeof(hdr.magic)) == 0 && hdr.version == CAPTURE_VERSION;
+        if (rfd >= 0) {
+            ::close(rfd);
+        }
+        if (!ok) {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    for (auto& ring : _rings) {
+        ring.buf = new uint8_t[_ringBytes];
+        ring.tail.store(0, std::memory_order_relaxed);
+        ring.head.store(0, std::memory_order_relaxed);
+        ring.bytes.store(0, std::memory_order_relaxed);
+        ring.dropped.store(0, std::memory_order_relaxed);
+        ring.droppedReported = 0;
+    }
+    _out = new uint8_t[CAPTURE_OUT_BYTES];
+    _outLen = 0;
+    _records.store(0, std::memory_order_relaxed);
+    _fileBytes.store(0, std::memory_order_relaxed);
+    _writeErrors.store(0, std::memory_order_relaxed);
+
+    // Начало сеанса — первой записью, до любых данных
+    CaptureRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    CaptureSession session;
+    memset(&session, 0, sizeof(session));
+    rec.timestampNs = rpi_monotonic_ns();
+    rec.length = sizeof(session);
+    rec.kind = CAPTURE_KIND_SESSION;
+    session.realtimeNs = realtimeNs();
+    session.baud = baud;
+    _fd = fd;
+    append(&rec, sizeof(rec));
+    append(&session, sizeof(session));
+    _records.fetch_add(1, std::memory_order_relaxed);
+
+    _stop = false;
+    _writer = std::thread(&CrsfCapture::writerLoop, this);
+    return true;
+}
+
+void CrsfCapture::close()
+{
+    if (_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        _writer.join();
+    }
+    if (_fd >= 0) {
+        flush();
+        ::close(_fd);
+        _fd = -1;
+    }
+    for (auto& ring : _rings) {
+        delete[] ring.buf;
+        ring.buf = nullptr;
+    }
+    delete[] _out;
+    _out = nullptr;
+}
+
+void CrsfCapture::record(CaptureDirection dir, uint64_t timestampNs, const uint8_t* data, size_t len)
+{
+    if (dir >= CAPTURE_DIRECTIONS || len == 0) {
+        return;
+    }
+    Ring& ring = _rings[dir];
+    if (ring.buf == nullptr) {
+        return;
+    }
+    CaptureRecord rec;
+    rec.timestampNs = timestampNs;
+    rec.length = static_cast<uint32_t>(len);
+    rec.direction = dir;
+    rec.kind = CAPTURE_KIND_DATA;
+    rec.reserved = 0;
+    if (push(ring, rec, data)) {
+        ring.bytes.fetch_add(len, std::memory_order_relaxed);
+    } else {
+        ring.dropped.fetch_add(len, std::memory_order_relaxed);
+    }
+}
+
+bool CrsfCapture::push(Ring& ring, const CaptureRecord& rec, const uint8_t* data)
+{
+    const size_t need = sizeof(rec) + rec.length;
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    if (need > _ringBytes - (tail - head)) {
+        return false;
+    }
+    const size_t mask = _ringBytes - 1;
+    // Заголовок и данные копируются в кольцо двумя частями, если переходят через его конец
+    const uint8_t* parts[2] = {reinterpret_cast<const uint8_t*>(&rec), data};
+    const size_t sizes[2] = {sizeof(rec), rec.length};
+    uint64_t pos = tail;
+    for (int i = 0; i < 2; ++i) {
+        size_t off = static_cast<size_t>(pos) & mask;
+        size_t first = sizes[i] < _ringBytes - off ? sizes[i] : _ringBytes - off;
+        memcpy(ring.buf + off, parts[i], first);
+        memcpy(ring.buf, parts[i] + first, sizes[i] - first);
+        pos += sizes[i];
+    }
+    ring.tail.store(pos, std::memory_order_release);
+    return true;
+}
+
+void CrsfCapture::copyOut(const Ring& ring, uint64_t pos, void* dst, size_t len) const
+{
+    const size_t off = static_cast<size_t>(pos) & (_ringBytes - 1);
+    const size_t first = len < _ringBytes - off ? len : _ringBytes - off;
+    memcpy(dst, ring.buf + off, first);
+    memcpy(static_cast<uint8_t*>(dst) + first, ring.buf, len - first);
+}
+
+void CrsfCapture::append(const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        if (_outLen == CAPTURE_OUT_BYTES) {
+            drainToFile();
+        }
+        size_t n = len < CAPTURE_OUT_BYTES - _outLen ? len : CAPTURE_OUT_BYTES - _outLen;
+        memcpy(_out + _outLen, p, n);
+        _outLen += n;
+        p += n;
+        len -= n;
+    }
+}
+
+bool CrsfCapture::drainToFile()
+{
+    size_t done = 0;
+    while (done < _outLen && _writeErrors.load(std::memory_order_relaxed) == 0) {
+        ssize_t n = ::write(_fd, _out + done, _outLen - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // Диск полон или снят: дальше только считаем потери, поток приёма не страдает
+            _writeErrors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    _fileBytes.fetch_add(done, std::memory_order_relaxed);
+    _outLen = 0;
+    return done > 0;
+}
+
+void CrsfCapture::flush()
+{
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    if (_fd < 0 || _out == nullptr) {
+        return;
+    }
+    uint64_t now = rpi_monotonic_ns();
+
+    // Потери с прошлого раза — отдельной записью перед данными направления
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        Ring& ring = _rings[d];
+        uint64_t dropped = ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != ring.droppedReported) {
+            CaptureRecord rec;
+            memset(&rec, 0, sizeof(rec));
+            uint64_t lost = dropped - ring.droppedReported;
+            rec.timestampNs = now;
+            rec.length = sizeof(lost);
+            rec.direction = static_cast<uint8_t>(d);
+            rec.kind = CAPTURE_KIND_GAP;
+            append(&rec, sizeof(rec));
+            append(&lost, sizeof(lost));
+            _records.fetch_add(1, std::memory_order_relaxed);
+            ring.droppedReported = dropped;
+        }
+    }
+
+    // Слияние двух колец по времени: в файле записи приёма и отправки идут по порядку
+    uint64_t tails[CAPTURE_DIRECTIONS];
+    uint64_t heads[CAPTURE_DIRECTIONS];
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        tails[d] = _rings[d].tail.load(std::memory_order_acquire);
+        heads[d] = _rings[d].head.load(std::memory_order_relaxed);
+    }
+    CaptureRecord next[CAPTURE_DIRECTIONS];
+    for (;;) {
+        int pick = -1;
+        for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+            if (heads[d] == tails[d]) {
+                continue;
+            }
+            copyOut(_rings[d], heads[d], &next[d], sizeof(CaptureRecord));
+            if (pick < 0 || next[d].timestampNs < next[pick].timestampNs) {
+                pick = static_cast<int>(d);
+            }
+        }
+        if (pick < 0) {
+            break;
+        }
+        Ring& ring = _rings[pick];
+        const CaptureRecord& rec = next[pick];
+        append(&rec, sizeof(rec));
+        uint64_t pos = heads[pick] + sizeof(rec);
+        size_t left = rec.length;
+        while (left > 0) {
+            if (_outLen == CAPTURE_OUT_BYTES) {
+                drainToFile();
+            }
+            size_t n = left < CAPTURE_OUT_BYTES - _outLen ? left : CAPTURE_OUT_BYTES - _outLen;
+            copyOut(ring, pos, _out + _outLen, n);
+            _outLen += n;
+            pos += n;
+            left -= n;
+        }
+        heads[pick] = pos;
+        // Место в кольце освобождается сразу: данные уже в буфере записи
+        ring.head.store(pos, std::memory_order_release);
+        _records.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (_outLen > 0) {
+        drainToFile();
+    }
+}
+
+void CrsfCapture::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(_wakeMutex);
+    while (!_stop) {
+        _wake.wait_for(lock, std::chrono::milliseconds(_flushMs), [this] { return _stop; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+CaptureStats CrsfCapture::stats() const
+{
+    CaptureStats s;
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        s.bytes[d] = _rings[d].bytes.load(std::memory_order_relaxed);
+        s.droppedBytes[d] = _rings[d].dropped.load(std::memory_order_relaxed);
+    }
+    s.records = _records.load(std::memory_order_relaxed);
+    s.fileBytes = _fileBytes.load(std::memory_order_relaxed);
+    s.writeErrors = _writeErrors.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+// Запись сырого потока CRSF в файл для разбора после полёта.
+// Каждая порция байт, принятая read() или отданная write(), попадает в файл записью
+// с временем CLOCK_MONOTONIC (нс) и направлением. Формат (little-endian):
+//
+//   CaptureFileHeader                 — один раз в начале файла
+//   CaptureRecord + length байт ...   — записи подряд, файл только дописывается
+//
+// При каждом открытии пишется запись CAPTURE_KIND_SESSION (время CLOCK_REALTIME и скорость порта),
+// поэтому сеансы разных запусков в одном файле различимы. Если кольцо направления переполнено,
+// порция отбрасывается, а в файл позже уходит запись CAPTURE_KIND_GAP с числом потерянных байт.
+//
+// Поток приёма и поток отправки никогда не ждут диска: у каждого направления своё SPSC-кольцо
+// фиксированного размера (выделяется один раз в open()), запись в файл — отдельный поток,
+// который раз в flushMs забирает оба кольца, упорядочивает записи по времени и пишет одним write().
+// 420 кбод — около 42 КБ/с в каждую сторону; кольцо по умолчанию держит ~25 с без записи на диск.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define CAPTURE_MAGIC "CRSFCAP"   // 8 байт с завершающим нулём
+#define CAPTURE_VERSION 1
+#define CAPTURE_RING_BYTES (1u << 20) // на направление (степень двойки)
+#define CAPTURE_FLUSH_MS 20
+
+enum CaptureDirection : uint8_t {
+    CAPTURE_RX = 0, // от полётника
+    CAPTURE_TX = 1, // к полётнику
+    CAPTURE_DIRECTIONS
+};
+
+enum CaptureKind : uint8_t {
+    CAPTURE_KIND_DATA = 0,    // байты из порта / в порт
+    CAPTURE_KIND_SESSION = 1, // CaptureSession: начало сеанса записи
+    CAPTURE_KIND_GAP = 2,     // uint64_t: байт направления direction потеряно при переполнении кольца
+};
+
+struct CaptureFileHeader {
+    char magic[8];        // CAPTURE_MAGIC
+    uint16_t version;     // CAPTURE_VERSION
+    uint16_t headerSize;  // sizeof(CaptureFileHeader)
+    uint16_t recordSize;  // sizeof(CaptureRecord)
+    uint16_t reserved;
+};
+
+struct CaptureRecord {
+    uint64_t timestampNs; // CLOCK_MONOTONIC
+    uint32_t length;      // байт данных после заголовка записи
+    uint8_t direction;    // CaptureDirection
+    uint8_t kind;         // CaptureKind
+    uint16_t reserved;
+};
+
+struct CaptureSession {
+    uint64_t realtimeNs;  // CLOCK_REALTIME в момент timestampNs записи
+    uint32_t baud;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CaptureFileHeader) == 16, "CaptureFileHeader layout is part of the file format");
+static_assert(sizeof(CaptureRecord) == 16, "CaptureRecord layout is part of the file format");
+static_assert(sizeof(CaptureSession) == 16, "CaptureSession layout is part of the file format");
+
+// Статистика записи (все поля читаются без блокировок)
+struct CaptureStats {
+    uint64_t bytes[CAPTURE_DIRECTIONS];        // байт данных, принятых в кольцо
+    uint64_t droppedBytes[CAPTURE_DIRECTIONS]; // байт, отброшенных при переполнении кольца
+    uint64_t records;                          // записей в файле за сеанс
+    uint64_t fileBytes;                        // байт, записанных в файл за сеанс
+    uint64_t writeErrors;                      // неудачных write(); после ошибки запись прекращается
+};
+
+class CrsfCapture {
+public:
+    // ringBytes — размер кольца одного направления (округляется вверх до степени двойки)
+    explicit CrsfCapture(size_t ringBytes = CAPTURE_RING_BYTES, unsigned int flushMs = CAPTURE_FLUSH_MS);
+    ~CrsfCapture() { close(); }
+
+    CrsfCapture(const CrsfCapture&) = delete;
+    CrsfCapture& operator=(const CrsfCapture&) = delete;
+
+    // Открыть (создать или дописать) файл, выделить кольца и запустить поток записи.
+    // false, если файл не открывается или существующий файл — не запись CRSF этой версии
+    bool open(const std::string& path, uint32_t baud);
+    // Остановить поток записи, дописать остаток колец и закрыть файл.
+    // Кольца освобождаются: перед close() запись нужно отсоединить от CrsfSerial (setCapture(nullptr))
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    // Порция байт одного направления. Без системных вызовов и блокировок; один производитель
+    // на направление (поток приёма для CAPTURE_RX, поток отправки для CAPTURE_TX)
+    void record(CaptureDirection dir, uint64_t timestampNs, const uint8_t* data, size_t len);
+
+    // Дописать в файл всё, что уже в кольцах (вызывается и потоком записи)
+    void flush();
+
+    CaptureStats stats() const;
+
+private:
+    struct Ring {
+        uint8_t* buf = nullptr;
+        alignas(64) std::atomic<uint64_t> tail{0};   // пишет производитель
+        alignas(64) std::atomic<uint64_t> head{0};   // пишет поток записи
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> dropped{0};            // всего отброшено
+        uint64_t droppedReported = 0;                // уже отмечено записью GAP (поток записи)
+    };
+
+    void writerLoop();
+    bool push(Ring& ring, const CaptureRecord& rec, const uint8_t* data);
+    void copyOut(const Ring& ring, uint64_t pos, void* dst, size_t len) const;
+    void append(const void* data, size_t len);
+    bool drainToFile();
+
+    size_t _ringBytes;
+    unsigned int _flushMs;
+    int _fd;
+    Ring _rings[CAPTURE_DIRECTIONS];
+
+    // Буфер сборки одного write() (только поток записи / flush() под _flushMutex)
+    uint8_t* _out;
+    size_t _outLen;
+    std::mutex _flushMutex;
+
+    std::thread _writer;
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    bool _stop;
+
+    std::atomic<uint64_t> _records{0};
+    std::atomic<uint64_t> _fileBytes{0};
+    std::atomic<uint64_t> _writeErrors{0};
+};
@@ -0,0 +1,488 @@
+#include "capture_decode.h"
+#include "channel_codec.h"
+#include "frame_decode.h"
+#include "link_counters.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+size_t capture_column_width(CaptureColumnType type)
+{
+    switch (type) {
+    case CAPTURE_COLUMN_U8:
+    case CAPTURE_COLUMN_I8: return 1;
+    case CAPTURE_COLUMN_U16:
+    case CAPTURE_COLUMN_I16: return 2;
+    case CAPTURE_COLUMN_I32:
+    case CAPTURE_COLUMN_U32: return 4;
+    case CAPTURE_COLUMN_U64:
+    case CAPTURE_COLUMN_F64: return 8;
+    }
+    return 0;
+}
+
+const char* capture_column_suffix(CaptureColumnType type)
+{
+    switch (type) {
+    case CAPTURE_COLUMN_U8: return "u8";
+    case CAPTURE_COLUMN_I8: return "i8";
+    case CAPTURE_COLUMN_U16: return "u16";
+    case CAPTURE_COLUMN_I16: return "i16";
+    case CAPTURE_COLUMN_I32: return "i32";
+    case CAPTURE_COLUMN_U32: return "u32";
+    case CAPTURE_COLUMN_U64: return "u64";
+    case CAPTURE_COLUMN_F64: return "f64";
+    }
+    return "bin";
+}
+
+const CaptureColumn* CaptureTable::column(const std::string& columnName) const
+{
+    for (const auto& c : columns) {
+        if (c.name == columnName) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+static void capture_table_init(CaptureTable& t, const char* name,
+                               std::initializer_list<std::pair<const char*, CaptureColumnType>> columns)
+{
+    t.name = name;
+    t.rows = 0;
+    t.columns.clear();
+    t.columns.push_back({"timeNs", CAPTURE_COLUMN_U64, {}});
+    for (const auto& c : columns) {
+        t.columns.push_back({c.first, c.second, {}});
+    }
+}
+
+CaptureTables::CaptureTables()
+{
+    CaptureTable& channels = tables[CAPTURE_TABLE_CHANNELS];
+    capture_table_init(channels, crsf_link_frame_kind_name(CRSF_LINK_FRAME_CHANNELS), {});
+    for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        channels.columns.push_back({"ch" + std::to_string(i + 1), CAPTURE_COLUMN_U16, {}});
+    }
+    capture_table_init(tables[CAPTURE_TABLE_LINK_STATISTICS], crsf_link_frame_kind_name(CRSF_LINK_FRAME_LINK_STATISTICS), {
+        {"uplinkRssi1", CAPTURE_COLUMN_U8},
+        {"uplinkRssi2", CAPTURE_COLUMN_U8},
+        {"uplinkLinkQuality", CAPTURE_COLUMN_U8},
+        {"uplinkSnr", CAPTURE_COLUMN_I8},
+        {"activeAntenna", CAPTURE_COLUMN_U8},
+        {"rfMode", CAPTURE_COLUMN_U8},
+        {"uplinkTxPower", CAPTURE_COLUMN_U8},
+        {"downlinkRssi", CAPTURE_COLUMN_U8},
+        {"downlinkLinkQuality", CAPTURE_COLUMN_U8},
+        {"downlinkSnr", CAPTURE_COLUMN_I8},
+    });
+    capture_table_init(tables[CAPTURE_TABLE_GPS], crsf_link_frame_kind_name(CRSF_LINK_FRAME_GPS), {
+        {"latitude", CAPTURE_COLUMN_I32},   // градусы × 1e7
+        {"longitude", CAPTURE_COLUMN_I32},
+        {"groundspeed", CAPTURE_COLUMN_U16}, // км/ч × 10
+        {"heading", CAPTURE_COLUMN_U16},     // градусы × 100
+        {"altitude", CAPTURE_COLUMN_U16},    // м + 1000
+        {"satellites", CAPTURE_COLUMN_U8},
+    });
+    capture_table_init(tables[CAPTURE_TABLE_BATTERY], crsf_link_frame_kind_name(CRSF_LINK_FRAME_BATTERY), {
+        {"voltage", CAPTURE_COLUMN_F64},
+        {"current", CAPTURE_COLUMN_F64},
+        {"capacity", CAPTURE_COLUMN_U32},
+        {"remaining", CAPTURE_COLUMN_U8},
+    });
+    capture_table_init(tables[CAPTURE_TABLE_ATTITUDE], crsf_link_frame_kind_name(CRSF_LINK_FRAME_ATTITUDE), {
+        {"roll", CAPTURE_COLUMN_F64},
+        {"pitch", CAPTURE_COLUMN_F64},
+        {"yaw", CAPTURE_COLUMN_F64},
+        {"rawRoll", CAPTURE_COLUMN_I16},
+        {"rawPitch", CAPTURE_COLUMN_I16},
+        {"rawYaw", CAPTURE_COLUMN_I16},
+    });
+}
+
+void CaptureTables::addFrame(uint64_t timestampNs, const uint8_t* frame, size_t length)
+{
+    const crsf_header_t* hdr = reinterpret_cast<const crsf_header_t*>(frame);
+    const size_t payload = length - 4;
+    CaptureTable* t = nullptr;
+    if (hdr->device_addr == CRSF_ADDRESS_FLIGHT_CONTROLLER) {
+        switch (hdr->type) {
+        case CRSF_FRAMETYPE_RC_CHANNELS_PACKED:
+            if (payload >= CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE) {
+                t = &tables[CAPTURE_TABLE_CHANNELS];
+                int us[CRSF_NUM_CHANNELS];
+                crsf_channels_decode(hdr->data, us);
+                for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+                    t->columns[i + 1].push(static_cast<uint16_t>(us[i]));
+                }
+            }
+            break;
+        case CRSF_FRAMETYPE_LINK_STATISTICS:
+            if (payload >= CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE) {
+                t = &tables[CAPTURE_TABLE_LINK_STATISTICS];
+                // Поля crsfLinkStatistics_t — по байту, в порядке столбцов
+                for (unsigned int i = 0; i < CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE; ++i) {
+                    t->columns[i + 1].push(hdr->data[i]);
+                }
+            }
+            break;
+        case CRSF_FRAMETYPE_GPS:
+            if (payload >= CRSF_FRAME_GPS_PAYLOAD_SIZE) {
+                t = &tables[CAPTURE_TABLE_GPS];
+                crsf_sensor_gps_t gps;
+                crsf_decode_gps(hdr->data, gps);
+                t->columns[1].push(static_cast<int32_t>(gps.latitude));
+                t->columns[2].push(static_cast<int32_t>(gps.longitude));
+                t->columns[3].push(static_cast<uint16_t>(gps.groundspeed));
+                t->columns[4].push(static_cast<uint16_t>(gps.heading));
+                t->columns[5].push(static_cast<uint16_t>(gps.altitude));
+                t->columns[6].push(static_cast<uint8_t>(gps.satellites));
+            }
+            break;
+        case CRSF_FRAMETYPE_BATTERY_SENSOR:
+            if (payload >= CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE) {
+                t = &tables[CAPTURE_TABLE_BATTERY];
+                CrsfBattery b;
+                crsf_decode_battery(hdr->data, b);
+                t->columns[1].push(b.voltage);
+                t->columns[2].push(b.current);
+                t->columns[3].push(static_cast<uint32_t>(b.capacity));
+                t->columns[4].push(b.remaining);
+            }
+            break;
+        case CRSF_FRAMETYPE_ATTITUDE:
+            if (payload >= CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE) {
+                t = &tables[CAPTURE_TABLE_ATTITUDE];
+                CrsfAttitude a;
+                crsf_decode_attitude(hdr->data, a);
+                t->columns[1].push(a.roll);
+                t->columns[2].push(a.pitch);
+                t->columns[3].push(a.yaw);
+                t->columns[4].push(a.rawRoll);
+                t->columns[5].push(a.rawPitch);
+                t->columns[6].push(a.rawYaw);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (t == nullptr) {
+        ++otherFrames;
+        return;
+    }
+    t->columns[0].push(timestampNs);
+    ++t->rows;
+}
+
+void CaptureTables::append(const CaptureTables& other)
+{
+    for (unsigned int id = 0; id < CAPTURE_TABLES; ++id) {
+        CaptureTable& t = tables[id];
+        const CaptureTable& o = other.tables[id];
+        for (size_t c = 0; c < t.columns.size(); ++c) {
+            t.columns[c].data.insert(t.columns[c].data.end(), o.columns[c].data.begin(), o.columns[c].data.end());
+        }
+        t.rows += o.rows;
+    }
+    otherFrames += other.otherFrames;
+    crcErrors += other.crcErrors;
+}
+
+size_t CaptureTables::rows() const
+{
+    size_t n = 0;
+    for (const auto& t : tables) {
+        n += t.rows;
+    }
+    return n;
+}
+
+// Положение в потоке: запись и байт в ней (упорядочено так же, как байты в файле)
+struct CapturePos {
+    uint64_t record;
+    uint64_t inRecord;
+
+    bool operator<(const CapturePos& o) const {
+        return record < o.record || (record == o.record && inRecord < o.inRecord);
+    }
+};
+
+static bool capture_is_rx_data(const CaptureRecord& rec)
+{
+    return rec.kind == CAPTURE_KIND_DATA && rec.direction == CAPTURE_RX;
+}
+
+// Точка синхронизации в записях [begin, end): первый из CAPTURE_DECODE_SYNC_FRAMES кадров подряд
+// (каждый начинается сразу за предыдущим) с верным CRC. false, если в части такой нет
+static bool capture_find_sync(const CaptureFile& file, size_t begin, size_t end, CapturePos& sync)
+{
+    CaptureFrameScanner scanner;
+    CaptureRecord rec;
+    const uint8_t* payload;
+    unsigned int run = 0;
+    uint64_t expected = 0;
+    CapturePos candidate = {0, 0};
+    bool found = false;
+    for (size_t off = begin; off < end && !found && file.recordAt(off, rec, payload); off = CaptureFile::nextRecord(off, rec)) {
+        if (!capture_is_rx_data(rec)) {
+            continue;
+        }
+        scanner.feed(rec, off, payload, 0, [&](const CaptureFrameScanner::Frame& f) {
+            if (found) {
+                return;
+            }
+            if (run > 0 && f.streamPos == expected) {
+                ++run;
+            } else {
+                run = 1;
+                candidate = {f.recordOffset, f.offsetInRecord};
+            }
+            expected = f.streamPos + f.length;
+            found = run >= CAPTURE_DECODE_SYNC_FRAMES;
+        });
+    }
+    if (found) {
+        sync = candidate;
+    }
+    return found;
+}
+
+// Кадры с началом в [from, to); кадр, начатый до to, дочитывается за ней
+static void capture_decode_range(const CaptureFile& file, CapturePos from, CapturePos to, CaptureTables& out)
+{
+    CaptureFrameScanner scanner;
+    CaptureRecord rec;
+    const uint8_t* payload;
+    bool reached = false;
+    uint64_t pastStop = 0;
+    size_t skip = static_cast<size_t>(from.inRecord);
+    for (size_t off = static_cast<size_t>(from.record); !reached && file.recordAt(off, rec, payload);
+         off = CaptureFile::nextRecord(off, rec)) {
+        if (!capture_is_rx_data(rec) || skip >= rec.length) {
+            skip = 0;
+            continue;
+        }
+        scanner.feed(rec, off, payload, skip, [&](const CaptureFrameScanner::Frame& f) {
+            if (reached) {
+                return;
+            }
+            if (!(CapturePos{f.recordOffset, f.offsetInRecord} < to)) {
+                reached = true;
+                return;
+            }
+            out.addFrame(f.timestampNs, f.bytes, f.length);
+        });
+        // Кадр, начатый до to, кончается не дальше CRSF_MAX_PACKET_SIZE байт после неё
+        if (off > to.record) {
+            pastStop += rec.length - skip;
+        } else if (off == to.record && rec.length > to.inRecord) {
+            pastStop += rec.length - std::max<uint64_t>(to.inRecord, skip);
+        }
+        if (pastStop >= CRSF_MAX_PACKET_SIZE) {
+            break;
+        }
+        skip = 0;
+    }
+    out.crcErrors += scanner.crcErrors();
+}
+
+unsigned int capture_decode(const CaptureFile& file, CaptureTables& out, unsigned int threads)
+{
+    out = CaptureTables();
+    if (!file.isOpen()) {
+        return 0;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Границы частей — первые записи после равных долей файла (проход только по заголовкам записей)
+    std::vector<size_t> starts(1, file.firstRecord());
+    const size_t body = file.size() - file.firstRecord();
+    CaptureRecord rec;
+    const uint8_t* payload;
+    for (size_t off = file.firstRecord(); starts.size() < threads && file.recordAt(off, rec, payload);
+         off = CaptureFile::nextRecord(off, rec)) {
+        if (off - file.firstRecord() >= body / threads * starts.size() && off > starts.back()) {
+            starts.push_back(off);
+        }
+    }
+    const unsigned int parts = static_cast<unsigned int>(starts.size());
+    starts.push_back(file.size());
+
+    // Точки синхронизации. Первая часть начинается с начала потока, как парсер после запуска;
+    // часть без точки синхронизации целиком дочитывает предыдущая
+    std::vector<CapturePos> sync(parts + 1, CapturePos{file.size(), 0});
+    std::vector<char> found(parts, 0);
+    {
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < parts; ++i) {
+            workers.emplace_back([&, i]() { found[i] = capture_find_sync(file, starts[i], starts[i + 1], sync[i]); });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    sync[0] = {file.firstRecord(), 0};
+    found[0] = 1;
+    for (unsigned int i = parts; i-- > 1;) {
+        if (!found[i]) {
+            sync[i] = sync[i + 1];
+        }
+    }
+
+    std::vector<CaptureTables> partial(parts > 1 ? parts - 1 : 0);
+    {
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < parts; ++i) {
+            if (sync[i] < sync[i + 1]) {
+                workers.emplace_back([&, i]() { capture_decode_range(file, sync[i], sync[i + 1], partial[i - 1]); });
+            }
+        }
+        // Первая часть — в вызывающем потоке
+        capture_decode_range(file, sync[0], sync[1], out);
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    // Склейка: итоговые столбцы выделяются сразу, каждая часть копирует свои строки параллельно
+    std::vector<std::vector<size_t>> offsets(partial.size(), std::vector<size_t>(CAPTURE_TABLES));
+    for (unsigned int id = 0; id < CAPTURE_TABLES; ++id) {
+        CaptureTable& t = out.tables[id];
+        size_t rows = t.rows;
+        for (size_t p = 0; p < partial.size(); ++p) {
+            offsets[p][id] = rows;
+            rows += partial[p].tables[id].rows;
+        }
+        for (auto& c : t.columns) {
+            c.data.resize(rows * capture_column_width(c.type));
+        }
+        t.rows = rows;
+    }
+    {
+        std::vector<std::thread> workers;
+        for (size_t p = 0; p < partial.size(); ++p) {
+            workers.emplace_back([&, p]() {
+                for (unsigned int id = 0; id < CAPTURE_TABLES; ++id) {
+                    CaptureTable& t = out.tables[id];
+                    const CaptureTable& part = partial[p].tables[id];
+                    for (size_t c = 0; c < t.columns.size(); ++c) {
+                        const auto& src = part.columns[c].data;
+                        if (!src.empty()) {
+                            memcpy(&t.columns[c].data[offsets[p][id] * capture_column_width(t.columns[c].type)],
+                                   src.data(), src.size());
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    for (const auto& p : partial) {
+        out.otherFrames += p.otherFrames;
+        out.crcErrors += p.crcErrors;
+    }
+    return parts;
+}
+
+static bool capture_write_file(const std::string& path, const void* data, size_t len)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    bool ok = true;
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return ::close(fd) == 0 && ok;
+}
+
+static bool capture_make_dir(const std::string& dir)
+{
+    return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool capture_write_columns(const CaptureTables& tables, const std::string& dir)
+{
+    if (!capture_make_dir(dir)) {
+        return false;
+    }
+    for (const auto& t : tables.tables) {
+        for (const auto& c : t.columns) {
+            std::string path = dir + "/" + t.name + "." + c.name + "." + capture_column_suffix(c.type);
+            if (!capture_write_file(path, c.data.data(), c.data.size())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Значение столбца в текст (std::to_chars: кратчайшее точное представление double)
+static char* capture_format_value(const CaptureColumn& c, size_t row, char* p, char* end)
+{
+    switch (c.type) {
+    case CAPTURE_COLUMN_U8: return std::to_chars(p, end, c.at<uint8_t>(row)).ptr;
+    case CAPTURE_COLUMN_I8: return std::to_chars(p, end, c.at<int8_t>(row)).ptr;
+    case CAPTURE_COLUMN_U16: return std::to_chars(p, end, c.at<uint16_t>(row)).ptr;
+    case CAPTURE_COLUMN_I16: return std::to_chars(p, end, c.at<int16_t>(row)).ptr;
+    case CAPTURE_COLUMN_I32: return std::to_chars(p, end, c.at<int32_t>(row)).ptr;
+    case CAPTURE_COLUMN_U32: return std::to_chars(p, end, c.at<uint32_t>(row)).ptr;
+    case CAPTURE_COLUMN_U64: return std::to_chars(p, end, c.at<uint64_t>(row)).ptr;
+    case CAPTURE_COLUMN_F64: return std::to_chars(p, end, c.at<double>(row)).ptr;
+    }
+    return p;
+}
+
+bool capture_write_csv(const CaptureTables& tables, const std::string& dir)
+{
+    if (!capture_make_dir(dir)) {
+        return false;
+    }
+    for (const auto& t : tables.tables) {
+        std::string text;
+        for (size_t c = 0; c < t.columns.size(); ++c) {
+            text += c ? "," : "";
+            text += t.columns[c].name;
+        }
+        text += "\n";
+        // Строка не длиннее 32 символов на столбец
+        text.reserve(text.size() + t.rows * t.columns.size() * 8);
+        char line[32 * (CRSF_NUM_CHANNELS + 1)];
+        for (size_t r = 0; r < t.rows; ++r) {
+            char* p = line;
+            for (size_t c = 0; c < t.columns.size(); ++c) {
+                if (c) {
+                    *p++ = ',';
+                }
+                p = capture_format_value(t.columns[c], r, p, line + sizeof(line));
+            }
+            *p++ = '\n';
+            text.append(line, static_cast<size_t>(p - line));
+        }
+        if (!capture_write_file(dir + "/" + t.name + ".csv", text.data(), text.size())) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+// Пакетный разбор записи сырого потока (libs/crsf/capture) в таблицы по типам кадров для анализа
+// после полёта: channels, linkStatistics, gps, battery, attitude (имена — как у групп CrsfLinkCounters).
+// Каждая таблица — столбцы фиксированной ширины (время CLOCK_MONOTONIC и поля кадра); кадры
+// разбираются теми же функциями, что в CrsfSerial::processPacketIn (frame_decode.h, channel_codec.h).
+//
+// Разбор параллельный: запись делится по границам записей на части по числу потоков. Каждый поток
+// находит в своей части точку синхронизации — CAPTURE_DECODE_SYNC_FRAMES кадров подряд с верным CRC —
+// и разбирает принятые кадры от неё до точки синхронизации следующей части. Кадр на границе частей
+// разбирает ровно один поток, порядок строк — порядок кадров в записи, результат не зависит от числа потоков.
+// Последовательны только проход по заголовкам записей (границы частей) и выделение памяти под итог;
+// части копируются в него параллельно.
+//
+//   CaptureFile file;  file.open("flight.cap");
+//   CaptureTables tables;
+//   capture_decode(file, tables);                 // все ядра
+//   capture_write_columns(tables, "out");         // out/gps.latitude.i32 ... (numpy.fromfile)
+//   capture_write_csv(tables, "out");             // out/gps.csv ...
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "capture_replay.h"
+
+#define CAPTURE_DECODE_SYNC_FRAMES 3
+
+enum CaptureColumnType : uint8_t {
+    CAPTURE_COLUMN_U8,
+    CAPTURE_COLUMN_I8,
+    CAPTURE_COLUMN_U16,
+    CAPTURE_COLUMN_I16,
+    CAPTURE_COLUMN_I32,
+    CAPTURE_COLUMN_U32,
+    CAPTURE_COLUMN_U64,
+    CAPTURE_COLUMN_F64,
+};
+
+// Ширина значения и суффикс файла столбца ("u8", "i32", "f64", ...)
+size_t capture_column_width(CaptureColumnType type);
+const char* capture_column_suffix(CaptureColumnType type);
+
+// Столбец: значения подряд, little-endian, ширина по типу
+struct CaptureColumn {
+    std::string name;
+    CaptureColumnType type;
+    std::vector<uint8_t> data;
+
+    template <typename T>
+    void push(T value) {
+        size_t n = data.size();
+        data.resize(n + sizeof(T));
+        memcpy(&data[n], &value, sizeof(T));
+    }
+    template <typename T>
+    T at(size_t row) const {
+        T value;
+        memcpy(&value, &data[row * sizeof(T)], sizeof(T));
+        return value;
+    }
+};
+
+struct CaptureTable {
+    std::string name;
+    size_t rows = 0;
+    std::vector<CaptureColumn> columns;  // первый — timeNs (u64)
+
+    // nullptr, если столбца нет
+    const CaptureColumn* column(const std::string& columnName) const;
+};
+
+enum CaptureTableId {
+    CAPTURE_TABLE_CHANNELS,
+    CAPTURE_TABLE_LINK_STATISTICS,
+    CAPTURE_TABLE_GPS,
+    CAPTURE_TABLE_BATTERY,
+    CAPTURE_TABLE_ATTITUDE,
+    CAPTURE_TABLES
+};
+
+struct CaptureTables {
+    CaptureTables();  // пустые таблицы со всеми столбцами
+
+    CaptureTable tables[CAPTURE_TABLES];
+    uint64_t otherFrames = 0;  // кадров с верным CRC, для которых таблицы нет
+    uint64_t crcErrors = 0;
+
+    CaptureTable& operator[](CaptureTableId id) { return tables[id]; }
+    const CaptureTable& operator[](CaptureTableId id) const { return tables[id]; }
+
+    // Строка из кадра CRSF (frame[0] — адрес), как CrsfSerial::processPacketIn
+    void addFrame(uint64_t timestampNs, const uint8_t* frame, size_t length);
+    // Дописать строки other в конец
+    void append(const CaptureTables& other);
+    size_t rows() const;
+};
+
+// Разобрать принятые кадры записи. threads = 0 — по числу ядер. Возвращает число потоков
+unsigned int capture_decode(const CaptureFile& file, CaptureTables& out, unsigned int threads = 0);
+
+// Столбцы в файлы <dir>/<таблица>.<столбец>.<тип>; каталог создаётся. false при ошибке записи
+bool capture_write_columns(const CaptureTables& tables, const std::string& dir);
+// Таблицы в <dir>/<таблица>.csv (заголовок — имена столбцов). false при ошибке записи
+bool capture_write_csv(const CaptureTables& tables, const std::string& dir);
@@ -0,0 +1,333 @@
+#include "capture_replay.h"
+#include "../rpi_hal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool CaptureFile::open(const std::string& path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CaptureFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    // Запись читается от начала до конца: ядро подкачивает страницы заранее
+    madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    CaptureFileHeader hdr;
+    memcpy(&hdr, map, sizeof(hdr));
+    if (memcmp(hdr.magic, CAPTURE_MAGIC, sizeof(hdr.magic)) != 0 || hdr.version != CAPTURE_VERSION ||
+        hdr.recordSize != sizeof(CaptureRecord) || hdr.headerSize < sizeof(CaptureFileHeader)) {
+        munmap(map, static_cast<size_t>(st.st_size));
+        ::close(fd);
+        return false;
+    }
+    _data = static_cast<const uint8_t*>(map);
+    _size = static_cast<size_t>(st.st_size);
+    _firstRecord = hdr.headerSize;
+    _fd = fd;
+
+    _firstTimestampNs = 0;
+    CaptureRecord rec;
+    const uint8_t* payload;
+    for (size_t off = _firstRecord; recordAt(off, rec, payload); off = nextRecord(off, rec)) {
+        if (rec.kind == CAPTURE_KIND_DATA) {
+            _firstTimestampNs = rec.timestampNs;
+            break;
+        }
+    }
+    return true;
+}
+
+void CaptureFile::close()
+{
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool CaptureFile::recordAt(size_t offset, CaptureRecord& rec, const uint8_t*& payload) const
+{
+    if (offset + sizeof(CaptureRecord) > _size) {
+        return false;
+    }
+    memcpy(&rec, _data + offset, sizeof(rec));
+    if (rec.length > _size - offset - sizeof(CaptureRecord)) {
+        return false;
+    }
+    payload = _data + offset + sizeof(CaptureRecord);
+    return true;
+}
+
+void CaptureIndex::build(const CaptureFile& file)
+{
+    _frames.clear();
+    _captureSize = file.size();
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        _crcErrors[d] = 0;
+        _gapBytes[d] = 0;
+    }
+    // Около 30 байт записи на кадр
+    _frames.reserve(file.size() / 40);
+
+    CaptureFrameScanner streams[CAPTURE_DIRECTIONS];
+    CaptureRecord rec;
+    const uint8_t* payload;
+    for (size_t off = file.firstRecord(); file.recordAt(off, rec, payload); off = CaptureFile::nextRecord(off, rec)) {
+        if (rec.direction >= CAPTURE_DIRECTIONS) {
+            continue;
+        }
+        if (rec.kind == CAPTURE_KIND_GAP && rec.length == sizeof(uint64_t)) {
+            uint64_t lost;
+            memcpy(&lost, payload, sizeof(lost));
+            _gapBytes[rec.direction] += lost;
+            continue;
+        }
+        if (rec.kind != CAPTURE_KIND_DATA) {
+            continue;
+        }
+        const uint8_t dir = rec.direction;
+        streams[dir].feed(rec, off, payload, 0, [&](const CaptureFrameScanner::Frame& f) {
+            CaptureFrameEntry e;
+            memset(&e, 0, sizeof(e));
+            e.timestampNs = f.timestampNs;
+            e.recordOffset = f.recordOffset;
+            e.offsetInRecord = f.offsetInRecord;
+            e.type = f.bytes[2];
+            e.direction = dir;
+            e.length = f.length;
+            _frames.push_back(e);
+        });
+    }
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        _crcErrors[d] = streams[d].crcErrors();
+    }
+}
+
+bool CaptureIndex::save(const std::string& indexPath) const
+{
+    CaptureIndexHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CAPTURE_INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = CAPTURE_INDEX_VERSION;
+    hdr.entrySize = sizeof(CaptureFrameEntry);
+    hdr.captureSize = _captureSize;
+    hdr.frameCount = _frames.size();
+    for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+        hdr.crcErrors[d] = _crcErrors[d];
+        hdr.gapBytes[d] = _gapBytes[d];
+    }
+    // Во временный файл и rename(): читатель никогда не видит недописанный индекс
+    std::string tmp = indexPath + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::write(fd, &hdr, sizeof(hdr)) == static_cast<ssize_t>(sizeof(hdr));
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(_frames.data());
+    size_t left = _frames.size() * sizeof(CaptureFrameEntry);
+    while (ok && left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    ::close(fd);
+    if (!ok || rename(tmp.c_str(), indexPath.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CaptureIndex::load(const CaptureFile& file, const std::string& indexPath)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+    int fd = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        CaptureIndexHeader hdr;
+        bool ok = ::read(fd, &hdr, sizeof(hdr)) == static_cast<ssize_t>(sizeof(hdr)) &&
+                  memcmp(hdr.magic, CAPTURE_INDEX_MAGIC, sizeof(hdr.magic)) == 0 &&
+                  hdr.version == CAPTURE_INDEX_VERSION && hdr.entrySize == sizeof(CaptureFrameEntry) &&
+                  hdr.captureSize == file.size();
+        if (ok) {
+            _frames.resize(hdr.frameCount);
+            uint8_t* p = reinterpret_cast<uint8_t*>(_frames.data());
+            size_t left = _frames.size() * sizeof(CaptureFrameEntry);
+            while (left > 0) {
+                ssize_t n = ::read(fd, p, left);
+                if (n <= 0) {
+                    ok = false;
+                    break;
+                }
+                p += n;
+                left -= static_cast<size_t>(n);
+            }
+        }
+        ::close(fd);
+        if (ok) {
+            _captureSize = hdr.captureSize;
+            for (unsigned int d = 0; d < CAPTURE_DIRECTIONS; ++d) {
+                _crcErrors[d] = hdr.crcErrors[d];
+                _gapBytes[d] = hdr.gapBytes[d];
+            }
+            return true;
+        }
+    }
+    // Индекса нет, он чужой или запись с тех пор дописана
+    build(file);
+    save(indexPath);
+    return true;
+}
+
+size_t CaptureIndex::countOfType(uint8_t type, CaptureDirection dir) const
+{
+    size_t n = 0;
+    for (const auto& e : _frames) {
+        n += (e.type == type && e.direction == dir);
+    }
+    return n;
+}
+
+size_t CaptureIndex::frameAtTime(uint64_t timestampNs) const
+{
+    // Записи в файле упорядочены по времени потоком записи (слиянием двух колец)
+    auto it = std::partition_point(_frames.begin(), _frames.end(),
+                                   [timestampNs](const CaptureFrameEntry& e) { return e.timestampNs < timestampNs; });
+    return static_cast<size_t>(it - _frames.begin());
+}
+
+size_t CaptureIndex::nextOfType(uint8_t type, size_t from, CaptureDirection dir) const
+{
+    for (size_t i = from; i < _frames.size(); ++i) {
+        if (_frames[i].type == type && _frames[i].direction == dir) {
+            return i;
+        }
+    }
+    return _frames.size();
+}
+
+CaptureReplayPort::CaptureReplayPort(const CaptureFile& file)
+    : SerialPort("", CRSF_BAUDRATE), _file(file), _offset(file.firstRecord()), _skip(0),
+      _realtime(false), _speed(1.0), _baseRecordNs(0), _baseWallNs(0), _bytesRead(0), _bytesWritten(0)
+{
+}
+
+void CaptureReplayPort::setRealtime(bool realtime, double speed)
+{
+    _realtime = realtime;
+    _speed = speed > 0 ? speed : 1.0;
+    _baseRecordNs = 0;
+}
+
+void CaptureReplayPort::rewind()
+{
+    _offset = _file.firstRecord();
+    _skip = 0;
+    _baseRecordNs = 0;
+}
+
+void CaptureReplayPort::seekFrame(const CaptureIndex& index, size_t frame)
+{
+    // Кадры TX в поток приёма не попадают: ищем ближайший кадр RX
+    while (frame < index.frameCount() && index.frame(frame).direction != CAPTURE_RX) {
+        ++frame;
+    }
+    if (frame >= index.frameCount()) {
+        _offset = _file.size();
+        _skip = 0;
+    } else {
+        _offset = static_cast<size_t>(index.frame(frame).recordOffset);
+        _skip = index.frame(frame).offsetInRecord;
+    }
+    _baseRecordNs = 0;
+}
+
+bool CaptureReplayPort::settle()
+{
+    CaptureRecord rec;
+    const uint8_t* payload;
+    while (_file.recordAt(_offset, rec, payload)) {
+        if (rec.kind == CAPTURE_KIND_DATA && rec.direction == CAPTURE_RX && _skip < rec.length) {
+            return true;
+        }
+        _offset = CaptureFile::nextRecord(_offset, rec);
+        _skip = 0;
+    }
+    _offset = _file.size(); // конец или обрезанная последняя запись
+    return false;
+}
+
+uint64_t CaptureReplayPort::nextDueNs()
+{
+    if (!_realtime || _baseRecordNs == 0 || !settle()) {
+        return 0;
+    }
+    CaptureRecord rec;
+    const uint8_t* payload;
+    _file.recordAt(_offset, rec, payload);
+    if (rec.timestampNs <= _baseRecordNs) {
+        return 0;
+    }
+    return _baseWallNs + static_cast<uint64_t>(static_cast<double>(rec.timestampNs - _baseRecordNs) / _speed);
+}
+
+int CaptureReplayPort::read(uint8_t* buf, size_t len)
+{
+    size_t done = 0;
+    CaptureRecord rec;
+    const uint8_t* payload = nullptr;
+    while (done < len && settle()) {
+        _file.recordAt(_offset, rec, payload);
+        if (_realtime) {
+            uint64_t now = rpi_monotonic_ns();
+            if (_baseRecordNs == 0) {
+                _baseRecordNs = rec.timestampNs;
+                _baseWallNs = now;
+            } else if (nextDueNs() > now) {
+                break; // Порция ещё не «пришла» — как пустой read() по таймауту VTIME
+            }
+        }
+        size_t n = std::min(len - done, static_cast<size_t>(rec.length) - _skip);
+        memcpy(buf + done, payload + _skip, n);
+        done += n;
+        _skip += n;
+        if (_realtime) {
+            break; // По одной порции записи за read(), как они приходили из драйвера
+        }
+    }
+    _bytesRead += done;
+    return static_cast<int>(done);
+}
+
+int CaptureReplayPort::write(const uint8_t* buf, size_t len)
+{
+    (void)buf;
+    _bytesWritten += len;
+    return static_cast<int>(len);
+}
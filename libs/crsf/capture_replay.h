@@ -0,0 +1,273 @@
+#pragma once
+
+// Воспроизведение и разбор записей сырого потока (libs/crsf/capture) быстрее реального времени.
+//
+// CaptureFile    — запись, отображённая в память (mmap) только на чтение; обход записей без копий.
+// CaptureFrameScanner — выделение кадров из потока одного направления по правилам CrsfSerial;
+//                  общий для индекса и пакетного декодера (libs/crsf/capture_decode).
+// CaptureIndex   — индекс кадров обоих направлений: время, тип, положение в файле. Кадры выделяются
+//                  по тем же правилам, что в CrsfSerial (байт длины, CRC), поэтому позиции совпадают
+//                  с границами кадров парсера. Сохраняется рядом с записью (<запись>.idx) и
+//                  перестраивается, если запись с тех пор дописана.
+// CaptureReplayPort — SerialPort в памяти: read() отдаёт принятые (RX) байты записи, запись в порт
+//                  отбрасывается. Без темпа — сколько поместится в буфер, с темпом — порции по их
+//                  времени (с множителем скорости). Перемотка к кадру по номеру или времени.
+//
+//   CaptureFile file;          file.open("flight.cap");
+//   CaptureIndex index;        index.load(file, "flight.cap.idx");  // или build() + save()
+//   CaptureReplayPort port(file);
+//   port.seekFrame(index, index.frameAtTime(file.firstTimestampNs() + 60000000000ull));
+//   CrsfSerial crsf(port);
+//   while (!port.atEnd()) crsf.loop();
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+#include "crc8.h"
+#include "crsf_protocol.h"
+#include "../SerialPort.h"
+
+#define CAPTURE_INDEX_MAGIC "CRSFIDX"  // 8 байт с завершающим нулём
+#define CAPTURE_INDEX_VERSION 1
+
+class CaptureFile {
+public:
+    CaptureFile() : _data(nullptr), _size(0), _fd(-1) {}
+    ~CaptureFile() { close(); }
+
+    CaptureFile(const CaptureFile&) = delete;
+    CaptureFile& operator=(const CaptureFile&) = delete;
+
+    // false, если файл не открывается или это не запись CRSF поддерживаемой версии
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return _data != nullptr; }
+
+    const uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+    // Смещение первой записи (сразу после CaptureFileHeader)
+    size_t firstRecord() const { return _firstRecord; }
+
+    // Запись по смещению offset: заголовок и указатель на её данные. false — конец файла
+    // или запись обрезана (последняя запись при аварийном завершении)
+    bool recordAt(size_t offset, CaptureRecord& rec, const uint8_t*& payload) const;
+    // Смещение следующей записи
+    static size_t nextRecord(size_t offset, const CaptureRecord& rec) { return offset + sizeof(CaptureRecord) + rec.length; }
+
+    // Время первой записи данных (0, если данных нет)
+    uint64_t firstTimestampNs() const { return _firstTimestampNs; }
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+    size_t _firstRecord = sizeof(CaptureFileHeader);
+    uint64_t _firstTimestampNs = 0;
+    int _fd;
+};
+
+// Кадры потока одного направления: данные записей подаются по порядку, на каждый кадр с верным CRC
+// вызывается onFrame. Правила те же, что в CrsfSerial::handleByteReceived(): недопустимый байт длины —
+// сдвиг на байт, неверный CRC — пропуск кадра целиком. Кадр, разрезанный между записями, собирается
+// из хвоста прошлых записей; его время и положение — время и положение записи с первым байтом.
+class CaptureFrameScanner {
+public:
+    struct Frame {
+        const uint8_t* bytes;    // кадр целиком (действителен только внутри onFrame)
+        uint8_t length;          // байт кадра (адрес, длина, тип, данные, CRC)
+        uint64_t timestampNs;
+        uint64_t recordOffset;
+        uint16_t offsetInRecord;
+        uint64_t streamPos;      // номер первого байта кадра в поданном потоке
+    };
+
+    // Данные записи rec со смещением offset, начиная с байта skip
+    template <typename OnFrame>
+    void feed(const CaptureRecord& rec, size_t offset, const uint8_t* payload, size_t skip, OnFrame&& onFrame);
+
+    void reset() { _len = 0; _streamPos = 0; _crcErrors = 0; }
+    uint64_t crcErrors() const { return _crcErrors; }
+
+private:
+    static const Crc8& crc() { static const Crc8 c(0xD5); return c; }
+
+    // Хвост прошлых записей, где кадр ещё не закончился, с происхождением каждого байта
+    uint8_t _bytes[CRSF_MAX_PACKET_SIZE];
+    uint64_t _recordOffset[CRSF_MAX_PACKET_SIZE];
+    uint64_t _timestampNs[CRSF_MAX_PACKET_SIZE];
+    uint16_t _offsetInRecord[CRSF_MAX_PACKET_SIZE];
+    size_t _len = 0;
+    uint64_t _streamPos = 0;     // номер первого байта хвоста
+    uint64_t _crcErrors = 0;
+};
+
+template <typename OnFrame>
+void CaptureFrameScanner::feed(const CaptureRecord& rec, size_t offset, const uint8_t* payload, size_t skip,
+                               OnFrame&& onFrame)
+{
+    payload += skip;
+    const size_t count = rec.length - skip;
+    const size_t carry = _len;
+    const size_t total = carry + count;
+    auto byteAt = [&](size_t i) { return i < carry ? _bytes[i] : payload[i - carry]; };
+
+    uint8_t straddle[CRSF_MAX_PACKET_SIZE];
+    size_t pos = 0;
+    while (total - pos >= 2) {
+        uint8_t len = byteAt(pos + 1);
+        if (len < 3 || len > CRSF_MAX_PAYLOAD_LEN + 2) {
+            ++pos;
+            continue;
+        }
+        if (total - pos < static_cast<size_t>(len) + 2) {
+            break;
+        }
+        const uint8_t* f;
+        if (pos >= carry) {
+            f = payload + (pos - carry);
+        } else {
+            for (size_t i = 0; i < static_cast<size_t>(len) + 2; ++i) {
+                straddle[i] = byteAt(pos + i);
+            }
+            f = straddle;
+        }
+        if (crc().update(0, &f[2], len - 1) == f[len + 1]) {
+            Frame frame;
+            frame.bytes = f;
+            frame.length = static_cast<uint8_t>(len + 2);
+            frame.streamPos = _streamPos + pos;
+            if (pos < carry) {
+                frame.timestampNs = _timestampNs[pos];
+                frame.recordOffset = _recordOffset[pos];
+                frame.offsetInRecord = _offsetInRecord[pos];
+            } else {
+                frame.timestampNs = rec.timestampNs;
+                frame.recordOffset = offset;
+                frame.offsetInRecord = static_cast<uint16_t>(skip + pos - carry);
+            }
+            onFrame(frame);
+        } else {
+            ++_crcErrors;
+        }
+        pos += static_cast<size_t>(len) + 2;
+    }
+
+    // Новый хвост: байты [pos, total) — их меньше кадра; сдвиг в начало буфера
+    const size_t tail = total - pos;
+    for (size_t i = 0; i < tail; ++i) {
+        size_t src = pos + i;
+        if (src < carry) {
+            _bytes[i] = _bytes[src];
+            _recordOffset[i] = _recordOffset[src];
+            _timestampNs[i] = _timestampNs[src];
+            _offsetInRecord[i] = _offsetInRecord[src];
+        } else {
+            _bytes[i] = payload[src - carry];
+            _recordOffset[i] = offset;
+            _timestampNs[i] = rec.timestampNs;
+            _offsetInRecord[i] = static_cast<uint16_t>(skip + src - carry);
+        }
+    }
+    _len = tail;
+    _streamPos += pos;
+}
+
+// Кадр в индексе (24 байта, раскладка — часть формата файла индекса)
+struct CaptureFrameEntry {
+    uint64_t timestampNs;  // время записи, в которой начинается кадр
+    uint64_t recordOffset; // смещение этой записи в файле
+    uint16_t offsetInRecord; // смещение первого байта кадра в данных записи
+    uint8_t type;          // тип кадра CRSF
+    uint8_t direction;     // CaptureDirection
+    uint8_t length;        // байт кадра целиком (адрес, длина, тип, данные, CRC)
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(CaptureFrameEntry) == 24, "CaptureFrameEntry layout is part of the index format");
+
+struct CaptureIndexHeader {
+    char magic[8];         // CAPTURE_INDEX_MAGIC
+    uint16_t version;      // CAPTURE_INDEX_VERSION
+    uint16_t entrySize;    // sizeof(CaptureFrameEntry)
+    uint32_t reserved;
+    uint64_t captureSize;  // размер записи, по которой построен индекс
+    uint64_t frameCount;
+    uint64_t crcErrors[CAPTURE_DIRECTIONS];
+    uint64_t gapBytes[CAPTURE_DIRECTIONS];  // потеряно при записи (записи CAPTURE_KIND_GAP)
+};
+
+class CaptureIndex {
+public:
+    // Построить индекс за один проход по записи
+    void build(const CaptureFile& file);
+    // Загрузить индекс; если его нет или он построен по записи другого размера (дописанной) —
+    // построить и сохранить. false, только если индекс не удалось ни загрузить, ни построить
+    bool load(const CaptureFile& file, const std::string& indexPath);
+    bool save(const std::string& indexPath) const;
+
+    size_t frameCount() const { return _frames.size(); }
+    const CaptureFrameEntry& frame(size_t i) const { return _frames[i]; }
+    const std::vector<CaptureFrameEntry>& frames() const { return _frames; }
+
+    // Кадров данного типа в направлении
+    size_t countOfType(uint8_t type, CaptureDirection dir = CAPTURE_RX) const;
+    // Номер первого кадра с временем >= timestampNs (frameCount(), если таких нет)
+    size_t frameAtTime(uint64_t timestampNs) const;
+    // Номер следующего кадра типа type направления dir, начиная с from (frameCount(), если нет)
+    size_t nextOfType(uint8_t type, size_t from, CaptureDirection dir = CAPTURE_RX) const;
+
+    uint64_t crcErrors(CaptureDirection dir) const { return _crcErrors[dir]; }
+    uint64_t gapBytes(CaptureDirection dir) const { return _gapBytes[dir]; }
+    uint64_t captureSize() const { return _captureSize; }
+
+private:
+    std::vector<CaptureFrameEntry> _frames;
+    uint64_t _captureSize = 0;
+    uint64_t _crcErrors[CAPTURE_DIRECTIONS] = {};
+    uint64_t _gapBytes[CAPTURE_DIRECTIONS] = {};
+};
+
+class CaptureReplayPort : public SerialPort {
+public:
+    explicit CaptureReplayPort(const CaptureFile& file);
+
+    // Порт в памяти всегда «открыт»; устройство не используется
+    bool open() override { return true; }
+    void close() override {}
+    void flush() override {}
+
+    int read(uint8_t* buf, size_t len) override;
+    int readByte(uint8_t& b) override { return read(&b, 1); }
+    int write(const uint8_t* buf, size_t len) override;
+    int writeByte(uint8_t b) override { return write(&b, 1); }
+
+    // Темп воспроизведения: false — без пауз; true — порция отдаётся не раньше своего времени
+    // относительно первой отданной порции, делённого на speed (2.0 — вдвое быстрее записи)
+    void setRealtime(bool realtime, double speed = 1.0);
+    // Время CLOCK_MONOTONIC, когда станет доступна следующая порция (0 — доступна сейчас или конец)
+    uint64_t nextDueNs();
+
+    // Перемотка: следующее чтение начнётся с первого байта кадра
+    void seekFrame(const CaptureIndex& index, size_t frame);
+    void rewind();
+    bool atEnd() const { return _offset >= _file.size(); }
+
+    uint64_t bytesRead() const { return _bytesRead; }
+    uint64_t bytesWritten() const { return _bytesWritten; }
+
+private:
+    // Перейти к ближайшей записи RX-данных начиная с _offset; false — конец файла
+    bool settle();
+
+    const CaptureFile& _file;
+    size_t _offset;       // текущая запись
+    size_t _skip;         // уже отданные байты её данных
+    bool _realtime;
+    double _speed;
+    uint64_t _baseRecordNs; // время записи, с которой начат отсчёт темпа (0 — не начат)
+    uint64_t _baseWallNs;
+    uint64_t _bytesRead;
+    uint64_t _bytesWritten;
+};
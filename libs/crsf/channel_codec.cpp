@@ -0,0 +1,608 @@
+#include "channel_codec.h"
+#include "channel_tables.h"
+
+#include <atomic>
+#include <cstring>
+#include <endian.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define CHANNEL_CODEC_HAVE_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CHANNEL_CODEC_HAVE_NEON 1
+#endif
+
+static const int CODE_LO = CRSF_CHANNEL_VALUE_1000;
+static const int CODE_HI = CRSF_CHANNEL_VALUE_2000;
+static const int CODE_DELTA = CODE_HI - CODE_LO;
+
+static const uint64_t MASK44 = (1ull << 44) - 1;
+static const uint64_t MASK22 = (1ull << 22) - 1;
+static const uint64_t MASK11 = (1ull << 11) - 1;
+
+// ===== Преобразование одного значения: таблицы, построенные при компиляции =====
+
+int crsf_code_to_us(int code)
+{
+    return crsf_code_to_us_lut(code);
+}
+
+int crsf_us_to_code(int us)
+{
+    return crsf_us_to_code_lut(us);
+}
+
+// ===== Общие части: кадр как четыре 44-битные группы по 4 канала =====
+// Группа k занимает биты [44k, 44k+44) и читается одним 64-битным словом без выхода за 22 байта
+
+static inline uint64_t load_le64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return le64toh(v);
+}
+
+static inline void load_groups(const uint8_t* payload, uint64_t q[4])
+{
+    q[0] = load_le64(payload) & MASK44;
+    q[1] = (load_le64(payload + 5) >> 4) & MASK44;
+    q[2] = load_le64(payload + 11) & MASK44;
+    q[3] = load_le64(payload + 14) >> 20;
+}
+
+static inline void store_groups(const uint64_t q[4], uint8_t* payload)
+{
+    uint64_t w0 = htole64(q[0] | (q[1] << 44));
+    uint64_t w1 = htole64((q[1] >> 20) | (q[2] << 24));
+    uint64_t w2 = htole64((q[2] >> 40) | (q[3] << 4));
+    memcpy(payload, &w0, 8);
+    memcpy(payload + 8, &w1, 8);
+    memcpy(payload + 16, &w2, 6);
+}
+
+// ===== Скалярная реализация =====
+
+static void scalar_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS])
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    for (int k = 0; k < 4; ++k) {
+        codes[4 * k + 0] = static_cast<uint16_t>(q[k] & MASK11);
+        codes[4 * k + 1] = static_cast<uint16_t>((q[k] >> 11) & MASK11);
+        codes[4 * k + 2] = static_cast<uint16_t>((q[k] >> 22) & MASK11);
+        codes[4 * k + 3] = static_cast<uint16_t>(q[k] >> 33);
+    }
+}
+
+static void scalar_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    uint64_t q[4];
+    for (int k = 0; k < 4; ++k) {
+        q[k] = (codes[4 * k + 0] & MASK11) |
+               ((codes[4 * k + 1] & MASK11) << 11) |
+               ((codes[4 * k + 2] & MASK11) << 22) |
+               ((codes[4 * k + 3] & MASK11) << 33);
+    }
+    store_groups(q, payload);
+}
+
+static void scalar_decode(const uint8_t* payload, uint16_t us[CRSF_NUM_CHANNELS])
+{
+    uint16_t codes[CRSF_NUM_CHANNELS];
+    scalar_unpack(payload, codes);
+    for (int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        us[i] = CRSF_CODE_TO_US[codes[i]]; // 11-битный код — всегда в пределах таблицы
+    }
+}
+
+static void scalar_encode(const uint16_t us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    uint16_t codes[CRSF_NUM_CHANNELS];
+    for (int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        codes[i] = static_cast<uint16_t>(crsf_us_to_code_lut(us[i]));
+    }
+    scalar_pack(codes, payload);
+}
+
+static void scalar_decode_int(const uint8_t* payload, int us[CRSF_NUM_CHANNELS])
+{
+    uint16_t codes[CRSF_NUM_CHANNELS];
+    scalar_unpack(payload, codes);
+    for (int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        us[i] = CRSF_CODE_TO_US[codes[i]];
+    }
+}
+
+static void scalar_encode_int(const int us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    uint16_t codes[CRSF_NUM_CHANNELS];
+    for (int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        codes[i] = static_cast<uint16_t>(crsf_us_to_code_lut(us[i]));
+    }
+    scalar_pack(codes, payload);
+}
+
+// Пакетные циклы с встраиванием ядра конкретной реализации
+#define CHANNEL_CODEC_BATCH(prefix, attr) \
+    attr static void prefix##_decode_batch(const uint8_t* payloads, size_t stride, size_t count, uint16_t* us) \
+    { \
+        for (size_t n = 0; n < count; ++n) \
+            prefix##_decode(payloads + n * stride, us + n * CRSF_NUM_CHANNELS); \
+    } \
+    attr static void prefix##_encode_batch(const uint16_t* us, size_t count, uint8_t* payloads, size_t stride) \
+    { \
+        for (size_t n = 0; n < count; ++n) \
+            prefix##_encode(us + n * CRSF_NUM_CHANNELS, payloads + n * stride); \
+    }
+
+CHANNEL_CODEC_BATCH(scalar, )
+
+// Векторные реализации считают в float: (x + 0.5) / d отстоит от целого не меньше чем на 0.5 / d,
+// а ошибка округления на этом диапазоне на порядок меньше, поэтому отбрасывание дробной части
+// совпадает с целочисленным делением. Коррекция ±1 в crsf_us_to_code для этих констант
+// не срабатывает ни для одного значения — это проверяет полный перебор в unit-тестах.
+// Таблицы здесь не используются: загрузка по 16 индексам (gather) медленнее пары умножений
+#define CODE_TO_US_BIAS (CODE_DELTA / 2 + 0.5f)
+#define US_TO_CODE_BIAS 500.5f
+
+#if defined(CHANNEL_CODEC_HAVE_X86)
+
+// ===== SSE2 =====
+
+// 2 x 44 бита → 4 x 22 бита в 32-битных полях, затем → 8 x 11 бит в 16-битных полях
+static inline __m128i sse2_split(__m128i q)
+{
+    __m128i p = _mm_or_si128(_mm_and_si128(q, _mm_set1_epi64x(MASK22)),
+                             _mm_slli_epi64(_mm_srli_epi64(q, 22), 32));
+    return _mm_or_si128(_mm_and_si128(p, _mm_set1_epi32(MASK11)),
+                        _mm_slli_epi32(_mm_srli_epi32(p, 11), 16));
+}
+
+// Обратное к sse2_split; результат — две 44-битные группы
+static inline __m128i sse2_join(__m128i c)
+{
+    __m128i p = _mm_or_si128(_mm_and_si128(c, _mm_set1_epi32(MASK11)),
+                             _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(c, 16), _mm_set1_epi32(MASK11)), 11));
+    return _mm_or_si128(_mm_and_si128(p, _mm_set1_epi64x(0xFFFFFFFFull)),
+                        _mm_slli_epi64(_mm_srli_epi64(p, 32), 22));
+}
+
+static inline __m128i sse2_code_to_us_epi32(__m128i code)
+{
+    __m128 c = _mm_cvtepi32_ps(code);
+    c = _mm_min_ps(_mm_max_ps(c, _mm_set1_ps(CODE_LO)), _mm_set1_ps(CODE_HI));
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(c, _mm_set1_ps(CODE_LO)), _mm_set1_ps(1000.0f)),
+                          _mm_set1_ps(CODE_TO_US_BIAS));
+    __m128i q = _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(1.0f / CODE_DELTA)));
+    return _mm_add_epi32(q, _mm_set1_epi32(1000));
+}
+
+static inline __m128i sse2_us_to_code_epi32(__m128i us)
+{
+    __m128 u = _mm_cvtepi32_ps(us);
+    u = _mm_min_ps(_mm_max_ps(u, _mm_set1_ps(1000.0f)), _mm_set1_ps(2000.0f));
+    __m128 v = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(u, _mm_set1_ps(1000.0f)), _mm_set1_ps(CODE_DELTA)),
+                          _mm_set1_ps(US_TO_CODE_BIAS));
+    __m128i q = _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(0.001f)));
+    return _mm_add_epi32(q, _mm_set1_epi32(CODE_LO));
+}
+
+static inline void sse2_unpack_v(const uint8_t* payload, __m128i& c0, __m128i& c1)
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    c0 = sse2_split(_mm_set_epi64x(static_cast<long long>(q[1]), static_cast<long long>(q[0])));
+    c1 = sse2_split(_mm_set_epi64x(static_cast<long long>(q[3]), static_cast<long long>(q[2])));
+}
+
+static inline void sse2_pack_v(__m128i c0, __m128i c1, uint8_t* payload)
+{
+    uint64_t q[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&q[0]), sse2_join(c0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&q[2]), sse2_join(c1));
+    store_groups(q, payload);
+}
+
+// 8 x u16 → 8 x u16 через две четвёрки int32
+#define SSE2_MAP16(x, fn) \
+    _mm_packs_epi32(fn(_mm_unpacklo_epi16((x), _mm_setzero_si128())), \
+                    fn(_mm_unpackhi_epi16((x), _mm_setzero_si128())))
+
+static void sse2_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS])
+{
+    __m128i c0, c1;
+    sse2_unpack_v(payload, c0, c1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(codes), c0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + 8), c1);
+}
+
+static void sse2_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    sse2_pack_v(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + 8)), payload);
+}
+
+static inline void sse2_decode(const uint8_t* payload, uint16_t us[CRSF_NUM_CHANNELS])
+{
+    __m128i c0, c1;
+    sse2_unpack_v(payload, c0, c1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(us), SSE2_MAP16(c0, sse2_code_to_us_epi32));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(us + 8), SSE2_MAP16(c1, sse2_code_to_us_epi32));
+}
+
+static inline void sse2_encode(const uint16_t us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    __m128i u0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(us));
+    __m128i u1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(us + 8));
+    sse2_pack_v(SSE2_MAP16(u0, sse2_us_to_code_epi32), SSE2_MAP16(u1, sse2_us_to_code_epi32), payload);
+}
+
+// Кадр CrsfSerial хранит каналы в int: int32 читаются и пишутся напрямую, без промежуточного uint16_t
+static void sse2_decode_int(const uint8_t* payload, int us[CRSF_NUM_CHANNELS])
+{
+    __m128i c[2];
+    sse2_unpack_v(payload, c[0], c[1]);
+    for (int h = 0; h < 2; ++h) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(us + 8 * h),
+                         sse2_code_to_us_epi32(_mm_unpacklo_epi16(c[h], _mm_setzero_si128())));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(us + 8 * h + 4),
+                         sse2_code_to_us_epi32(_mm_unpackhi_epi16(c[h], _mm_setzero_si128())));
+    }
+}
+
+static void sse2_encode_int(const int us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    const __m128i* in = reinterpret_cast<const __m128i*>(us);
+    __m128i c0 = _mm_packs_epi32(sse2_us_to_code_epi32(_mm_loadu_si128(in)),
+                                 sse2_us_to_code_epi32(_mm_loadu_si128(in + 1)));
+    __m128i c1 = _mm_packs_epi32(sse2_us_to_code_epi32(_mm_loadu_si128(in + 2)),
+                                 sse2_us_to_code_epi32(_mm_loadu_si128(in + 3)));
+    sse2_pack_v(c0, c1, payload);
+}
+
+CHANNEL_CODEC_BATCH(sse2, )
+
+// ===== AVX2: все 16 каналов в одном регистре =====
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i avx2_split(__m256i q)
+{
+    __m256i p = _mm256_or_si256(_mm256_and_si256(q, _mm256_set1_epi64x(MASK22)),
+                                _mm256_slli_epi64(_mm256_srli_epi64(q, 22), 32));
+    return _mm256_or_si256(_mm256_and_si256(p, _mm256_set1_epi32(MASK11)),
+                           _mm256_slli_epi32(_mm256_srli_epi32(p, 11), 16));
+}
+
+AVX2_TARGET static inline __m256i avx2_join(__m256i c)
+{
+    __m256i p = _mm256_or_si256(_mm256_and_si256(c, _mm256_set1_epi32(MASK11)),
+                                _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(c, 16), _mm256_set1_epi32(MASK11)), 11));
+    return _mm256_or_si256(_mm256_and_si256(p, _mm256_set1_epi64x(0xFFFFFFFFull)),
+                           _mm256_slli_epi64(_mm256_srli_epi64(p, 32), 22));
+}
+
+AVX2_TARGET static inline __m256i avx2_code_to_us_epi32(__m256i code)
+{
+    __m256 c = _mm256_cvtepi32_ps(code);
+    c = _mm256_min_ps(_mm256_max_ps(c, _mm256_set1_ps(CODE_LO)), _mm256_set1_ps(CODE_HI));
+    __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(c, _mm256_set1_ps(CODE_LO)), _mm256_set1_ps(1000.0f)),
+                             _mm256_set1_ps(CODE_TO_US_BIAS));
+    __m256i q = _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(1.0f / CODE_DELTA)));
+    return _mm256_add_epi32(q, _mm256_set1_epi32(1000));
+}
+
+AVX2_TARGET static inline __m256i avx2_us_to_code_epi32(__m256i us)
+{
+    __m256 u = _mm256_cvtepi32_ps(us);
+    u = _mm256_min_ps(_mm256_max_ps(u, _mm256_set1_ps(1000.0f)), _mm256_set1_ps(2000.0f));
+    __m256 v = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(u, _mm256_set1_ps(1000.0f)), _mm256_set1_ps(CODE_DELTA)),
+                             _mm256_set1_ps(US_TO_CODE_BIAS));
+    __m256i q = _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(0.001f)));
+    return _mm256_add_epi32(q, _mm256_set1_epi32(CODE_LO));
+}
+
+// 16 x u16 → 16 x u16 через две восьмёрки int32; packus перемешивает 128-битные половины
+#define AVX2_MAP16(x, fn) \
+    _mm256_permute4x64_epi64(_mm256_packus_epi32(fn(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(x))), \
+                                                 fn(_mm256_cvtepu16_epi32(_mm256_extracti128_si256((x), 1)))), 0xD8)
+
+AVX2_TARGET static inline __m256i avx2_unpack_v(const uint8_t* payload)
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    return avx2_split(_mm256_set_epi64x(static_cast<long long>(q[3]), static_cast<long long>(q[2]),
+                                        static_cast<long long>(q[1]), static_cast<long long>(q[0])));
+}
+
+AVX2_TARGET static inline void avx2_pack_v(__m256i c, uint8_t* payload)
+{
+    uint64_t q[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(q), avx2_join(c));
+    store_groups(q, payload);
+}
+
+AVX2_TARGET static void avx2_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS])
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes), avx2_unpack_v(payload));
+}
+
+AVX2_TARGET static void avx2_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    avx2_pack_v(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(codes)), payload);
+}
+
+AVX2_TARGET static inline void avx2_decode(const uint8_t* payload, uint16_t us[CRSF_NUM_CHANNELS])
+{
+    __m256i c = avx2_unpack_v(payload);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(us), AVX2_MAP16(c, avx2_code_to_us_epi32));
+}
+
+AVX2_TARGET static inline void avx2_encode(const uint16_t us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(us));
+    avx2_pack_v(AVX2_MAP16(u, avx2_us_to_code_epi32), payload);
+}
+
+AVX2_TARGET static void avx2_decode_int(const uint8_t* payload, int us[CRSF_NUM_CHANNELS])
+{
+    __m256i c = avx2_unpack_v(payload);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(us),
+                        avx2_code_to_us_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(c))));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(us + 8),
+                        avx2_code_to_us_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(c, 1))));
+}
+
+AVX2_TARGET static void avx2_encode_int(const int us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    const __m256i* in = reinterpret_cast<const __m256i*>(us);
+    __m256i c = _mm256_packus_epi32(avx2_us_to_code_epi32(_mm256_loadu_si256(in)),
+                                    avx2_us_to_code_epi32(_mm256_loadu_si256(in + 1)));
+    avx2_pack_v(_mm256_permute4x64_epi64(c, 0xD8), payload);
+}
+
+CHANNEL_CODEC_BATCH(avx2, AVX2_TARGET)
+
+#endif // CHANNEL_CODEC_HAVE_X86
+
+#if defined(CHANNEL_CODEC_HAVE_NEON)
+
+// ===== NEON =====
+
+static inline uint16x8_t neon_split(uint64_t qa, uint64_t qb)
+{
+    uint64x2_t q = vcombine_u64(vcreate_u64(qa), vcreate_u64(qb));
+    uint32x4_t p = vreinterpretq_u32_u64(vorrq_u64(vandq_u64(q, vdupq_n_u64(MASK22)),
+                                                   vshlq_n_u64(vshrq_n_u64(q, 22), 32)));
+    return vreinterpretq_u16_u32(vorrq_u32(vandq_u32(p, vdupq_n_u32(MASK11)),
+                                           vshlq_n_u32(vshrq_n_u32(p, 11), 16)));
+}
+
+static inline uint64x2_t neon_join(uint16x8_t codes)
+{
+    uint32x4_t c = vreinterpretq_u32_u16(codes);
+    uint64x2_t p = vreinterpretq_u64_u32(vorrq_u32(vandq_u32(c, vdupq_n_u32(MASK11)),
+                                                   vshlq_n_u32(vandq_u32(vshrq_n_u32(c, 16), vdupq_n_u32(MASK11)), 11)));
+    return vorrq_u64(vandq_u64(p, vdupq_n_u64(0xFFFFFFFFull)), vshlq_n_u64(vshrq_n_u64(p, 32), 22));
+}
+
+static inline uint32x4_t neon_code_to_us_u32(uint32x4_t code)
+{
+    float32x4_t c = vcvtq_f32_u32(code);
+    c = vminq_f32(vmaxq_f32(c, vdupq_n_f32(CODE_LO)), vdupq_n_f32(CODE_HI));
+    float32x4_t v = vaddq_f32(vmulq_f32(vsubq_f32(c, vdupq_n_f32(CODE_LO)), vdupq_n_f32(1000.0f)),
+                              vdupq_n_f32(CODE_TO_US_BIAS));
+    uint32x4_t q = vcvtq_u32_f32(vmulq_f32(v, vdupq_n_f32(1.0f / CODE_DELTA)));
+    return vaddq_u32(q, vdupq_n_u32(1000));
+}
+
+// Вход — float, чтобы одинаково обрабатывать uint16_t и отрицательные int
+static inline uint32x4_t neon_us_to_code_f32(float32x4_t u)
+{
+    u = vminq_f32(vmaxq_f32(u, vdupq_n_f32(1000.0f)), vdupq_n_f32(2000.0f));
+    float32x4_t v = vaddq_f32(vmulq_f32(vsubq_f32(u, vdupq_n_f32(1000.0f)), vdupq_n_f32(CODE_DELTA)),
+                              vdupq_n_f32(US_TO_CODE_BIAS));
+    uint32x4_t q = vcvtq_u32_f32(vmulq_f32(v, vdupq_n_f32(0.001f)));
+    return vaddq_u32(q, vdupq_n_u32(CODE_LO));
+}
+
+static inline uint32x4_t neon_us_to_code_u32(uint32x4_t us)
+{
+    return neon_us_to_code_f32(vcvtq_f32_u32(us));
+}
+
+#define NEON_MAP16(x, fn) \
+    vcombine_u16(vmovn_u32(fn(vmovl_u16(vget_low_u16(x)))), vmovn_u32(fn(vmovl_u16(vget_high_u16(x)))))
+
+static inline void neon_store_groups(uint64x2_t q01, uint64x2_t q23, uint8_t* payload)
+{
+    uint64_t q[4];
+    vst1q_u64(&q[0], q01);
+    vst1q_u64(&q[2], q23);
+    store_groups(q, payload);
+}
+
+static void neon_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS])
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    vst1q_u16(codes, neon_split(q[0], q[1]));
+    vst1q_u16(codes + 8, neon_split(q[2], q[3]));
+}
+
+static void neon_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    neon_store_groups(neon_join(vld1q_u16(codes)), neon_join(vld1q_u16(codes + 8)), payload);
+}
+
+static inline void neon_decode(const uint8_t* payload, uint16_t us[CRSF_NUM_CHANNELS])
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    vst1q_u16(us, NEON_MAP16(neon_split(q[0], q[1]), neon_code_to_us_u32));
+    vst1q_u16(us + 8, NEON_MAP16(neon_split(q[2], q[3]), neon_code_to_us_u32));
+}
+
+static inline void neon_encode(const uint16_t us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    uint16x8_t c0 = NEON_MAP16(vld1q_u16(us), neon_us_to_code_u32);
+    uint16x8_t c1 = NEON_MAP16(vld1q_u16(us + 8), neon_us_to_code_u32);
+    neon_store_groups(neon_join(c0), neon_join(c1), payload);
+}
+
+static void neon_decode_int(const uint8_t* payload, int us[CRSF_NUM_CHANNELS])
+{
+    uint64_t q[4];
+    load_groups(payload, q);
+    uint16x8_t c[2] = { neon_split(q[0], q[1]), neon_split(q[2], q[3]) };
+    for (int h = 0; h < 2; ++h) {
+        vst1q_s32(us + 8 * h, vreinterpretq_s32_u32(neon_code_to_us_u32(vmovl_u16(vget_low_u16(c[h])))));
+        vst1q_s32(us + 8 * h + 4, vreinterpretq_s32_u32(neon_code_to_us_u32(vmovl_u16(vget_high_u16(c[h])))));
+    }
+}
+
+static void neon_encode_int(const int us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    uint16x4_t c[4];
+    for (int i = 0; i < 4; ++i) {
+        c[i] = vmovn_u32(neon_us_to_code_f32(vcvtq_f32_s32(vld1q_s32(us + 4 * i))));
+    }
+    neon_store_groups(neon_join(vcombine_u16(c[0], c[1])), neon_join(vcombine_u16(c[2], c[3])), payload);
+}
+
+CHANNEL_CODEC_BATCH(neon, )
+
+#endif // CHANNEL_CODEC_HAVE_NEON
+
+// ===== Выбор реализации =====
+
+struct ChannelKernels {
+    ChannelCodecImpl impl;
+    void (*unpack)(const uint8_t*, uint16_t*);
+    void (*pack)(const uint16_t*, uint8_t*);
+    void (*decode)(const uint8_t*, uint16_t*);
+    void (*encode)(const uint16_t*, uint8_t*);
+    void (*decodeInt)(const uint8_t*, int*);
+    void (*encodeInt)(const int*, uint8_t*);
+    void (*decodeBatch)(const uint8_t*, size_t, size_t, uint16_t*);
+    void (*encodeBatch)(const uint16_t*, size_t, uint8_t*, size_t);
+};
+
+#define CHANNEL_KERNELS(impl, prefix) \
+    { impl, prefix##_unpack, prefix##_pack, prefix##_decode, prefix##_encode, \
+      prefix##_decode_int, prefix##_encode_int, \
+      prefix##_decode_batch, prefix##_encode_batch }
+
+static const ChannelKernels scalarKernels = CHANNEL_KERNELS(CHANNEL_CODEC_SCALAR, scalar);
+#if defined(CHANNEL_CODEC_HAVE_X86)
+static const ChannelKernels sse2Kernels = CHANNEL_KERNELS(CHANNEL_CODEC_SSE2, sse2);
+static const ChannelKernels avx2Kernels = CHANNEL_KERNELS(CHANNEL_CODEC_AVX2, avx2);
+#endif
+#if defined(CHANNEL_CODEC_HAVE_NEON)
+static const ChannelKernels neonKernels = CHANNEL_KERNELS(CHANNEL_CODEC_NEON, neon);
+#endif
+
+static const ChannelKernels* kernelsFor(ChannelCodecImpl impl)
+{
+    switch (impl) {
+    case CHANNEL_CODEC_SCALAR:
+        return &scalarKernels;
+#if defined(CHANNEL_CODEC_HAVE_X86)
+    case CHANNEL_CODEC_SSE2:
+        return &sse2Kernels;
+    case CHANNEL_CODEC_AVX2:
+        return __builtin_cpu_supports("avx2") ? &avx2Kernels : nullptr;
+#endif
+#if defined(CHANNEL_CODEC_HAVE_NEON)
+    case CHANNEL_CODEC_NEON:
+        return &neonKernels;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+static std::atomic<const ChannelKernels*> activeKernels{nullptr};
+
+static const ChannelKernels* kernels()
+{
+    const ChannelKernels* k = activeKernels.load(std::memory_order_acquire);
+    if (k == nullptr) {
+        const ChannelCodecImpl preferred[] = {CHANNEL_CODEC_AVX2, CHANNEL_CODEC_NEON, CHANNEL_CODEC_SSE2};
+        k = &scalarKernels;
+        for (ChannelCodecImpl impl : preferred) {
+            if (const ChannelKernels* candidate = kernelsFor(impl)) {
+                k = candidate;
+                break;
+            }
+        }
+        activeKernels.store(k, std::memory_order_release);
+    }
+    return k;
+}
+
+bool channel_codec_set_impl(ChannelCodecImpl impl)
+{
+    const ChannelKernels* k = kernelsFor(impl);
+    if (k == nullptr) return false;
+    activeKernels.store(k, std::memory_order_release);
+    return true;
+}
+
+ChannelCodecImpl channel_codec_get_impl()
+{
+    return kernels()->impl;
+}
+
+bool channel_codec_is_supported(ChannelCodecImpl impl)
+{
+    return kernelsFor(impl) != nullptr;
+}
+
+const char* channel_codec_impl_name(ChannelCodecImpl impl)
+{
+    switch (impl) {
+    case CHANNEL_CODEC_SCALAR:
+        return "scalar";
+    case CHANNEL_CODEC_SSE2:
+        return "sse2";
+    case CHANNEL_CODEC_AVX2:
+        return "avx2";
+    case CHANNEL_CODEC_NEON:
+        return "neon";
+    }
+    return "unknown";
+}
+
+// ===== Публичный интерфейс =====
+
+void crsf_channels_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS])
+{
+    kernels()->unpack(payload, codes);
+}
+
+void crsf_channels_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    kernels()->pack(codes, payload);
+}
+
+void crsf_channels_decode(const uint8_t* payload, int us[CRSF_NUM_CHANNELS])
+{
+    kernels()->decodeInt(payload, us);
+}
+
+void crsf_channels_encode(const int us[CRSF_NUM_CHANNELS], uint8_t* payload)
+{
+    kernels()->encodeInt(us, payload);
+}
+
+void crsf_channels_decode_batch(const uint8_t* payloads, size_t stride, size_t count, uint16_t* us)
+{
+    kernels()->decodeBatch(payloads, stride, count, us);
+}
+
+void crsf_channels_encode_batch(const uint16_t* us, size_t count, uint8_t* payloads, size_t stride)
+{
+    kernels()->encodeBatch(us, count, payloads, stride);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Кодек кадра RC_CHANNELS_PACKED: 16 каналов по 11 бит (22 байта, младший бит первым)
+// и преобразование кодов CRSF в микросекунды 1000..2000 и обратно.
+// Реализации: скалярная (64-битные слова), SSE2, AVX2 (x86-64) и NEON (ARM);
+// все дают побитово одинаковый результат, самая быстрая выбирается во время выполнения.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crsf_protocol.h"
+
+#define CRSF_CHANNELS_PAYLOAD_SIZE 22 // 16 * 11 бит
+
+enum ChannelCodecImpl {
+    CHANNEL_CODEC_SCALAR = 0,
+    CHANNEL_CODEC_SSE2 = 1,
+    CHANNEL_CODEC_AVX2 = 2,
+    CHANNEL_CODEC_NEON = 3,
+};
+
+// Преобразование одного значения (с ограничением диапазона) — загрузка из таблиц channel_tables.h
+int crsf_code_to_us(int code);
+int crsf_us_to_code(int us);
+
+// Распаковка/упаковка 11-битных кодов без преобразования (лишние старшие биты кода отбрасываются)
+void crsf_channels_unpack(const uint8_t* payload, uint16_t codes[CRSF_NUM_CHANNELS]);
+void crsf_channels_pack(const uint16_t codes[CRSF_NUM_CHANNELS], uint8_t* payload);
+
+// Кадр целиком: payload → мкс и мкс → payload (значения вне 1000..2000 ограничиваются)
+void crsf_channels_decode(const uint8_t* payload, int us[CRSF_NUM_CHANNELS]);
+void crsf_channels_encode(const int us[CRSF_NUM_CHANNELS], uint8_t* payload);
+
+// Пакетная обработка логов: count кадров, payload расположены с шагом stride байт,
+// значения в мкс идут подряд, по CRSF_NUM_CHANNELS на кадр
+void crsf_channels_decode_batch(const uint8_t* payloads, size_t stride, size_t count, uint16_t* us);
+void crsf_channels_encode_batch(const uint16_t* us, size_t count, uint8_t* payloads, size_t stride);
+
+// Выбор реализации (для тестов и бенчмарков). false, если не поддерживается процессором
+bool channel_codec_set_impl(ChannelCodecImpl impl);
+ChannelCodecImpl channel_codec_get_impl();
+bool channel_codec_is_supported(ChannelCodecImpl impl);
+const char* channel_codec_impl_name(ChannelCodecImpl impl);
@@ -0,0 +1,98 @@
+#pragma once
+
+// Таблицы преобразования код CRSF ↔ мкс, построенные при компиляции.
+// Код → мкс индексируется любым 11-битным кодом (0..2047), ограничение диапазона уже учтено в таблице;
+// мкс → код — значениями 1000..2000. Преобразование становится одной загрузкой без делений и ветвлений.
+
+#include <array>
+#include <stdint.h>
+#include "crsf_protocol.h"
+
+#define CRSF_CODE_TABLE_SIZE 2048 // все 11-битные коды
+#define CRSF_US_MIN 1000
+#define CRSF_US_MAX 2000
+
+// Формулы, по которым строятся таблицы (исходный алгоритм packetChannelsPacked/packetChannelsSend)
+constexpr int crsf_code_to_us_calc(int code)
+{
+    const int delta = CRSF_CHANNEL_VALUE_2000 - CRSF_CHANNEL_VALUE_1000;
+    if (code < CRSF_CHANNEL_VALUE_1000) code = CRSF_CHANNEL_VALUE_1000;
+    if (code > CRSF_CHANNEL_VALUE_2000) code = CRSF_CHANNEL_VALUE_2000;
+    return CRSF_US_MIN + ((code - CRSF_CHANNEL_VALUE_1000) * 1000 + delta / 2) / delta; // округление к ближайшему
+}
+
+constexpr int crsf_us_to_code_calc(int us)
+{
+    const int delta = CRSF_CHANNEL_VALUE_2000 - CRSF_CHANNEL_VALUE_1000;
+    if (us < CRSF_US_MIN) us = CRSF_US_MIN;
+    if (us > CRSF_US_MAX) us = CRSF_US_MAX;
+
+    // Первичное кодирование (округление к ближайшему)
+    int code = CRSF_CHANNEL_VALUE_1000 + ((us - CRSF_US_MIN) * delta + 500) / 1000;
+    if (code > CRSF_CHANNEL_VALUE_2000) code = CRSF_CHANNEL_VALUE_2000;
+    if (code < CRSF_CHANNEL_VALUE_1000) code = CRSF_CHANNEL_VALUE_1000;
+
+    // Проверка: декодирование должно дать ровно us, иначе подправляем код на ±1
+    int decodedUs = crsf_code_to_us_calc(code);
+    if (decodedUs < us && code < CRSF_CHANNEL_VALUE_2000) {
+        if (crsf_code_to_us_calc(code + 1) == us) code = code + 1;
+    } else if (decodedUs > us && code > CRSF_CHANNEL_VALUE_1000) {
+        if (crsf_code_to_us_calc(code - 1) == us) code = code - 1;
+    }
+    return code;
+}
+
+constexpr std::array<uint16_t, CRSF_CODE_TABLE_SIZE> crsf_make_code_to_us_table()
+{
+    std::array<uint16_t, CRSF_CODE_TABLE_SIZE> table{};
+    for (int code = 0; code < CRSF_CODE_TABLE_SIZE; ++code) {
+        table[code] = static_cast<uint16_t>(crsf_code_to_us_calc(code));
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, CRSF_US_MAX - CRSF_US_MIN + 1> crsf_make_us_to_code_table()
+{
+    std::array<uint16_t, CRSF_US_MAX - CRSF_US_MIN + 1> table{};
+    for (int us = CRSF_US_MIN; us <= CRSF_US_MAX; ++us) {
+        table[us - CRSF_US_MIN] = static_cast<uint16_t>(crsf_us_to_code_calc(us));
+    }
+    return table;
+}
+
+inline constexpr std::array<uint16_t, CRSF_CODE_TABLE_SIZE> CRSF_CODE_TO_US = crsf_make_code_to_us_table();
+inline constexpr std::array<uint16_t, CRSF_US_MAX - CRSF_US_MIN + 1> CRSF_US_TO_CODE = crsf_make_us_to_code_table();
+
+// Каждое значение 1000..2000 мкс переживает кодирование и декодирование без изменений,
+// а коды не выходят за диапазон CRSF_CHANNEL_VALUE_MIN..CRSF_CHANNEL_VALUE_MAX (172..1811)
+constexpr bool crsf_tables_round_trip_exact()
+{
+    for (int us = CRSF_US_MIN; us <= CRSF_US_MAX; ++us) {
+        int code = CRSF_US_TO_CODE[us - CRSF_US_MIN];
+        if (code < CRSF_CHANNEL_VALUE_MIN || code > CRSF_CHANNEL_VALUE_MAX) return false;
+        if (CRSF_CODE_TO_US[code] != us) return false;
+    }
+    for (int code = CRSF_CHANNEL_VALUE_MIN; code <= CRSF_CHANNEL_VALUE_MAX; ++code) {
+        int us = CRSF_CODE_TO_US[code];
+        if (us < CRSF_US_MIN || us > CRSF_US_MAX) return false;
+        if (CRSF_CODE_TO_US[CRSF_US_TO_CODE[us - CRSF_US_MIN]] != us) return false;
+    }
+    return true;
+}
+
+static_assert(crsf_tables_round_trip_exact(), "CRSF code <-> us tables must round-trip exactly");
+
+// Одна загрузка; ограничение входа сводится к min/max (cmov, без ветвлений)
+inline int crsf_code_to_us_lut(int code)
+{
+    code = code < 0 ? 0 : code;
+    code = code > CRSF_CODE_TABLE_SIZE - 1 ? CRSF_CODE_TABLE_SIZE - 1 : code;
+    return CRSF_CODE_TO_US[code];
+}
+
+inline int crsf_us_to_code_lut(int us)
+{
+    us = us < CRSF_US_MIN ? CRSF_US_MIN : us;
+    us = us > CRSF_US_MAX ? CRSF_US_MAX : us;
+    return CRSF_US_TO_CODE[us - CRSF_US_MIN];
+}
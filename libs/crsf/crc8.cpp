@@ -1,5 +1,28 @@
 #include "crc8.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC8_CLMUL_X86 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC8_CLMUL_ARM 1
+#endif
+
+// x^n mod P, где P = x^8 + poly
+static uint64_t xpow_mod(unsigned int n, uint8_t poly)
+{
+    uint16_t r = 1;
+    while (n--)
+    {
+        r <<= 1;
+        if (r & 0x100)
+            r ^= 0x100 | poly;
+    }
+    return r;
+}
+
 Crc8::Crc8(uint8_t poly)
 {
     init(poly);
@@ -16,14 +39,231 @@ void Crc8::init(uint8_t poly)
         }
         _lut[idx] = crc & 0xff;
     }
+
+    // Таблицы slicing-by-8: каждый следующий нулевой байт — ещё один проход по _lut
+    for (int idx=0; idx<256; ++idx)
+    {
+        uint8_t crc = _lut[idx];
+        for (int k=0; k<7; ++k)
+        {
+            crc = _lut[crc];
+            _slice[k][idx] = crc;
+        }
+    }
+
+    // Константы свёртки: блок A, за которым идут ещё n бит, даёт A * x^n,
+    // а A = H*x^64 + L сворачивается в H*(x^(n+64) mod P) + L*(x^n mod P)
+    _fold128 = xpow_mod(128, poly);
+    _fold192 = xpow_mod(192, poly);
+    _fold512 = xpow_mod(512, poly);
+    _fold576 = xpow_mod(576, poly);
+
+    _impl = isSupported(IMPL_CLMUL) ? IMPL_CLMUL : IMPL_SLICE8;
 }
 
 uint8_t Crc8::calc(uint8_t *data, uint8_t len)
 {
-    uint8_t crc = 0;
+    return update(0, data, len);
+}
+
+uint8_t Crc8::update(uint8_t crc, const uint8_t *data, size_t len) const
+{
+    switch (_impl)
+    {
+    case IMPL_TABLE:
+        return updateTable(crc, data, len);
+    case IMPL_CLMUL:
+        return updateClmul(crc, data, len);
+    default:
+        return updateSlice8(crc, data, len);
+    }
+}
+
+bool Crc8::setImpl(Impl impl)
+{
+    if (!isSupported(impl))
+        return false;
+    _impl = impl;
+    return true;
+}
+
+bool Crc8::isSupported(Impl impl)
+{
+    if (impl != IMPL_CLMUL)
+        return true;
+#if defined(CRC8_CLMUL_X86)
+    static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    return supported;
+#elif defined(CRC8_CLMUL_ARM)
+    static const bool supported = (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+    return supported;
+#else
+    return false;
+#endif
+}
+
+const char *Crc8::implName(Impl impl)
+{
+    switch (impl)
+    {
+    case IMPL_TABLE:
+        return "table";
+    case IMPL_SLICE8:
+        return "slice8";
+    case IMPL_CLMUL:
+        return "clmul";
+    }
+    return "unknown";
+}
+
+uint8_t Crc8::updateTable(uint8_t crc, const uint8_t *data, size_t len) const
+{
     while (len--)
     {
         crc = _lut[crc ^ *data++];
     }
     return crc;
 }
+
+uint8_t Crc8::updateSlice8(uint8_t crc, const uint8_t *data, size_t len) const
+{
+    while (len >= 8)
+    {
+        crc = _slice[6][crc ^ data[0]] ^ _slice[5][data[1]] ^
+              _slice[4][data[2]] ^ _slice[3][data[3]] ^
+              _slice[2][data[4]] ^ _slice[1][data[5]] ^
+              _slice[0][data[6]] ^ _lut[data[7]];
+        data += 8;
+        len -= 8;
+    }
+    return updateTable(crc, data, len);
+}
+
+#if defined(CRC8_CLMUL_X86)
+
+// 16 байт из памяти в 128-битный многочлен: первый байт — старшие коэффициенты
+#define CRC8_LOAD_BE(p) _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), bswap)
+#define CRC8_FOLD(x, k) _mm_xor_si128(_mm_clmulepi64_si128((x), (k), 0x11), _mm_clmulepi64_si128((x), (k), 0x00))
+
+__attribute__((target("pclmul,ssse3")))
+uint8_t Crc8::updateClmul(uint8_t crc, const uint8_t *data, size_t len) const
+{
+    // Кадры CRSF короче 64 байт: свёртка не окупается
+    if (len < 64)
+        return updateSlice8(crc, data, len);
+
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k4 = _mm_set_epi64x(static_cast<long long>(_fold576), static_cast<long long>(_fold512));
+    const __m128i k1 = _mm_set_epi64x(static_cast<long long>(_fold192), static_cast<long long>(_fold128));
+
+    // Четыре независимых аккумулятора скрывают задержку умножения
+    __m128i x0 = CRC8_LOAD_BE(data);
+    __m128i x1 = CRC8_LOAD_BE(data + 16);
+    __m128i x2 = CRC8_LOAD_BE(data + 32);
+    __m128i x3 = CRC8_LOAD_BE(data + 48);
+    // Начальное состояние эквивалентно XOR с первым байтом данных
+    x0 = _mm_xor_si128(x0, _mm_set_epi64x(static_cast<long long>(static_cast<uint64_t>(crc) << 56), 0));
+    data += 64;
+    len -= 64;
+
+    while (len >= 64)
+    {
+        x0 = _mm_xor_si128(CRC8_FOLD(x0, k4), CRC8_LOAD_BE(data));
+        x1 = _mm_xor_si128(CRC8_FOLD(x1, k4), CRC8_LOAD_BE(data + 16));
+        x2 = _mm_xor_si128(CRC8_FOLD(x2, k4), CRC8_LOAD_BE(data + 32));
+        x3 = _mm_xor_si128(CRC8_FOLD(x3, k4), CRC8_LOAD_BE(data + 48));
+        data += 64;
+        len -= 64;
+    }
+
+    __m128i x = _mm_xor_si128(CRC8_FOLD(x0, k1), x1);
+    x = _mm_xor_si128(CRC8_FOLD(x, k1), x2);
+    x = _mm_xor_si128(CRC8_FOLD(x, k1), x3);
+    while (len >= 16)
+    {
+        x = _mm_xor_si128(CRC8_FOLD(x, k1), CRC8_LOAD_BE(data));
+        data += 16;
+        len -= 16;
+    }
+
+    // Остаток свёртки сравним с данными по модулю P: досчитываем его и хвост таблицами
+    uint8_t folded[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(folded), _mm_shuffle_epi8(x, bswap));
+    crc = updateSlice8(0, folded, sizeof(folded));
+    return updateSlice8(crc, data, len);
+}
+
+#undef CRC8_LOAD_BE
+#undef CRC8_FOLD
+
+#elif defined(CRC8_CLMUL_ARM)
+
+// 16 байт из памяти в 128-битный многочлен: первый байт — старшие коэффициенты
+__attribute__((target("+crypto")))
+static inline uint64x2_t crc8_load_be(const uint8_t *p)
+{
+    uint8x16_t v = vrev64q_u8(vld1q_u8(p));
+    return vreinterpretq_u64_u8(vextq_u8(v, v, 8));
+}
+
+__attribute__((target("+crypto")))
+static inline uint64x2_t crc8_fold(uint64x2_t x, uint64_t kHi, uint64_t kLo)
+{
+    poly128_t h = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(x, 1)), static_cast<poly64_t>(kHi));
+    poly128_t l = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(x, 0)), static_cast<poly64_t>(kLo));
+    return veorq_u64(vreinterpretq_u64_p128(h), vreinterpretq_u64_p128(l));
+}
+
+__attribute__((target("+crypto")))
+uint8_t Crc8::updateClmul(uint8_t crc, const uint8_t *data, size_t len) const
+{
+    // Кадры CRSF короче 64 байт: свёртка не окупается
+    if (len < 64)
+        return updateSlice8(crc, data, len);
+
+    // Четыре независимых аккумулятора скрывают задержку умножения
+    uint64x2_t x0 = crc8_load_be(data);
+    uint64x2_t x1 = crc8_load_be(data + 16);
+    uint64x2_t x2 = crc8_load_be(data + 32);
+    uint64x2_t x3 = crc8_load_be(data + 48);
+    // Начальное состояние эквивалентно XOR с первым байтом данных
+    x0 = veorq_u64(x0, vcombine_u64(vcreate_u64(0), vcreate_u64(static_cast<uint64_t>(crc) << 56)));
+    data += 64;
+    len -= 64;
+
+    while (len >= 64)
+    {
+        x0 = veorq_u64(crc8_fold(x0, _fold576, _fold512), crc8_load_be(data));
+        x1 = veorq_u64(crc8_fold(x1, _fold576, _fold512), crc8_load_be(data + 16));
+        x2 = veorq_u64(crc8_fold(x2, _fold576, _fold512), crc8_load_be(data + 32));
+        x3 = veorq_u64(crc8_fold(x3, _fold576, _fold512), crc8_load_be(data + 48));
+        data += 64;
+        len -= 64;
+    }
+
+    uint64x2_t x = veorq_u64(crc8_fold(x0, _fold192, _fold128), x1);
+    x = veorq_u64(crc8_fold(x, _fold192, _fold128), x2);
+    x = veorq_u64(crc8_fold(x, _fold192, _fold128), x3);
+    while (len >= 16)
+    {
+        x = veorq_u64(crc8_fold(x, _fold192, _fold128), crc8_load_be(data));
+        data += 16;
+        len -= 16;
+    }
+
+    // Остаток свёртки сравним с данными по модулю P: досчитываем его и хвост таблицами
+    uint8_t folded[16];
+    uint8x16_t v = vrev64q_u8(vreinterpretq_u8_u64(x));
+    vst1q_u8(folded, vextq_u8(v, v, 8));
+    crc = updateSlice8(0, folded, sizeof(folded));
+    return updateSlice8(crc, data, len);
+}
+
+#else
+
+uint8_t Crc8::updateClmul(uint8_t crc, const uint8_t *data, size_t len) const
+{
+    return updateSlice8(crc, data, len);
+}
+
+#endif
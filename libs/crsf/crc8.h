@@ -1,14 +1,44 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
+// CRC8 (MSB-first, начальное значение 0, без финального XOR).
+// Короткие кадры считаются таблицами slicing-by-8, длинные буферы (запись/воспроизведение логов) —
+// свёрткой через беззнаковое умножение (PCLMULQDQ на x86-64, PMULL на AArch64),
+// если процессор её поддерживает. Все реализации дают побитово одинаковый результат
 class Crc8
 {
 public:
+    enum Impl
+    {
+        IMPL_TABLE = 0,  // побайтовая таблица 256 записей (исходный алгоритм)
+        IMPL_SLICE8 = 1, // slicing-by-8
+        IMPL_CLMUL = 2,  // PCLMULQDQ / PMULL + slicing-by-8 для хвоста
+    };
+
     Crc8(uint8_t poly);
     uint8_t calc(uint8_t *data, uint8_t len);
+    // Продолжить расчёт с состояния crc (0 — новый расчёт) для буфера произвольной длины
+    uint8_t update(uint8_t crc, const uint8_t *data, size_t len) const;
+
+    // Выбор реализации (по умолчанию — самая быстрая доступная). false, если не поддерживается процессором
+    bool setImpl(Impl impl);
+    Impl impl() const { return _impl; }
+    static bool isSupported(Impl impl);
+    static const char *implName(Impl impl);
 
 protected:
     uint8_t _lut[256];
+    uint8_t _slice[7][256]; // _slice[k][x] — CRC байта x, за которым следуют k+1 нулевых байт
+    uint64_t _fold128;      // x^128 mod P
+    uint64_t _fold192;      // x^192 mod P
+    uint64_t _fold512;      // x^512 mod P
+    uint64_t _fold576;      // x^576 mod P
+    Impl _impl;
     void init(uint8_t poly);
+
+    uint8_t updateTable(uint8_t crc, const uint8_t *data, size_t len) const;
+    uint8_t updateSlice8(uint8_t crc, const uint8_t *data, size_t len) const;
+    uint8_t updateClmul(uint8_t crc, const uint8_t *data, size_t len) const;
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+// Разбор данных кадров телеметрии CRSF в значения. Общий для CrsfSerial (разбор на лету)
+// и пакетного декодера записей (libs/crsf/capture_decode): одни и те же коэффициенты и порядок полей.
+// data — первый байт данных кадра (после типа); длину проверяет вызывающий.
+
+#include <cstdint>
+
+#include "crsf_protocol.h"
+
+struct CrsfAttitude {
+    int16_t rawPitch;  // байты 0-1
+    int16_t rawRoll;   // байты 2-3 (поменяны местами с pitch)
+    int16_t rawYaw;    // байты 4-5
+    double roll;       // градусы
+    double pitch;
+    double yaw;        // 0..360
+};
+
+struct CrsfBattery {
+    double voltage;    // В
+    double current;    // мА
+    double capacity;   // мАч
+    uint8_t remaining; // %
+};
+
+inline int16_t crsf_be16(const uint8_t* p)
+{
+    return static_cast<int16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
+}
+
+inline int32_t crsf_be32(const uint8_t* p)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                                (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]));
+}
+
+// GPS (CRSF_FRAME_GPS_PAYLOAD_SIZE байт): поля в порядке хоста
+inline void crsf_decode_gps(const uint8_t* data, crsf_sensor_gps_t& out)
+{
+    out.latitude = crsf_be32(&data[0]);
+    out.longitude = crsf_be32(&data[4]);
+    out.groundspeed = static_cast<uint16_t>(crsf_be16(&data[8]));
+    out.heading = static_cast<uint16_t>(crsf_be16(&data[10]));
+    out.altitude = static_cast<uint16_t>(crsf_be16(&data[12]));
+    out.satellites = data[14];
+}
+
+// ATTITUDE (CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE байт)
+inline void crsf_decode_attitude(const uint8_t* data, CrsfAttitude& out)
+{
+    // ВНИМАНИЕ: коэффициенты получены экспериментально и могут различаться в зависимости от прошивки
+    // полётного контроллера (Betaflight/iNAV). Стандартная спецификация CRSF: градусы × 100, но данные не соответствуют.
+    out.rawPitch = crsf_be16(&data[0]);
+    out.rawRoll = crsf_be16(&data[2]);
+    out.rawYaw = crsf_be16(&data[4]);
+    out.roll = out.rawRoll / 175.0;
+    out.pitch = out.rawPitch / 175.0;
+
+    // Yaw нормализуется к 0..360°
+    double yaw = out.rawYaw / 175.0;
+    while (yaw < 0) yaw += 360.0;
+    while (yaw >= 360.0) yaw -= 360.0;
+    out.yaw = yaw;
+}
+
+// BATTERY_SENSOR (CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE байт)
+inline void crsf_decode_battery(const uint8_t* data, CrsfBattery& out)
+{
+    out.voltage = static_cast<uint16_t>(crsf_be16(&data[0])) / 100.0;
+    out.current = static_cast<uint16_t>(crsf_be16(&data[2]));
+    out.capacity = (static_cast<uint32_t>(data[4]) << 16) | (static_cast<uint32_t>(data[5]) << 8) | data[6];
+    out.remaining = data[7];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// Счётчики протокола одного линка CrsfSerial (снимок; сами счётчики в CrsfSerial атомарные).
+// Публикуются в разделяемой телеметрии (SharedTelemetryData::link) и в JSON/бинарном кадре.
+
+#include <cstdint>
+
+#include "crsf_protocol.h"
+
+// Группы типов принятых кадров
+enum CrsfLinkFrameKind {
+    CRSF_LINK_FRAME_CHANNELS,
+    CRSF_LINK_FRAME_LINK_STATISTICS,
+    CRSF_LINK_FRAME_GPS,
+    CRSF_LINK_FRAME_BATTERY,
+    CRSF_LINK_FRAME_ATTITUDE,
+    CRSF_LINK_FRAME_FLIGHT_MODE,
+    CRSF_LINK_FRAME_OTHER,
+    CRSF_LINK_FRAME_KINDS
+};
+
+struct CrsfLinkCounters {
+    uint32_t rxFrames;                                // кадров с верным CRC
+    uint32_t rxFramesByKind[CRSF_LINK_FRAME_KINDS];   // они же по типам
+    uint32_t rxCrcErrors;                             // кадров с неверным CRC (отброшены целиком)
+    uint32_t rxLengthRejects;                         // потерь синхронизации: недопустимый байт длины
+    uint32_t rxResyncBytes;                           // байт, пропущенных при ресинхронизации
+    uint32_t rxBufferResets;                          // сбросов недоразобранных данных по таймауту
+    uint32_t txFrames;                                // кадров, переданных в порт (и неполностью)
+    uint32_t txDropped;                               // кадров, не отправленных при неактивном линке
+    uint32_t txShortWrites;                           // записей, вернувших меньше длины кадра (и ошибок)
+    uint64_t txBytes;                                 // байт, записанных в порт
+};
+
+inline CrsfLinkFrameKind crsf_link_frame_kind(uint8_t type)
+{
+    switch (type) {
+    case CRSF_FRAMETYPE_RC_CHANNELS_PACKED: return CRSF_LINK_FRAME_CHANNELS;
+    case CRSF_FRAMETYPE_LINK_STATISTICS: return CRSF_LINK_FRAME_LINK_STATISTICS;
+    case CRSF_FRAMETYPE_GPS: return CRSF_LINK_FRAME_GPS;
+    case CRSF_FRAMETYPE_BATTERY_SENSOR: return CRSF_LINK_FRAME_BATTERY;
+    case CRSF_FRAMETYPE_ATTITUDE: return CRSF_LINK_FRAME_ATTITUDE;
+    case CRSF_FRAMETYPE_FLIGHT_MODE: return CRSF_LINK_FRAME_FLIGHT_MODE;
+    default: return CRSF_LINK_FRAME_OTHER;
+    }
+}
+
+// Имя группы для JSON ("channels", "linkStatistics", ...)
+inline const char* crsf_link_frame_kind_name(unsigned int kind)
+{
+    static const char* const NAMES[CRSF_LINK_FRAME_KINDS] = {
+        "channels", "linkStatistics", "gps", "battery", "attitude", "flightMode", "other",
+    };
+    return kind < CRSF_LINK_FRAME_KINDS ? NAMES[kind] : "unknown";
+}
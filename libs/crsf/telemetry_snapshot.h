@@ -0,0 +1,84 @@
+#pragma once
+
+// Согласованный снимок телеметрии CrsfSerial и тройной буфер для его публикации.
+// Поток приёма после каждого кадра телеметрии копирует состояние в свой слот и меняет его
+// местами со средним одним атомарным exchange (wait-free); читатель забирает последний
+// опубликованный слот тем же способом и никогда не видит поля из разных кадров.
+
+#include <atomic>
+#include <cstdint>
+#include "crsf_protocol.h"
+
+struct TelemetrySnapshot {
+    uint32_t sequence;      // номер публикации (0 — телеметрии ещё не было)
+    uint8_t lastFrameType;  // тип кадра, вызвавшего публикацию
+    bool linkUp;            // на момент вызова snapshot()
+    uint32_t lastReceive;   // rpi_millis() последнего приёма байт
+
+    // Текущие значения каналов (мкс) на момент вызова snapshot(), как getChannels()
+    int channels[CRSF_NUM_CHANNELS];
+
+    crsfLinkStatistics_t linkStatistics;
+    crsf_sensor_gps_t gps;
+
+    double batteryVoltage;
+    double batteryCurrent;
+    double batteryCapacity;
+    uint8_t batteryRemaining;
+
+    double attitudeRoll;
+    double attitudePitch;
+    double attitudeYaw;
+    int16_t rawAttitudeRoll;
+    int16_t rawAttitudePitch;
+    int16_t rawAttitudeYaw;
+
+    // Время приёма последнего кадра каждого типа (rpi_monotonic_ns(); 0 — кадр ещё не приходил)
+    uint64_t channelsTimeNs;
+    uint64_t linkStatisticsTimeNs;
+    uint64_t gpsTimeNs;
+    uint64_t batteryTimeNs;
+    uint64_t attitudeTimeNs;
+};
+
+// Тройной буфер: один писатель, один читатель (несколько читателей упорядочиваются снаружи).
+// Писатель и читатель владеют каждый своим слотом, третий — обменный;
+// бит DIRTY в обменном индексе означает, что в нём лежит ещё не прочитанная публикация
+template <typename T>
+class TripleBuffer {
+public:
+    // Слот писателя: заполняется целиком перед publish()
+    T& back() { return _slots[_back].value; }
+
+    // Публикация заполненного слота (только писатель)
+    void publish()
+    {
+        _back = _middle.exchange(static_cast<uint8_t>(_back | DIRTY), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Забрать последнюю публикацию, если она новее текущего слота читателя (только читатель)
+    bool update()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & DIRTY) == 0)
+            return false;
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Слот читателя: не меняется до следующего update()
+    const T& front() const { return _slots[_front].value; }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t DIRTY = 0x04;
+
+    // Каждый слот на своей кэш-линии: запись писателя не выталкивает данные читателя
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    Slot _slots[3];
+    std::atomic<uint8_t> _middle{1};
+    uint8_t _back = 0;   // только писатель
+    uint8_t _front = 2;  // только читатель
+};
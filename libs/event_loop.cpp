@@ -0,0 +1,105 @@
+#include "event_loop.h"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop() : _epfd(epoll_create1(EPOLL_CLOEXEC)), _running(false) {}
+
+EventLoop::~EventLoop()
+{
+    for (int tfd : _timers) {
+        ::close(tfd);
+    }
+    if (_epfd >= 0) {
+        ::close(_epfd);
+    }
+}
+
+bool EventLoop::add(int fd, Handler handler, Handler onHangup)
+{
+    if (_epfd < 0 || fd < 0) return false;
+
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    int op = _handlers.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(_epfd, op, fd, &ev) < 0) return false;
+
+    _handlers[fd] = Watch{std::move(handler), std::move(onHangup)};
+    return true;
+}
+
+void EventLoop::remove(int fd)
+{
+    if (_handlers.erase(fd) == 0) return;
+    epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, nullptr);
+    if (_timers.erase(fd)) {
+        ::close(fd);
+    }
+}
+
+int EventLoop::addTimer(uint32_t periodMs, Handler handler)
+{
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) return -1;
+
+    struct itimerspec spec{};
+    spec.it_interval.tv_sec = periodMs / 1000;
+    spec.it_interval.tv_nsec = static_cast<long>(periodMs % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(tfd, 0, &spec, nullptr) < 0) {
+        ::close(tfd);
+        return -1;
+    }
+
+    // Счётчик срабатываний нужно вычитать, иначе fd останется готовым
+    Handler wrapped = [tfd, handler = std::move(handler)]() {
+        uint64_t expirations = 0;
+        if (::read(tfd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            handler();
+        }
+    };
+    if (!add(tfd, std::move(wrapped))) {
+        ::close(tfd);
+        return -1;
+    }
+    _timers.insert(tfd);
+    return tfd;
+}
+
+void EventLoop::runOnce(int timeoutMs)
+{
+    if (_epfd < 0) return;
+
+    struct epoll_event events[16];
+    int n = epoll_wait(_epfd, events, 16, timeoutMs);
+    if (n < 0) {
+        return; // EINTR и прочие — просто следующая итерация
+    }
+    for (int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        // Предыдущий обработчик мог удалить fd во время этой итерации
+        auto it = _handlers.find(fd);
+        if (it == _handlers.end()) continue;
+        if (events[i].events & EPOLLIN) {
+            it->second.onReady(); // данные, пришедшие до отключения
+            it = _handlers.find(fd);
+            if (it == _handlers.end()) continue;
+        }
+        if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+            // Отключённый fd остаётся готовым (level-triggered): без снятия цикл крутился бы вхолостую
+            Handler onHangup = std::move(it->second.onHangup);
+            remove(fd);
+            if (onHangup) onHangup();
+        }
+    }
+}
+
+void EventLoop::run()
+{
+    _running = true;
+    while (_running) {
+        runOnce(-1);
+    }
+}
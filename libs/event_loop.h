@@ -0,0 +1,51 @@
+#pragma once
+
+// Простой реактор на epoll: процесс спит в epoll_wait(), пока не появится работа
+// (данные в UART, события джойстика, срабатывание таймера, новые команды)
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+class EventLoop {
+public:
+    using Handler = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool isOpen() const { return _epfd >= 0; }
+
+    // Подписаться на готовность fd к чтению (EPOLLIN). Повторный вызов заменяет обработчик.
+    // Обработчик не должен удалять собственный fd из цикла.
+    // При EPOLLHUP/EPOLLERR (устройство отключено) fd сразу снимается с epoll, иначе готовность
+    // сообщалась бы бесконечно, и вызывается onHangup — он закрывает fd через его владельца
+    // (без onHangup fd только снимается с epoll)
+    bool add(int fd, Handler handler, Handler onHangup = nullptr);
+    void remove(int fd);
+
+    // Периодический таймер на timerfd (CLOCK_MONOTONIC). Возвращает fd таймера или -1.
+    // Если тики были пропущены, обработчик вызывается один раз
+    int addTimer(uint32_t periodMs, Handler handler);
+
+    // Одна итерация ожидания: timeoutMs = -1 — ждать бесконечно
+    void runOnce(int timeoutMs = -1);
+    // Цикл до вызова stop()
+    void run();
+    void stop() { _running = false; }
+
+private:
+    struct Watch {
+        Handler onReady;
+        Handler onHangup;
+    };
+
+    int _epfd;
+    bool _running;
+    std::unordered_map<int, Watch> _handlers;
+    std::unordered_set<int> _timers; // fd таймеров, которые закрываем сами
+};
@@ -0,0 +1,324 @@
+#include "http_client.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+HttpKeepAliveClient::HttpKeepAliveClient(const std::string& host, int port, int timeoutMs)
+    : _host(host), _port(port), _timeoutMs(timeoutMs), _resolved(false)
+{
+    memset(&_addr, 0, sizeof(_addr));
+}
+
+void HttpKeepAliveClient::setTarget(const std::string& host, int port)
+{
+    closeAll();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _host = host;
+    _port = port;
+    _resolved = false;
+}
+
+void HttpKeepAliveClient::setTimeoutMs(int timeoutMs)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _timeoutMs = timeoutMs;
+}
+
+void HttpKeepAliveClient::closeAll()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int fd : _idle) {
+        ::close(fd);
+    }
+    _idle.clear();
+}
+
+// Вызывать под _mutex
+bool HttpKeepAliveClient::resolve(sockaddr_in& addr)
+{
+    if (!_resolved) {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* res = nullptr;
+        if (getaddrinfo(_host.c_str(), nullptr, &hints, &res) != 0 || res == nullptr) {
+            return false;
+        }
+        memcpy(&_addr, res->ai_addr, sizeof(_addr));
+        _addr.sin_port = htons(static_cast<uint16_t>(_port));
+        freeaddrinfo(res);
+        _resolved = true;
+    }
+    addr = _addr;
+    return true;
+}
+
+int HttpKeepAliveClient::openConnection()
+{
+    sockaddr_in addr;
+    int timeoutMs;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!resolve(addr)) {
+            return -1;
+        }
+        timeoutMs = _timeoutMs;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+    // SO_SNDTIMEO ограничивает и connect()
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    // Короткие запросы уходят сразу, без алгоритма Нейгла
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        // Адрес мог смениться (DHCP, перезапуск узла): в следующий раз разрешаем заново
+        std::lock_guard<std::mutex> lock(_mutex);
+        _resolved = false;
+        return -1;
+    }
+    _connects.fetch_add(1, std::memory_order_relaxed);
+    return fd;
+}
+
+int HttpKeepAliveClient::acquire(bool& reused)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_idle.empty()) {
+            int fd = _idle.back();
+            _idle.pop_back();
+            reused = true;
+            return fd;
+        }
+    }
+    reused = false;
+    return openConnection();
+}
+
+void HttpKeepAliveClient::release(int fd)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_idle.size() < MAX_IDLE_CONNECTIONS) {
+        _idle.push_back(fd);
+    } else {
+        ::close(fd);
+    }
+}
+
+HttpKeepAliveClient::Exchange HttpKeepAliveClient::exchange(int fd, const std::string& request, int& status, bool& keepAlive)
+{
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Сервер закрыл соединение, пока оно простаивало: ничего не обработано
+            return (sent == 0 && (errno == EPIPE || errno == ECONNRESET)) ? EXCHANGE_STALE : EXCHANGE_FAILED;
+        }
+        sent += static_cast<size_t>(n);
+    }
+
+    // Заголовки ответа
+    char buf[2048];
+    std::string resp;
+    size_t headerEnd = std::string::npos;
+    while (headerEnd == std::string::npos) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // Закрытие без единого байта ответа — признак устаревшего соединения
+            bool closed = (n == 0 || errno == ECONNRESET);
+            return (resp.empty() && closed) ? EXCHANGE_STALE : EXCHANGE_FAILED;
+        }
+        resp.append(buf, static_cast<size_t>(n));
+        headerEnd = resp.find("\r\n\r\n");
+    }
+
+    // Строка статуса: HTTP/1.x NNN
+    if (resp.compare(0, 5, "HTTP/") != 0) {
+        return EXCHANGE_FAILED;
+    }
+    size_t sp = resp.find(' ');
+    status = (sp != std::string::npos && sp < headerEnd) ? atoi(resp.c_str() + sp + 1) : 0;
+    keepAlive = resp.compare(5, 3, "1.1") == 0;
+
+    long contentLength = -1;
+    size_t lineStart = resp.find("\r\n") + 2;
+    while (lineStart < headerEnd) {
+        size_t lineEnd = resp.find("\r\n", lineStart);
+        const char* line = resp.c_str() + lineStart;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = strtol(line + 15, nullptr, 10);
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            std::string value = resp.substr(lineStart + 11, lineEnd - lineStart - 11);
+            if (strcasestr(value.c_str(), "close")) {
+                keepAlive = false;
+            } else if (strcasestr(value.c_str(), "keep-alive")) {
+                keepAlive = true;
+            }
+        }
+        lineStart = lineEnd + 2;
+    }
+
+    // Тело ответа вычитываем целиком, чтобы следующий ответ на этом соединении начинался с начала
+    size_t have = resp.size() - (headerEnd + 4);
+    if (contentLength < 0) {
+        // Без длины границу тела задаёт только закрытие соединения
+        keepAlive = false;
+        while (recv(fd, buf, sizeof(buf), 0) > 0) {
+        }
+        return EXCHANGE_OK;
+    }
+    if (have > static_cast<size_t>(contentLength)) {
+        // Лишние байты после ответа: состояние соединения непредсказуемо
+        keepAlive = false;
+    }
+    while (have < static_cast<size_t>(contentLength)) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return EXCHANGE_FAILED;
+        }
+        have += static_cast<size_t>(n);
+    }
+    return EXCHANGE_OK;
+}
+
+bool HttpKeepAliveClient::post(const std::string& path, const std::string& body, int* status, const char* contentType)
+{
+    uint64_t start = latency_now_ns();
+    _requests.fetch_add(1, std::memory_order_relaxed);
+
+    std::string request;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        request.reserve(160 + path.size() + _host.size() + body.size());
+        request += "POST ";
+        request += path;
+        request += " HTTP/1.1\r\nHost: ";
+        request += _host;
+        request += ':';
+        request += std::to_string(_port);
+    }
+    request += "\r\nContent-Type: ";
+    request += contentType;
+    request += "\r\nContent-Length: ";
+    request += std::to_string(body.size());
+    request += "\r\nConnection: keep-alive\r\n\r\n";
+    request += body;
+
+    int code = 0;
+    bool ok = false;
+    // Вторая попытка — только если переиспользованное соединение оказалось закрыто сервером
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        int fd = acquire(reused);
+        if (fd < 0) {
+            break;
+        }
+        bool keepAlive = false;
+        Exchange result = exchange(fd, request, code, keepAlive);
+        if (result == EXCHANGE_OK) {
+            if (keepAlive) {
+                release(fd);
+            } else {
+                ::close(fd);
+            }
+            ok = (code >= 200 && code < 300);
+            break;
+        }
+        ::close(fd);
+        if (result != EXCHANGE_STALE || !reused) {
+            break;
+        }
+        _retries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (status) {
+        *status = code;
+    }
+    if (ok) {
+        _latency.record(latency_now_ns() - start);
+    } else {
+        _failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ok;
+}
+
+std::string HttpKeepAliveClient::statsJson() const
+{
+    std::string target;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        target = _host + ":" + std::to_string(_port);
+    }
+    uint64_t n = _latency.count();
+    char stats[384];
+    snprintf(stats, sizeof(stats),
+             "\",\"requests\":%llu,\"failures\":%llu,\"connects\":%llu,\"retries\":%llu,"
+             "\"latency\":{\"count\":%llu,\"avgUs\":%.1f,\"maxUs\":%.1f,"
+             "\"p50Us\":%.1f,\"p90Us\":%.1f,\"p99Us\":%.1f,\"p999Us\":%.1f}}",
+             static_cast<unsigned long long>(requests()), static_cast<unsigned long long>(failures()),
+             static_cast<unsigned long long>(connects()), static_cast<unsigned long long>(retries()),
+             static_cast<unsigned long long>(n), n ? _latency.sumNs() / 1000.0 / n : 0.0,
+             _latency.maxNs() / 1000.0,
+             _latency.percentileNs(0.50) / 1000.0, _latency.percentileNs(0.90) / 1000.0,
+             _latency.percentileNs(0.99) / 1000.0, _latency.percentileNs(0.999) / 1000.0);
+    return "{\"target\":\"" + target + stats;
+}
+
+std::string HttpKeepAliveClient::prometheus(const char* prefix) const
+{
+    std::string labels;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        labels = "target=\"" + _host + ":" + std::to_string(_port) + "\"";
+    }
+    std::string metric = std::string(prefix) + "_latency_seconds";
+    std::string out;
+    char line[384];
+
+    out += "# HELP " + metric + " HTTP request latency (send to response)\n";
+    out += "# TYPE " + metric + " summary\n";
+    latency_prometheus_summary(out, metric.c_str(), labels.c_str(), _latency);
+    snprintf(line, sizeof(line), "# HELP %s_latency_max_seconds Largest observed HTTP request latency\n"
+             "# TYPE %s_latency_max_seconds gauge\n%s_latency_max_seconds{%s} %.9f\n",
+             prefix, prefix, prefix, labels.c_str(), _latency.maxNs() / 1e9);
+    out += line;
+    snprintf(line, sizeof(line), "# HELP %s_requests_total HTTP requests sent\n"
+             "# TYPE %s_requests_total counter\n%s_requests_total{%s} %llu\n",
+             prefix, prefix, prefix, labels.c_str(), static_cast<unsigned long long>(requests()));
+    out += line;
+    snprintf(line, sizeof(line), "# HELP %s_failures_total HTTP requests without a 2xx response\n"
+             "# TYPE %s_failures_total counter\n%s_failures_total{%s} %llu\n",
+             prefix, prefix, prefix, labels.c_str(), static_cast<unsigned long long>(failures()));
+    out += line;
+    return out;
+}
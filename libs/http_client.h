@@ -0,0 +1,82 @@
+#pragma once
+
+// Клиент HTTP/1.1 с постоянными соединениями для пересылки команд между узлами
+// (crsf_api_server → crsf_api_interpreter). Адрес цели разрешается один раз и кэшируется
+// (повторно — только после неудачного подключения), открытые соединения переиспользуются
+// (keep-alive) из небольшого пула: на каждую команду не тратятся ни DNS-запрос, ни TCP-рукопожатие.
+// Если сервер закрыл простаивающее соединение, запрос один раз повторяется на новом.
+// Время каждого успешного запроса попадает в HDR-гистограмму задержек (та же, что у /metrics crsf_io_rpi).
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+#include "latency_metrics.h"
+
+class HttpKeepAliveClient {
+public:
+    explicit HttpKeepAliveClient(const std::string& host = "localhost", int port = 8082, int timeoutMs = 2000);
+    ~HttpKeepAliveClient() { closeAll(); }
+
+    HttpKeepAliveClient(const HttpKeepAliveClient&) = delete;
+    HttpKeepAliveClient& operator=(const HttpKeepAliveClient&) = delete;
+
+    // Смена цели сбрасывает кэш адреса и закрывает пул
+    void setTarget(const std::string& host, int port);
+    // Таймаут подключения, отправки и ожидания ответа
+    void setTimeoutMs(int timeoutMs);
+
+    // POST path с телом body (по умолчанию application/json). true при ответе 2xx.
+    // status — код ответа (0 при сетевой ошибке). Потокобезопасен: параллельные
+    // запросы идут по разным соединениям пула
+    bool post(const std::string& path, const std::string& body, int* status = nullptr,
+              const char* contentType = "application/json");
+
+    void closeAll();
+
+    const HdrHistogram& latency() const { return _latency; }
+    uint64_t requests() const { return _requests.load(std::memory_order_relaxed); }
+    uint64_t failures() const { return _failures.load(std::memory_order_relaxed); }
+    uint64_t connects() const { return _connects.load(std::memory_order_relaxed); }
+    uint64_t retries() const { return _retries.load(std::memory_order_relaxed); }
+    // {"target":"host:port","requests":..,"failures":..,"connects":..,"retries":..,
+    //  "latency":{"count":..,"avgUs":..,"maxUs":..,"p50Us":..,"p90Us":..,"p99Us":..,"p999Us":..}}
+    std::string statsJson() const;
+    // Текст для GET /metrics: summary <prefix>_latency_seconds{target="host:port"},
+    // gauge <prefix>_latency_max_seconds и счётчики <prefix>_requests_total, <prefix>_failures_total
+    std::string prometheus(const char* prefix) const;
+
+private:
+    static const size_t MAX_IDLE_CONNECTIONS = 4;
+
+    // Исход одного обмена запрос/ответ на конкретном соединении
+    enum Exchange {
+        EXCHANGE_OK,        // ответ получен
+        EXCHANGE_STALE,     // соединение оказалось закрыто до первого байта ответа — можно повторить
+        EXCHANGE_FAILED,    // ошибка или таймаут после отправки — повторять нельзя
+    };
+
+    bool resolve(sockaddr_in& addr);
+    int openConnection();
+    int acquire(bool& reused);
+    void release(int fd);
+    Exchange exchange(int fd, const std::string& request, int& status, bool& keepAlive);
+
+    mutable std::mutex _mutex; // пул, цель и кэш адреса
+    std::string _host;
+    int _port;
+    int _timeoutMs;
+    bool _resolved;
+    sockaddr_in _addr;
+    std::vector<int> _idle;
+
+    HdrHistogram _latency;
+    std::atomic<uint64_t> _requests{0};
+    std::atomic<uint64_t> _failures{0};
+    std::atomic<uint64_t> _connects{0};
+    std::atomic<uint64_t> _retries{0};
+};
@@ -0,0 +1,745 @@
+#include "http_server.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+// Не разбираем новые запросы соединения, пока клиент не забрал столько ответов
+static const size_t MAX_PENDING_OUTPUT = 256 * 1024;
+static const int MAX_IOV = 16;
+
+static uint64_t http_server_now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000u + static_cast<uint64_t>(ts.tv_nsec) / 1000000u;
+}
+
+const std::string& HttpRequest::header(const char* name) const
+{
+    static const std::string empty;
+    for (const auto& h : headers) {
+        if (h.first == name) {
+            return h.second;
+        }
+    }
+    return empty;
+}
+
+bool HttpRequest::queryParam(const char* name, std::string& value) const
+{
+    size_t nameLen = strlen(name);
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        size_t eq = query.find('=', pos);
+        size_t keyEnd = (eq < end) ? eq : end;
+        if (keyEnd - pos == nameLen && query.compare(pos, nameLen, name) == 0) {
+            value.clear();
+            for (size_t i = (eq < end) ? eq + 1 : end; i < end; ++i) {
+                char c = query[i];
+                if (c == '+') {
+                    c = ' ';
+                } else if (c == '%' && i + 2 < end && isxdigit(static_cast<unsigned char>(query[i + 1])) &&
+                           isxdigit(static_cast<unsigned char>(query[i + 2]))) {
+                    char hex[3] = {query[i + 1], query[i + 2], '\0'};
+                    c = static_cast<char>(strtol(hex, nullptr, 16));
+                    i += 2;
+                }
+                value += c;
+            }
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+const char* http_status_text(int status)
+{
+    switch (status) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 406: return "Not Acceptable";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 415: return "Unsupported Media Type";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+    }
+}
+
+// Исходящий сегмент: собственная строка или общий буфер без копирования
+struct OutSegment {
+    std::string owned;
+    std::shared_ptr<const std::string> shared;
+    size_t offset = 0;
+
+    const std::string& data() const { return shared ? *shared : owned; }
+};
+
+struct HttpServer::Connection {
+    int fd;
+    std::string in;
+    size_t inPos = 0;              // начало неразобранных данных в in
+    std::deque<OutSegment> out;
+    size_t outBytes = 0;           // ещё не отправлено
+    bool closeAfterWrite = false;
+    bool peerClosed = false;
+    uint32_t events = 0;           // текущая подписка в epoll
+    uint64_t lastActiveMs = 0;
+    std::shared_ptr<HttpStream> stream; // соединение отдаёт поток событий
+};
+
+struct HttpServer::Worker {
+    int epfd = -1;
+    int wakeFd = -1;               // eventfd: в потоки соединений этого рабочего есть новые данные
+    std::unordered_map<int, std::unique_ptr<Connection>> conns;
+    std::mutex readyMutex;
+    std::vector<std::shared_ptr<HttpStream>> ready;
+
+    // Вызывается под мьютексом потока (порядок блокировок: поток → readyMutex)
+    void schedule(std::shared_ptr<HttpStream> stream)
+    {
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(std::move(stream));
+        }
+        uint64_t one = 1;
+        ssize_t r = write(wakeFd, &one, sizeof(one));
+        (void)r;
+    }
+};
+
+bool HttpStream::send(std::shared_ptr<const std::string> data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_worker || _closeRequested) {
+        return false;
+    }
+    // Медленный клиент: вытесняем самые старые фрагменты (для телеметрии важен последний снимок)
+    while (!_queue.empty() && _queuedBytes + data->size() > HttpServer::MAX_STREAM_BACKLOG) {
+        _queuedBytes -= _queue.front()->size();
+        _queue.pop_front();
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    _queuedBytes += data->size();
+    _queue.push_back(std::move(data));
+    if (!_scheduled) {
+        _scheduled = true;
+        _worker->schedule(shared_from_this());
+    }
+    return true;
+}
+
+void HttpStream::close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_worker || _closeRequested) {
+        return;
+    }
+    _closeRequested = true;
+    if (!_scheduled) {
+        _scheduled = true;
+        _worker->schedule(shared_from_this());
+    }
+}
+
+HttpServer::HttpServer(Handler handler, unsigned int workers, int idleTimeoutMs)
+    : _handler(std::move(handler)), _workerCount(workers ? workers : 1), _idleTimeoutMs(idleTimeoutMs),
+      _listenFd(-1), _stopFd(-1), _port(0)
+{
+}
+
+HttpServer::~HttpServer()
+{
+    stop();
+    for (auto& t : _threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    for (auto& w : _workers) {
+        std::vector<int> fds;
+        for (auto& c : w->conns) {
+            fds.push_back(c.first);
+        }
+        for (int fd : fds) {
+            closeConnection(*w, fd);
+        }
+        if (w->epfd >= 0) {
+            ::close(w->epfd);
+        }
+        if (w->wakeFd >= 0) {
+            ::close(w->wakeFd);
+        }
+    }
+    if (_listenFd >= 0) {
+        ::close(_listenFd);
+    }
+    if (_stopFd >= 0) {
+        ::close(_stopFd);
+    }
+}
+
+bool HttpServer::listen(int port)
+{
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listenFd < 0) {
+        return false;
+    }
+    int opt = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(_listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(_listenFd, SOMAXCONN) < 0) {
+        ::close(_listenFd);
+        _listenFd = -1;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(_listenFd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    _port = ntohs(addr.sin_port);
+    return true;
+}
+
+bool HttpServer::start()
+{
+    if (_listenFd < 0 || _running) {
+        return false;
+    }
+    _stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_stopFd < 0) {
+        return false;
+    }
+    _running = true;
+    for (unsigned int i = 0; i < _workerCount; ++i) {
+        std::unique_ptr<Worker> w(new Worker());
+        w->epfd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        // Новое подключение будит один рабочий поток, а не все
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.fd = _listenFd;
+        epoll_ctl(w->epfd, EPOLL_CTL_ADD, _listenFd, &ev);
+        // Сигнал остановки не сбрасывается и будит все потоки
+        ev.events = EPOLLIN;
+        ev.data.fd = _stopFd;
+        epoll_ctl(w->epfd, EPOLL_CTL_ADD, _stopFd, &ev);
+        w->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ev.data.fd = w->wakeFd;
+        epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->wakeFd, &ev);
+        _workers.push_back(std::move(w));
+    }
+    for (auto& w : _workers) {
+        Worker* worker = w.get();
+        _threads.emplace_back([this, worker]() { workerLoop(*worker); });
+    }
+    return true;
+}
+
+void HttpServer::run()
+{
+    if (!start()) {
+        return;
+    }
+    for (auto& t : _threads) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+}
+
+void HttpServer::stop()
+{
+    if (_running.exchange(false) && _stopFd >= 0) {
+        uint64_t one = 1;
+        ssize_t r = write(_stopFd, &one, sizeof(one));
+        (void)r;
+    }
+}
+
+void HttpServer::workerLoop(Worker& worker)
+{
+    struct epoll_event events[64];
+    uint64_t lastSweep = http_server_now_ms();
+    while (_running.load(std::memory_order_relaxed)) {
+        int n = epoll_wait(worker.epfd, events, 64, 1000);
+        if (n < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == _stopFd) {
+                continue;
+            }
+            if (fd == _listenFd) {
+                acceptAll(worker);
+                continue;
+            }
+            if (fd == worker.wakeFd) {
+                drainStreams(worker);
+                continue;
+            }
+            auto it = worker.conns.find(fd);
+            if (it == worker.conns.end()) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(worker, fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                if (!flush(worker, conn)) {
+                    continue;
+                }
+                // Ответы ушли — можно разобрать запросы, отложенные из-за переполнения выхода
+                if (!conn.in.empty() && !conn.stream) {
+                    processInput(worker, conn);
+                    if (!flush(worker, conn)) {
+                        continue;
+                    }
+                }
+            }
+            if (events[i].events & EPOLLIN) {
+                onReadable(worker, conn);
+            }
+        }
+
+        // Закрываем простаивающие соединения
+        uint64_t now = http_server_now_ms();
+        if (_idleTimeoutMs > 0 && now - lastSweep >= 1000) {
+            lastSweep = now;
+            std::vector<int> idle;
+            for (auto& c : worker.conns) {
+                // Поток событий живёт, пока клиент не отключится
+                if (!c.second->stream && now - c.second->lastActiveMs > static_cast<uint64_t>(_idleTimeoutMs)) {
+                    idle.push_back(c.first);
+                }
+            }
+            for (int fd : idle) {
+                closeConnection(worker, fd);
+            }
+        }
+    }
+}
+
+void HttpServer::acceptAll(Worker& worker)
+{
+    for (;;) {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN: очередь пуста (или подключение забрал другой поток)
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->fd = fd;
+        conn->lastActiveMs = http_server_now_ms();
+        conn->events = EPOLLIN | EPOLLRDHUP;
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        if (epoll_ctl(worker.epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        worker.conns[fd] = std::move(conn);
+        _accepted.fetch_add(1, std::memory_order_relaxed);
+        _open.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HttpServer::onReadable(Worker& worker, Connection& conn)
+{
+    char buf[16384];
+    for (;;) {
+        ssize_t r = recv(conn.fd, buf, sizeof(buf), 0);
+        if (r > 0) {
+            conn.in.append(buf, static_cast<size_t>(r));
+            if (static_cast<size_t>(r) < sizeof(buf)) {
+                break;
+            }
+            // Не даём одному клиенту раздуть буфер: остальное дочитаем после разбора
+            if (conn.in.size() - conn.inPos > MAX_HEADER_BYTES + MAX_BODY_BYTES) {
+                break;
+            }
+            continue;
+        }
+        if (r == 0) {
+            // Клиент закончил передачу: отвечаем на уже полученные запросы и закрываем
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(worker, conn.fd);
+            return;
+        }
+        break;
+    }
+    conn.lastActiveMs = http_server_now_ms();
+
+    if (conn.stream) {
+        // Клиент потока ничего не присылает: входящие байты отбрасываем, ждём только закрытия
+        conn.in.clear();
+        if (conn.peerClosed) {
+            closeConnection(worker, conn.fd);
+        }
+        return;
+    }
+    processInput(worker, conn);
+    if (conn.peerClosed) {
+        conn.closeAfterWrite = true;
+    }
+    flush(worker, conn);
+}
+
+// Разбор всех полных запросов из буфера (конвейер) и постановка ответов в очередь.
+// false, если соединение нужно закрыть после отправки очереди
+bool HttpServer::processInput(Worker& worker, Connection& conn)
+{
+    while (!conn.closeAfterWrite && !conn.stream && conn.outBytes < MAX_PENDING_OUTPUT) {
+        size_t headerEnd = conn.in.find("\r\n\r\n", conn.inPos);
+        if (headerEnd == std::string::npos) {
+            if (conn.in.size() - conn.inPos > MAX_HEADER_BYTES) {
+                HttpResponse resp;
+                resp.set(431, "application/json", "{\"status\":\"error\",\"message\":\"Header too large\"}");
+                queueResponse(conn, nullptr, resp, false);
+            }
+            break;
+        }
+
+        HttpRequest req;
+        bool bad = false;
+        // Строка запроса: METHOD SP target SP version
+        size_t lineEnd = conn.in.find("\r\n", conn.inPos);
+        size_t sp1 = conn.in.find(' ', conn.inPos);
+        size_t sp2 = (sp1 < lineEnd) ? conn.in.find(' ', sp1 + 1) : std::string::npos;
+        if (sp1 >= lineEnd || sp2 >= lineEnd) {
+            bad = true;
+        } else {
+            req.method.assign(conn.in, conn.inPos, sp1 - conn.inPos);
+            req.target.assign(conn.in, sp1 + 1, sp2 - sp1 - 1);
+            req.version.assign(conn.in, sp2 + 1, lineEnd - sp2 - 1);
+            size_t q = req.target.find('?');
+            req.path = req.target.substr(0, q);
+            if (q != std::string::npos) {
+                req.query = req.target.substr(q + 1);
+            }
+        }
+
+        size_t contentLength = 0;
+        bool chunked = false;
+        size_t pos = lineEnd + 2;
+        while (!bad && pos < headerEnd) {
+            size_t eol = conn.in.find("\r\n", pos);
+            size_t colon = conn.in.find(':', pos);
+            if (colon >= eol) {
+                bad = true;
+                break;
+            }
+            std::string name(conn.in, pos, colon - pos);
+            for (char& c : name) {
+                c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            }
+            size_t vs = colon + 1;
+            while (vs < eol && (conn.in[vs] == ' ' || conn.in[vs] == '\t')) {
+                ++vs;
+            }
+            size_t ve = eol;
+            while (ve > vs && (conn.in[ve - 1] == ' ' || conn.in[ve - 1] == '\t')) {
+                --ve;
+            }
+            std::string value(conn.in, vs, ve - vs);
+            if (name == "content-length") {
+                char* end = nullptr;
+                unsigned long long v = strtoull(value.c_str(), &end, 10);
+                if (end == value.c_str() || *end != '\0') {
+                    bad = true;
+                }
+                contentLength = static_cast<size_t>(v);
+            } else if (name == "transfer-encoding") {
+                chunked = true;
+            }
+            req.headers.emplace_back(std::move(name), std::move(value));
+            pos = eol + 2;
+        }
+
+        if (bad) {
+            HttpResponse resp;
+            resp.set(400, "application/json", "{\"status\":\"error\",\"message\":\"Malformed request\"}");
+            queueResponse(conn, nullptr, resp, false);
+            break;
+        }
+        if (chunked) {
+            HttpResponse resp;
+            resp.set(501, "application/json", "{\"status\":\"error\",\"message\":\"Chunked body is not supported\"}");
+            queueResponse(conn, nullptr, resp, false);
+            break;
+        }
+        if (contentLength > MAX_BODY_BYTES) {
+            HttpResponse resp;
+            resp.set(413, "application/json", "{\"status\":\"error\",\"message\":\"Body too large\"}");
+            queueResponse(conn, nullptr, resp, false);
+            break;
+        }
+        size_t bodyStart = headerEnd + 4;
+        if (conn.in.size() - bodyStart < contentLength) {
+            break; // Тело ещё не пришло целиком
+        }
+        req.body.assign(conn.in, bodyStart, contentLength);
+        conn.inPos = bodyStart + contentLength;
+
+        // HTTP/1.1 держит соединение по умолчанию, HTTP/1.0 — только по явной просьбе
+        const std::string& connection = req.header("connection");
+        bool keepAlive = (req.version == "HTTP/1.1") ? (strcasecmp(connection.c_str(), "close") != 0)
+                                                    : (strcasecmp(connection.c_str(), "keep-alive") == 0);
+
+        HttpResponse resp;
+        try {
+            _handler(req, resp);
+        } catch (...) {
+            resp = HttpResponse();
+            resp.set(500, "application/json", "{\"status\":\"error\",\"message\":\"Internal error\"}");
+        }
+        _requests.fetch_add(1, std::memory_order_relaxed);
+        if (resp.onStream && resp.status == 200 && req.method != "HEAD") {
+            openStream(worker, conn, resp);
+            break;
+        }
+        queueResponse(conn, &req, resp, keepAlive && !resp.close);
+    }
+
+    // Сдвигаем неразобранный остаток в начало буфера
+    if (conn.inPos > 0) {
+        conn.in.erase(0, conn.inPos);
+        conn.inPos = 0;
+    }
+    return !conn.closeAfterWrite;
+}
+
+void HttpServer::queueResponse(Connection& conn, const HttpRequest* req, HttpResponse& resp, bool keepAlive)
+{
+    const std::string& body = resp.sharedBody ? *resp.sharedBody : resp.body;
+    bool headOnly = req && req->method == "HEAD";
+
+    char line[128];
+    snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\nContent-Length: %zu\r\n", resp.status,
+             http_status_text(resp.status), body.size());
+    OutSegment head;
+    head.owned.reserve(160 + resp.contentType.size() + resp.extraHeaders.size());
+    head.owned += line;
+    head.owned += "Content-Type: ";
+    head.owned += resp.contentType;
+    head.owned += "\r\nAccess-Control-Allow-Origin: *\r\n";
+    head.owned += resp.extraHeaders;
+    head.owned += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    conn.outBytes += head.owned.size();
+    conn.out.push_back(std::move(head));
+    if (!headOnly && !body.empty()) {
+        OutSegment seg;
+        if (resp.sharedBody) {
+            seg.shared = std::move(resp.sharedBody);
+        } else {
+            seg.owned = std::move(resp.body);
+        }
+        conn.outBytes += seg.data().size();
+        conn.out.push_back(std::move(seg));
+    }
+    if (!keepAlive) {
+        conn.closeAfterWrite = true;
+    }
+}
+
+// Заголовки потока событий без Content-Length; дальше соединение только пишет
+void HttpServer::openStream(Worker& worker, Connection& conn, HttpResponse& resp)
+{
+    OutSegment head;
+    head.owned = "HTTP/1.1 200 OK\r\nContent-Type: ";
+    head.owned += resp.contentType;
+    head.owned += "\r\nCache-Control: no-cache\r\nAccess-Control-Allow-Origin: *\r\n";
+    head.owned += resp.extraHeaders;
+    head.owned += "Connection: keep-alive\r\n\r\n";
+    head.owned += resp.body;
+    conn.outBytes += head.owned.size();
+    conn.out.push_back(std::move(head));
+
+    // Запросы, пришедшие следом по этому соединению, не обслуживаются
+    conn.in.clear();
+    conn.inPos = 0;
+    conn.stream.reset(new HttpStream(&worker, conn.fd));
+    _streams.fetch_add(1, std::memory_order_relaxed);
+    resp.onStream(conn.stream);
+}
+
+// Перенос данных из очередей готовых потоков в соединения
+void HttpServer::drainStreams(Worker& worker)
+{
+    uint64_t count;
+    ssize_t r = read(worker.wakeFd, &count, sizeof(count));
+    (void)r;
+
+    std::vector<std::shared_ptr<HttpStream>> ready;
+    {
+        std::lock_guard<std::mutex> lock(worker.readyMutex);
+        ready.swap(worker.ready);
+    }
+    for (auto& stream : ready) {
+        auto it = worker.conns.find(stream->_fd);
+        // Соединение могло закрыться, а его дескриптор — достаться новому
+        if (it == worker.conns.end() || it->second->stream != stream) {
+            continue;
+        }
+        Connection& conn = *it->second;
+        {
+            std::lock_guard<std::mutex> lock(stream->_mutex);
+            stream->_scheduled = false;
+            for (auto& data : stream->_queue) {
+                // Сокет забит: не копим больше MAX_STREAM_BACKLOG, новые данные важнее
+                if (conn.outBytes > MAX_STREAM_BACKLOG) {
+                    stream->_dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                OutSegment seg;
+                seg.shared = std::move(data);
+                conn.outBytes += seg.shared->size();
+                conn.out.push_back(std::move(seg));
+            }
+            stream->_queue.clear();
+            stream->_queuedBytes = 0;
+            if (stream->_closeRequested) {
+                conn.closeAfterWrite = true;
+            }
+        }
+        conn.lastActiveMs = http_server_now_ms();
+        flush(worker, conn);
+    }
+}
+
+// Отправка очереди одним writev. false, если соединение закрыто
+bool HttpServer::flush(Worker& worker, Connection& conn)
+{
+    while (!conn.out.empty()) {
+        struct iovec iov[MAX_IOV];
+        int cnt = 0;
+        for (auto it = conn.out.begin(); it != conn.out.end() && cnt < MAX_IOV; ++it, ++cnt) {
+            const std::string& d = it->data();
+            iov[cnt].iov_base = const_cast<char*>(d.data() + it->offset);
+            iov[cnt].iov_len = d.size() - it->offset;
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(cnt);
+        ssize_t w = sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            closeConnection(worker, conn.fd);
+            return false;
+        }
+        size_t left = static_cast<size_t>(w);
+        conn.outBytes -= left;
+        while (left > 0) {
+            OutSegment& seg = conn.out.front();
+            size_t avail = seg.data().size() - seg.offset;
+            if (left >= avail) {
+                left -= avail;
+                conn.out.pop_front();
+            } else {
+                seg.offset += left;
+                left = 0;
+            }
+        }
+    }
+
+    if (conn.out.empty() && conn.closeAfterWrite) {
+        closeConnection(worker, conn.fd);
+        return false;
+    }
+    updateInterest(worker, conn, !conn.out.empty());
+    return true;
+}
+
+void HttpServer::updateInterest(Worker& worker, Connection& conn, bool wantWrite)
+{
+    // Пока клиент не забирает ответы, новые запросы не читаем (поток читаем всегда — ждём закрытия)
+    bool wantRead = !conn.peerClosed && (conn.stream || conn.outBytes < MAX_PENDING_OUTPUT);
+    uint32_t events = 0;
+    if (wantRead) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (wantWrite) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn.events) {
+        return;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = conn.fd;
+    epoll_ctl(worker.epfd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.events = events;
+}
+
+void HttpServer::closeConnection(Worker& worker, int fd)
+{
+    auto it = worker.conns.find(fd);
+    if (it == worker.conns.end()) {
+        return;
+    }
+    if (it->second->stream) {
+        HttpStream& stream = *it->second->stream;
+        std::lock_guard<std::mutex> lock(stream._mutex);
+        stream._worker = nullptr;
+        stream._queue.clear();
+        stream._queuedBytes = 0;
+        stream._open.store(false, std::memory_order_release);
+        _streams.fetch_sub(1, std::memory_order_relaxed);
+    }
+    epoll_ctl(worker.epfd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    worker.conns.erase(it);
+    _open.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+// Неблокирующий HTTP/1.1 сервер на epoll для crsf_api_server, crsf_api_interpreter и telemetry_server.
+// Фиксированное число рабочих потоков; каждый держит свой epoll и сам принимает подключения
+// со общего слушающего сокета (EPOLLEXCLUSIVE), поэтому потоки не создаются на каждое соединение.
+// Соединения keep-alive, запросы в конвейере (pipelining) обрабатываются по порядку,
+// ответы уходят одним writev: заголовки и тело отдельными сегментами, общий
+// (заранее сериализованный) буфер тела не копируется.
+// Ответ-поток (Server-Sent Events) оставляет соединение открытым: данные в него
+// ставит любой поток через HttpStream.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct HttpRequest {
+    std::string method;
+    std::string target;   // как в строке запроса: путь с query
+    std::string path;     // без query
+    std::string query;    // после '?', без него
+    std::string version;  // "HTTP/1.1"
+    std::vector<std::pair<std::string, std::string>> headers; // имена в нижнем регистре
+    std::string body;
+
+    // Значение заголовка (имя в нижнем регистре); пустая строка, если его нет
+    const std::string& header(const char* name) const;
+    // Значение параметра query (с декодированием %XX и '+'); false, если параметра нет
+    bool queryParam(const char* name, std::string& value) const;
+};
+
+class HttpStream;
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+    // Общий неизменяемый буфер тела: если задан, отправляется вместо body без копирования
+    std::shared_ptr<const std::string> sharedBody;
+    // Дополнительные заголовки, каждый со своим "\r\n"
+    std::string extraHeaders;
+    // Закрыть соединение после этого ответа
+    bool close = false;
+    // Ответ-поток: заголовки уходят без Content-Length, body — первым фрагментом,
+    // соединение больше не читает запросы. Вызывается в рабочем потоке сразу после заголовков
+    std::function<void(std::shared_ptr<HttpStream>)> onStream;
+
+    void set(int statusCode, const std::string& type, std::string content)
+    {
+        status = statusCode;
+        contentType = type;
+        body = std::move(content);
+    }
+};
+
+// Текстовое описание кода ответа ("OK", "Not Found", ...)
+const char* http_status_text(int status);
+
+class HttpServer {
+public:
+    // Обработчик вызывается из рабочих потоков параллельно: общие данные защищает сам обработчик.
+    // Долгий обработчик задерживает только соединения своего рабочего потока
+    using Handler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+    static const size_t MAX_HEADER_BYTES = 16384;
+    static const size_t MAX_BODY_BYTES = 1 << 20;
+    // Неотправленный объём потока, после которого новые фрагменты вытесняют старые
+    static const size_t MAX_STREAM_BACKLOG = 256 * 1024;
+
+    explicit HttpServer(Handler handler, unsigned int workers = 2, int idleTimeoutMs = 60000);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Открыть слушающий сокет (0 — выбрать свободный порт). false при ошибке bind/listen
+    bool listen(int port);
+    int port() const { return _port; }
+
+    // Запустить рабочие потоки и вернуться
+    bool start();
+    // Запустить и ждать до stop()
+    void run();
+    // Остановить рабочие потоки и закрыть все соединения (можно вызывать из любого потока)
+    void stop();
+
+    // Статистика
+    uint64_t requests() const { return _requests.load(std::memory_order_relaxed); }
+    uint64_t connectionsAccepted() const { return _accepted.load(std::memory_order_relaxed); }
+    uint64_t connectionsOpen() const { return _open.load(std::memory_order_relaxed); }
+    uint64_t streamsOpen() const { return _streams.load(std::memory_order_relaxed); }
+
+private:
+    friend class HttpStream;
+    struct Connection;
+    struct Worker;
+
+    void workerLoop(Worker& worker);
+    void acceptAll(Worker& worker);
+    void onReadable(Worker& worker, Connection& conn);
+    bool processInput(Worker& worker, Connection& conn);
+    void queueResponse(Connection& conn, const HttpRequest* req, HttpResponse& resp, bool keepAlive);
+    void openStream(Worker& worker, Connection& conn, HttpResponse& resp);
+    void drainStreams(Worker& worker);
+    bool flush(Worker& worker, Connection& conn);
+    void closeConnection(Worker& worker, int fd);
+    void updateInterest(Worker& worker, Connection& conn, bool wantWrite);
+
+    Handler _handler;
+    unsigned int _workerCount;
+    int _idleTimeoutMs;
+    int _listenFd;
+    int _stopFd;
+    int _port;
+    std::atomic<bool> _running{false};
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+
+    std::atomic<uint64_t> _requests{0};
+    std::atomic<uint64_t> _accepted{0};
+    std::atomic<uint64_t> _open{0};
+    std::atomic<uint64_t> _streams{0};
+};
+
+// Открытый поток ответа (SSE). Потокобезопасен; живёт дольше соединения и сервера
+class HttpStream : public std::enable_shared_from_this<HttpStream> {
+public:
+    // Поставить буфер в очередь без копирования. false, если соединение уже закрыто.
+    // Если клиент не забирает данные, старые фрагменты отбрасываются (см. dropped())
+    bool send(std::shared_ptr<const std::string> data);
+    // Закрыть соединение после отправки очереди
+    void close();
+    bool isOpen() const { return _open.load(std::memory_order_acquire); }
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend class HttpServer;
+    HttpStream(HttpServer::Worker* worker, int fd) : _worker(worker), _fd(fd) {}
+
+    std::mutex _mutex;
+    HttpServer::Worker* _worker; // рабочий поток владельца соединения; nullptr после закрытия
+    int _fd;
+    std::deque<std::shared_ptr<const std::string>> _queue;
+    size_t _queuedBytes = 0;
+    bool _scheduled = false;     // уже в списке готовых у рабочего потока
+    bool _closeRequested = false;
+    std::atomic<bool> _open{true};
+    std::atomic<uint64_t> _dropped{0};
+};
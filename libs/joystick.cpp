@@ -25,8 +25,6 @@ bool js_open(const char* path)
     return true;
 }
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не вызывается
-/*
 void js_close()
 {
     if (g_fd >= 0) {
@@ -36,7 +34,6 @@ void js_close()
     g_axes.clear();
     g_buttons.clear();
 }
-*/
 
 static void ensure_axis_size(size_t idx)
 {
@@ -78,6 +75,11 @@ bool js_get_axis(int index, int16_t& outValue)
     return true;
 }
 
+int js_get_fd()
+{
+    return g_fd;
+}
+
 int js_num_axes()
 {
     return static_cast<int>(g_axes.size());
@@ -9,9 +9,8 @@
 // Открыть джойстик. path по умолчанию "/dev/input/js0". Возвращает true при успехе
 bool js_open(const char* path = "/dev/input/js0");
 
-//БЕСПОЛЕЗНО: функция определена, но нигде не вызывается
-// Закрыть джойстик
-//void js_close();
+// Закрыть джойстик (после отключения устройства; js_open() откроет его снова)
+void js_close();
 
 // Прочитать доступные события (неблокирующее). Возвращает true, если что-то обработано
 bool js_poll();
@@ -20,6 +19,9 @@ bool js_poll();
 // Возвращает true, если ось присутствует
 bool js_get_axis(int index, int16_t& outValue);
 
+// Файловый дескриптор открытого джойстика (-1, если не открыт) — для подписки в epoll
+int js_get_fd();
+
 // Получить количество известных осей/кнопок (по данным из событий)
 int js_num_axes();
 int js_num_buttons();
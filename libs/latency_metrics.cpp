@@ -0,0 +1,127 @@
+#include "latency_metrics.h"
+
+#include <cstdio>
+
+LatencyMetrics g_latency;
+
+static const char* const LATENCY_STAGE_NAMES[LATENCY_STAGE_COUNT] = {
+    "rx_to_crc",
+    "crc_to_dispatch",
+    "rx_to_publish",
+    "cmd_queue",
+    "cmd_to_tx",
+    "tx_write",
+};
+
+const char* latency_stage_name(LatencyStage stage)
+{
+    return static_cast<unsigned int>(stage) < LATENCY_STAGE_COUNT ? LATENCY_STAGE_NAMES[stage] : "unknown";
+}
+
+uint64_t HdrHistogram::bucketUpperNs(unsigned int index)
+{
+    if (index < (1u << SUB_BUCKET_BITS)) {
+        return index;
+    }
+    unsigned int shift = (index >> SUB_BUCKET_BITS) - 1;
+    uint64_t mantissa = (1u << SUB_BUCKET_BITS) + (index & ((1u << SUB_BUCKET_BITS) - 1));
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void HdrHistogram::reset()
+{
+    for (auto& b : _buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    _sumNs.store(0, std::memory_order_relaxed);
+    _maxNs.store(0, std::memory_order_relaxed);
+}
+
+uint64_t HdrHistogram::count() const
+{
+    uint64_t total = 0;
+    for (const auto& b : _buckets) {
+        total += b.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t HdrHistogram::percentileNs(double q) const
+{
+    // Счётчики читаются один раз: запись может идти параллельно
+    static thread_local uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (unsigned int i = 0; i < BUCKETS; ++i) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * total);
+    if (rank >= total) {
+        rank = total - 1;
+    }
+    uint64_t max = maxNs();
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            uint64_t upper = bucketUpperNs(i);
+            return (max != 0 && upper > max) ? max : upper;
+        }
+    }
+    return max;
+}
+
+void latency_prometheus_summary(std::string& out, const char* metric, const char* labels, const HdrHistogram& h)
+{
+    static const double QUANTILES[] = {0.5, 0.99, 0.999};
+    const char* sep = labels[0] ? "," : "";
+    char line[192];
+    for (double q : QUANTILES) {
+        snprintf(line, sizeof(line), "%s{%s%squantile=\"%g\"} %.9f\n", metric, labels, sep, q, h.percentileNs(q) / 1e9);
+        out += line;
+    }
+    snprintf(line, sizeof(line), "%s_sum{%s} %.9f\n", metric, labels, h.sumNs() / 1e9);
+    out += line;
+    snprintf(line, sizeof(line), "%s_count{%s} %llu\n", metric, labels, static_cast<unsigned long long>(h.count()));
+    out += line;
+}
+
+LatencyMetrics::LatencyMetrics()
+{
+    for (auto& p : _pending) {
+        p.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyMetrics::reset()
+{
+    for (unsigned int i = 0; i < LATENCY_STAGE_COUNT; ++i) {
+        _histograms[i].reset();
+        _pending[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string LatencyMetrics::prometheus() const
+{
+    std::string out;
+    char line[160];
+
+    out += "# HELP crsf_latency_seconds Hot-path stage latency in crsf_io_rpi\n";
+    out += "# TYPE crsf_latency_seconds summary\n";
+    for (unsigned int i = 0; i < LATENCY_STAGE_COUNT; ++i) {
+        snprintf(line, sizeof(line), "stage=\"%s\"", LATENCY_STAGE_NAMES[i]);
+        latency_prometheus_summary(out, "crsf_latency_seconds", line, _histograms[i]);
+    }
+
+    out += "# HELP crsf_latency_max_seconds Largest observed hot-path stage latency\n";
+    out += "# TYPE crsf_latency_max_seconds gauge\n";
+    for (unsigned int i = 0; i < LATENCY_STAGE_COUNT; ++i) {
+        snprintf(line, sizeof(line), "crsf_latency_max_seconds{stage=\"%s\"} %.9f\n",
+                 LATENCY_STAGE_NAMES[i], _histograms[i].maxNs() / 1e9);
+        out += line;
+    }
+    return out;
+}
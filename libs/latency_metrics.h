@@ -0,0 +1,147 @@
+#pragma once
+
+// Гистограммы задержек горячего пути crsf_io_rpi (отдаются на GET /metrics в формате Prometheus).
+// Этапы считаются по CLOCK_MONOTONIC:
+//   rx_to_crc        — read() из UART вернул первый байт кадра → кадр с верным CRC (handleByteReceived)
+//   crc_to_dispatch  — CRC верен → обработчик кадра в processPacketIn завершён
+//   rx_to_publish    — первый байт кадра прочитан → снимок опубликован в /dev/shm (main.cpp)
+//   cmd_queue        — команда поставлена в кольцо клиентом → принята основным циклом
+//   cmd_to_tx        — команда каналов принята → пакет каналов записан в UART (queuePacket)
+//   tx_write         — длительность записи пакета в UART (queuePacket)
+//
+// Гистограмма в духе HDR: 16 корзин на каждую степень двойки (погрешность квантиля не больше 1/16),
+// значения до 16 нс точные. Запись без блокировок: два атомарных сложения и, только на новом
+// максимуме, CAS. При USE_LATENCY_METRICS == false макросы LATENCY_* не порождают кода.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <time.h>
+
+#include "../config.h"
+
+enum LatencyStage {
+    LATENCY_RX_TO_CRC,
+    LATENCY_CRC_TO_DISPATCH,
+    LATENCY_RX_TO_PUBLISH,
+    LATENCY_CMD_QUEUE,
+    LATENCY_CMD_TO_TX,
+    LATENCY_TX_WRITE,
+    LATENCY_STAGE_COUNT
+};
+
+// Имя этапа для метки stage="..."
+const char* latency_stage_name(LatencyStage stage);
+
+// CLOCK_MONOTONIC в наносекундах (та же шкала, что rpi_monotonic_ns и CommandRecord::timestampNs)
+inline uint64_t latency_now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+class HdrHistogram {
+public:
+    static const unsigned int SUB_BUCKET_BITS = 4;  // 16 корзин на октаву
+    static const unsigned int MAX_BITS = 40;        // до 2^40 нс (~18 мин); больше — в последнюю корзину
+    static const unsigned int BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    void record(uint64_t ns)
+    {
+        _buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        _sumNs.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t prev = _maxNs.load(std::memory_order_relaxed);
+        while (ns > prev && !_maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    void reset();
+
+    uint64_t count() const;
+    uint64_t sumNs() const { return _sumNs.load(std::memory_order_relaxed); }
+    uint64_t maxNs() const { return _maxNs.load(std::memory_order_relaxed); }
+    // Верхняя граница корзины квантиля q (0..1), не больше максимума; 0, если записей нет
+    uint64_t percentileNs(double q) const;
+
+    static unsigned int bucketIndex(uint64_t ns)
+    {
+        if (ns < (1u << SUB_BUCKET_BITS)) {
+            return static_cast<unsigned int>(ns);
+        }
+        unsigned int msb = 63 - static_cast<unsigned int>(__builtin_clzll(ns));
+        if (msb >= MAX_BITS) {
+            return BUCKETS - 1;
+        }
+        unsigned int shift = msb - SUB_BUCKET_BITS;
+        return ((shift + 1) << SUB_BUCKET_BITS) + static_cast<unsigned int>((ns >> shift) & ((1u << SUB_BUCKET_BITS) - 1));
+    }
+    // Наибольшее значение, попадающее в корзину
+    static uint64_t bucketUpperNs(unsigned int index);
+
+private:
+    std::atomic<uint64_t> _buckets[BUCKETS] = {};
+    std::atomic<uint64_t> _sumNs{0};
+    std::atomic<uint64_t> _maxNs{0};
+};
+
+// Строки summary одной гистограммы в формате Prometheus: квантили 0.5/0.99/0.999, _sum и _count.
+// labels — метки без фигурных скобок ("stage=\"tx_write\""), пустая строка — без меток
+void latency_prometheus_summary(std::string& out, const char* metric, const char* labels, const HdrHistogram& h);
+
+class LatencyMetrics {
+public:
+    LatencyMetrics();
+
+    HdrHistogram& histogram(LatencyStage stage) { return _histograms[stage]; }
+    const HdrHistogram& histogram(LatencyStage stage) const { return _histograms[stage]; }
+
+    // Отрезок [startNs, endNs]; startNs == 0 — начала не было (замер пропускается)
+    void record(LatencyStage stage, uint64_t startNs, uint64_t endNs)
+    {
+        if (startNs != 0 && endNs >= startNs) {
+            _histograms[stage].record(endNs - startNs);
+        }
+    }
+    // Этап, начало и конец которого в разных местах кода: начало запоминается,
+    // пока не будет конца (повторные начала не сдвигают самое раннее)
+    void start(LatencyStage stage, uint64_t startNs)
+    {
+        if (_pending[stage].load(std::memory_order_relaxed) == 0) {
+            _pending[stage].store(startNs, std::memory_order_relaxed);
+        }
+    }
+    void finish(LatencyStage stage, uint64_t endNs)
+    {
+        uint64_t startNs = _pending[stage].load(std::memory_order_relaxed);
+        if (startNs != 0) {
+            _pending[stage].store(0, std::memory_order_relaxed);
+            record(stage, startNs, endNs);
+        }
+    }
+
+    void reset();
+
+    // Текст для GET /metrics (Prometheus text format 0.0.4): summary crsf_latency_seconds
+    // с квантилями 0.5/0.99/0.999 и gauge crsf_latency_max_seconds по каждому этапу
+    std::string prometheus() const;
+
+private:
+    HdrHistogram _histograms[LATENCY_STAGE_COUNT];
+    std::atomic<uint64_t> _pending[LATENCY_STAGE_COUNT];
+};
+
+// Общие метрики процесса (определены в latency_metrics.cpp)
+extern LatencyMetrics g_latency;
+
+#if USE_LATENCY_METRICS == true
+#define LATENCY_NOW() latency_now_ns()
+#define LATENCY_RECORD(stage, startNs, endNs) g_latency.record((stage), (startNs), (endNs))
+#define LATENCY_START(stage, startNs) g_latency.start((stage), (startNs))
+#define LATENCY_FINISH(stage, endNs) g_latency.finish((stage), (endNs))
+#else
+#define LATENCY_NOW() static_cast<uint64_t>(0)
+#define LATENCY_RECORD(stage, startNs, endNs) ((void)0)
+#define LATENCY_START(stage, startNs) ((void)0)
+#define LATENCY_FINISH(stage, endNs) ((void)0)
+#endif
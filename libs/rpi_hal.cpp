@@ -17,6 +17,12 @@ uint32_t rpi_millis() {
     return static_cast<uint32_t>(ms & 0xFFFFFFFFu);
 }
 
+uint64_t rpi_monotonic_ns() {
+    // steady_clock в Linux — это CLOCK_MONOTONIC: значения сравнимы между процессами
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ClockSteady::now().time_since_epoch()).count();
+    return static_cast<uint64_t>(ns);
+}
+
 //БЕСПОЛЕЗНО: функция определена, но нигде не используется
 /*
 uint32_t rpi_micros() {
@@ -8,6 +8,7 @@
 
 // Время
 uint32_t rpi_millis();        // миллисекунды с момента запуска процесса
+uint64_t rpi_monotonic_ns();  // наносекунды CLOCK_MONOTONIC (общие для всех процессов)
 //БЕСПОЛЕЗНО: функция определена, но нигде не используется
 //uint32_t rpi_micros();
 void rpi_delay_ms(uint32_t);  // пауза в миллисекундах
@@ -0,0 +1,194 @@
+#include "shared_telemetry.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+bool SharedTelemetry::mapNotify(bool create)
+{
+    int fd = shm_open(_notifyName.c_str(), create ? O_RDWR | O_CREAT : O_RDWR, 0666);
+    if (fd < 0) return false;
+    if (create) {
+        fchmod(fd, 0666); // читатели могут работать под другим пользователем
+        if (ftruncate(fd, sizeof(TelemetryNotifyState)) < 0) {
+            ::close(fd);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(TelemetryNotifyState)) {
+            ::close(fd);
+            return false;
+        }
+    }
+    void* p = mmap(nullptr, sizeof(TelemetryNotifyState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    // Счётчики не сбрасываем: курсоры читателей, переживших перезапуск писателя, остаются верными
+    _notify = static_cast<TelemetryNotifyState*>(p);
+    return true;
+}
+
+bool SharedTelemetry::create()
+{
+    if (_region) return _writable;
+
+    // Уведомления готовы до публикации magic: принявший область читатель найдёт и их
+    if (!mapNotify(true)) return false;
+
+    int fd = shm_open(_name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        close();
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SharedTelemetryRegion)) < 0) {
+        ::close(fd);
+        close();
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(SharedTelemetryRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // отображение остаётся действительным после закрытия fd
+    if (p == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    _region = static_cast<SharedTelemetryRegion*>(p);
+    _writable = true;
+
+    // Сначала заполняем заголовок, magic публикуем последним:
+    // читатель не примет область, пока она не готова
+    _region->magic.store(0, std::memory_order_relaxed);
+    _region->version = SHARED_TELEMETRY_VERSION;
+    _region->dataSize = sizeof(SharedTelemetryData);
+    // Сохраняем чётность seq, чтобы не оставить "вечную запись" после аварийного перезапуска
+    uint32_t seq = _region->seq.load(std::memory_order_relaxed);
+    _region->seq.store((seq + 1) & ~1u, std::memory_order_relaxed);
+    _region->magic.store(SHARED_TELEMETRY_MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool SharedTelemetry::open()
+{
+    if (_region) return true;
+
+    int fd = shm_open(_name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(SharedTelemetryRegion)) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, sizeof(SharedTelemetryRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    SharedTelemetryRegion* region = static_cast<SharedTelemetryRegion*>(p);
+    if (region->magic.load(std::memory_order_acquire) != SHARED_TELEMETRY_MAGIC ||
+        region->version != SHARED_TELEMETRY_VERSION ||
+        region->dataSize != sizeof(SharedTelemetryData)) {
+        munmap(p, sizeof(SharedTelemetryRegion));
+        return false;
+    }
+    if (!mapNotify(false)) {
+        munmap(p, sizeof(SharedTelemetryRegion));
+        return false;
+    }
+
+    _region = region;
+    _writable = false;
+    return true;
+}
+
+void SharedTelemetry::close()
+{
+    if (_region) {
+        munmap(_region, sizeof(SharedTelemetryRegion));
+        _region = nullptr;
+        _writable = false;
+    }
+    if (_notify) {
+        munmap(_notify, sizeof(TelemetryNotifyState));
+        _notify = nullptr;
+    }
+}
+
+// Снимок без счётчиков передачи: для проверки, есть ли в публикации что-то, кроме них
+static void clear_tx_counters(SharedTelemetryData& data)
+{
+    data.packetsSent = 0;
+    data.link.txFrames = 0;
+    data.link.txDropped = 0;
+    data.link.txShortWrites = 0;
+    data.link.txBytes = 0;
+}
+
+void SharedTelemetry::publish(const SharedTelemetryData& data)
+{
+    if (!_region || !_writable) return;
+
+    // Группы кадров, принятых с прошлой публикации: ждущий только их не просыпается на остальные
+    uint32_t kindMask = 0;
+    for (unsigned int kind = 0; kind < CRSF_LINK_FRAME_KINDS; ++kind) {
+        if (data.link.rxFramesByKind[kind] != _region->data.link.rxFramesByKind[kind]) {
+            kindMask |= TELEMETRY_NOTIFY_KIND(kind);
+        }
+    }
+    // Без новых кадров будим, только если изменилось что-то кроме счётчиков передачи
+    bool notify = kindMask != 0;
+    if (!notify) {
+        SharedTelemetryData before, after;
+        memcpy(&before, &_region->data, sizeof(before));
+        memcpy(&after, &data, sizeof(after));
+        clear_tx_counters(before);
+        clear_tx_counters(after);
+        notify = memcmp(&before, &after, sizeof(before)) != 0;
+    }
+
+    // Писатель один, поэтому seq можно читать relaxed
+    uint32_t seq = _region->seq.load(std::memory_order_relaxed);
+    _region->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_region->data, &data, sizeof(SharedTelemetryData));
+    _region->seq.store(seq + 2, std::memory_order_release);
+
+    if (notify) {
+        TelemetryNotify(_notify, TELEMETRY_NOTIFY_SHARED).post(kindMask);
+    }
+}
+
+bool SharedTelemetry::read(SharedTelemetryData& out) const
+{
+    if (!_region) return false;
+
+    // Писатель держит запись доли микросекунды, поэтому ограниченного числа попыток достаточно
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        uint32_t before = _region->seq.load(std::memory_order_acquire);
+        if (before & 1u) continue;
+        memcpy(&out, &_region->data, sizeof(SharedTelemetryData));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = _region->seq.load(std::memory_order_relaxed);
+        if (before == after) return true;
+    }
+    return false;
+}
+
+uint32_t SharedTelemetry::sequence() const
+{
+    return _region ? _region->seq.load(std::memory_order_acquire) : 0;
+}
+
+TelemetryNotifyCursor SharedTelemetry::cursor() const
+{
+    if (!_notify) return TelemetryNotifyCursor{};
+    return TelemetryNotify(_notify, TELEMETRY_NOTIFY_SHARED).cursor();
+}
+
+bool SharedTelemetry::wait(TelemetryNotifyCursor& cursor, uint32_t kindMask, int timeoutMs) const
+{
+    if (!_region || !_notify) return false;
+    return TelemetryNotify(_notify, TELEMETRY_NOTIFY_SHARED).wait(cursor, kindMask, timeoutMs);
+}
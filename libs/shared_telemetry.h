@@ -0,0 +1,113 @@
+#pragma once
+
+// Телеметрия в разделяемой памяти (POSIX shm_open + mmap) под seqlock.
+// Писатель (crsf_io_rpi) публикует снимок без системных вызовов,
+// читатели (api_interpreter, pybind) получают согласованную копию без блокировок
+// и могут ждать следующую публикацию на futex (wait) вместо опроса. Слова futex лежат в отдельном
+// объекте, доступном читателям на запись (там они отмечаются ждущими), сама телеметрия — только на чтение.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "crsf/link_counters.h"
+#include "telemetry_notify.h"
+
+// Имя объекта разделяемой памяти (виден как /dev/shm/crsf_telemetry)
+#define SHARED_TELEMETRY_NAME "/crsf_telemetry"
+#define SHARED_TELEMETRY_MAGIC 0x4C455443u // "CTEL"
+#define SHARED_TELEMETRY_VERSION 3
+// Объект уведомлений: имя области + суффикс (/dev/shm/crsf_telemetry_notify)
+#define SHARED_TELEMETRY_NOTIFY_SUFFIX "_notify"
+
+// Снимок телеметрии (формат прежнего /tmp/crsf_telemetry.dat)
+struct SharedTelemetryData {
+    bool linkUp;
+    uint32_t lastReceive;
+    int channels[16];
+    // Сводка счётчиков линка: кадры с верным CRC, отправленные кадры, кадры с неверным CRC
+    uint32_t packetsReceived;
+    uint32_t packetsSent;
+    uint32_t packetsLost;
+    double latitude;
+    double longitude;
+    double altitude;
+    double speed;
+    double voltage;
+    double current;
+    double capacity;
+    uint8_t remaining;
+    double roll;
+    double pitch;
+    double yaw;
+    int16_t rollRaw;
+    int16_t pitchRaw;
+    int16_t yawRaw;
+    // Время приёма последнего кадра каждого типа (CLOCK_MONOTONIC, нс; 0 — кадра ещё не было)
+    uint64_t channelsTimeNs;
+    uint64_t linkStatisticsTimeNs;
+    uint64_t gpsTimeNs;
+    uint64_t batteryTimeNs;
+    uint64_t attitudeTimeNs;
+    // Счётчики протокола CrsfSerial
+    CrsfLinkCounters link;
+};
+
+// Раскладка области: заголовок с версией + счётчик seqlock + данные.
+// Нечётное значение seq означает, что писатель в процессе записи
+struct SharedTelemetryRegion {
+    std::atomic<uint32_t> magic;
+    uint16_t version;
+    uint16_t dataSize;
+    std::atomic<uint32_t> seq;
+    uint32_t reserved;
+    SharedTelemetryData data;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock counter must be lock-free to live in shared memory");
+
+class SharedTelemetry {
+public:
+    // name — имя объекта shm (другое имя удобно для тестов)
+    explicit SharedTelemetry(const char* name = SHARED_TELEMETRY_NAME)
+        : _name(name), _notifyName(std::string(name) + SHARED_TELEMETRY_NOTIFY_SUFFIX),
+          _region(nullptr), _notify(nullptr), _writable(false) {}
+    ~SharedTelemetry() { close(); }
+
+    SharedTelemetry(const SharedTelemetry&) = delete;
+    SharedTelemetry& operator=(const SharedTelemetry&) = delete;
+
+    // Писатель: создать (или переиспользовать) область и проинициализировать заголовок
+    bool create();
+    // Читатель: подключиться к телеметрии на чтение и к уведомлениям на запись; false, если писатель
+    // ещё не запущен или версия/размер области не совпадают
+    bool open();
+    void close();
+    bool isOpen() const { return _region != nullptr; }
+
+    // Публикация снимка (только писатель). Без системных вызовов, пока никто не ждёт в wait().
+    // Изменение одних счётчиков передачи (tx*, packetsSent) ждущих не будит: они растут на каждом
+    // тике отправки каналов, а пробуждение должно означать новые данные
+    void publish(const SharedTelemetryData& data);
+    // Согласованное чтение снимка. false, если область не открыта
+    // или писатель не успел завершить запись за отведённые попытки
+    bool read(SharedTelemetryData& out) const;
+    // Текущее значение seqlock (растёт на 2 с каждой публикацией, 0 — ещё не было данных)
+    uint32_t sequence() const;
+
+    // Ожидание следующей публикации вместо опроса read()/sequence() по таймеру.
+    // kindMask — группы кадров, пришедших с прошлой публикации (TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_...)),
+    // TELEMETRY_NOTIFY_ANY — любая публикация. false — таймаут или область не открыта
+    TelemetryNotifyCursor cursor() const;
+    bool wait(TelemetryNotifyCursor& cursor, uint32_t kindMask, int timeoutMs) const;
+
+private:
+    bool mapNotify(bool create);
+
+    const char* _name;
+    std::string _notifyName;
+    SharedTelemetryRegion* _region;
+    TelemetryNotifyState* _notify;
+    bool _writable;
+};
@@ -0,0 +1,134 @@
+#include "telemetry_json.h"
+
+#include <chrono>
+#include <ctime>
+
+static void telemetry_json_two_digits(char* out, int v)
+{
+    out[0] = static_cast<char>('0' + v / 10);
+    out[1] = static_cast<char>('0' + v % 10);
+}
+
+uint32_t telemetry_json_time_of_day_ms()
+{
+    auto now = std::chrono::system_clock::now();
+    time_t t = std::chrono::system_clock::to_time_t(now);
+    int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    struct tm local;
+    localtime_r(&t, &local);
+    return static_cast<uint32_t>(((local.tm_hour * 60 + local.tm_min) * 60 + local.tm_sec) * 1000 + ms);
+}
+
+size_t telemetry_json_format_time(uint32_t timeOfDayMs, char* buf, size_t capacity)
+{
+    if (capacity < 13) {
+        return 0;
+    }
+    uint32_t seconds = timeOfDayMs / 1000;
+    uint32_t ms = timeOfDayMs % 1000;
+    telemetry_json_two_digits(buf, static_cast<int>(seconds / 3600 % 100));
+    buf[2] = ':';
+    telemetry_json_two_digits(buf + 3, static_cast<int>(seconds / 60 % 60));
+    buf[5] = ':';
+    telemetry_json_two_digits(buf + 6, static_cast<int>(seconds % 60));
+    buf[8] = '.';
+    buf[9] = static_cast<char>('0' + ms / 100);
+    telemetry_json_two_digits(buf + 10, static_cast<int>(ms % 100));
+    buf[12] = '\0';
+    return 12;
+}
+
+size_t telemetry_json_timestamp(char* buf, size_t capacity)
+{
+    return telemetry_json_format_time(telemetry_json_time_of_day_ms(), buf, capacity);
+}
+
+void telemetry_json_link(JsonWriter& w, const CrsfLinkCounters& link)
+{
+    w.raw("{\"rxFrames\":");
+    w.integer(link.rxFrames);
+    w.raw(",\"rxByType\":{");
+    for (unsigned int i = 0; i < CRSF_LINK_FRAME_KINDS; ++i) {
+        if (i > 0) {
+            w.raw(",");
+        }
+        w.raw("\"");
+        w.append(crsf_link_frame_kind_name(i));
+        w.raw("\":");
+        w.integer(link.rxFramesByKind[i]);
+    }
+    w.raw("},\"crcErrors\":");
+    w.integer(link.rxCrcErrors);
+    w.raw(",\"lengthRejects\":");
+    w.integer(link.rxLengthRejects);
+    w.raw(",\"resyncBytes\":");
+    w.integer(link.rxResyncBytes);
+    w.raw(",\"bufferResets\":");
+    w.integer(link.rxBufferResets);
+    w.raw(",\"txFrames\":");
+    w.integer(link.txFrames);
+    w.raw(",\"txDropped\":");
+    w.integer(link.txDropped);
+    w.raw(",\"txShortWrites\":");
+    w.integer(link.txShortWrites);
+    w.raw(",\"txBytes\":");
+    w.integer(link.txBytes);
+    w.raw("}");
+}
+
+size_t telemetry_json_encode(const SharedTelemetryData& data, const char* timestamp, char* buf, size_t capacity)
+{
+    JsonWriter w(buf, capacity);
+    w.raw("{\"linkUp\":");
+    w.boolean(data.linkUp);
+    w.raw(",\"lastReceive\":");
+    w.integer(data.lastReceive);
+    w.raw(",\"channels\":[");
+    for (int i = 0; i < 16; i++) {
+        if (i > 0) {
+            w.raw(",");
+        }
+        w.integer(data.channels[i]);
+    }
+    w.raw("],\"packetsReceived\":");
+    w.integer(data.packetsReceived);
+    w.raw(",\"packetsSent\":");
+    w.integer(data.packetsSent);
+    w.raw(",\"packetsLost\":");
+    w.integer(data.packetsLost);
+    // С широты и дальше прежний поток был в std::fixed, std::setprecision(6)
+    w.raw(",\"gps\":{\"latitude\":");
+    w.fixed(data.latitude);
+    w.raw(",\"longitude\":");
+    w.fixed(data.longitude);
+    w.raw(",\"altitude\":");
+    w.fixed(data.altitude);
+    w.raw(",\"speed\":");
+    w.fixed(data.speed);
+    w.raw("},\"battery\":{\"voltage\":");
+    w.fixed(data.voltage);
+    w.raw(",\"current\":");
+    w.fixed(data.current);
+    w.raw(",\"capacity\":");
+    w.fixed(data.capacity);
+    w.raw(",\"remaining\":");
+    w.integer(static_cast<int>(data.remaining));
+    w.raw("},\"attitude\":{\"roll\":");
+    w.fixed(data.roll);
+    w.raw(",\"pitch\":");
+    w.fixed(data.pitch);
+    w.raw(",\"yaw\":");
+    w.fixed(data.yaw);
+    w.raw("},\"attitudeRaw\":{\"roll\":");
+    w.integer(data.rollRaw);
+    w.raw(",\"pitch\":");
+    w.integer(data.pitchRaw);
+    w.raw(",\"yaw\":");
+    w.integer(data.yawRaw);
+    w.raw("},\"link\":");
+    telemetry_json_link(w, data.link);
+    w.raw(",\"timestamp\":\"");
+    w.append(timestamp);
+    w.raw("\",\"activePort\":\"UART Active\"}");
+    return w.ok() ? w.size() : 0;
+}
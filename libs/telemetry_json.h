@@ -0,0 +1,101 @@
+#pragma once
+
+// Кодировщик JSON телеметрии без выделения памяти: пишет в буфер вызывающего через std::to_chars
+// и заранее заготовленные фрагменты ключей вместо std::stringstream.
+// Вывод побайтно совпадает с прежним потоковым форматированием:
+//   general() — как поток по умолчанию (printf "%g", 6 значащих цифр),
+//   fixed()   — как std::fixed << std::setprecision(6) (printf "%.6f").
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "shared_telemetry.h"
+
+// Буфер, в который помещается любой снимок (даже десять double порядка 1e308 в %.6f)
+static const size_t TELEMETRY_JSON_MAX = 4608;
+// "HH:MM:SS.mmm" и завершающий ноль
+static const size_t TELEMETRY_TIMESTAMP_MAX = 16;
+
+class JsonWriter {
+public:
+    JsonWriter(char* buf, size_t capacity) : _begin(buf), _pos(buf), _end(buf + capacity), _overflow(false) {}
+
+    // Строковый литерал (фрагмент ключа) без strlen
+    template <size_t N>
+    void raw(const char (&s)[N]) { append(s, N - 1); }
+
+    void append(const char* s, size_t n)
+    {
+        if (static_cast<size_t>(_end - _pos) < n) {
+            _overflow = true;
+            return;
+        }
+        memcpy(_pos, s, n);
+        _pos += n;
+    }
+
+    void append(const char* s) { append(s, strlen(s)); }
+
+    void boolean(bool v)
+    {
+        if (v) {
+            raw("true");
+        } else {
+            raw("false");
+        }
+    }
+
+    template <typename T>
+    void integer(T v)
+    {
+        std::to_chars_result r = std::to_chars(_pos, _end, v);
+        advance(r);
+    }
+
+    void general(double v)
+    {
+        std::to_chars_result r = std::to_chars(_pos, _end, v, std::chars_format::general, 6);
+        advance(r);
+    }
+
+    void fixed(double v)
+    {
+        std::to_chars_result r = std::to_chars(_pos, _end, v, std::chars_format::fixed, 6);
+        advance(r);
+    }
+
+    size_t size() const { return static_cast<size_t>(_pos - _begin); }
+    bool ok() const { return !_overflow; }
+
+private:
+    void advance(const std::to_chars_result& r)
+    {
+        if (r.ec != std::errc()) {
+            _overflow = true;
+            return;
+        }
+        _pos = r.ptr;
+    }
+
+    char* _begin;
+    char* _pos;
+    char* _end;
+    bool _overflow;
+};
+
+// Местное время "HH:MM:SS.mmm" (как getCurrentTime через std::put_time) в buf; длина или 0
+size_t telemetry_json_timestamp(char* buf, size_t capacity);
+// То же по частям: миллисекунды от местной полуночи (так время идёт в бинарном кадре)
+// и их запись в виде "HH:MM:SS.mmm"
+uint32_t telemetry_json_time_of_day_ms();
+size_t telemetry_json_format_time(uint32_t timeOfDayMs, char* buf, size_t capacity);
+
+// Объект счётчиков линка: "link":{"rxFrames":..,"rxByType":{..},"crcErrors":..,...}
+// (ключ с запятой перед ним пишет вызывающий)
+void telemetry_json_link(JsonWriter& w, const CrsfLinkCounters& link);
+
+// JSON снимка из разделяемой памяти в формате crsf_api_interpreter (POST /api/telemetry).
+// Возвращает длину; 0, если буфер мал (TELEMETRY_JSON_MAX достаточно)
+size_t telemetry_json_encode(const SharedTelemetryData& data, const char* timestamp, char* buf, size_t capacity);
@@ -0,0 +1,159 @@
+#pragma once
+
+// Уведомление о новой телеметрии на futex: потребители блокируются до следующей публикации
+// вместо опроса по таймеру. Состояние — счётчики публикаций: общий и по группам принятых кадров
+// (CrsfLinkFrameKind). Ждущий одну группу спит на её слове, и ядро не будит его на кадры других типов;
+// ждущий несколько групп спит на общем слове и проверяет свои счётчики после пробуждения.
+//
+// Ждущие отмечаются в waiters, и post() без ждущих обходится без системного вызова —
+// писатель не платит за уведомления, пока их никто не ждёт. Режимы:
+//   TELEMETRY_NOTIFY_PROCESS — состояние в памяти процесса (CrsfSerial), futex с FUTEX_PRIVATE_FLAG;
+//   TELEMETRY_NOTIFY_SHARED — состояние в разделяемой памяти (SharedTelemetry), доступной читателям
+//     на запись: межпроцессный futex.
+//
+//   TelemetryNotifyCursor cursor = notify.cursor();
+//   while (running) {
+//       if (notify.wait(cursor, TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_ATTITUDE), 100)) { ... }
+//   }
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#include "crsf/link_counters.h"
+
+#define TELEMETRY_NOTIFY_ANY 0u                      // любая публикация (в том числе без кадров)
+#define TELEMETRY_NOTIFY_KIND(kind) (1u << (kind))   // маска группы CrsfLinkFrameKind
+
+static_assert(CRSF_LINK_FRAME_KINDS <= 32, "frame kinds must fit the notify mask");
+
+struct TelemetryNotifyState {
+    std::atomic<uint32_t> any;                           // публикаций всего
+    std::atomic<uint32_t> kinds[CRSF_LINK_FRAME_KINDS];  // публикаций с кадрами группы
+    std::atomic<uint32_t> waiters;                       // ждущих в futex
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex words must be plain 32-bit atomics");
+
+// Значения счётчиков, после которых ждать следующую публикацию
+struct TelemetryNotifyCursor {
+    uint32_t any;
+    uint32_t kinds[CRSF_LINK_FRAME_KINDS];
+};
+
+enum TelemetryNotifyMode {
+    TELEMETRY_NOTIFY_PROCESS,
+    TELEMETRY_NOTIFY_SHARED,
+};
+
+class TelemetryNotify {
+public:
+    TelemetryNotify(TelemetryNotifyState* state, TelemetryNotifyMode mode) : _state(state), _mode(mode) {}
+
+    // Писатель: публикация с кадрами групп kindMask (0 — без новых кадров, будит только ждущих любую)
+    void post(uint32_t kindMask)
+    {
+        for (unsigned int kind = 0; kind < CRSF_LINK_FRAME_KINDS; ++kind) {
+            if (kindMask & TELEMETRY_NOTIFY_KIND(kind)) {
+                _state->kinds[kind].fetch_add(1, std::memory_order_release);
+            }
+        }
+        _state->any.fetch_add(1, std::memory_order_release);
+
+        // Пара к fetch_add(waiters) в wait(): либо ждущий увидит новый счётчик, либо мы — ждущего
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_state->waiters.load(std::memory_order_relaxed) == 0) return;
+        for (unsigned int kind = 0; kind < CRSF_LINK_FRAME_KINDS; ++kind) {
+            if (kindMask & TELEMETRY_NOTIFY_KIND(kind)) {
+                futex(&_state->kinds[kind], FUTEX_WAKE, INT32_MAX, nullptr);
+            }
+        }
+        futex(&_state->any, FUTEX_WAKE, INT32_MAX, nullptr);
+    }
+
+    TelemetryNotifyCursor cursor() const
+    {
+        TelemetryNotifyCursor c;
+        for (unsigned int kind = 0; kind < CRSF_LINK_FRAME_KINDS; ++kind) {
+            c.kinds[kind] = _state->kinds[kind].load(std::memory_order_acquire);
+        }
+        c.any = _state->any.load(std::memory_order_acquire);
+        return c;
+    }
+
+    // Ждать публикацию групп kindMask (TELEMETRY_NOTIFY_ANY — любую) новее cursor.
+    // true — была, cursor сдвинут на текущее состояние; false — таймаут (timeoutMs < 0 — без ограничения)
+    bool wait(TelemetryNotifyCursor& cursor, uint32_t kindMask, int timeoutMs) const
+    {
+        kindMask &= (1u << CRSF_LINK_FRAME_KINDS) - 1;
+        bool single = kindMask != 0 && (kindMask & (kindMask - 1)) == 0;
+        std::atomic<uint32_t>* word = single ? &_state->kinds[__builtin_ctz(kindMask)] : &_state->any;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        for (;;) {
+            // Слово читаем до проверки: публикация после проверки изменит его, и futex не уснёт
+            uint32_t expected = word->load(std::memory_order_acquire);
+            if (changed(cursor, kindMask)) {
+                cursor = this->cursor();
+                return true;
+            }
+
+            struct timespec remaining;
+            struct timespec* timeout = nullptr;
+            if (timeoutMs >= 0) {
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+                remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+                if (remaining.tv_nsec < 0) {
+                    remaining.tv_sec -= 1;
+                    remaining.tv_nsec += 1000000000L;
+                }
+                if (remaining.tv_sec < 0) return false;
+                timeout = &remaining;
+            }
+
+            _state->waiters.fetch_add(1, std::memory_order_seq_cst);
+            if (word->load(std::memory_order_seq_cst) == expected) {
+                futex(word, FUTEX_WAIT, expected, timeout);
+            }
+            _state->waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    bool changed(const TelemetryNotifyCursor& cursor, uint32_t kindMask) const
+    {
+        if (kindMask == TELEMETRY_NOTIFY_ANY) {
+            return _state->any.load(std::memory_order_acquire) != cursor.any;
+        }
+        for (unsigned int kind = 0; kind < CRSF_LINK_FRAME_KINDS; ++kind) {
+            if ((kindMask & TELEMETRY_NOTIFY_KIND(kind)) &&
+                _state->kinds[kind].load(std::memory_order_acquire) != cursor.kinds[kind]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const struct timespec* timeout) const
+    {
+        if (_mode == TELEMETRY_NOTIFY_PROCESS) op |= FUTEX_PRIVATE_FLAG;
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+    }
+
+    TelemetryNotifyState* _state;
+    TelemetryNotifyMode _mode;
+};
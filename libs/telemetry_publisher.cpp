@@ -0,0 +1,175 @@
+#include "telemetry_publisher.h"
+
+#include <cmath>
+#include <cstring>
+
+// После ошибки отправки следующая попытка не раньше (не заваливаем лог и сеть при недоступном сервере)
+static const uint64_t TELEMETRY_PUBLISH_RETRY_MS = 200;
+
+// Счётчики передачи меняются на каждом такте отправки (и при упавшей связи — txDropped),
+// поэтому сами по себе кадр не вызывают: уходят вместе со следующим изменением или ключевым кадром
+static const uint64_t TELEMETRY_PUBLISH_TX_FIELDS =
+    (1ull << TELEMETRY_WIRE_PACKETS_SENT) |
+    (1ull << TELEMETRY_WIRE_LINK_TX_FRAMES) |
+    (1ull << TELEMETRY_WIRE_LINK_TX_DROPPED) |
+    (1ull << TELEMETRY_WIRE_LINK_TX_SHORT_WRITES) |
+    (1ull << TELEMETRY_WIRE_LINK_TX_BYTES);
+
+// Пороги изменения полей с плавающей точкой
+struct TelemetryPublishTolerance {
+    TelemetryWireFieldIndex field;
+    double epsilon;
+};
+
+static const TelemetryPublishTolerance TELEMETRY_PUBLISH_TOLERANCES[] = {
+    { TELEMETRY_WIRE_LATITUDE, 0.000001 },
+    { TELEMETRY_WIRE_LONGITUDE, 0.000001 },
+    { TELEMETRY_WIRE_ALTITUDE, 0.1 },
+    { TELEMETRY_WIRE_SPEED, 0.1 },
+    { TELEMETRY_WIRE_VOLTAGE, 0.01 },
+    { TELEMETRY_WIRE_CURRENT, 0.01 },
+    { TELEMETRY_WIRE_CAPACITY, 0.1 },
+    { TELEMETRY_WIRE_ROLL, 0.01 },
+    { TELEMETRY_WIRE_PITCH, 0.01 },
+    { TELEMETRY_WIRE_YAW, 0.01 },
+};
+
+static double telemetry_publish_value(const SharedTelemetryData& d, TelemetryWireFieldIndex field)
+{
+    switch (field) {
+    case TELEMETRY_WIRE_LATITUDE: return d.latitude;
+    case TELEMETRY_WIRE_LONGITUDE: return d.longitude;
+    case TELEMETRY_WIRE_ALTITUDE: return d.altitude;
+    case TELEMETRY_WIRE_SPEED: return d.speed;
+    case TELEMETRY_WIRE_VOLTAGE: return d.voltage;
+    case TELEMETRY_WIRE_CURRENT: return d.current;
+    case TELEMETRY_WIRE_CAPACITY: return d.capacity;
+    case TELEMETRY_WIRE_ROLL: return d.roll;
+    case TELEMETRY_WIRE_PITCH: return d.pitch;
+    case TELEMETRY_WIRE_YAW: return d.yaw;
+    default: return 0.0;
+    }
+}
+
+TelemetryPublisher::TelemetryPublisher()
+    : _coalesceMs(0),
+      _keyframeMs(1000),
+      _deltaFrames(true),
+      _synced(false),
+      _hasLatest(false),
+      _dirty(0),
+      _pending(false),
+      _pendingSinceMs(0),
+      _nowMs(0),
+      _lastKeyframeMs(0),
+      _retryAfterMs(0),
+      _framesSinceKeyframe(0),
+      _seq(0),
+      _updates(0),
+      _framesSent(0),
+      _keyframesSent(0),
+      _coalesced(0)
+{
+    memset(&_remote, 0, sizeof(_remote));
+    memset(&_latest, 0, sizeof(_latest));
+    memset(_fieldSeq, 0, sizeof(_fieldSeq));
+}
+
+uint64_t TelemetryPublisher::changedFields(const SharedTelemetryData& data) const
+{
+    if (!_synced) {
+        return TELEMETRY_WIRE_ALL_FIELDS;
+    }
+    uint64_t mask = telemetry_wire_changed_fields(data, _remote);
+    // Дрожание плавающей точки в пределах порога не считается изменением.
+    // Сравнение с тем, что есть у приёмника, а не с прошлым снимком: медленный дрейф всё равно уйдёт
+    for (const TelemetryPublishTolerance& t : TELEMETRY_PUBLISH_TOLERANCES) {
+        uint64_t bit = 1ull << t.field;
+        if ((mask & bit) &&
+            std::abs(telemetry_publish_value(data, t.field) - telemetry_publish_value(_remote, t.field)) <= t.epsilon) {
+            mask &= ~bit;
+        }
+    }
+    return mask;
+}
+
+bool TelemetryPublisher::keyframeDue() const
+{
+    return !_synced ||
+           _framesSinceKeyframe >= TELEMETRY_WIRE_KEYFRAME_INTERVAL ||
+           (_keyframeMs != 0 && _nowMs - _lastKeyframeMs >= _keyframeMs);
+}
+
+bool TelemetryPublisher::update(const SharedTelemetryData& data, uint64_t nowMs)
+{
+    ++_updates;
+    _latest = data;
+    _hasLatest = true;
+    _nowMs = nowMs;
+    _dirty = changedFields(data);
+
+    if ((_dirty & ~TELEMETRY_PUBLISH_TX_FIELDS) != 0) {
+        if (!_pending) {
+            _pending = true;
+            _pendingSinceMs = nowMs;
+        } else {
+            // Изменение внутри окна: уйдёт тем же кадром
+            ++_coalesced;
+        }
+    } else {
+        // Значения вернулись к тому, что есть у приёмника, или изменились только счётчики передачи —
+        // отправлять нечего (счётчики остаются в _dirty и уйдут со следующим кадром)
+        _pending = false;
+    }
+
+    if (nowMs < _retryAfterMs) {
+        return false;
+    }
+    if (keyframeDue()) {
+        return true;
+    }
+    return _pending && nowMs - _pendingSinceMs >= _coalesceMs;
+}
+
+size_t TelemetryPublisher::encode(uint32_t timeOfDayMs, uint8_t* buf, size_t capacity)
+{
+    if (!_hasLatest) {
+        return 0;
+    }
+    if (!_deltaFrames || keyframeDue()) {
+        return telemetry_wire_encode(_latest, _seq + 1, timeOfDayMs, nullptr, 0, buf, capacity);
+    }
+    return telemetry_wire_encode_fields(_latest, _seq + 1, timeOfDayMs, _dirty, _seq, buf, capacity);
+}
+
+void TelemetryPublisher::sent(bool success, uint64_t nowMs)
+{
+    bool keyframe = !_deltaFrames || keyframeDue();
+    ++_seq;
+    if (!success) {
+        _synced = false;
+        _retryAfterMs = nowMs + TELEMETRY_PUBLISH_RETRY_MS;
+        return;
+    }
+
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        if (_dirty & (1ull << i)) {
+            _fieldSeq[i] = _seq;
+        }
+    }
+    // Приёмник получил latest целиком (ключевой кадр) или поля из маски поверх своей копии
+    if (keyframe) {
+        _remote = _latest;
+        _lastKeyframeMs = nowMs;
+        _framesSinceKeyframe = 1;
+        ++_keyframesSent;
+    } else {
+        // Поля в пределах порога остаются у приёмника прежними
+        telemetry_wire_copy_fields(_remote, _latest, _dirty);
+        ++_framesSinceKeyframe;
+    }
+    _synced = true;
+    _dirty = 0;
+    _pending = false;
+    ++_framesSent;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+// Публикация телеметрии от crsf_api_interpreter к crsf_api_server с учётом изменений.
+// Хранит копию снимка, который уже есть у приёмника, и по каждому новому снимку
+// обновляет грязные биты полей (номера полей — как в бинарном кадре telemetry_wire).
+// Поля с плавающей точкой считаются изменившимися только сверх порога (GPS 1e-6°,
+// батарея 0.01, ориентация 0.01 — как прежний hasTelemetryChanged). Изменение одних
+// счётчиков передачи (packetsSent, link.tx*) кадр не вызывает — они уходят со следующим.
+//
+// Изменения за окно объединения (coalesceMs) уходят одним кадром с последними значениями;
+// ключевой кадр со всеми полями — первым, после ошибки отправки, раз в keyframeMs
+// и раз в TELEMETRY_WIRE_KEYFRAME_INTERVAL кадров.
+//
+// Использование (один поток отправки):
+//   if (pub.update(data, nowMs)) {
+//       size_t len = pub.encode(timeOfDayMs, buf, sizeof(buf));
+//       pub.sent(post(buf, len), nowMs);
+//   }
+
+#include <cstddef>
+#include <cstdint>
+
+#include "shared_telemetry.h"
+#include "telemetry_wire.h"
+
+class TelemetryPublisher {
+public:
+    TelemetryPublisher();
+
+    // Окно объединения: первое изменение ждёт столько мс, пока копятся остальные (0 — сразу)
+    void setCoalesceMs(uint32_t ms) { _coalesceMs = ms; }
+    // Период ключевого кадра (0 — только по счётчику кадров). Заодно служит пульсом при тишине
+    void setKeyframeMs(uint32_t ms) { _keyframeMs = ms; }
+    // false — каждый кадр полный (JSON не бывает разностным): грязные биты только решают, когда слать
+    void setDeltaFrames(bool enabled) { _deltaFrames = enabled; }
+
+    uint32_t coalesceMs() const { return _coalesceMs; }
+    uint32_t keyframeMs() const { return _keyframeMs; }
+
+    // Новый снимок (последний сохраняется для отправки). true — пора отправлять
+    bool update(const SharedTelemetryData& data, uint64_t nowMs);
+
+    // Что уйдёт следующим кадром
+    bool keyframeDue() const;
+    uint64_t dirtyFields() const { return _dirty; }
+    const SharedTelemetryData& latest() const { return _latest; }
+
+    // Бинарный кадр последнего снимка: ключевой или разностный только с грязными полями.
+    // Номер кадра — sequence() + 1. Длина; 0, если буфер мал (TELEMETRY_WIRE_MAX достаточно)
+    size_t encode(uint32_t timeOfDayMs, uint8_t* buf, size_t capacity);
+
+    // Итог отправки кадра: при успехе приёмник получил latest(), грязные биты сброшены;
+    // при ошибке следующий кадр будет ключевым
+    void sent(bool success, uint64_t nowMs);
+
+    // Номер кадра, в котором поле последний раз ушло изменившимся (0 — ещё не уходило)
+    uint32_t fieldSequence(size_t field) const { return field < TELEMETRY_WIRE_FIELDS ? _fieldSeq[field] : 0; }
+    // Номер последнего отправленного кадра
+    uint32_t sequence() const { return _seq; }
+
+    // Счётчики
+    uint64_t updates() const { return _updates; }
+    uint64_t framesSent() const { return _framesSent; }
+    uint64_t keyframesSent() const { return _keyframesSent; }
+    uint64_t coalesced() const { return _coalesced; }
+
+private:
+    // Грязные поля latest относительно снимка приёмника (с порогами для плавающей точки)
+    uint64_t changedFields(const SharedTelemetryData& data) const;
+
+    uint32_t _coalesceMs;
+    uint32_t _keyframeMs;
+    bool _deltaFrames;
+
+    SharedTelemetryData _remote;   // снимок у приёмника (база разностного кадра)
+    SharedTelemetryData _latest;   // последний снимок из разделяемой памяти
+    bool _synced;                  // _remote действителен (был успешный ключевой кадр)
+    bool _hasLatest;
+    uint64_t _dirty;               // грязные поля _latest относительно _remote
+    bool _pending;                 // есть неотправленные изменения
+    uint64_t _pendingSinceMs;      // первое из них (для окна объединения)
+    uint64_t _nowMs;               // время последнего update()
+    uint64_t _lastKeyframeMs;
+    uint64_t _retryAfterMs;        // после ошибки отправки не слать раньше
+    uint32_t _framesSinceKeyframe;
+
+    uint32_t _seq;                 // номер последнего отправленного кадра (база следующего)
+    uint32_t _fieldSeq[TELEMETRY_WIRE_FIELDS];
+
+    uint64_t _updates;
+    uint64_t _framesSent;
+    uint64_t _keyframesSent;
+    uint64_t _coalesced;
+};
@@ -0,0 +1,305 @@
+#include "telemetry_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+
+static uint64_t telemetry_stream_now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Пропуск JSON-значения начиная с pos (строка, объект, массив или скаляр); возвращает позицию за ним
+static size_t telemetry_skip_value(const std::string& json, size_t pos)
+{
+    int depth = 0;
+    bool inString = false;
+    for (; pos < json.size(); ++pos) {
+        char c = json[pos];
+        if (inString) {
+            if (c == '\\') {
+                ++pos;
+            } else if (c == '"') {
+                inString = false;
+                if (depth == 0) {
+                    return pos + 1;
+                }
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return pos; // конец объекта-владельца
+            }
+            if (--depth == 0) {
+                return pos + 1;
+            }
+        } else if (c == ',' && depth == 0) {
+            return pos;
+        }
+    }
+    return std::string::npos;
+}
+
+bool telemetry_split_json(const std::string& json, TelemetryFields& fields)
+{
+    fields.clear();
+    size_t pos = json.find_first_not_of(" \t\r\n");
+    if (pos == std::string::npos || json[pos] != '{') {
+        return false;
+    }
+    ++pos;
+    for (;;) {
+        pos = json.find_first_not_of(" \t\r\n,", pos);
+        if (pos == std::string::npos) {
+            return false;
+        }
+        if (json[pos] == '}') {
+            return true;
+        }
+        if (json[pos] != '"') {
+            return false;
+        }
+        size_t nameEnd = telemetry_skip_value(json, pos);
+        size_t colon = (nameEnd == std::string::npos) ? nameEnd : json.find(':', nameEnd);
+        if (colon == std::string::npos) {
+            return false;
+        }
+        size_t valueStart = json.find_first_not_of(" \t\r\n", colon + 1);
+        size_t valueEnd = (valueStart == std::string::npos) ? valueStart : telemetry_skip_value(json, valueStart);
+        if (valueEnd == std::string::npos) {
+            return false;
+        }
+        size_t trimmed = valueEnd;
+        while (trimmed > valueStart && (json[trimmed - 1] == ' ' || json[trimmed - 1] == '\n' ||
+                                        json[trimmed - 1] == '\r' || json[trimmed - 1] == '\t')) {
+            --trimmed;
+        }
+        fields.emplace_back(json.substr(pos + 1, nameEnd - pos - 2), json.substr(valueStart, trimmed - valueStart));
+        pos = valueEnd;
+    }
+}
+
+// Событие SSE: каждая строка данных со своим "data: "
+static std::shared_ptr<const std::string> telemetry_make_event(uint64_t seq, const std::string& json)
+{
+    auto event = std::make_shared<std::string>();
+    event->reserve(json.size() + 48);
+    *event += "id: ";
+    *event += std::to_string(seq);
+    *event += "\nevent: telemetry\ndata: ";
+    size_t start = 0;
+    size_t nl;
+    while ((nl = json.find('\n', start)) != std::string::npos) {
+        event->append(json, start, nl - start);
+        *event += "\ndata: ";
+        start = nl + 1;
+    }
+    event->append(json, start, std::string::npos);
+    *event += "\n\n";
+    return event;
+}
+
+TelemetryStreamHub::TelemetryStreamHub()
+{
+    _thread = std::thread([this]() { senderLoop(); });
+}
+
+TelemetryStreamHub::~TelemetryStreamHub()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+void TelemetryStreamHub::subscribe(const HttpRequest& req, HttpResponse& resp)
+{
+    if (_subscriberCount.load(std::memory_order_relaxed) >= MAX_SUBSCRIBERS) {
+        resp.set(503, "application/json", "{\"status\":\"error\",\"message\":\"Too many stream subscribers\"}");
+        return;
+    }
+
+    Subscriber sub;
+    std::string value;
+    if (req.queryParam("fields", value)) {
+        size_t pos = 0;
+        while (pos <= value.size()) {
+            size_t comma = value.find(',', pos);
+            if (comma == std::string::npos) {
+                comma = value.size();
+            }
+            if (comma > pos) {
+                sub.fields.push_back(value.substr(pos, comma - pos));
+            }
+            pos = comma + 1;
+        }
+        std::vector<std::string> sorted = sub.fields;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        for (const auto& f : sorted) {
+            sub.key += f;
+            sub.key += ',';
+        }
+    }
+    if (req.queryParam("rate", value)) {
+        long hz = strtol(value.c_str(), nullptr, 10);
+        if (hz <= 0 || hz > static_cast<long>(MAX_RATE_HZ)) {
+            resp.set(400, "application/json", "{\"status\":\"error\",\"message\":\"rate must be 1..1000\"}");
+            return;
+        }
+        sub.intervalNs = 1000000000ull / static_cast<uint64_t>(hz);
+    }
+
+    resp.contentType = "text/event-stream";
+    resp.body = "retry: 1000\n\n";
+    resp.onStream = [this, sub](std::shared_ptr<HttpStream> stream) mutable {
+        sub.stream = std::move(stream);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _incoming.push_back(std::move(sub));
+        }
+        _subscriberCount.fetch_add(1, std::memory_order_relaxed);
+        _cv.notify_one();
+    };
+}
+
+void TelemetryStreamHub::publish(std::string json)
+{
+    publish(std::make_shared<const std::string>(std::move(json)));
+}
+
+void TelemetryStreamHub::publish(std::shared_ptr<const std::string> snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _latest = std::move(snapshot);
+        ++_latestSeq;
+    }
+    _published.fetch_add(1, std::memory_order_relaxed);
+    _cv.notify_one();
+}
+
+std::string TelemetryStreamHub::statsJson() const
+{
+    char buf[192];
+    snprintf(buf, sizeof(buf), "{\"subscribers\":%zu,\"published\":%llu,\"serializations\":%llu,\"eventsSent\":%llu}",
+             subscribers(), static_cast<unsigned long long>(published()),
+             static_cast<unsigned long long>(serializations()), static_cast<unsigned long long>(eventsSent()));
+    return buf;
+}
+
+void TelemetryStreamHub::senderLoop()
+{
+    static const auto heartbeat = std::make_shared<const std::string>(":\n\n");
+    const uint64_t heartbeatNs = static_cast<uint64_t>(HEARTBEAT_MS) * 1000000ull;
+
+    // Список подписчиков принадлежит только этому потоку
+    std::vector<Subscriber> subs;
+    uint64_t seenSeq = 0;
+    uint64_t nextWakeNs = telemetry_stream_now_ns() + heartbeatNs;
+
+    for (;;) {
+        std::shared_ptr<const std::string> latest;
+        uint64_t seq;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            uint64_t now = telemetry_stream_now_ns();
+            auto wait = std::chrono::nanoseconds(nextWakeNs > now ? nextWakeNs - now : 0);
+            _cv.wait_for(lock, wait, [&]() { return _stop || _latestSeq != seenSeq || !_incoming.empty(); });
+            if (_stop) {
+                break;
+            }
+            for (auto& s : _incoming) {
+                s.lastWriteNs = now;
+                subs.push_back(std::move(s));
+            }
+            _incoming.clear();
+            latest = _latest;
+            seq = _latestSeq;
+        }
+        seenSeq = seq;
+
+        uint64_t now = telemetry_stream_now_ns();
+        nextWakeNs = now + heartbeatNs;
+        // Событие строится один раз на набор полей и раздаётся всем подписчикам этого набора
+        std::unordered_map<std::string, std::shared_ptr<const std::string>> events;
+        TelemetryFields split;
+        bool splitDone = false;
+
+        for (size_t i = 0; i < subs.size();) {
+            Subscriber& sub = subs[i];
+            bool alive = sub.stream->isOpen();
+            if (alive && latest && sub.sentSeq < seq) {
+                if (sub.intervalNs && now - sub.lastSentNs < sub.intervalNs) {
+                    // Предел частоты: отправим последний снимок, когда подойдёт срок
+                    nextWakeNs = std::min(nextWakeNs, sub.lastSentNs + sub.intervalNs);
+                    ++i;
+                    continue;
+                }
+                std::shared_ptr<const std::string>& event = events[sub.key];
+                if (!event) {
+                    if (sub.fields.empty()) {
+                        event = telemetry_make_event(seq, *latest);
+                    } else {
+                        if (!splitDone) {
+                            telemetry_split_json(*latest, split);
+                            splitDone = true;
+                        }
+                        std::string json = "{";
+                        for (const auto& field : split) {
+                            if (std::find(sub.fields.begin(), sub.fields.end(), field.first) == sub.fields.end()) {
+                                continue;
+                            }
+                            if (json.size() > 1) {
+                                json += ',';
+                            }
+                            json += '"';
+                            json += field.first;
+                            json += "\":";
+                            json += field.second;
+                        }
+                        json += '}';
+                        event = telemetry_make_event(seq, json);
+                    }
+                    _serializations.fetch_add(1, std::memory_order_relaxed);
+                }
+                alive = sub.stream->send(event);
+                if (alive) {
+                    sub.sentSeq = seq;
+                    sub.lastSentNs = now;
+                    sub.lastWriteNs = now;
+                    _eventsSent.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else if (alive && now - sub.lastWriteNs >= heartbeatNs) {
+                alive = sub.stream->send(heartbeat);
+                sub.lastWriteNs = now;
+            }
+            if (!alive) {
+                subs[i] = std::move(subs.back());
+                subs.pop_back();
+                _subscriberCount.fetch_sub(1, std::memory_order_relaxed);
+                continue;
+            }
+            nextWakeNs = std::min(nextWakeNs, sub.lastWriteNs + heartbeatNs);
+            ++i;
+        }
+    }
+
+    for (auto& sub : subs) {
+        sub.stream->close();
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& sub : _incoming) {
+        sub.stream->close();
+    }
+}
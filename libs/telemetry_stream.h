@@ -0,0 +1,86 @@
+#pragma once
+
+// Потоковая раздача телеметрии (Server-Sent Events) поверх HttpServer.
+// Источник публикует готовый JSON снимка один раз; отдельный поток рассылки
+// сериализует событие один раз на каждый набор полей и раздаёт один и тот же
+// буфер всем подписчикам без копирования. У каждого клиента свой предел частоты
+// (промежуточные снимки схлопываются — клиент получает последний) и свой набор полей.
+//
+//   GET /api/telemetry/stream                      — все поля, каждое обновление
+//   GET /api/telemetry/stream?fields=channels,gps  — только перечисленные поля верхнего уровня
+//   GET /api/telemetry/stream?rate=10              — не чаще 10 событий в секунду
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "http_server.h"
+
+// Поля верхнего уровня JSON-объекта: имя и готовый JSON значения
+using TelemetryFields = std::vector<std::pair<std::string, std::string>>;
+
+// Разбор JSON-объекта на поля верхнего уровня (значения не разбираются). false, если это не объект
+bool telemetry_split_json(const std::string& json, TelemetryFields& fields);
+
+class TelemetryStreamHub {
+public:
+    static const size_t MAX_SUBSCRIBERS = 64;
+    static const unsigned int MAX_RATE_HZ = 1000;
+    // Комментарий-пинг, если событий не было столько времени (держит прокси и выявляет мёртвых клиентов)
+    static const unsigned int HEARTBEAT_MS = 15000;
+
+    TelemetryStreamHub();
+    ~TelemetryStreamHub();
+
+    TelemetryStreamHub(const TelemetryStreamHub&) = delete;
+    TelemetryStreamHub& operator=(const TelemetryStreamHub&) = delete;
+
+    // Обработчик запроса подписки: разбирает fields/rate и открывает поток в resp.
+    // Свыше MAX_SUBSCRIBERS отвечает 503
+    void subscribe(const HttpRequest& req, HttpResponse& resp);
+
+    // Новый снимок телеметрии (JSON-объект). Дёшево: сериализация и рассылка в потоке хаба
+    void publish(std::string json);
+    // То же для уже общего буфера (без копирования: тот же буфер может отдаваться и на опрос)
+    void publish(std::shared_ptr<const std::string> json);
+
+    // Есть ли подписчики (источник может не готовить JSON впустую)
+    bool hasSubscribers() const { return _subscriberCount.load(std::memory_order_relaxed) > 0; }
+    size_t subscribers() const { return _subscriberCount.load(std::memory_order_relaxed); }
+    uint64_t published() const { return _published.load(std::memory_order_relaxed); }
+    uint64_t serializations() const { return _serializations.load(std::memory_order_relaxed); }
+    uint64_t eventsSent() const { return _eventsSent.load(std::memory_order_relaxed); }
+    std::string statsJson() const;
+
+private:
+    struct Subscriber {
+        std::shared_ptr<HttpStream> stream;
+        std::vector<std::string> fields;   // пусто — все поля
+        std::string key;                   // отсортированный список полей: общий буфер события
+        uint64_t intervalNs = 0;           // 0 — без ограничения частоты
+        uint64_t lastSentNs = 0;           // последнее событие (для предела частоты)
+        uint64_t lastWriteNs = 0;          // последняя запись в поток (событие или пинг)
+        uint64_t sentSeq = 0;              // последний отправленный снимок
+    };
+
+    void senderLoop();
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+    std::shared_ptr<const std::string> _latest;   // JSON последнего снимка
+    uint64_t _latestSeq = 0;
+    std::vector<Subscriber> _incoming;            // новые подписчики, забирает поток рассылки
+    bool _stop = false;
+    std::thread _thread;
+
+    std::atomic<size_t> _subscriberCount{0};
+    std::atomic<uint64_t> _published{0};
+    std::atomic<uint64_t> _serializations{0};
+    std::atomic<uint64_t> _eventsSent{0};
+};
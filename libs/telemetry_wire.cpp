@@ -0,0 +1,357 @@
+#include "telemetry_wire.h"
+
+#include <cstring>
+
+// Тип поля на проводе
+enum TelemetryWireKind {
+    WIRE_BOOL,
+    WIRE_U8,
+    WIRE_U32,
+    WIRE_U64,
+    WIRE_I32,
+    WIRE_I16,
+    WIRE_F64,
+};
+
+struct TelemetryWireField {
+    size_t offset; // смещение в SharedTelemetryData
+    TelemetryWireKind kind;
+};
+
+#define WIRE_FIELD(member, kind) { offsetof(SharedTelemetryData, member), kind }
+#define WIRE_CHANNEL(i) { offsetof(SharedTelemetryData, channels) + (i) * sizeof(int), WIRE_I32 }
+#define WIRE_RX_KIND(i) { offsetof(SharedTelemetryData, link.rxFramesByKind) + (i) * sizeof(uint32_t), WIRE_U32 }
+
+// Порядок полей — как в JSON; номер в таблице — номер бита в маске разностного кадра
+static const TelemetryWireField TELEMETRY_WIRE_TABLE[TELEMETRY_WIRE_FIELDS] = {
+    WIRE_FIELD(linkUp, WIRE_BOOL),
+    WIRE_FIELD(lastReceive, WIRE_U32),
+    WIRE_CHANNEL(0), WIRE_CHANNEL(1), WIRE_CHANNEL(2), WIRE_CHANNEL(3),
+    WIRE_CHANNEL(4), WIRE_CHANNEL(5), WIRE_CHANNEL(6), WIRE_CHANNEL(7),
+    WIRE_CHANNEL(8), WIRE_CHANNEL(9), WIRE_CHANNEL(10), WIRE_CHANNEL(11),
+    WIRE_CHANNEL(12), WIRE_CHANNEL(13), WIRE_CHANNEL(14), WIRE_CHANNEL(15),
+    WIRE_FIELD(packetsReceived, WIRE_U32),
+    WIRE_FIELD(packetsSent, WIRE_U32),
+    WIRE_FIELD(packetsLost, WIRE_U32),
+    WIRE_FIELD(latitude, WIRE_F64),
+    WIRE_FIELD(longitude, WIRE_F64),
+    WIRE_FIELD(altitude, WIRE_F64),
+    WIRE_FIELD(speed, WIRE_F64),
+    WIRE_FIELD(voltage, WIRE_F64),
+    WIRE_FIELD(current, WIRE_F64),
+    WIRE_FIELD(capacity, WIRE_F64),
+    WIRE_FIELD(remaining, WIRE_U8),
+    WIRE_FIELD(roll, WIRE_F64),
+    WIRE_FIELD(pitch, WIRE_F64),
+    WIRE_FIELD(yaw, WIRE_F64),
+    WIRE_FIELD(rollRaw, WIRE_I16),
+    WIRE_FIELD(pitchRaw, WIRE_I16),
+    WIRE_FIELD(yawRaw, WIRE_I16),
+    WIRE_FIELD(link.rxFrames, WIRE_U32),
+    WIRE_RX_KIND(0), WIRE_RX_KIND(1), WIRE_RX_KIND(2), WIRE_RX_KIND(3),
+    WIRE_RX_KIND(4), WIRE_RX_KIND(5), WIRE_RX_KIND(6),
+    WIRE_FIELD(link.rxCrcErrors, WIRE_U32),
+    WIRE_FIELD(link.rxLengthRejects, WIRE_U32),
+    WIRE_FIELD(link.rxResyncBytes, WIRE_U32),
+    WIRE_FIELD(link.rxBufferResets, WIRE_U32),
+    WIRE_FIELD(link.txFrames, WIRE_U32),
+    WIRE_FIELD(link.txDropped, WIRE_U32),
+    WIRE_FIELD(link.txShortWrites, WIRE_U32),
+    WIRE_FIELD(link.txBytes, WIRE_U64),
+};
+
+#undef WIRE_FIELD
+#undef WIRE_CHANNEL
+#undef WIRE_RX_KIND
+
+static_assert(TELEMETRY_WIRE_FIELDS < 64, "field mask is u64");
+static_assert(TELEMETRY_WIRE_LINK_TX_BYTES == TELEMETRY_WIRE_FIELDS - 1, "field indices follow the table");
+static_assert(TELEMETRY_WIRE_LINK_RX_KIND_0 + CRSF_LINK_FRAME_KINDS == TELEMETRY_WIRE_LINK_CRC_ERRORS,
+              "one field per frame kind");
+
+static size_t telemetry_wire_kind_size(TelemetryWireKind kind)
+{
+    switch (kind) {
+    case WIRE_BOOL:
+    case WIRE_U8:
+        return 1;
+    case WIRE_I16:
+        return 2;
+    case WIRE_U32:
+    case WIRE_I32:
+        return 4;
+    case WIRE_U64:
+    case WIRE_F64:
+        return 8;
+    }
+    return 0;
+}
+
+// Запись/чтение little-endian: на little-endian процессоре (x86, ARM Raspberry Pi) —
+// копирование фиксированной ширины, которое компилятор сводит к одной инструкции
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+template <typename T>
+static void telemetry_wire_put_as(uint8_t* out, uint64_t v)
+{
+    T t = static_cast<T>(v);
+    memcpy(out, &t, sizeof(t));
+}
+
+template <typename T>
+static uint64_t telemetry_wire_get_as(const uint8_t* in)
+{
+    T t;
+    memcpy(&t, in, sizeof(t));
+    return t;
+}
+#endif
+
+static void telemetry_wire_put(uint8_t* out, uint64_t v, size_t size)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    switch (size) {
+    case 1: telemetry_wire_put_as<uint8_t>(out, v); return;
+    case 2: telemetry_wire_put_as<uint16_t>(out, v); return;
+    case 4: telemetry_wire_put_as<uint32_t>(out, v); return;
+    case 8: telemetry_wire_put_as<uint64_t>(out, v); return;
+    }
+#endif
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+static uint64_t telemetry_wire_get(const uint8_t* in, size_t size)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    switch (size) {
+    case 1: return telemetry_wire_get_as<uint8_t>(in);
+    case 2: return telemetry_wire_get_as<uint16_t>(in);
+    case 4: return telemetry_wire_get_as<uint32_t>(in);
+    case 8: return telemetry_wire_get_as<uint64_t>(in);
+    }
+#endif
+    uint64_t v = 0;
+    for (size_t i = 0; i < size; ++i) {
+        v |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return v;
+}
+
+// Значение поля как беззнаковое целое нужной ширины (double — его битовое представление)
+static uint64_t telemetry_wire_load(const SharedTelemetryData& data, const TelemetryWireField& field)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&data) + field.offset;
+    switch (field.kind) {
+    case WIRE_BOOL: {
+        bool v;
+        memcpy(&v, p, sizeof(v));
+        return v ? 1 : 0;
+    }
+    case WIRE_U8:
+        return *p;
+    case WIRE_I16: {
+        int16_t v;
+        memcpy(&v, p, sizeof(v));
+        return static_cast<uint16_t>(v);
+    }
+    case WIRE_U32: {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    case WIRE_I32: {
+        int32_t v;
+        memcpy(&v, p, sizeof(v));
+        return static_cast<uint32_t>(v);
+    }
+    case WIRE_U64:
+    case WIRE_F64: {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    }
+    return 0;
+}
+
+static void telemetry_wire_store(SharedTelemetryData& data, const TelemetryWireField& field, uint64_t raw)
+{
+    uint8_t* p = reinterpret_cast<uint8_t*>(&data) + field.offset;
+    switch (field.kind) {
+    case WIRE_BOOL: {
+        bool v = raw != 0;
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case WIRE_U8:
+        *p = static_cast<uint8_t>(raw);
+        break;
+    case WIRE_I16: {
+        int16_t v = static_cast<int16_t>(static_cast<uint16_t>(raw));
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case WIRE_U32: {
+        uint32_t v = static_cast<uint32_t>(raw);
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case WIRE_I32: {
+        int32_t v = static_cast<int32_t>(static_cast<uint32_t>(raw));
+        memcpy(p, &v, sizeof(v));
+        break;
+    }
+    case WIRE_U64:
+    case WIRE_F64:
+        memcpy(p, &raw, sizeof(raw));
+        break;
+    }
+}
+
+uint64_t telemetry_wire_changed_fields(const SharedTelemetryData& data, const SharedTelemetryData& base)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        const TelemetryWireField& field = TELEMETRY_WIRE_TABLE[i];
+        if (telemetry_wire_load(data, field) != telemetry_wire_load(base, field)) {
+            mask |= 1ull << i;
+        }
+    }
+    return mask;
+}
+
+void telemetry_wire_copy_fields(SharedTelemetryData& dst, const SharedTelemetryData& src, uint64_t mask)
+{
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        if (mask & (1ull << i)) {
+            telemetry_wire_store(dst, TELEMETRY_WIRE_TABLE[i], telemetry_wire_load(src, TELEMETRY_WIRE_TABLE[i]));
+        }
+    }
+}
+
+// Общая запись кадра: delta == false — ключевой (все поля, mask игнорируется)
+static size_t telemetry_wire_write(const SharedTelemetryData& data, uint32_t seq, uint32_t timeOfDayMs,
+                                   bool delta, uint64_t mask, uint32_t baseSeq, uint8_t* buf, size_t capacity)
+{
+    mask = delta ? (mask & TELEMETRY_WIRE_ALL_FIELDS) : TELEMETRY_WIRE_ALL_FIELDS;
+    size_t size = TELEMETRY_WIRE_HEADER_SIZE;
+    if (delta) {
+        size += TELEMETRY_WIRE_DELTA_HEADER_SIZE;
+    }
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        if (mask & (1ull << i)) {
+            size += telemetry_wire_kind_size(TELEMETRY_WIRE_TABLE[i].kind);
+        }
+    }
+    if (capacity < size) {
+        return 0;
+    }
+
+    telemetry_wire_put(buf, TELEMETRY_WIRE_MAGIC, 2);
+    buf[2] = TELEMETRY_WIRE_VERSION;
+    buf[3] = delta ? TELEMETRY_WIRE_FLAG_DELTA : 0;
+    telemetry_wire_put(buf + 4, seq, 4);
+    telemetry_wire_put(buf + 8, timeOfDayMs, 4);
+    uint8_t* out = buf + TELEMETRY_WIRE_HEADER_SIZE;
+    if (delta) {
+        telemetry_wire_put(out, baseSeq, 4);
+        telemetry_wire_put(out + 4, mask, 8);
+        out += TELEMETRY_WIRE_DELTA_HEADER_SIZE;
+    }
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        if (mask & (1ull << i)) {
+            const TelemetryWireField& field = TELEMETRY_WIRE_TABLE[i];
+            size_t fieldSize = telemetry_wire_kind_size(field.kind);
+            telemetry_wire_put(out, telemetry_wire_load(data, field), fieldSize);
+            out += fieldSize;
+        }
+    }
+    return size;
+}
+
+size_t telemetry_wire_encode(const SharedTelemetryData& data, uint32_t seq, uint32_t timeOfDayMs,
+                             const SharedTelemetryData* base, uint32_t baseSeq,
+                             uint8_t* buf, size_t capacity)
+{
+    uint64_t mask = base ? telemetry_wire_changed_fields(data, *base) : TELEMETRY_WIRE_ALL_FIELDS;
+    return telemetry_wire_write(data, seq, timeOfDayMs, base != nullptr, mask, baseSeq, buf, capacity);
+}
+
+size_t telemetry_wire_encode_fields(const SharedTelemetryData& data, uint32_t seq, uint32_t timeOfDayMs,
+                                    uint64_t mask, uint32_t baseSeq, uint8_t* buf, size_t capacity)
+{
+    return telemetry_wire_write(data, seq, timeOfDayMs, true, mask, baseSeq, buf, capacity);
+}
+
+TelemetryWireStatus telemetry_wire_decode(const uint8_t* buf, size_t len, TelemetryWireFrame& frame)
+{
+    if (len < TELEMETRY_WIRE_HEADER_SIZE || telemetry_wire_get(buf, 2) != TELEMETRY_WIRE_MAGIC) {
+        return TELEMETRY_WIRE_MALFORMED;
+    }
+    if (buf[2] != TELEMETRY_WIRE_VERSION) {
+        return TELEMETRY_WIRE_BAD_VERSION;
+    }
+    uint8_t flags = buf[3];
+    if (flags & ~TELEMETRY_WIRE_FLAG_DELTA) {
+        return TELEMETRY_WIRE_MALFORMED;
+    }
+    uint32_t seq = static_cast<uint32_t>(telemetry_wire_get(buf + 4, 4));
+    uint32_t timeOfDayMs = static_cast<uint32_t>(telemetry_wire_get(buf + 8, 4));
+    const uint8_t* in = buf + TELEMETRY_WIRE_HEADER_SIZE;
+    const uint8_t* end = buf + len;
+
+    uint64_t mask = TELEMETRY_WIRE_ALL_FIELDS;
+    SharedTelemetryData data;
+    if (flags & TELEMETRY_WIRE_FLAG_DELTA) {
+        if (static_cast<size_t>(end - in) < TELEMETRY_WIRE_DELTA_HEADER_SIZE) {
+            return TELEMETRY_WIRE_MALFORMED;
+        }
+        uint32_t baseSeq = static_cast<uint32_t>(telemetry_wire_get(in, 4));
+        uint64_t deltaMask = telemetry_wire_get(in + 4, 8);
+        in += TELEMETRY_WIRE_DELTA_HEADER_SIZE;
+        if (deltaMask & ~mask) {
+            return TELEMETRY_WIRE_MALFORMED;
+        }
+        if (!frame.valid || frame.seq != baseSeq) {
+            return TELEMETRY_WIRE_BASE_MISMATCH;
+        }
+        mask = deltaMask;
+        data = frame.data;
+    } else {
+        memset(&data, 0, sizeof(data));
+    }
+
+    for (size_t i = 0; i < TELEMETRY_WIRE_FIELDS; ++i) {
+        if (!(mask & (1ull << i))) {
+            continue;
+        }
+        const TelemetryWireField& field = TELEMETRY_WIRE_TABLE[i];
+        size_t fieldSize = telemetry_wire_kind_size(field.kind);
+        if (static_cast<size_t>(end - in) < fieldSize) {
+            return TELEMETRY_WIRE_MALFORMED;
+        }
+        telemetry_wire_store(data, field, telemetry_wire_get(in, fieldSize));
+        in += fieldSize;
+    }
+    if (in != end) {
+        return TELEMETRY_WIRE_MALFORMED;
+    }
+
+    frame.data = data;
+    frame.seq = seq;
+    frame.timeOfDayMs = timeOfDayMs;
+    frame.valid = true;
+    return TELEMETRY_WIRE_OK;
+}
+
+const char* telemetry_wire_status_text(TelemetryWireStatus status)
+{
+    switch (status) {
+    case TELEMETRY_WIRE_OK: return "ok";
+    case TELEMETRY_WIRE_MALFORMED: return "Malformed telemetry frame";
+    case TELEMETRY_WIRE_BAD_VERSION: return "Unsupported telemetry frame version";
+    case TELEMETRY_WIRE_BASE_MISMATCH: return "Delta base mismatch, keyframe required";
+    }
+    return "unknown";
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+// Компактный бинарный кадр телеметрии (альтернатива JSON между crsf_api_interpreter и crsf_api_server).
+// Фиксированная раскладка, little-endian, версия в заголовке. Поля те же, что в JSON, в том же порядке.
+//
+// Заголовок (12 байт):
+//   u16 magic 0x5743 ("CW") | u8 version | u8 flags | u32 seq | u32 timeOfDayMs (мс от местной полуночи)
+// Ключевой кадр (flags = 0): все поля подряд (TELEMETRY_WIRE_PAYLOAD_SIZE байт).
+// Разностный кадр (TELEMETRY_WIRE_FLAG_DELTA):
+//   u32 baseSeq | u64 mask (бит i — поле i изменилось) | только изменившиеся поля по порядку.
+// Разностный кадр применяется только к снимку с seq == baseSeq; иначе приёмник ждёт ключевой.
+//
+// Поля: u8 linkUp, u32 lastReceive, i32 channels[16], u32 packetsReceived/Sent/Lost,
+// f64 latitude/longitude/altitude/speed/voltage/current/capacity, u8 remaining,
+// f64 roll/pitch/yaw, i16 rollRaw/pitchRaw/yawRaw, счётчики линка: u32 rxFrames, u32 rxFramesByKind[7],
+// u32 crcErrors/lengthRejects/resyncBytes/bufferResets/txFrames/txDropped/txShortWrites, u64 txBytes.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "shared_telemetry.h"
+
+#define TELEMETRY_WIRE_CONTENT_TYPE "application/x-crsf-telemetry"
+#define TELEMETRY_WIRE_MAGIC 0x5743
+#define TELEMETRY_WIRE_VERSION 2
+#define TELEMETRY_WIRE_FLAG_DELTA 0x01
+
+static const size_t TELEMETRY_WIRE_HEADER_SIZE = 12;
+static const size_t TELEMETRY_WIRE_DELTA_HEADER_SIZE = 12; // baseSeq + mask
+static const size_t TELEMETRY_WIRE_FIELDS = 51;
+static const size_t TELEMETRY_WIRE_PAYLOAD_SIZE = 236;
+// Наибольший кадр (разностный со всеми полями)
+static const size_t TELEMETRY_WIRE_MAX = TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_DELTA_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE;
+// Отправитель шлёт ключевой кадр не реже чем раз в столько кадров
+static const uint32_t TELEMETRY_WIRE_KEYFRAME_INTERVAL = 50;
+
+// Номера полей (бит в маске разностного кадра)
+enum TelemetryWireFieldIndex {
+    TELEMETRY_WIRE_LINK_UP = 0,
+    TELEMETRY_WIRE_LAST_RECEIVE = 1,
+    TELEMETRY_WIRE_CHANNEL_0 = 2,         // channels[i] — TELEMETRY_WIRE_CHANNEL_0 + i
+    TELEMETRY_WIRE_PACKETS_RECEIVED = 18,
+    TELEMETRY_WIRE_PACKETS_SENT = 19,
+    TELEMETRY_WIRE_PACKETS_LOST = 20,
+    TELEMETRY_WIRE_LATITUDE = 21,
+    TELEMETRY_WIRE_LONGITUDE = 22,
+    TELEMETRY_WIRE_ALTITUDE = 23,
+    TELEMETRY_WIRE_SPEED = 24,
+    TELEMETRY_WIRE_VOLTAGE = 25,
+    TELEMETRY_WIRE_CURRENT = 26,
+    TELEMETRY_WIRE_CAPACITY = 27,
+    TELEMETRY_WIRE_REMAINING = 28,
+    TELEMETRY_WIRE_ROLL = 29,
+    TELEMETRY_WIRE_PITCH = 30,
+    TELEMETRY_WIRE_YAW = 31,
+    TELEMETRY_WIRE_ROLL_RAW = 32,
+    TELEMETRY_WIRE_PITCH_RAW = 33,
+    TELEMETRY_WIRE_YAW_RAW = 34,
+    TELEMETRY_WIRE_LINK_RX_FRAMES = 35,
+    TELEMETRY_WIRE_LINK_RX_KIND_0 = 36,   // link.rxFramesByKind[i] — TELEMETRY_WIRE_LINK_RX_KIND_0 + i
+    TELEMETRY_WIRE_LINK_CRC_ERRORS = 43,
+    TELEMETRY_WIRE_LINK_LENGTH_REJECTS = 44,
+    TELEMETRY_WIRE_LINK_RESYNC_BYTES = 45,
+    TELEMETRY_WIRE_LINK_BUFFER_RESETS = 46,
+    TELEMETRY_WIRE_LINK_TX_FRAMES = 47,
+    TELEMETRY_WIRE_LINK_TX_DROPPED = 48,
+    TELEMETRY_WIRE_LINK_TX_SHORT_WRITES = 49,
+    TELEMETRY_WIRE_LINK_TX_BYTES = 50,
+};
+
+// Маска всех полей (ключевой кадр)
+static const uint64_t TELEMETRY_WIRE_ALL_FIELDS = (1ull << TELEMETRY_WIRE_FIELDS) - 1;
+
+// Состояние приёмника: последний собранный снимок (база для следующего разностного кадра)
+struct TelemetryWireFrame {
+    SharedTelemetryData data;
+    uint32_t seq;
+    uint32_t timeOfDayMs;
+    bool valid;
+};
+
+enum TelemetryWireStatus {
+    TELEMETRY_WIRE_OK,
+    TELEMETRY_WIRE_MALFORMED,      // короткий кадр, неверный magic или длина
+    TELEMETRY_WIRE_BAD_VERSION,    // версия формата не поддерживается
+    TELEMETRY_WIRE_BASE_MISMATCH,  // разностный кадр к другому снимку — нужен ключевой
+};
+
+// Кодирование кадра в buf (TELEMETRY_WIRE_MAX достаточно). base == nullptr — ключевой кадр,
+// иначе разностный относительно base с номером baseSeq. Возвращает длину; 0, если буфер мал
+size_t telemetry_wire_encode(const SharedTelemetryData& data, uint32_t seq, uint32_t timeOfDayMs,
+                             const SharedTelemetryData* base, uint32_t baseSeq,
+                             uint8_t* buf, size_t capacity);
+
+// Разностный кадр с заданной маской полей (отправитель сам решает, какие поля изменились).
+// Поля вне маски приёмник берёт из снимка baseSeq
+size_t telemetry_wire_encode_fields(const SharedTelemetryData& data, uint32_t seq, uint32_t timeOfDayMs,
+                                    uint64_t mask, uint32_t baseSeq, uint8_t* buf, size_t capacity);
+
+// Маска полей data, побитово отличающихся от base (-0.0 и NaN тоже считаются изменением)
+uint64_t telemetry_wire_changed_fields(const SharedTelemetryData& data, const SharedTelemetryData& base);
+
+// Копирование полей из mask (то, что делает приёмник с разностным кадром)
+void telemetry_wire_copy_fields(SharedTelemetryData& dst, const SharedTelemetryData& src, uint64_t mask);
+
+// Декодирование кадра поверх frame (для разностного frame должен содержать базу).
+// При ошибке frame не меняется
+TelemetryWireStatus telemetry_wire_decode(const uint8_t* buf, size_t len, TelemetryWireFrame& frame);
+
+// Текстовое описание статуса для ответа об ошибке
+const char* telemetry_wire_status_text(TelemetryWireStatus status);
@@ -1,16 +1,23 @@
 #include "config.h"
-#include <thread>
 #include <string>
 #include <fstream>
 #include <unistd.h>
 #include <cstdio>
 #include <sstream>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <sys/inotify.h>
 
 #include "crsf/crsf.h"
 #include "libs/rpi_hal.h"
 #include "libs/joystick.h"
+#include "libs/event_loop.h"
+#include "libs/shared_telemetry.h"
+#include "libs/command_ring.h"
 #include "libs/crsf/CrsfSerial.h"
+#include "libs/http_server.h"
+#include "libs/latency_metrics.h"
 
 // g_ignore_telemetry определена в globals.cpp
 
@@ -21,15 +28,164 @@ std::string getWorkMode() {
     return "manual"; // По умолчанию ручной режим управления
 }
 
+static const char* COMMAND_FILE_PATH = "/tmp/crsf_command.txt";
+static const char* COMMAND_FILE_NAME = "crsf_command.txt";
+
+// Кольцо команд в разделяемой памяти (api_interpreter, pybind)
+static CommandRingServer commandRing;
+
+// Применение одной команды (из кольца или из файла)
+static void applyCommand(const CommandRecord& rec) {
+#if USE_LATENCY_METRICS == true
+  uint64_t ingestNs = LATENCY_NOW();
+  LATENCY_RECORD(LATENCY_CMD_QUEUE, rec.timestampNs, ingestNs); // только из кольца: у команд из файла метки нет
+  if (rec.type == CMD_SET_CHANNELS || rec.type == CMD_SEND_CHANNELS) {
+    LATENCY_START(LATENCY_CMD_TO_TX, ingestNs);
+  }
+#endif
+  switch (rec.type) {
+    case CMD_SET_CHANNELS:
+      for (unsigned int ch = 1; ch <= 16; ch++) {
+        if (rec.mask & (1u << (ch - 1))) {
+          crsfSetChannel(ch, rec.values[ch - 1]);
+        }
+      }
+      break;
+    case CMD_SEND_CHANNELS:
+      // Команда sendChannels больше не нужна - отправка происходит автоматически
+      // по таймеру в основном цикле, но оставляем для совместимости
+      crsfSendChannels();
+      commandRing.markSent();
+      break;
+    case CMD_SET_MODE:
+      // Режим управляется через pybind модуль, здесь только для совместимости
+      break;
+    default:
+      break;
+  }
+}
+
+// Обработка команд из файла (прежний канал, для совместимости со старыми клиентами)
+static void processCommandFile() {
+  std::ifstream cmdFile(COMMAND_FILE_PATH);
+  if (!cmdFile.is_open()) {
+    return;
+  }
+  std::string cmd;
+  CommandRecord rec;
+  // Обрабатываем все команды из файла (многострочный формат)
+  while (std::getline(cmdFile, cmd)) {
+    if (command_from_text(cmd, rec)) {
+      applyCommand(rec);
+    }
+  }
+  cmdFile.close();
+  // Удаляем файл после обработки всех команд
+  remove(COMMAND_FILE_PATH);
+}
+
+#if USE_CRSF_SEND == true
+// Преобразуем оси джойстика [-32767..32767] в CRSF [1000..2000]
+static int axisToUs(int16_t v) {
+  // нормируем к [-1..1]
+  const float nf = (v >= 0) ? (static_cast<float>(v) / 32767.0f)
+                            : (static_cast<float>(v) / 32768.0f);
+  // диапазон [1000..2000]
+  float us = 1500.0f + nf * 500.0f;
+  int ius = static_cast<int>(us + 0.5f);
+  if (ius < 1000) ius = 1000;
+  if (ius > 2000) ius = 2000;
+  return ius;
+}
+
+// Обработка событий джойстика (вызывается, когда fd джойстика готов к чтению)
+static void processJoystick() {
+  // Читать события джойстика (неблокирующе)
+  js_poll();
+
+  // Обработка осей джойстика только в режиме joystick
+  std::string mode = getWorkMode();
+  if (mode == "joystick") {
+    int16_t ax0 = 0, ax1 = 0, ax2 = 0, ax3 = 0;
+    bool axis0_ok = js_get_axis(0, ax0);
+    bool axis1_ok = js_get_axis(1, ax1);
+    bool axis2_ok = js_get_axis(2, ax2);
+    bool axis3_ok = js_get_axis(3, ax3);
+
+    if (axis0_ok) crsfSetChannel(1, axisToUs(ax2)); // Roll
+    if (axis1_ok) crsfSetChannel(2, axisToUs(-ax3)); // Pitch
+    if (axis2_ok) crsfSetChannel(3, axisToUs(-ax1)); // Throttle
+    if (axis3_ok) crsfSetChannel(4, axisToUs(ax0)); // Yaw
+  }
+}
+#endif
+
+// Заполнение снимка телеметрии из активного CRSF
+// Все поля берутся из одного согласованного снимка CrsfSerial::snapshot()
+static void fillSharedTelemetry(CrsfSerial& crsf, SharedTelemetryData& shared) {
+  const TelemetrySnapshot snap = crsf.snapshot();
+  shared.linkUp = snap.linkUp;
+  shared.lastReceive = snap.lastReceive;
+
+  // Каналы
+  for (int i = 0; i < 16; i++) {
+    shared.channels[i] = snap.channels[i];
+  }
+
+  // Счётчики протокола и их сводка в прежних полях
+  shared.link = crsf.getLinkCounters();
+  shared.packetsReceived = shared.link.rxFrames;
+  shared.packetsSent = shared.link.txFrames;
+  shared.packetsLost = shared.link.rxCrcErrors;
+
+  // GPS
+  shared.latitude = snap.gps.latitude / 10000000.0;
+  shared.longitude = snap.gps.longitude / 10000000.0;
+  shared.altitude = snap.gps.altitude - 1000;
+  shared.speed = snap.gps.groundspeed / 10.0;
+
+  // Батарея
+  shared.voltage = snap.batteryVoltage;
+  shared.current = snap.batteryCurrent;
+  shared.capacity = snap.batteryCapacity;
+  shared.remaining = snap.batteryRemaining;
+
+  // Положение
+  shared.roll = snap.attitudeRoll;
+  shared.pitch = snap.attitudePitch;
+  shared.yaw = snap.attitudeYaw;
+
+  // Сырые значения attitude
+  shared.rollRaw = snap.rawAttitudeRoll;
+  shared.pitchRaw = snap.rawAttitudePitch;
+  shared.yawRaw = snap.rawAttitudeYaw;
+
+  // Время приёма кадров (CLOCK_MONOTONIC, нс)
+  shared.channelsTimeNs = snap.channelsTimeNs;
+  shared.linkStatisticsTimeNs = snap.linkStatisticsTimeNs;
+  shared.gpsTimeNs = snap.gpsTimeNs;
+  shared.batteryTimeNs = snap.batteryTimeNs;
+  shared.attitudeTimeNs = snap.attitudeTimeNs;
+}
+
 // Главная точка входа Linux-приложения для Raspberry Pi
 // Полная замена Arduino setup()/loop()
 int main(int argc, char* argv[]) {
+    int metricsPort = METRICS_PORT;
+    const char* capturePath = nullptr;
     // Парсинг аргументов командной строки
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--notel") {
             g_ignore_telemetry = true;
             std::cout << "[INFO] Running in NO-TELEMETRY mode. Safety checks disabled." << std::endl;
+        } else if (arg.compare(0, 15, "--metrics-port=") == 0) {
+            metricsPort = atoi(arg.c_str() + 15);
+        } else if (arg.compare(0, 7, "--port=") == 0) {
+            // Порт CRSF вместо CRSF_PORT_PRIMARY (PTY симулятора полётника: bench/pty_latency)
+            crsfSetPort(arg.c_str() + 7);
+        } else if (arg.compare(0, 10, "--capture=") == 0) {
+            capturePath = argv[i] + 10;
         }
     }
 #if USE_CRSF_RECV == true
@@ -38,12 +194,18 @@ int main(int argc, char* argv[]) {
 #if USE_CRSF_SEND == true
   crsfInitSend(); // Запуск CRSF передачи
 #endif
+  if (capturePath != nullptr) {
+    // Сырой поток порта с метками времени — для разбора после полёта
+    if (crsfStartCapture(capturePath)) {
+      printf("✓ Запись потока CRSF: %s\n", capturePath);
+    } else {
+      printf("Предупреждение: не удалось открыть файл записи %s\n", capturePath);
+    }
+  }
 
   //БЕСПОЛЕЗНО: устаревший Arduino код - закомментированная неиспользуемая переменная
   // флаг доступности (не используется, можно удалить/раскомментировать при необходимости)
   // bool isCan = true;
-  const uint32_t crsfSendPeriodMs = 10; // ~100 Гц отправка каналов для реалтайма
-  uint32_t lastSendMs = 0;
   // Инициализация джойстика (не критично, если недоступен)
   if (js_open("/dev/input/js0")) {
     printf("Джойстик подключен: %d осей, %d кнопок\n", js_num_axes(), js_num_buttons());
@@ -51,194 +213,164 @@ int main(int argc, char* argv[]) {
     printf("Предупреждение: джойстик недоступен, работа без управления\n");
   }
 
-  // Структура для записи телеметрии в файл (для Python обертки)
-  struct SharedTelemetryData {
-    bool linkUp;
-    uint32_t lastReceive;
-    int channels[16];
-    // Статистика связи - отключена (поля оставлены для совместимости)
-    uint32_t packetsReceived;
-    uint32_t packetsSent;
-    uint32_t packetsLost;
-    double latitude;
-    double longitude;
-    double altitude;
-    double speed;
-    double voltage;
-    double current;
-    double capacity;
-    uint8_t remaining;
-    double roll;
-    double pitch;
-    double yaw;
-    int16_t rollRaw;
-    int16_t pitchRaw;
-    int16_t yawRaw;
-  };
-  
-  // Запускаем поток для периодической записи телеметрии в файл
-  std::thread telemetryWriterThread([&]() {
+  // Телеметрия для Python обертки и API интерпретатора: область в разделяемой памяти.
+  // Публикуется из основного цикла сразу после приёма кадров и на каждом тике таймера.
+  // Неизменившийся снимок не публикуется. Ждущих в SharedTelemetry::wait() будят только новые данные:
+  // снимок, где изменились одни счётчики передачи (растут на каждом тике), публикуется без пробуждения
+  static SharedTelemetry sharedTelemetry;
+  if (sharedTelemetry.create()) {
+    printf("✓ Телеметрия публикуется в разделяемую память /dev/shm%s\n", SHARED_TELEMETRY_NAME);
+  } else {
+    printf("Предупреждение: не удалось создать разделяемую память телеметрии\n");
+  }
+  auto publishTelemetry = []() {
     CrsfSerial* crsf = static_cast<CrsfSerial*>(crsfGetActive());
-    if (crsf == nullptr) return;
-    
-    while (true) {
-      SharedTelemetryData shared;
-      
-      shared.linkUp = crsf->isLinkUp();
-      shared.lastReceive = crsf->_lastReceive;
-      
-      // Каналы
-      for (int i = 0; i < 16; i++) {
-        shared.channels[i] = crsf->getChannel(i + 1);
-      }
-      
-      // Статистика связи - отключена
-      shared.packetsReceived = 0;
-      shared.packetsSent = 0;
-      shared.packetsLost = 0;
-      
-      // GPS
-      const crsf_sensor_gps_t* gps = crsf->getGpsSensor();
-      if (gps) {
-        shared.latitude = gps->latitude / 10000000.0;
-        shared.longitude = gps->longitude / 10000000.0;
-        shared.altitude = gps->altitude - 1000;
-        shared.speed = gps->groundspeed / 10.0;
-      }
-      
-      // Батарея
-      shared.voltage = crsf->getBatteryVoltage();
-      shared.current = crsf->getBatteryCurrent();
-      shared.capacity = crsf->getBatteryCapacity();
-      shared.remaining = crsf->getBatteryRemaining();
-      
-      // Положение
-      shared.roll = crsf->getAttitudeRoll();
-      shared.pitch = crsf->getAttitudePitch();
-      shared.yaw = crsf->getAttitudeYaw();
-      
-      // Сырые значения attitude
-      shared.rollRaw = crsf->getRawAttitudeRoll();
-      shared.pitchRaw = crsf->getRawAttitudePitch();
-      shared.yawRaw = crsf->getRawAttitudeYaw();
-      
-      // Записываем в файл
-      std::ofstream file("/tmp/crsf_telemetry.dat", std::ios::binary);
-      if (file.is_open()) {
-        file.write(reinterpret_cast<const char*>(&shared), sizeof(SharedTelemetryData));
-        file.close();
-      }
-      
-      rpi_delay_ms(20); // Обновляем каждые 20мс для реалтайма
-    }
-  });
-  telemetryWriterThread.detach();
-  
-  printf("✓ Поток записи телеметрии запущен для Python обертки\n");
+    if (crsf == nullptr || !sharedTelemetry.isOpen()) return;
+    static SharedTelemetryData lastPublished;
+    SharedTelemetryData shared;
+    memset(&shared, 0, sizeof(shared)); // обнуляем выравнивание, чтобы снимки сравнивались memcmp
+    fillSharedTelemetry(*crsf, shared);
+    if (sharedTelemetry.sequence() != 0 && memcmp(&shared, &lastPublished, sizeof(shared)) == 0) return;
+    sharedTelemetry.publish(shared);
+    memcpy(&lastPublished, &shared, sizeof(shared));
+    LATENCY_FINISH(LATENCY_RX_TO_PUBLISH, LATENCY_NOW());
+  };
 
 
 
-  // Главный цикл
-  for (;;) {
+#if USE_LATENCY_METRICS == true
+  // Гистограммы задержек горячего пути для Prometheus: отдельный рабочий поток HTTP,
+  // основной цикл только пишет в гистограммы без блокировок
+  static HttpServer metricsServer([](const HttpRequest& req, HttpResponse& resp) {
+    if (req.path == "/metrics" && req.method == "GET") {
+      resp.set(200, "text/plain; version=0.0.4", g_latency.prometheus());
+    } else {
+      resp.set(404, "text/plain", "Not Found\n");
+    }
+  }, 1);
+  if (metricsPort > 0) {
+    if (metricsServer.listen(metricsPort) && metricsServer.start()) {
+      printf("✓ Метрики задержек: http://0.0.0.0:%d/metrics\n", metricsPort);
+    } else {
+      printf("Предупреждение: не удалось открыть порт метрик %d\n", metricsPort);
+    }
+  }
+#else
+  (void)metricsPort;
+#endif
+
+  // Главный цикл: реактор на epoll вместо непрерывного опроса.
+  // Процесс спит, пока не придут данные UART, события джойстика, новые команды
+  // или не сработает таймер отправки каналов (timerfd, ~100 Гц)
+  EventLoop loop;
+  if (!loop.isOpen()) {
+    printf("Ошибка: не удалось создать epoll\n");
+    return 1;
+  }
+
 #if USE_CRSF_RECV == true
-    loop_ch();
+  // UART: loop_ch() вызывается только когда в порту есть данные.
+  // Отключённый порт (USB UART) закрывается, тик переоткрывает его и подписывается заново
+  int uartFd = crsfGetRecvFd();
+  auto onUartReady = [&]() { loop_ch(); publishTelemetry(); };
+  auto onUartHangup = [&]() {
+    printf("Предупреждение: порт CRSF отключен, ожидание переподключения\n");
+    uartFd = -1;
+    crsfCloseRecvPort();
+  };
+  if (uartFd >= 0) {
+    loop.add(uartFd, onUartReady, onUartHangup);
+  } else {
+    printf("Предупреждение: порт CRSF не открыт, приём отключен\n");
+  }
 #endif
 
-    // Обработка команд из файла (от Python обертки)
-    std::ifstream cmdFile("/tmp/crsf_command.txt");
-    if (cmdFile.is_open()) {
-      std::string cmd;
-      // Обрабатываем все команды из файла (многострочный формат)
-      while (std::getline(cmdFile, cmd)) {
-        if (cmd.find("setChannels") == 0) {
-          // Формат: setChannels 1=1500 2=1600 3=1700 ...
-          std::istringstream iss(cmd);
-          std::string token;
-          iss >> token; // пропускаем "setChannels"
-          while (iss >> token) {
-            size_t pos = token.find('=');
-            if (pos != std::string::npos) {
-              unsigned int ch = std::stoi(token.substr(0, pos));
-              int value = std::stoi(token.substr(pos + 1));
-              if (ch >= 1 && ch <= 16 && value >= 1000 && value <= 2000) {
-                crsfSetChannel(ch, value);
-              }
-            }
-          }
-        } else if (cmd.find("setChannel") == 0) {
-          unsigned int ch;
-          int value;
-          if (sscanf(cmd.c_str(), "setChannel %u %d", &ch, &value) == 2) {
-            if (ch >= 1 && ch <= 16 && value >= 1000 && value <= 2000) {
-              crsfSetChannel(ch, value);
-            }
-          }
-        } else if (cmd == "sendChannels") {
-          // Команда sendChannels больше не нужна - отправка происходит автоматически
-          // через processSend() в основном цикле, но оставляем для совместимости
-          // (просто триггерим отправку через processSend)
-          crsfSendChannels();
-        } else if (cmd.find("setMode") == 0) {
-          std::string mode = cmd.substr(8); // "setMode " = 8 символов
-          if (mode == "joystick" || mode == "manual") {
-            // Режим сохраняется в глобальной переменной workMode
-            // (управляется через pybind модуль, но для совместимости оставляем)
+  // Канал команд: кольцо в разделяемой памяти с eventfd-звонком.
+  // Команды применяются сразу по звонку, не дожидаясь тика
+  if (commandRing.create()) {
+    loop.add(commandRing.doorbellFd(), [&]() {
+      if (commandRing.drain(applyCommand) > 0) {
+        publishTelemetry();
+      }
+    });
+    loop.add(commandRing.listenFd(), []() { commandRing.acceptClients(); });
+    printf("✓ Кольцо команд в разделяемой памяти /dev/shm%s\n", COMMAND_RING_NAME);
+  } else {
+    printf("Предупреждение: не удалось создать кольцо команд, только файл команд\n");
+  }
+
+  // Прежний канал команд: inotify на /tmp, файл команд обрабатывается после закрытия его писателем
+  int cmdFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (cmdFd >= 0 && inotify_add_watch(cmdFd, "/tmp", IN_CLOSE_WRITE | IN_MOVED_TO) >= 0) {
+    loop.add(cmdFd, [cmdFd]() {
+      alignas(struct inotify_event) char buf[4096];
+      bool commandFileChanged = false;
+      ssize_t len;
+      while ((len = read(cmdFd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + len;) {
+          const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+          if (ev->len > 0 && strcmp(ev->name, COMMAND_FILE_NAME) == 0) {
+            commandFileChanged = true;
           }
+          p += sizeof(struct inotify_event) + ev->len;
         }
       }
-      cmdFile.close();
-      // Удаляем файл после обработки всех команд
-      remove("/tmp/crsf_command.txt");
-    }
+      if (commandFileChanged) {
+        processCommandFile();
+      }
+    });
+  } else {
+    printf("Предупреждение: inotify недоступен, команды из файла не принимаются\n");
+  }
+  processCommandFile(); // Команды, записанные до запуска
 
 #if USE_CRSF_SEND == true
-    uint32_t currentMillis = rpi_millis();
-
-    // Читать события джойстика (неблокирующе)
-    js_poll();
-
-    // Преобразуем оси джойстика [-32767..32767] в CRSF [1000..2000]
-    auto axisToUs = [](int16_t v) -> int {
-      // нормируем к [-1..1]
-      const float nf = (v >= 0) ? (static_cast<float>(v) / 32767.0f)
-                                : (static_cast<float>(v) / 32768.0f);
-      // диапазон [1000..2000]
-      float us = 1500.0f + nf * 500.0f;
-      int ius = static_cast<int>(us + 0.5f);
-      if (ius < 1000) ius = 1000;
-      if (ius > 2000) ius = 2000;
-      return ius;
-    };
-
-    // Обработка осей джойстика только в режиме joystick
-    std::string mode = getWorkMode();
-    if (mode == "joystick") {
-      int16_t ax0 = 0, ax1 = 0, ax2 = 0, ax3 = 0;
-      bool axis0_ok = js_get_axis(0, ax0);
-      bool axis1_ok = js_get_axis(1, ax1);
-      bool axis2_ok = js_get_axis(2, ax2);
-      bool axis3_ok = js_get_axis(3, ax3);
-      
-      if (axis0_ok) crsfSetChannel(1, axisToUs(ax2)); // Roll
-      if (axis1_ok) crsfSetChannel(2, axisToUs(-ax3)); // Pitch
-      if (axis2_ok) crsfSetChannel(3, axisToUs(-ax1)); // Throttle
-      if (axis3_ok) crsfSetChannel(4, axisToUs(ax0)); // Yaw
-    }
+  // Отключённый джойстик закрывается, тик раз в секунду пробует открыть его снова
+  auto onJoystickHangup = []() {
+    printf("Предупреждение: джойстик отключен, ожидание переподключения\n");
+    js_close();
+  };
+  int jsFd = js_get_fd();
+  if (jsFd >= 0) {
+    loop.add(jsFd, processJoystick, onJoystickHangup);
+  }
+  uint32_t lastJoystickOpenMs = rpi_millis();
+#endif
 
-    // Асинхронная отправка RC-каналов с частотой ~100 Гц для реалтайма
-    // processSend() отправляет пакет только если были изменения каналов (флаг _needSendPacket)
-    // или периодически, если нужно поддерживать связь
-    if (currentMillis - lastSendMs >= crsfSendPeriodMs) {
-      lastSendMs = currentMillis;
-      crsfSendChannels(); // Вызывает processSend() внутри
+  // Периодический тик от таймера ядра: отправка RC-каналов и проверка таймаутов приёма
+  const uint32_t crsfSendPeriodMs = 10; // ~100 Гц отправка каналов для реалтайма
+  int tickFd = loop.addTimer(crsfSendPeriodMs, [&]() {
+#if USE_CRSF_RECV == true
+    crsfCheckTimeouts();
+    // Активный порт мог смениться (onLinkDown) — переподписываемся на новый fd
+    int fd = crsfGetRecvFd();
+    if (fd != uartFd) {
+      if (uartFd >= 0) loop.remove(uartFd);
+      uartFd = fd;
+      if (uartFd >= 0) loop.add(uartFd, onUartReady, onUartHangup);
     }
-
-
 #endif
-    //БЕСПОЛЕЗНО: закомментированный код
-    // Реалтайм без задержек - максимальная скорость обработки
-    // rpi_delay_ms(0); // Полностью убираем задержку для реалтайма
+#if USE_CRSF_SEND == true
+    if (js_get_fd() < 0 && rpi_millis() - lastJoystickOpenMs >= 1000) {
+      lastJoystickOpenMs = rpi_millis();
+      if (js_open("/dev/input/js0")) {
+        printf("Джойстик подключен: %d осей, %d кнопок\n", js_num_axes(), js_num_buttons());
+        loop.add(js_get_fd(), processJoystick, onJoystickHangup);
+      }
+    }
+    // processSend() отправляет пакет каналов; периодичность задаёт timerfd
+    crsfSendChannels();
+    commandRing.markSent();
+#endif
+    // Изменения каналов командами и состояние линка видны читателям не позже следующего тика
+    publishTelemetry();
+  });
+  if (tickFd < 0) {
+    printf("Ошибка: не удалось создать timerfd\n");
+    return 1;
   }
 
+  loop.run();
+
   return 0;
 }
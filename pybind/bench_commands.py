@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Бенчмарк канала команд Python -> crsf_io_rpi
+
+Сравниваются три пути:
+  file    - прежний файл /tmp/crsf_command.txt (строка на команду, открыть/дописать/закрыть)
+  ring    - кольцо команд, crsf_native.set_channel: одна команда на вызов
+  batch   - кольцо команд, crsf_native.push_channels: пачка строк каналов из массива NumPy без GIL
+
+crsf_io_rpi запускается на псевдотерминале (как bench/pty_latency) с --notel: отправка каналов
+не ждёт линка, полётник не нужен. Выход порта вычитывается отдельным потоком.
+
+Замеры:
+  команд/с  - за --duration секунд. Для кольца - применённые crsf_io_rpi (command_stats),
+              для файла - записанные: основной цикл читает файл по закрытию и удаляет,
+              строки, дописанные между чтением и удалением, теряются
+  задержка  - от вызова до появления значения пробного канала в телеметрии
+              (TelemetryView.wait), p50/p90/p99/max в мкс
+
+Области /dev/shm общие с рабочим crsf_io_rpi: другой его экземпляр запущен быть не должен.
+
+    python bench_commands.py [--bin ../crsf_io_rpi] [--duration 3] [--samples 300] [--batch 64]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import threading
+import time
+
+import numpy as np
+
+import crsf_native
+
+COMMAND_FILE = "/tmp/crsf_command.txt"
+
+
+def start_target(binary):
+    """Запустить crsf_io_rpi на slave-стороне PTY; вернуть процесс, master fd и поток чтения"""
+    master, slave = os.openpty()
+    port = os.ttyname(slave)
+    proc = subprocess.Popen([binary, "--port=" + port, "--metrics-port=0", "--notel"],
+                            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    os.close(slave)
+    stop = threading.Event()
+
+    def drain():
+        while not stop.is_set():
+            try:
+                if not os.read(master, 4096):
+                    break
+            except OSError:
+                break
+
+    reader = threading.Thread(target=drain, daemon=True)
+    reader.start()
+    return proc, master, stop
+
+
+def wait_ready(view, timeout=5.0):
+    """Дождаться телеметрии и подключения к кольцу команд"""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if view.wait(timeout=0.1) and crsf_native.command_stats()["attached"]:
+            return True
+    return False
+
+
+def file_command(channel, value):
+    with open(COMMAND_FILE, "a") as f:
+        f.write(f"setChannel {channel} {value}\n")
+
+
+def ring_command(channel, value):
+    crsf_native.set_channel(channel, value)
+
+
+def make_batch_command(probe):
+    row = np.zeros(16, dtype=np.int32)
+
+    def batch_command(channel, value):
+        row[channel - 1] = value
+        crsf_native.push_channels(row)
+        row[channel - 1] = 0
+
+    return batch_command
+
+
+def measure_latency(view, send, probe, samples):
+    """Задержка вызов -> значение в телеметрии, мкс; второй элемент - число потерянных команд"""
+    latencies = []
+    lost = 0
+    channels = view.channels
+    for i in range(samples):
+        value = 1100 + (i * 37) % 800
+        if channels[probe - 1] == value:
+            value += 1
+        view.update()
+        t0 = time.monotonic_ns()
+        send(probe, value)
+        deadline = time.monotonic() + 0.5
+        while channels[probe - 1] != value:
+            if time.monotonic() > deadline:
+                lost += 1
+                break
+            view.wait(timeout=0.05)
+        else:
+            latencies.append((time.monotonic_ns() - t0) / 1000.0)
+    return latencies, lost
+
+
+def measure_throughput(send_many, duration):
+    """send_many() ставит порцию команд и возвращает их число. Вернуть (вызвано/с, применено/с)"""
+    applied0 = crsf_native.command_stats()["commandsApplied"]
+    sent = 0
+    start = time.monotonic()
+    while time.monotonic() - start < duration:
+        sent += send_many()
+    elapsed = time.monotonic() - start
+    time.sleep(0.05)  # дать основному циклу разобрать хвост
+    applied = crsf_native.command_stats()["commandsApplied"] - applied0
+    return sent / elapsed, applied / elapsed
+
+
+def report(name, throughput, latencies, lost):
+    sent, applied = throughput
+    line = f"{name:<8} sent/s {sent:>10.0f}"
+    if applied > 0:
+        line += f"  applied/s {applied:>10.0f}"
+    print(line)
+    if latencies:
+        p = np.percentile(latencies, [50, 90, 99])
+        print(f"{'':<8} latency us  p50 {p[0]:.1f}  p90 {p[1]:.1f}  p99 {p[2]:.1f}  max {max(latencies):.1f}"
+              f"  lost {lost}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Команды Python -> crsf_io_rpi: файл против кольца")
+    parser.add_argument("--bin", default=os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                                      "..", "crsf_io_rpi"))
+    parser.add_argument("--duration", type=float, default=3.0, help="секунд на замер пропускной способности")
+    parser.add_argument("--samples", type=int, default=300, help="замеров задержки на путь")
+    parser.add_argument("--batch", type=int, default=64, help="строк каналов в пачке push_channels")
+    parser.add_argument("--probe-channel", type=int, default=8)
+    args = parser.parse_args()
+
+    proc, master, stop = start_target(args.bin)
+    try:
+        view = crsf_native.TelemetryView()
+        if not wait_ready(view):
+            print("Ошибка: crsf_io_rpi не опубликовал телеметрию или кольцо команд", file=sys.stderr)
+            return 1
+        probe = args.probe_channel
+        print(f"target   {args.bin} --notel, probe channel {probe}, batch {args.batch}")
+
+        counter = [0]
+
+        def file_many():
+            counter[0] += 1
+            file_command(probe, 1100 + counter[0] % 800)
+            return 1
+
+        def ring_many():
+            counter[0] += 1
+            ring_command(probe, 1100 + counter[0] % 800)
+            return 1
+
+        batch = np.zeros((args.batch, 16), dtype=np.int32)
+        batch[:, probe - 1] = 1100 + np.arange(args.batch) % 800
+
+        def batch_many():
+            if crsf_native.push_channels(batch):
+                return args.batch
+            time.sleep(0)  # кольцо заполнено: уступить процессор потребителю
+            return 0
+
+        report("file", measure_throughput(file_many, args.duration),
+               *measure_latency(view, file_command, probe, args.samples))
+        report("ring", measure_throughput(ring_many, args.duration),
+               *measure_latency(view, ring_command, probe, args.samples))
+        report("batch", measure_throughput(batch_many, args.duration),
+               *measure_latency(view, make_batch_command(probe), probe, args.samples))
+    finally:
+        stop.set()
+        proc.terminate()
+        proc.wait()
+        os.close(master)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
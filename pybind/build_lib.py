@@ -24,9 +24,14 @@ class get_pybind_include(object):
 crsf_sources = [
     'src/crsf_bindings.cpp',
     os.path.join(project_root, 'libs/crsf/CrsfSerial.cpp'),
+    os.path.join(project_root, 'libs/crsf/capture.cpp'),
     os.path.join(project_root, 'libs/crsf/crc8.cpp'),
+    os.path.join(project_root, 'libs/crsf/channel_codec.cpp'),
     os.path.join(project_root, 'libs/SerialPort.cpp'),
     os.path.join(project_root, 'libs/rpi_hal.cpp'),
+    os.path.join(project_root, 'libs/shared_telemetry.cpp'),
+    os.path.join(project_root, 'libs/command_ring.cpp'),
+    os.path.join(project_root, 'libs/latency_metrics.cpp'),
 ]
 
 # Директории с заголовками
@@ -37,7 +37,7 @@ class CRSFWrapper:
     Универсальная Python обертка для CRSF
     
     Автоматически определяет, что использовать:
-    - Если запущен crsf_io_rpi (файл /tmp/crsf_telemetry.dat существует) -> использует pybind
+    - Если запущен crsf_io_rpi (разделяемая память /dev/shm/crsf_telemetry существует) -> использует pybind
     - Если запущен api_server -> использует API
     - Программа не знает, через что работает - единый интерфейс
     """
@@ -92,12 +92,12 @@ class CRSFWrapper:
         Автоматическая инициализация CRSF
         
         Автоматически определяет, что использовать:
-        1. Проверяет наличие файла /tmp/crsf_telemetry.dat (crsf_io_rpi запущен) -> pybind
+        1. Проверяет наличие разделяемой памяти /dev/shm/crsf_telemetry (crsf_io_rpi запущен) -> pybind
         2. Если файла нет, пробует подключиться к API серверу -> API
         3. Программа не знает, через что работает - единый интерфейс
         """
         # Шаг 1: Проверяем, запущен ли crsf_io_rpi (pybind режим)
-        telemetry_file = "/tmp/crsf_telemetry.dat"
+        telemetry_file = "/dev/shm/crsf_telemetry"
         if os.path.exists(telemetry_file) and PYBIND_AVAILABLE:
             try:
                 # Файл существует, значит crsf_io_rpi запущен - используем pybind
@@ -183,6 +183,21 @@ class CRSFWrapper:
         else:
             raise RuntimeError("Неизвестный backend")
     
+    def telemetry_view(self):
+        """
+        Телеметрия без копий (только pybind режим)
+
+        Returns:
+            crsf_native.TelemetryView: view.channels (int32[16]) и view.data (структурный массив) -
+            NumPy-представления над снимком; view.wait(timeout) ждёт новый снимок без GIL
+            и обновляет их на месте
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        if self._backend != 'pybind':
+            raise RuntimeError("TelemetryView доступен только в pybind режиме (crsf_io_rpi)")
+        return crsf_native.TelemetryView()
+    
     def set_work_mode(self, mode: str):
         """
         Установить режим работы
@@ -263,6 +278,34 @@ class CRSFWrapper:
         else:
             raise RuntimeError("Неизвестный backend")
     
+    def update_channels(self, updates: Dict[int, int], send: bool = False):
+        """
+        Установить несколько каналов одной командой
+
+        Args:
+            updates: {номер канала (1-16): значение (1000-2000)}
+            send: сразу отправить пакет каналов (в той же пачке команд)
+        """
+        if not self._initialized:
+            raise RuntimeError("CRSF не инициализирован. Вызовите auto_init() сначала.")
+        
+        for channel, value in updates.items():
+            if not (1 <= channel <= 16):
+                raise ValueError(f"Номер канала должен быть от 1 до 16, получено: {channel}")
+            if not (1000 <= value <= 2000):
+                raise ValueError(f"Значение канала должно быть от 1000 до 2000, получено: {value}")
+        
+        if self._backend == 'api':
+            for channel, value in updates.items():
+                self._api_wrapper.set_channel(channel, value)
+            if send:
+                self._api_wrapper.send_channels()
+        elif self._backend == 'pybind':
+            if not crsf_native.push_channel_updates(list(updates.keys()), list(updates.values()), send):
+                raise RuntimeError("Очередь команд crsf_io_rpi переполнена")
+        else:
+            raise RuntimeError("Неизвестный backend")
+    
     def send_channels(self):
         """Отправить пакет каналов"""
         if not self._initialized:
@@ -1,16 +1,25 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <vector>
 #include <string>
 #include <mutex>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
-#include <fstream>
 #include <cstdint>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
 #include "../crsf/crsf.h"
 #include "../libs/crsf/CrsfSerial.h"
+#include "../libs/shared_telemetry.h"
+#include "../libs/command_ring.h"
 
 namespace py = pybind11;
 
@@ -18,6 +27,8 @@ namespace py = pybind11;
 static CrsfSerial* crsfInstance = nullptr;
 static std::mutex telemetryMutex;
 static std::string workMode = "manual"; // joystick, manual - по умолчанию ручной режим
+static SharedTelemetry sharedTelemetry; // Телеметрия от crsf_io_rpi (только чтение)
+static CommandRingClient commandRing;   // Команды в crsf_io_rpi; файл команд — резервный канал
 
 // Структура для телеметрии
 struct TelemetryData {
@@ -42,6 +53,12 @@ struct TelemetryData {
     int16_t rollRaw = 0;
     int16_t pitchRaw = 0;
     int16_t yawRaw = 0;
+    // Время приёма кадров (CLOCK_MONOTONIC, нс; сравнимо с time.monotonic_ns() в Python)
+    uint64_t channelsTimeNs = 0;
+    uint64_t linkStatisticsTimeNs = 0;
+    uint64_t gpsTimeNs = 0;
+    uint64_t batteryTimeNs = 0;
+    uint64_t attitudeTimeNs = 0;
     std::string timestamp;
 };
 
@@ -84,43 +101,15 @@ void autoInitCrsfInstance() {
     }
 }
 
-// Структура для чтения данных из файла (совместима с записью из main.cpp)
-struct SharedTelemetryData {
-    bool linkUp;
-    uint32_t lastReceive;
-    int channels[16];
-    uint32_t packetsReceived;
-    uint32_t packetsSent;
-    uint32_t packetsLost;
-    double latitude;
-    double longitude;
-    double altitude;
-    double speed;
-    double voltage;
-    double current;
-    double capacity;
-    uint8_t remaining;
-    double roll;
-    double pitch;
-    double yaw;
-    int16_t rollRaw;
-    int16_t pitchRaw;
-    int16_t yawRaw;
-};
-
-// Получение телеметрии из файла (безопасный способ для межпроцессного взаимодействия)
+// Получение телеметрии из разделяемой памяти (безопасный способ для межпроцессного взаимодействия)
 TelemetryData getTelemetry() {
     std::lock_guard<std::mutex> lock(telemetryMutex);
     TelemetryData data;
     
-    // Читаем данные из файла, созданного основным приложением
-    std::ifstream file("/tmp/crsf_telemetry.dat", std::ios::binary);
-    if (file.is_open() && file.good()) {
+    // Область создаётся основным приложением; подключаемся один раз и дальше читаем без системных вызовов
+    if (sharedTelemetry.isOpen() || sharedTelemetry.open()) {
         SharedTelemetryData shared;
-        file.read(reinterpret_cast<char*>(&shared), sizeof(SharedTelemetryData));
-        file.close();
-        
-        if (file.gcount() == sizeof(SharedTelemetryData)) {
+        if (sharedTelemetry.sequence() != 0 && sharedTelemetry.read(shared)) {
             // Копируем данные из разделяемой структуры
             data.linkUp = shared.linkUp;
             data.lastReceive = shared.lastReceive;
@@ -142,6 +131,11 @@ TelemetryData getTelemetry() {
             data.rollRaw = shared.rollRaw;
             data.pitchRaw = shared.pitchRaw;
             data.yawRaw = shared.yawRaw;
+            data.channelsTimeNs = shared.channelsTimeNs;
+            data.linkStatisticsTimeNs = shared.linkStatisticsTimeNs;
+            data.gpsTimeNs = shared.gpsTimeNs;
+            data.batteryTimeNs = shared.batteryTimeNs;
+            data.attitudeTimeNs = shared.attitudeTimeNs;
             data.activePort = "UART Active";
         } else {
             data.activePort = "No Connection";
@@ -154,17 +148,225 @@ TelemetryData getTelemetry() {
     return data;
 }
 
-// Установка режима работы через файл команд
+// Телеметрия без копий в объекты Python: NumPy-представления над снимком из разделяемой памяти.
+// Снимок (SharedTelemetryData) живёт в объекте и обновляется на месте методами update()/wait(),
+// поэтому массивы, полученные один раз, всегда показывают последний принятый снимок:
+//
+//   view = crsf_native.TelemetryView()
+//   ch = view.channels            # int32[16], представление, не копия
+//   while view.wait(0.1):         # ждёт новую публикацию без GIL (futex, не опрос)
+//       use(ch, view.data["roll"])
+//   view.wait(0.1, crsf_native.FRAME_ATTITUDE)   # только публикацию с новым кадром ориентации
+//
+// Прямо на область shm массивы не смотрят: писатель меняет её под seqlock, и читатель
+// увидел бы разорванный снимок. Согласованная копия (~300 байт) делается без GIL
+// во временный буфер и переносится в снимок уже под GIL — потоки Python видят только целые снимки.
+class TelemetryView {
+public:
+    // Квант ожидания, после которого проверяются сигналы (Ctrl+C)
+    static constexpr auto SIGNAL_CHECK_INTERVAL = std::chrono::milliseconds(50);
+
+    TelemetryView() : _seq(0), _cursor{} { memset(&_snapshot, 0, sizeof(_snapshot)); }
+
+    // Забрать новый снимок, если он опубликован. true — снимок обновлён
+    bool update() {
+        if (!ensureOpen()) return false;
+        SharedTelemetryData fresh;
+        uint32_t known = _seq, seq;
+        TelemetryNotifyCursor cursor;
+        {
+            py::gil_scoped_release release;
+            if (!readIfNew(known, fresh, seq, cursor)) return false;
+        }
+        commit(fresh, seq, cursor);
+        return true;
+    }
+
+    // Дождаться публикации новее текущего снимка; timeout в секундах, None — без ограничения.
+    // kinds — маска групп кадров (FRAME_*), 0 — любая публикация.
+    // GIL отпущен на время ожидания. false — за timeout новых данных не было
+    bool wait(std::optional<double> timeout, uint32_t kinds) {
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = timeout ? start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                              std::chrono::duration<double>(*timeout))
+                                : std::chrono::steady_clock::time_point::max();
+        SharedTelemetryData fresh;
+        uint32_t known = _seq, seq;
+        TelemetryNotifyCursor waitCursor = _cursor, cursor;
+        for (;;) {
+            bool got = false;
+            if (ensureOpen()) {
+                py::gil_scoped_release release;
+                auto sliceEnd = std::min(deadline, std::chrono::steady_clock::now() + SIGNAL_CHECK_INTERVAL);
+                for (;;) {
+                    auto left = std::chrono::ceil<std::chrono::milliseconds>(sliceEnd - std::chrono::steady_clock::now());
+                    if (left.count() < 0) break;
+                    // Публикация могла уже попасть в снимок через update(): тогда ждём следующую
+                    if (!_shm.wait(waitCursor, kinds, static_cast<int>(left.count()))) break;
+                    if ((got = readIfNew(known, fresh, seq, cursor))) break;
+                }
+            } else {
+                // Писатель ещё не запущен: подключение пробуем раз в квант
+                py::gil_scoped_release release;
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                    SIGNAL_CHECK_INTERVAL, std::max(deadline - std::chrono::steady_clock::now(),
+                                                    std::chrono::steady_clock::duration::zero())));
+            }
+            if (got) {
+                commit(fresh, seq, cursor);
+                return true;
+            }
+            if (PyErr_CheckSignals() != 0) throw py::error_already_set();
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+        }
+    }
+
+    // Номер снимка (seqlock писателя); 0 — данных ещё не было
+    uint32_t sequence() const { return _seq; }
+    bool connected() const { return _shm.isOpen(); }
+
+    const SharedTelemetryData& snapshot() const { return _snapshot; }
+
+private:
+    // Под GIL: подключение к области меняет _shm
+    bool ensureOpen() { return _shm.isOpen() || _shm.open(); }
+
+    // Без GIL: только чтение области и запись в локальный буфер; known — номер текущего снимка.
+    // Счётчики уведомлений берутся до чтения: писатель увеличивает их после записи снимка,
+    // поэтому снимок не старше cursor
+    bool readIfNew(uint32_t known, SharedTelemetryData& out, uint32_t& seq, TelemetryNotifyCursor& cursor) const {
+        cursor = _shm.cursor();
+        seq = _shm.sequence();
+        if (seq == 0 || seq == known || (seq & 1u)) return false;
+        return _shm.read(out);
+    }
+
+    void commit(const SharedTelemetryData& fresh, uint32_t seq, const TelemetryNotifyCursor& cursor) {
+        memcpy(&_snapshot, &fresh, sizeof(_snapshot));
+        _seq = seq;
+        _cursor = cursor;
+    }
+
+    SharedTelemetry _shm;
+    SharedTelemetryData _snapshot;
+    uint32_t _seq;
+    TelemetryNotifyCursor _cursor; // счётчики уведомлений, соответствующие снимку
+};
+
+// Структурный dtype, повторяющий раскладку SharedTelemetryData (смещения — из компилятора)
+static py::dtype telemetryDtype() {
+    py::list linkNames, linkFormats, linkOffsets;
+    auto linkField = [&](const char* name, const std::string& format, size_t offset) {
+        linkNames.append(name);
+        linkFormats.append(format);
+        linkOffsets.append(offset);
+    };
+    linkField("rxFrames", "<u4", offsetof(CrsfLinkCounters, rxFrames));
+    linkField("rxFramesByKind", "(" + std::to_string(CRSF_LINK_FRAME_KINDS) + ",)<u4",
+              offsetof(CrsfLinkCounters, rxFramesByKind));
+    linkField("rxCrcErrors", "<u4", offsetof(CrsfLinkCounters, rxCrcErrors));
+    linkField("rxLengthRejects", "<u4", offsetof(CrsfLinkCounters, rxLengthRejects));
+    linkField("rxResyncBytes", "<u4", offsetof(CrsfLinkCounters, rxResyncBytes));
+    linkField("rxBufferResets", "<u4", offsetof(CrsfLinkCounters, rxBufferResets));
+    linkField("txFrames", "<u4", offsetof(CrsfLinkCounters, txFrames));
+    linkField("txDropped", "<u4", offsetof(CrsfLinkCounters, txDropped));
+    linkField("txShortWrites", "<u4", offsetof(CrsfLinkCounters, txShortWrites));
+    linkField("txBytes", "<u8", offsetof(CrsfLinkCounters, txBytes));
+    py::dtype linkDtype(linkNames, linkFormats, linkOffsets, sizeof(CrsfLinkCounters));
+
+    py::list names, formats, offsets;
+    auto field = [&](const char* name, py::object format, size_t offset) {
+        names.append(name);
+        formats.append(format);
+        offsets.append(offset);
+    };
+#define TELEMETRY_FIELD(name, format) field(#name, py::str(format), offsetof(SharedTelemetryData, name))
+    static_assert(sizeof(bool) == 1, "linkUp is exported as numpy bool");
+    TELEMETRY_FIELD(linkUp, "?");
+    TELEMETRY_FIELD(lastReceive, "<u4");
+    TELEMETRY_FIELD(channels, "(16,)<i4");
+    TELEMETRY_FIELD(packetsReceived, "<u4");
+    TELEMETRY_FIELD(packetsSent, "<u4");
+    TELEMETRY_FIELD(packetsLost, "<u4");
+    TELEMETRY_FIELD(latitude, "<f8");
+    TELEMETRY_FIELD(longitude, "<f8");
+    TELEMETRY_FIELD(altitude, "<f8");
+    TELEMETRY_FIELD(speed, "<f8");
+    TELEMETRY_FIELD(voltage, "<f8");
+    TELEMETRY_FIELD(current, "<f8");
+    TELEMETRY_FIELD(capacity, "<f8");
+    TELEMETRY_FIELD(remaining, "u1");
+    TELEMETRY_FIELD(roll, "<f8");
+    TELEMETRY_FIELD(pitch, "<f8");
+    TELEMETRY_FIELD(yaw, "<f8");
+    TELEMETRY_FIELD(rollRaw, "<i2");
+    TELEMETRY_FIELD(pitchRaw, "<i2");
+    TELEMETRY_FIELD(yawRaw, "<i2");
+    TELEMETRY_FIELD(channelsTimeNs, "<u8");
+    TELEMETRY_FIELD(linkStatisticsTimeNs, "<u8");
+    TELEMETRY_FIELD(gpsTimeNs, "<u8");
+    TELEMETRY_FIELD(batteryTimeNs, "<u8");
+    TELEMETRY_FIELD(attitudeTimeNs, "<u8");
+#undef TELEMETRY_FIELD
+    field("link", linkDtype, offsetof(SharedTelemetryData, link));
+    return py::dtype(names, formats, offsets, sizeof(SharedTelemetryData));
+}
+
+// dtype строится один раз на модуль (объект намеренно не освобождается при выгрузке интерпретатора)
+static const py::dtype& telemetryDtypeCached() {
+    static const py::dtype* dtype = new py::dtype(telemetryDtype());
+    return *dtype;
+}
+
+// Представление только на чтение над памятью объекта view (массив держит view живым)
+static py::array telemetryArray(py::handle view, const py::dtype& dtype, std::vector<py::ssize_t> shape,
+                                const void* ptr) {
+    std::vector<py::ssize_t> strides;
+    if (!shape.empty()) strides.push_back(dtype.itemsize());
+    py::array arr(dtype, shape, strides, ptr, view);
+    py::detail::array_proxy(arr.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return arr;
+}
+
+// Прежний канал команд: основной цикл читает файл по закрытию его писателем и удаляет.
+// Файл только дополняется, причём одним write(): перезапись стёрла бы ещё не прочитанные команды
+static const char* COMMAND_FILE_PATH = "/tmp/crsf_command.txt";
+
+static bool appendCommandFile(const CommandRecord* recs, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        std::string line = command_to_text(recs[i]);
+        if (!line.empty()) {
+            text += line;
+            text += '\n';
+        }
+    }
+    if (text.empty()) return true;
+    int fd = ::open(COMMAND_FILE_PATH, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+    if (fd < 0) return false;
+    ssize_t written = ::write(fd, text.data(), text.size());
+    ::close(fd);
+    return written == static_cast<ssize_t>(text.size());
+}
+
+// Команды в crsf_io_rpi: кольцо в разделяемой памяти, файл — если кольцо не подключается
+// (старый crsf_io_rpi). Переполненное кольцо в файл не обходим: команды применились бы не по порядку.
+// Можно вызывать без GIL. false — команды не поставлены в очередь
+static bool enqueueCommands(CommandRecord* recs, size_t count) {
+    if (count == 0 || commandRing.push(recs, count)) return true;
+    if (commandRing.isAttached()) return false;
+    return appendCommandFile(recs, count);
+}
+
+// Установка режима работы
 void setWorkMode(const std::string& mode) {
     std::lock_guard<std::mutex> lock(telemetryMutex);
     if (mode == "joystick" || mode == "manual") {
         workMode = mode;
-        // Записываем команду в файл для основного приложения
-        std::ofstream cmdFile("/tmp/crsf_command.txt");
-        if (cmdFile.is_open()) {
-            cmdFile << "setMode " << mode << std::endl;
-            cmdFile.close();
-        }
+        CommandRecord rec{};
+        rec.type = CMD_SET_MODE;
+        rec.mode = (mode == "joystick") ? CMD_MODE_JOYSTICK : CMD_MODE_MANUAL;
+        enqueueCommands(&rec, 1);
     }
 }
 
@@ -174,49 +376,145 @@ std::string getWorkMode() {
     return workMode;
 }
 
-// Установка канала через файл команд (добавляет команду, не перезаписывает)
+// Установка одного канала
 void setChannel(unsigned int channel, int value) {
     if (channel >= 1 && channel <= 16 && value >= 1000 && value <= 2000) {
-        // Добавляем команду в файл (append mode) для основного приложения
-        std::ofstream cmdFile("/tmp/crsf_command.txt", std::ios::app);
-        if (cmdFile.is_open()) {
-            cmdFile << "setChannel " << channel << " " << value << std::endl;
-            cmdFile.close();
-        }
+        CommandRecord rec{};
+        rec.type = CMD_SET_CHANNELS;
+        rec.mask = static_cast<uint16_t>(1u << (channel - 1));
+        rec.values[channel - 1] = static_cast<uint16_t>(value);
+        enqueueCommands(&rec, 1);
     }
 }
 
 // Установка всех каналов одной командой
 void setChannels(const std::vector<int>& channels) {
     if (channels.size() >= 16) {
-        std::ofstream cmdFile("/tmp/crsf_command.txt");
-        if (cmdFile.is_open()) {
-            cmdFile << "setChannels";
-            for (size_t i = 0; i < 16; i++) {
-                if (channels[i] >= 1000 && channels[i] <= 2000) {
-                    cmdFile << " " << (i + 1) << "=" << channels[i];
-                }
+        CommandRecord rec{};
+        rec.type = CMD_SET_CHANNELS;
+        for (size_t i = 0; i < 16; i++) {
+            if (channels[i] >= 1000 && channels[i] <= 2000) {
+                rec.mask |= static_cast<uint16_t>(1u << i);
+                rec.values[i] = static_cast<uint16_t>(channels[i]);
             }
-            cmdFile << std::endl;
-            cmdFile.close();
+        }
+        if (rec.mask != 0) {
+            enqueueCommands(&rec, 1);
         }
     }
 }
 
-// Отправка каналов через файл команд
-// ВАЖНО: используем append режим, чтобы не перезаписать команды setChannel
+// Немедленная отправка пакета каналов
 void sendChannels() {
-    std::ofstream cmdFile("/tmp/crsf_command.txt", std::ios::app);
-    if (cmdFile.is_open()) {
-        cmdFile << "sendChannels" << std::endl;
-        cmdFile.close();
+    CommandRecord rec{};
+    rec.type = CMD_SEND_CHANNELS;
+    enqueueCommands(&rec, 1);
+}
+
+typedef py::array_t<int32_t, py::array::c_style | py::array::forcecast> ChannelArray;
+
+// Пачка строк каналов из массива NumPy (или списка): форма (16,) или (N, 16), строка — одна команда
+// CMD_SET_CHANNELS; значение вне 1000..2000 (например, 0) оставляет канал как есть.
+// send=True добавляет в конец CMD_SEND_CHANNELS. Пачка публикуется в кольце целиком
+// (одно обновление tail, один звонок); разбор массива и постановка в очередь — без GIL
+bool pushChannels(ChannelArray values, bool send) {
+    size_t rows;
+    if (values.ndim() == 1 && values.shape(0) == 16) {
+        rows = 1;
+    } else if (values.ndim() == 2 && values.shape(1) == 16) {
+        rows = static_cast<size_t>(values.shape(0));
+    } else {
+        throw py::value_error("channel values must have shape (16,) or (N, 16)");
+    }
+    if (rows + (send ? 1 : 0) > COMMAND_RING_CAPACITY) {
+        throw py::value_error("batch exceeds command ring capacity (" + std::to_string(COMMAND_RING_CAPACITY) +
+                              " commands)");
+    }
+    const int32_t* data = values.data();
+
+    py::gil_scoped_release release;
+    CommandRecord recs[COMMAND_RING_CAPACITY];
+    size_t count = 0;
+    for (size_t row = 0; row < rows; row++) {
+        const int32_t* v = data + row * 16;
+        CommandRecord& rec = recs[count];
+        memset(&rec, 0, sizeof(rec));
+        rec.type = CMD_SET_CHANNELS;
+        for (size_t i = 0; i < 16; i++) {
+            if (v[i] >= 1000 && v[i] <= 2000) {
+                rec.mask |= static_cast<uint16_t>(1u << i);
+                rec.values[i] = static_cast<uint16_t>(v[i]);
+            }
+        }
+        if (rec.mask != 0) count++;
+    }
+    if (send) {
+        memset(&recs[count], 0, sizeof(CommandRecord));
+        recs[count++].type = CMD_SEND_CHANNELS;
     }
+    return enqueueCommands(recs, count);
+}
+
+// Выборочное обновление каналов одной командой: номера каналов (1..16) и значения попарно.
+// Значения вне 1000..2000 пропускаются; send=True — в той же пачке CMD_SEND_CHANNELS
+bool pushChannelUpdates(ChannelArray channels, ChannelArray values, bool send) {
+    if (channels.ndim() != 1 || values.ndim() != 1 || channels.shape(0) != values.shape(0)) {
+        throw py::value_error("channels and values must be 1-D arrays of equal length");
+    }
+    size_t n = static_cast<size_t>(channels.shape(0));
+    const int32_t* ch = channels.data();
+    const int32_t* v = values.data();
+    for (size_t i = 0; i < n; i++) {
+        if (ch[i] < 1 || ch[i] > 16) {
+            throw py::value_error("channel numbers must be in 1..16");
+        }
+    }
+
+    py::gil_scoped_release release;
+    CommandRecord recs[2] = {};
+    size_t count = 0;
+    recs[0].type = CMD_SET_CHANNELS;
+    for (size_t i = 0; i < n; i++) {
+        if (v[i] >= 1000 && v[i] <= 2000) {
+            recs[0].mask |= static_cast<uint16_t>(1u << (ch[i] - 1));
+            recs[0].values[ch[i] - 1] = static_cast<uint16_t>(v[i]);
+        }
+    }
+    if (recs[0].mask != 0) count++;
+    if (send) {
+        recs[count++].type = CMD_SEND_CHANNELS;
+    }
+    return enqueueCommands(recs, count);
+}
+
+// Статистика кольца команд (пишет crsf_io_rpi): применено команд, задержки постановка→применение
+// и постановка→отправка кадра каналов; нули, если кольцо не подключено
+py::dict commandStats() {
+    py::dict stats;
+    bool attached = commandRing.attach();
+    const CommandRegion* region = attached ? commandRing.region() : nullptr;
+    stats["attached"] = attached;
+    stats["appliedSeq"] = attached ? commandRing.appliedSeq() : 0u;
+    stats["commandsApplied"] = region ? region->commandsApplied.load(std::memory_order_relaxed) : 0ull;
+    stats["lastApplyLatencyNs"] = region ? region->lastApplyLatencyNs.load(std::memory_order_relaxed) : 0ull;
+    stats["lastWireLatencyNs"] = region ? region->lastWireLatencyNs.load(std::memory_order_relaxed) : 0ull;
+    stats["maxWireLatencyNs"] = region ? region->maxWireLatencyNs.load(std::memory_order_relaxed) : 0ull;
+    return stats;
 }
 
 // Модуль pybind11
 PYBIND11_MODULE(crsf_native, m) {
     m.doc() = "CRSF Native C++ bindings for Python";
     
+    // Маски групп кадров для TelemetryView.wait(kinds=...), объединяются через |
+    m.attr("FRAME_CHANNELS") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_CHANNELS);
+    m.attr("FRAME_LINK_STATISTICS") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_LINK_STATISTICS);
+    m.attr("FRAME_GPS") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_GPS);
+    m.attr("FRAME_BATTERY") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_BATTERY);
+    m.attr("FRAME_ATTITUDE") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_ATTITUDE);
+    m.attr("FRAME_FLIGHT_MODE") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_FLIGHT_MODE);
+    m.attr("FRAME_OTHER") = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_OTHER);
+    
     // Экспорт структуры TelemetryData
     py::class_<TelemetryData>(m, "TelemetryData")
         .def_readwrite("linkUp", &TelemetryData::linkUp)
@@ -240,8 +538,39 @@ PYBIND11_MODULE(crsf_native, m) {
         .def_readwrite("rollRaw", &TelemetryData::rollRaw)
         .def_readwrite("pitchRaw", &TelemetryData::pitchRaw)
         .def_readwrite("yawRaw", &TelemetryData::yawRaw)
+        .def_readwrite("channelsTimeNs", &TelemetryData::channelsTimeNs)
+        .def_readwrite("linkStatisticsTimeNs", &TelemetryData::linkStatisticsTimeNs)
+        .def_readwrite("gpsTimeNs", &TelemetryData::gpsTimeNs)
+        .def_readwrite("batteryTimeNs", &TelemetryData::batteryTimeNs)
+        .def_readwrite("attitudeTimeNs", &TelemetryData::attitudeTimeNs)
         .def_readwrite("timestamp", &TelemetryData::timestamp);
     
+    // Телеметрия без копий: NumPy-представления над снимком, ожидание без GIL
+    py::class_<TelemetryView>(m, "TelemetryView", py::buffer_protocol())
+        .def(py::init<>())
+        .def("update", &TelemetryView::update,
+             "Take the latest published snapshot if it is newer; returns True if updated")
+        .def("wait", &TelemetryView::wait,
+             "Wait (GIL released, futex) for a snapshot newer than the current one; timeout in seconds, "
+             "None waits forever; kinds: FRAME_* mask, 0 - any publication",
+             py::arg("timeout") = py::none(), py::arg("kinds") = TELEMETRY_NOTIFY_ANY)
+        .def_property_readonly("sequence", &TelemetryView::sequence)
+        .def_property_readonly("connected", &TelemetryView::connected)
+        .def_property_readonly_static("dtype", [](py::object) { return telemetryDtypeCached(); })
+        .def_property_readonly("data", [](py::object self) {
+            const TelemetryView& view = self.cast<const TelemetryView&>();
+            return telemetryArray(self, telemetryDtypeCached(), {}, &view.snapshot());
+        }, "0-d structured array over the snapshot (fields as in TelemetryData, plus link counters)")
+        .def_property_readonly("channels", [](py::object self) {
+            const TelemetryView& view = self.cast<const TelemetryView&>();
+            return telemetryArray(self, py::dtype::of<int32_t>(), {16}, view.snapshot().channels);
+        }, "int32[16] view of the channels")
+        .def_buffer([](TelemetryView& view) {
+            return py::buffer_info(const_cast<SharedTelemetryData*>(&view.snapshot()), 1,
+                                   py::format_descriptor<uint8_t>::format(), 1,
+                                   {static_cast<py::ssize_t>(sizeof(SharedTelemetryData))}, {1}, true);
+        });
+    
     // Экспорт функций
     m.def("init_crsf_instance", &initCrsfInstance,
           "Initialize CRSF instance from pointer value (uintptr_t)",
@@ -270,5 +599,18 @@ PYBIND11_MODULE(crsf_native, m) {
     
     m.def("send_channels", &sendChannels,
           "Send channels packet");
+    
+    // Пачки команд из массивов NumPy без GIL
+    m.def("push_channels", &pushChannels,
+          "Enqueue rows of 16 channel values (shape (16,) or (N, 16)) as one atomic batch; "
+          "values outside 1000..2000 leave the channel unchanged. Returns False if the ring is full",
+          py::arg("values"), py::arg("send") = false);
+    
+    m.def("push_channel_updates", &pushChannelUpdates,
+          "Enqueue one command setting the given channels (1..16) to values",
+          py::arg("channels"), py::arg("values"), py::arg("send") = false);
+    
+    m.def("command_stats", &commandStats,
+          "Command ring statistics published by crsf_io_rpi");
 }
 
@@ -2,13 +2,11 @@
 #include <thread>
 #include <mutex>
 #include <chrono>
-#include <sstream>
-#include <iomanip>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
 #include <cstring>
 #include "libs/crsf/CrsfSerial.h"
+#include "libs/http_server.h"
+#include "libs/telemetry_stream.h"
+#include "libs/telemetry_json.h"
 
 // Глобальные переменные для телеметрии
 struct TelemetryData {
@@ -24,6 +22,7 @@ struct TelemetryData {
     uint32_t packetsReceived = 0;
     uint32_t packetsSent = 0;
     uint32_t packetsLost = 0;
+    CrsfLinkCounters link = {};
     
     // GPS данные (если доступны)
     double latitude = 0.0;
@@ -54,6 +53,13 @@ struct TelemetryData {
 static TelemetryData telemetryData;
 static std::mutex telemetryMutex;
 static CrsfSerial* crsfInstance = nullptr;
+static uint64_t telemetryGeneration = 0;          // номер обновления telemetryData (под telemetryMutex)
+// JSON текущего снимка: строится один раз на обновление и отдаётся всем клиентам без копирования
+static std::mutex telemetryJsonMutex;
+static std::shared_ptr<const std::string> telemetryJson;
+static uint64_t telemetryJsonGeneration = 0;
+// Подписчики /api/telemetry/stream (SSE)
+static TelemetryStreamHub telemetryHub;
 
 // Функция для получения текущего режима работы
 std::string getWorkMode() {
@@ -63,15 +69,9 @@ std::string getWorkMode() {
 
 // Функция для получения текущего времени
 std::string getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+    char timestamp[TELEMETRY_TIMESTAMP_MAX];
+    size_t len = telemetry_json_timestamp(timestamp, sizeof(timestamp));
+    return std::string(timestamp, len);
 }
 
 // Функция для обновления телеметрии
@@ -79,49 +79,46 @@ void updateTelemetry() {
     std::lock_guard<std::mutex> lock(telemetryMutex);
     
     if (crsfInstance) {
-        telemetryData.linkUp = crsfInstance->isLinkUp();
-        telemetryData.lastReceive = crsfInstance->_lastReceive;
+        // Один согласованный снимок вместо отдельных геттеров: все поля из одних и тех же кадров
+        const TelemetrySnapshot snap = crsfInstance->snapshot();
+        telemetryData.linkUp = snap.linkUp;
+        telemetryData.lastReceive = snap.lastReceive;
         
-        // Получаем каналы
         for (int i = 0; i < 16; i++) {
-            telemetryData.channels[i] = crsfInstance->getChannel(i + 1);
+            telemetryData.channels[i] = snap.channels[i];
         }
         
-        // Получаем статистику связи
-        const crsfLinkStatistics_t* stats = crsfInstance->getLinkStatistics();
-        if (stats) {
-            telemetryData.packetsReceived = stats->uplink_RSSI_1;
-            telemetryData.packetsSent = stats->uplink_RSSI_2;
-            telemetryData.packetsLost = 100 - stats->uplink_Link_quality; // Потерянные пакеты = 100 - качество связи
-        }
+        // Счётчики протокола (прежде здесь были RSSI и качество связи из LINK_STATISTICS)
+        telemetryData.link = crsfInstance->getLinkCounters();
+        telemetryData.packetsReceived = telemetryData.link.rxFrames;
+        telemetryData.packetsSent = telemetryData.link.txFrames;
+        telemetryData.packetsLost = telemetryData.link.rxCrcErrors;
         
-        // Получаем GPS данные
-        const crsf_sensor_gps_t* gps = crsfInstance->getGpsSensor();
-        if (gps) {
-            // Конвертируем из формата CRSF (degree / 10,000,000) в обычные градусы
-            telemetryData.latitude = gps->latitude / 10000000.0;
-            telemetryData.longitude = gps->longitude / 10000000.0;
-            // Высота в метрах, +1000м offset
-            telemetryData.altitude = gps->altitude - 1000;
-            // Скорость в км/ч / 10
-            telemetryData.speed = gps->groundspeed / 10.0;
-        }
+        // GPS данные
+        const crsf_sensor_gps_t& gps = snap.gps;
+        // Конвертируем из формата CRSF (degree / 10,000,000) в обычные градусы
+        telemetryData.latitude = gps.latitude / 10000000.0;
+        telemetryData.longitude = gps.longitude / 10000000.0;
+        // Высота в метрах, +1000м offset
+        telemetryData.altitude = gps.altitude - 1000;
+        // Скорость в км/ч / 10
+        telemetryData.speed = gps.groundspeed / 10.0;
         
-        // Получаем данные батареи
-        telemetryData.voltage = crsfInstance->getBatteryVoltage();
-        telemetryData.current = crsfInstance->getBatteryCurrent();
-        telemetryData.capacity = crsfInstance->getBatteryCapacity();
-        telemetryData.remaining = crsfInstance->getBatteryRemaining();
+        // Данные батареи
+        telemetryData.voltage = snap.batteryVoltage;
+        telemetryData.current = snap.batteryCurrent;
+        telemetryData.capacity = snap.batteryCapacity;
+        telemetryData.remaining = snap.batteryRemaining;
         
-        // Получаем данные положения
-        telemetryData.roll = crsfInstance->getAttitudeRoll();
-        telemetryData.pitch = crsfInstance->getAttitudePitch();
-        telemetryData.yaw = crsfInstance->getAttitudeYaw();
+        // Данные положения
+        telemetryData.roll = snap.attitudeRoll;
+        telemetryData.pitch = snap.attitudePitch;
+        telemetryData.yaw = snap.attitudeYaw;
         
-        // Получаем сырые значения attitude
-        telemetryData.rawAttitudeBytes[0] = crsfInstance->getRawAttitudeRoll();
-        telemetryData.rawAttitudeBytes[1] = crsfInstance->getRawAttitudePitch();
-        telemetryData.rawAttitudeBytes[2] = crsfInstance->getRawAttitudeYaw();
+        // Сырые значения attitude
+        telemetryData.rawAttitudeBytes[0] = snap.rawAttitudeRoll;
+        telemetryData.rawAttitudeBytes[1] = snap.rawAttitudePitch;
+        telemetryData.rawAttitudeBytes[2] = snap.rawAttitudeYaw;
     }
     
     telemetryData.timestamp = getCurrentTime();
@@ -132,81 +129,106 @@ void updateTelemetry() {
     } else {
         telemetryData.activePort = "No Connection";
     }
+    ++telemetryGeneration;
 }
 
-// Функция для отправки HTTP ответа
-void sendHttpResponse(int clientSocket, const std::string& content, const std::string& contentType = "text/html") {
-    std::stringstream response;
-    response << "HTTP/1.1 200 OK\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
-    response << "Access-Control-Allow-Origin: *\r\n";
-    response << "Connection: close\r\n\r\n";
-    response << content;
-    
-    std::string responseStr = response.str();
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
+// Функция для заполнения HTTP ответа (заголовки и отправку формирует HttpServer)
+void sendHttpResponse(HttpResponse& resp, const std::string& content, const std::string& contentType = "text/html", int statusCode = 200) {
+    resp.set(statusCode, contentType, content);
 }
 
-// Функция для создания JSON телеметрии
+// Функция для создания JSON телеметрии: фиксированный буфер и std::to_chars вместо std::stringstream
+// (double как в потоке по умолчанию — %g, 6 значащих цифр)
 std::string createTelemetryJson() {
-    std::lock_guard<std::mutex> lock(telemetryMutex);
-    
-    std::stringstream json;
-    json << "{";
-    json << "\"linkUp\":" << (telemetryData.linkUp ? "true" : "false") << ",";
-    json << "\"activePort\":\"" << telemetryData.activePort << "\",";
-    json << "\"lastReceive\":" << telemetryData.lastReceive << ",";
-    json << "\"timestamp\":\"" << telemetryData.timestamp << "\",";
-    
-    // RC каналы
-    json << "\"channels\":[";
-    for (int i = 0; i < 16; i++) {
-        if (i > 0) json << ",";
-        json << telemetryData.channels[i];
+    char buf[TELEMETRY_JSON_MAX];
+    JsonWriter w(buf, sizeof(buf));
+    {
+        std::lock_guard<std::mutex> lock(telemetryMutex);
+        w.raw("{\"linkUp\":");
+        w.boolean(telemetryData.linkUp);
+        w.raw(",\"activePort\":\"");
+        w.append(telemetryData.activePort.data(), telemetryData.activePort.size());
+        w.raw("\",\"lastReceive\":");
+        w.integer(telemetryData.lastReceive);
+        w.raw(",\"timestamp\":\"");
+        w.append(telemetryData.timestamp.data(), telemetryData.timestamp.size());
+        
+        // RC каналы
+        w.raw("\",\"channels\":[");
+        for (int i = 0; i < 16; i++) {
+            if (i > 0) w.raw(",");
+            w.integer(telemetryData.channels[i]);
+        }
+        
+        // Статистика
+        w.raw("],\"packetsReceived\":");
+        w.integer(telemetryData.packetsReceived);
+        w.raw(",\"packetsSent\":");
+        w.integer(telemetryData.packetsSent);
+        w.raw(",\"packetsLost\":");
+        w.integer(telemetryData.packetsLost);
+        
+        // GPS
+        w.raw(",\"gps\":{\"latitude\":");
+        w.general(telemetryData.latitude);
+        w.raw(",\"longitude\":");
+        w.general(telemetryData.longitude);
+        w.raw(",\"altitude\":");
+        w.general(telemetryData.altitude);
+        w.raw(",\"speed\":");
+        w.general(telemetryData.speed);
+        
+        // Батарея
+        w.raw("},\"battery\":{\"voltage\":");
+        w.general(telemetryData.voltage);
+        w.raw(",\"current\":");
+        w.general(telemetryData.current);
+        w.raw(",\"capacity\":");
+        w.general(telemetryData.capacity);
+        w.raw(",\"remaining\":");
+        w.integer((int)telemetryData.remaining);
+        
+        // Положение
+        w.raw("},\"attitude\":{\"roll\":");
+        w.general(telemetryData.roll);
+        w.raw(",\"pitch\":");
+        w.general(telemetryData.pitch);
+        w.raw(",\"yaw\":");
+        w.general(telemetryData.yaw);
+        
+        // Сырые значения attitude (raw CRSF bytes)
+        w.raw("},\"attitudeRaw\":{\"roll\":");
+        w.integer(telemetryData.rawAttitudeBytes[0]);
+        w.raw(",\"pitch\":");
+        w.integer(telemetryData.rawAttitudeBytes[1]);
+        w.raw(",\"yaw\":");
+        w.integer(telemetryData.rawAttitudeBytes[2]);
+        
+        // Счётчики протокола
+        w.raw("},\"link\":");
+        telemetry_json_link(w, telemetryData.link);
+        
+        // Режим работы
+        w.raw(",\"workMode\":\"");
+        w.append(telemetryData.workMode.data(), telemetryData.workMode.size());
+        w.raw("\"}");
     }
-    json << "],";
-    
-    // Статистика
-    json << "\"packetsReceived\":" << telemetryData.packetsReceived << ",";
-    json << "\"packetsSent\":" << telemetryData.packetsSent << ",";
-    json << "\"packetsLost\":" << telemetryData.packetsLost << ",";
-    
-    // GPS
-    json << "\"gps\":{";
-    json << "\"latitude\":" << telemetryData.latitude << ",";
-    json << "\"longitude\":" << telemetryData.longitude << ",";
-    json << "\"altitude\":" << telemetryData.altitude << ",";
-    json << "\"speed\":" << telemetryData.speed;
-    json << "},";
-    
-    // Батарея
-    json << "\"battery\":{";
-    json << "\"voltage\":" << telemetryData.voltage << ",";
-    json << "\"current\":" << telemetryData.current << ",";
-    json << "\"capacity\":" << telemetryData.capacity << ",";
-    json << "\"remaining\":" << (int)telemetryData.remaining;
-    json << "},";
-    
-    // Положение
-    json << "\"attitude\":{";
-    json << "\"roll\":" << telemetryData.roll << ",";
-    json << "\"pitch\":" << telemetryData.pitch << ",";
-    json << "\"yaw\":" << telemetryData.yaw;
-    json << "},";
-    
-    // Сырые значения attitude (raw CRSF bytes)
-    json << "\"attitudeRaw\":{";
-    json << "\"roll\":" << telemetryData.rawAttitudeBytes[0] << ",";
-    json << "\"pitch\":" << telemetryData.rawAttitudeBytes[1] << ",";
-    json << "\"yaw\":" << telemetryData.rawAttitudeBytes[2];
-    json << "},";
-    
-    // Режим работы
-    json << "\"workMode\":\"" << telemetryData.workMode << "\"";
-    
-    json << "}";
-    return json.str();
+    return std::string(buf, w.ok() ? w.size() : 0);
+}
+
+// JSON текущего снимка: повторные запросы до следующего обновления получают тот же буфер
+std::shared_ptr<const std::string> currentTelemetryJson() {
+    std::lock_guard<std::mutex> lock(telemetryJsonMutex);
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> dataLock(telemetryMutex);
+        generation = telemetryGeneration;
+    }
+    if (!telemetryJson || telemetryJsonGeneration != generation) {
+        telemetryJson = std::make_shared<const std::string>(createTelemetryJson());
+        telemetryJsonGeneration = generation;
+    }
+    return telemetryJson;
 }
 
 // Функция для обработки команд управления
@@ -235,10 +257,8 @@ void handleCommand(const std::string& command, const std::string& value) {
 }
 
 // Функция для обработки HTTP запросов
-void handleHttpRequest(int clientSocket, const std::string& request) {
-    std::stringstream ss(request);
-    std::string method, path, version;
-    ss >> method >> path >> version;
+void handleHttpRequest(const HttpRequest& req, HttpResponse& resp) {
+    const std::string& path = req.target;
     
     if (path == "/" || path == "/index.html") {
         // Простая информационная страница
@@ -249,14 +269,18 @@ void handleHttpRequest(int clientSocket, const std::string& request) {
 <p>Доступные endpoints:</p>
 <ul>
 <li><a href="/api/telemetry">/api/telemetry</a> - JSON данные телеметрии</li>
+<li><a href="/api/telemetry/stream">/api/telemetry/stream</a> - поток телеметрии (Server-Sent Events, ?fields=...&amp;rate=...)</li>
 <li><a href="/api/command">/api/command</a> - Команды управления</li>
 </ul>
 </body></html>)";
-        sendHttpResponse(clientSocket, html);
+        sendHttpResponse(resp, html);
     } else if (path == "/api/telemetry") {
         // API для получения телеметрии
-        std::string json = createTelemetryJson();
-        sendHttpResponse(clientSocket, json, "application/json");
+        resp.contentType = "application/json";
+        resp.sharedBody = currentTelemetryJson();
+    } else if (req.path == "/api/telemetry/stream") {
+        // Поток телеметрии: одна сериализация на обновление для всех подписчиков
+        telemetryHub.subscribe(req, resp);
     } else if (path.find("/api/command") == 0) {
         // API для команд управления
         size_t pos = path.find("?");
@@ -272,84 +296,46 @@ void handleHttpRequest(int clientSocket, const std::string& request) {
             }
         }
         
-        sendHttpResponse(clientSocket, "{\"status\":\"ok\"}", "application/json");
+        sendHttpResponse(resp, "{\"status\":\"ok\"}", "application/json");
     } else {
         // 404 Not Found
-        std::string response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\n\r\n<h1>404 Not Found</h1>";
-        send(clientSocket, response.c_str(), response.length(), 0);
+        sendHttpResponse(resp, "<h1>404 Not Found</h1>", "text/html", 404);
     }
 }
 
-// Функция для обработки клиентских подключений
-void handleClient(int clientSocket) {
-    char buffer[4096];
-    int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytesReceived > 0) {
-        buffer[bytesReceived] = '\0';
-        std::string request(buffer);
-        handleHttpRequest(clientSocket, request);
-    }
-    
-    close(clientSocket);
-}
-
 // Основная функция веб-сервера
 void startTelemetryServer(CrsfSerial* crsf, int port = 8080, int updateIntervalMs = 10) {
     std::cout << "🌐 Запуск веб-сервера телеметрии (реалтайм " << updateIntervalMs << "мс)..." << std::endl;
     crsfInstance = crsf;
     
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        std::cerr << "Ошибка создания сокета" << std::endl;
-        return;
-    }
-    
-    int opt = 1;
-    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-    
-    if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+    // Страницы и JSON отдают два рабочих потока с постоянными соединениями
+    HttpServer server(handleHttpRequest, 2);
+    if (!server.listen(port)) {
         std::cerr << "❌ Ошибка привязки к порту " << port << std::endl;
-        close(serverSocket);
-        return;
-    }
-    
-    if (listen(serverSocket, 5) < 0) {
-        std::cerr << "❌ Ошибка прослушивания порта" << std::endl;
-        close(serverSocket);
         return;
     }
     
     std::cout << "🌐 Веб-сервер телеметрии запущен на порту " << port << std::endl;
     std::cout << "📱 Откройте браузер: http://localhost:" << port << std::endl;
     
-    // Запускаем поток для обновления телеметрии (реалтайм)
+    // Запускаем поток для обновления телеметрии (реалтайм): просыпается по новому кадру от потока приёма,
+    // записи каналов или потере линка, но не чаще раза в updateIntervalMs; без изменений — раз в секунду
     std::thread telemetryThread([updateIntervalMs]() {
+        TelemetryNotifyCursor cursor = crsfInstance ? crsfInstance->telemetryCursor() : TelemetryNotifyCursor{};
         while (true) {
+            auto updated = std::chrono::steady_clock::now();
             updateTelemetry();
-            std::this_thread::sleep_for(std::chrono::milliseconds(updateIntervalMs));
+            if (telemetryHub.hasSubscribers()) {
+                telemetryHub.publish(currentTelemetryJson());
+            }
+            if (crsfInstance) {
+                crsfInstance->waitTelemetry(cursor, TELEMETRY_NOTIFY_ANY, 1000);
+            }
+            std::this_thread::sleep_until(updated + std::chrono::milliseconds(updateIntervalMs));
         }
     });
     telemetryThread.detach();
     
     // Основной цикл сервера
-    while (true) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket < 0) {
-            continue;
-        }
-        
-        std::thread clientThread(handleClient, clientSocket);
-        clientThread.detach();
-    }
-    
-    close(serverSocket);
+    server.run();
 }
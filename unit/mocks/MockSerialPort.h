@@ -13,5 +13,20 @@ public:
     MOCK_METHOD(int, write, (const uint8_t* buf, size_t len), (override));
     MOCK_METHOD(int, writeByte, (uint8_t b), (override));
     MOCK_METHOD(void, flush, (), (override));
+
+    // Пакетное чтение сводится к последовательным readByte(), чтобы тесты
+    // могли по-прежнему задавать входной поток через EXPECT_CALL(readByte)
+    int read(uint8_t* buf, size_t len) override {
+        size_t n = 0;
+        while (n < len) {
+            uint8_t b;
+            int r = readByte(b);
+            if (r <= 0) {
+                return n > 0 ? static_cast<int>(n) : r;
+            }
+            buf[n++] = b;
+        }
+        return static_cast<int>(n);
+    }
 };
 
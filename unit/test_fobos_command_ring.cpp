@@ -0,0 +1,307 @@
+/**
+ * @file test_fobos_command_ring.cpp
+ * @brief Unit тесты для кольца команд в разделяемой памяти
+ * 
+ * Тесты проверяют:
+ * - Разбор текстовых команд прежнего формата в двоичные записи
+ * - Передачу команд от производителя потребителю с номерами и метками времени
+ * - Публикацию пачки команд одним звонком eventfd
+ * - Отказ при переполнении кольца и отсутствии потребителя
+ * - Отказ второго потребителя без сброса колец работающего
+ * - Отдельные кольца у нескольких производителей одного процесса
+ * 
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/mman.h>
+#include "../libs/command_ring.h"
+
+// Отдельные имена, чтобы не мешать запущенному crsf_io_rpi
+static const char* TEST_RING_NAME = "/crsf_commands_unit_test";
+static const char* TEST_RING_SOCKET = "crsf_commands_unit_test_doorbell";
+
+/**
+ * @class CommandRingTest
+ * @brief Фикстура: потребитель создаёт область, производитель подключается к ней
+ */
+class CommandRingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        shm_unlink(TEST_RING_NAME);
+        ASSERT_TRUE(server.create());
+    }
+    void TearDown() override {
+        client.close();
+        server.close();
+        shm_unlink(TEST_RING_NAME);
+    }
+
+    // Готов ли звонок (без ожидания)
+    bool doorbellReady() {
+        struct pollfd pfd = { server.doorbellFd(), POLLIN, 0 };
+        return poll(&pfd, 1, 0) == 1;
+    }
+
+    // Подключение производителя: сокет обслуживает потребитель в этом же потоке
+    void attachClient() { attachClient(client); }
+    void attachClient(CommandRingClient& producer) {
+        std::thread acceptor([this]() {
+            struct pollfd pfd = { server.listenFd(), POLLIN, 0 };
+            poll(&pfd, 1, 1000);
+            server.acceptClients();
+        });
+        bool attached = producer.attach();
+        acceptor.join();
+        ASSERT_TRUE(attached);
+    }
+
+    CommandRingServer server{TEST_RING_NAME, TEST_RING_SOCKET};
+    CommandRingClient client{TEST_RING_NAME, TEST_RING_SOCKET};
+};
+
+/**
+ * @test Текстовые команды прежнего формата разбираются в записи
+ */
+TEST(CommandRingTextTest, CommandFromText_ParsesLegacyFormat) {
+    CommandRecord rec;
+
+    ASSERT_TRUE(command_from_text("setChannel 3 1600", rec));
+    EXPECT_EQ(rec.type, CMD_SET_CHANNELS);
+    EXPECT_EQ(rec.mask, 1u << 2);
+    EXPECT_EQ(rec.values[2], 1600);
+
+    ASSERT_TRUE(command_from_text("setChannels 1=1500 2=1000 16=2000 5=999", rec));
+    EXPECT_EQ(rec.type, CMD_SET_CHANNELS);
+    EXPECT_EQ(rec.mask, (1u << 0) | (1u << 1) | (1u << 15)); // 999 вне диапазона
+    EXPECT_EQ(rec.values[0], 1500);
+    EXPECT_EQ(rec.values[1], 1000);
+    EXPECT_EQ(rec.values[15], 2000);
+
+    ASSERT_TRUE(command_from_text("sendChannels", rec));
+    EXPECT_EQ(rec.type, CMD_SEND_CHANNELS);
+
+    ASSERT_TRUE(command_from_text("setMode joystick", rec));
+    EXPECT_EQ(rec.type, CMD_SET_MODE);
+    EXPECT_EQ(rec.mode, CMD_MODE_JOYSTICK);
+}
+
+/**
+ * @test Некорректные команды отклоняются без исключений
+ */
+TEST(CommandRingTextTest, CommandFromText_RejectsInvalid) {
+    CommandRecord rec;
+    EXPECT_FALSE(command_from_text("", rec));
+    EXPECT_FALSE(command_from_text("setChannel 17 1500", rec));
+    EXPECT_FALSE(command_from_text("setChannel 1 2500", rec));
+    EXPECT_FALSE(command_from_text("setChannel abc 1500", rec));
+    EXPECT_FALSE(command_from_text("setChannels x=y", rec));
+    EXPECT_FALSE(command_from_text("setMode auto", rec));
+    EXPECT_FALSE(command_from_text("reboot", rec));
+}
+
+/**
+ * @test Текстовый вид записи (резервный путь через файл) разбирается обратно в ту же команду
+ */
+TEST(CommandRingTextTest, CommandToText_RoundTrip) {
+    CommandRecord rec{};
+    rec.type = CMD_SET_CHANNELS;
+    rec.mask = (1u << 2) | (1u << 3) | (1u << 15);
+    rec.values[2] = 1234;
+    rec.values[3] = 1765;
+    rec.values[15] = 2000;
+    EXPECT_EQ(command_to_text(rec), "setChannels 3=1234 4=1765 16=2000");
+
+    CommandRecord parsed;
+    ASSERT_TRUE(command_from_text(command_to_text(rec), parsed));
+    EXPECT_EQ(parsed.type, CMD_SET_CHANNELS);
+    EXPECT_EQ(parsed.mask, rec.mask);
+    EXPECT_EQ(memcmp(parsed.values, rec.values, sizeof(rec.values)), 0);
+
+    CommandRecord send{};
+    send.type = CMD_SEND_CHANNELS;
+    ASSERT_TRUE(command_from_text(command_to_text(send), parsed));
+    EXPECT_EQ(parsed.type, CMD_SEND_CHANNELS);
+
+    CommandRecord mode{};
+    mode.type = CMD_SET_MODE;
+    mode.mode = CMD_MODE_JOYSTICK;
+    ASSERT_TRUE(command_from_text(command_to_text(mode), parsed));
+    EXPECT_EQ(parsed.mode, CMD_MODE_JOYSTICK);
+
+    CommandRecord empty{};
+    empty.type = CMD_SET_CHANNELS;
+    EXPECT_EQ(command_to_text(empty), "");
+}
+
+/**
+ * @test Без потребителя производитель не подключается
+ */
+TEST(CommandRingNoServerTest, Attach_WithoutServer_Fails) {
+    shm_unlink(TEST_RING_NAME);
+    CommandRingClient client(TEST_RING_NAME, TEST_RING_SOCKET);
+    EXPECT_FALSE(client.attach());
+
+    CommandRecord rec{};
+    rec.type = CMD_SEND_CHANNELS;
+    EXPECT_FALSE(client.push(rec));
+}
+
+/**
+ * @test Команда доходит до потребителя с номером и меткой времени, звонок срабатывает
+ */
+TEST_F(CommandRingTest, Push_ThenDrain_DeliversRecord) {
+    attachClient();
+    EXPECT_FALSE(doorbellReady());
+
+    CommandRecord rec;
+    ASSERT_TRUE(command_from_text("setChannel 1 1700", rec));
+    uint64_t before = command_ring_now_ns();
+    ASSERT_TRUE(client.push(rec));
+    EXPECT_EQ(rec.seq, 1u);
+    EXPECT_GE(rec.timestampNs, before);
+    EXPECT_TRUE(doorbellReady());
+
+    std::vector<CommandRecord> received;
+    EXPECT_EQ(server.drain([&](const CommandRecord& r) { received.push_back(r); }), 1u);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].seq, 1u);
+    EXPECT_EQ(received[0].mask, 1u);
+    EXPECT_EQ(received[0].values[0], 1700);
+    EXPECT_EQ(received[0].timestampNs, rec.timestampNs);
+
+    // Звонок сброшен, номер применённой команды виден производителю
+    EXPECT_FALSE(doorbellReady());
+    EXPECT_EQ(client.appliedSeq(), 1u);
+    EXPECT_EQ(server.region()->commandsApplied.load(), 1u);
+
+    server.markSent();
+    EXPECT_GT(server.region()->lastWireLatencyNs.load(), 0u);
+}
+
+/**
+ * @test Пачка команд применяется по порядку, номера идут подряд
+ */
+TEST_F(CommandRingTest, PushBatch_DrainedInOrder) {
+    attachClient();
+
+    CommandRecord batch[10];
+    for (int i = 0; i < 10; i++) {
+        memset(&batch[i], 0, sizeof(batch[i]));
+        batch[i].type = CMD_SET_CHANNELS;
+        batch[i].mask = 1;
+        batch[i].values[0] = static_cast<uint16_t>(1000 + i);
+    }
+    ASSERT_TRUE(client.push(batch, 10));
+
+    std::vector<CommandRecord> received;
+    EXPECT_EQ(server.drain([&](const CommandRecord& r) { received.push_back(r); }), 10u);
+    ASSERT_EQ(received.size(), 10u);
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(received[i].seq, i + 1);
+        EXPECT_EQ(received[i].values[0], 1000 + i);
+    }
+    EXPECT_EQ(client.appliedSeq(), 10u);
+}
+
+/**
+ * @test Переполненное кольцо отклоняет команды, после разбора снова принимает
+ */
+TEST_F(CommandRingTest, Push_WhenFull_RejectedUntilDrained) {
+    attachClient();
+
+    std::vector<CommandRecord> batch(COMMAND_RING_CAPACITY);
+    for (auto& rec : batch) {
+        memset(&rec, 0, sizeof(rec));
+        rec.type = CMD_SEND_CHANNELS;
+    }
+    ASSERT_TRUE(client.push(batch.data(), batch.size()));
+
+    CommandRecord extra{};
+    extra.type = CMD_SEND_CHANNELS;
+    EXPECT_FALSE(client.push(extra));
+
+    EXPECT_EQ(server.drain([](const CommandRecord&) {}), static_cast<size_t>(COMMAND_RING_CAPACITY));
+    EXPECT_TRUE(client.push(extra));
+    EXPECT_EQ(extra.seq, COMMAND_RING_CAPACITY + 1u);
+}
+
+/**
+ * @test Второй потребитель не запускается и не сбрасывает кольца работающего
+ */
+TEST_F(CommandRingTest, SecondServer_FailsWithoutResettingRegion) {
+    attachClient();
+    CommandRecord rec{};
+    rec.type = CMD_SEND_CHANNELS;
+    ASSERT_TRUE(client.push(rec));
+    uint32_t generation = server.region()->generation.load();
+
+    CommandRingServer second(TEST_RING_NAME, TEST_RING_SOCKET);
+    EXPECT_FALSE(second.create());
+    second.close();
+
+    EXPECT_EQ(server.region()->magic.load(), COMMAND_RING_MAGIC);
+    EXPECT_EQ(server.region()->generation.load(), generation);
+    EXPECT_TRUE(client.push(rec));
+    EXPECT_EQ(rec.seq, 2u);
+    EXPECT_EQ(server.drain([](const CommandRecord&) {}), 2u);
+}
+
+/**
+ * @test Два производителя в одном процессе получают разные кольца; закрытие одного не освобождает чужое
+ */
+TEST_F(CommandRingTest, TwoClientsInProcess_UseSeparateRings) {
+    attachClient();
+    CommandRingClient second(TEST_RING_NAME, TEST_RING_SOCKET);
+    attachClient(second);
+
+    CommandRecord rec{};
+    rec.type = CMD_SEND_CHANNELS;
+    ASSERT_TRUE(client.push(rec));
+    ASSERT_TRUE(second.push(rec));
+    EXPECT_EQ(rec.seq, 1u); // своя нумерация — своё кольцо
+
+    size_t owned = 0;
+    for (const auto& slot : server.region()->slots) {
+        if (slot.owner.load() != 0) ++owned;
+    }
+    EXPECT_EQ(owned, 2u);
+
+    // Освободившееся кольцо достаётся новому клиенту, занятое вторым — нет
+    second.close();
+    CommandRingClient third(TEST_RING_NAME, TEST_RING_SOCKET);
+    attachClient(third);
+    ASSERT_TRUE(third.push(rec));
+    ASSERT_TRUE(client.push(rec));
+    EXPECT_EQ(rec.seq, 2u);
+    EXPECT_EQ(server.drain([](const CommandRecord&) {}), 4u);
+}
+
+/**
+ * @test После перезапуска потребителя производитель переподключается сам
+ */
+TEST_F(CommandRingTest, ServerRestart_ClientReattaches) {
+    attachClient();
+    CommandRecord rec{};
+    rec.type = CMD_SEND_CHANNELS;
+    ASSERT_TRUE(client.push(rec));
+
+    server.close();
+    ASSERT_TRUE(server.create());
+
+    std::thread acceptor([this]() {
+        struct pollfd pfd = { server.listenFd(), POLLIN, 0 };
+        poll(&pfd, 1, 1000);
+        server.acceptClients();
+    });
+    bool pushed = client.push(rec);
+    acceptor.join();
+    ASSERT_TRUE(pushed);
+    EXPECT_EQ(rec.seq, 1u); // новое поколение — нумерация с начала
+    EXPECT_TRUE(doorbellReady());
+    EXPECT_EQ(server.drain([](const CommandRecord&) {}), 1u);
+}
@@ -7,11 +7,13 @@
  * - Инкрементальный расчет
  * - Разные полиномы
  * - Корректность вычислений для типичных CRSF пакетов
+ * - Побитовое совпадение реализаций table / slice8 / clmul
  * 
  * @version 4.3
  */
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "../libs/crsf/crc8.h"
 
 /**
@@ -177,3 +179,77 @@ TEST(Crc8ExtendedTest, Calculate_LinkStatisticsPacket_ReturnsValidCrc) {
     EXPECT_NE(result, 0x00);
 }
 
+/**
+ * @brief Эталон: исходный побитовый алгоритм CRC8 без таблиц
+ */
+static uint8_t referenceCrc8(uint8_t poly, const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc << 1) ^ ((crc & 0x80) ? poly : 0);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @test Все реализации совпадают с эталоном на любых длинах и смещениях
+ * 
+ * Длины покрывают хвосты slicing-by-8, границы блоков свёртки по 16 и 64 байта
+ * и невыровненные адреса.
+ */
+TEST(Crc8ExtendedTest, AllImplementations_BitExactWithReference) {
+    std::vector<uint8_t> buf(4096 + 16);
+    uint32_t seed = 12345;
+    for (auto& b : buf) {
+        seed = seed * 1103515245u + 12345u;
+        b = static_cast<uint8_t>(seed >> 16);
+    }
+
+    const uint8_t polys[] = {0xD5, 0x07, 0x31};
+    const Crc8::Impl impls[] = {Crc8::IMPL_TABLE, Crc8::IMPL_SLICE8, Crc8::IMPL_CLMUL};
+    for (uint8_t poly : polys) {
+        Crc8 crc(poly);
+        for (Crc8::Impl impl : impls) {
+            if (!crc.setImpl(impl)) {
+                continue; // clmul недоступен на этом процессоре
+            }
+            for (size_t len = 0; len <= 4096; len += (len < 300 ? 1 : 97)) {
+                for (size_t offset = 0; offset < 4; offset++) {
+                    ASSERT_EQ(crc.update(0, buf.data() + offset, len),
+                              referenceCrc8(poly, buf.data() + offset, len))
+                        << "poly=" << int(poly) << " impl=" << Crc8::implName(impl)
+                        << " len=" << len << " offset=" << offset;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @test Продолжение расчёта с промежуточного состояния равно расчёту целиком
+ */
+TEST(Crc8ExtendedTest, Update_Incremental_EqualsWholeBuffer) {
+    std::vector<uint8_t> buf(1000);
+    for (size_t i = 0; i < buf.size(); i++) {
+        buf[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    Crc8 crc(0xD5);
+    uint8_t whole = crc.update(0, buf.data(), buf.size());
+    for (size_t split : {1u, 63u, 64u, 500u, 999u}) {
+        uint8_t part = crc.update(0, buf.data(), split);
+        EXPECT_EQ(crc.update(part, buf.data() + split, buf.size() - split), whole) << "split=" << split;
+    }
+}
+
+/**
+ * @test По умолчанию выбирается самая быстрая доступная реализация
+ */
+TEST(Crc8ExtendedTest, DefaultImpl_IsFastestSupported) {
+    Crc8 crc(0xD5);
+    EXPECT_TRUE(Crc8::isSupported(Crc8::IMPL_TABLE));
+    EXPECT_TRUE(Crc8::isSupported(Crc8::IMPL_SLICE8));
+    EXPECT_EQ(crc.impl(), Crc8::isSupported(Crc8::IMPL_CLMUL) ? Crc8::IMPL_CLMUL : Crc8::IMPL_SLICE8);
+}
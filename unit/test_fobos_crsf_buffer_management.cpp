@@ -3,7 +3,7 @@
  * @brief Unit тесты для управления буфером CRSF
  * 
  * Тесты проверяют:
- * - shiftRxBuffer() - граничные случаи
+ * - Кольцевой буфер приёма - граничные случаи и переход через конец кольца
  * - Защита от переполнения буфера
  * - Таймаут и очистка буфера
  * - Несколько пакетов в буфере
@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <memory>
+#include <vector>
 #include "../libs/crsf/CrsfSerial.h"
 #include "../libs/crsf/crsf_protocol.h"
 #include "mocks/MockSerialPort.h"
@@ -22,6 +23,7 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::InSequence;
 using ::testing::DoAll;
+using ::testing::Invoke;
 
 /**
  * @class CrsfBufferManagementTest
@@ -276,3 +278,82 @@ TEST_F(CrsfBufferManagementTest, BufferManagement_MaxLengthPacket_ProcessesCorre
     }
 }
 
+
+/**
+ * @brief Собирает валидный CRSF кадр для адреса полетного контроллера
+ */
+static void appendFrame(std::vector<uint8_t>& stream, uint8_t type, const uint8_t* payload, uint8_t len) {
+    Crc8 crc(0xD5);
+    size_t start = stream.size();
+    stream.push_back(CRSF_ADDRESS_FLIGHT_CONTROLLER);
+    stream.push_back(len + 2);
+    stream.push_back(type);
+    stream.insert(stream.end(), payload, payload + len);
+    stream.push_back(crc.calc(&stream[start + 2], len + 1));
+}
+
+/**
+ * @test Кадр, переходящий через конец кольцевого буфера
+ * 
+ * Тест проверяет, что кадр, разорванный концом кольца,
+ * собирается целиком и разбирается корректно, а все кадры потока
+ * учитываются счетчиком принятых кадров.
+ */
+TEST_F(CrsfBufferManagementTest, BufferManagement_FrameAcrossRingWrap_ParsedCorrectly) {
+    std::vector<uint8_t> stream;
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = {0};
+    // 9 кадров каналов (234 байта) + GPS (19 байт) = 253 байта,
+    // второй GPS кадр начинается на позиции 253 и переходит через конец кольца (256)
+    for (int i = 0; i < 9; i++) {
+        appendFrame(stream, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+    }
+    uint8_t gps1[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0x01, 0x02, 0x03, 0x04};
+    uint8_t gps2[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0x02, 0x1C, 0xDB, 0x4E, 0x00, 0x5B, 0x8D, 0x80};
+    appendFrame(stream, CRSF_FRAMETYPE_GPS, gps1, sizeof(gps1));
+    appendFrame(stream, CRSF_FRAMETYPE_GPS, gps2, sizeof(gps2));
+    ASSERT_GT(stream.size(), static_cast<size_t>(CrsfSerial::CRSF_RX_RING_SIZE));
+
+    size_t pos = 0;
+    EXPECT_CALL(*mockSerial, readByte(_))
+        .WillRepeatedly(Invoke([&](uint8_t& b) {
+            if (pos >= stream.size()) return 0;
+            b = stream[pos++];
+            return 1;
+        }));
+
+    crsf->loop();
+    crsf->loop();
+
+    EXPECT_EQ(crsf->getRxFrameCount(), 11u);
+    EXPECT_EQ(crsf->getGpsSensor()->latitude, 0x021CDB4E);
+    EXPECT_EQ(crsf->getGpsSensor()->longitude, 0x005B8D80);
+}
+
+/**
+ * @test Число системных вызовов чтения на кадр
+ * 
+ * Тест проверяет, что поток из многих кадров читается пакетно:
+ * число вызовов SerialPort::read() значительно меньше числа кадров.
+ */
+TEST_F(CrsfBufferManagementTest, BufferManagement_BulkRead_FewReadCallsPerFrame) {
+    std::vector<uint8_t> stream;
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = {0};
+    for (int i = 0; i < 100; i++) {
+        appendFrame(stream, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+    }
+
+    size_t pos = 0;
+    EXPECT_CALL(*mockSerial, readByte(_))
+        .WillRepeatedly(Invoke([&](uint8_t& b) {
+            if (pos >= stream.size()) return 0;
+            b = stream[pos++];
+            return 1;
+        }));
+
+    while (pos < stream.size()) {
+        crsf->loop();
+    }
+
+    EXPECT_EQ(crsf->getRxFrameCount(), 100u);
+    EXPECT_LT(crsf->getRxReadsPerFrame(), 0.25);
+}
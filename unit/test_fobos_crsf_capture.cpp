@@ -0,0 +1,281 @@
+/**
+ * @file test_fobos_crsf_capture.cpp
+ * @brief Unit тесты для записи сырого потока CRSF (CrsfCapture)
+ *
+ * Тесты проверяют:
+ * - Заголовок файла и запись начала сеанса
+ * - Порции приёма и отправки с временем и направлением, слияние по времени
+ * - Переполнение кольца: порция отбрасывается, в файл уходит запись о потере
+ * - Дописывание в существующий файл и отказ писать в чужой
+ * - Запись потока из CrsfSerial (read() и queuePacket)
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/capture.h"
+#include "../libs/crsf/crsf_protocol.h"
+#include "mocks/MockSerialPort.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace {
+
+struct ParsedRecord {
+    CaptureRecord rec;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Разбор файла записи: заголовок и список записей
+ */
+bool parseCapture(const std::string& path, CaptureFileHeader& hdr, std::vector<ParsedRecord>& out)
+{
+    std::ifstream f(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (bytes.size() < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, bytes.data(), sizeof(hdr));
+    size_t pos = hdr.headerSize;
+    while (pos + sizeof(CaptureRecord) <= bytes.size()) {
+        ParsedRecord r;
+        memcpy(&r.rec, &bytes[pos], sizeof(r.rec));
+        pos += sizeof(r.rec);
+        if (pos + r.rec.length > bytes.size()) {
+            return false;
+        }
+        r.data.assign(bytes.begin() + pos, bytes.begin() + pos + r.rec.length);
+        pos += r.rec.length;
+        out.push_back(r);
+    }
+    return pos == bytes.size();
+}
+
+} // namespace
+
+/**
+ * @class CrsfCaptureTest
+ * @brief Фикстура: временный файл записи
+ */
+class CrsfCaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = "/tmp/test_fobos_capture_" + std::to_string(getpid()) + ".bin";
+        unlink(path.c_str());
+    }
+    void TearDown() override {
+        unlink(path.c_str());
+    }
+
+    std::string path;
+};
+
+/**
+ * @test Заголовок файла и начало сеанса
+ */
+TEST_F(CrsfCaptureTest, Open_WritesHeaderAndSession) {
+    CrsfCapture cap;
+    ASSERT_TRUE(cap.open(path, 420000));
+    cap.close();
+
+    CaptureFileHeader hdr;
+    std::vector<ParsedRecord> recs;
+    ASSERT_TRUE(parseCapture(path, hdr, recs));
+    EXPECT_EQ(memcmp(hdr.magic, CAPTURE_MAGIC, sizeof(hdr.magic)), 0);
+    EXPECT_EQ(hdr.version, CAPTURE_VERSION);
+    EXPECT_EQ(hdr.headerSize, sizeof(CaptureFileHeader));
+    EXPECT_EQ(hdr.recordSize, sizeof(CaptureRecord));
+    ASSERT_EQ(recs.size(), 1u);
+    EXPECT_EQ(recs[0].rec.kind, CAPTURE_KIND_SESSION);
+    ASSERT_EQ(recs[0].data.size(), sizeof(CaptureSession));
+    CaptureSession session;
+    memcpy(&session, recs[0].data.data(), sizeof(session));
+    EXPECT_EQ(session.baud, 420000u);
+    EXPECT_GT(session.realtimeNs, 0u);
+}
+
+/**
+ * @test Порции обоих направлений попадают в файл по времени
+ */
+TEST_F(CrsfCaptureTest, Record_BothDirectionsMergedByTime) {
+    CrsfCapture cap;
+    ASSERT_TRUE(cap.open(path, 420000));
+    const uint8_t rx1[] = {0xC8, 0x04, 0x1E};
+    const uint8_t rx2[] = {0x01, 0x02};
+    const uint8_t tx1[] = {0xC8, 0x18, 0x16, 0xAA};
+    cap.record(CAPTURE_RX, 1000, rx1, sizeof(rx1));
+    cap.record(CAPTURE_RX, 3000, rx2, sizeof(rx2));
+    cap.record(CAPTURE_TX, 2000, tx1, sizeof(tx1));
+    cap.close();
+
+    CaptureFileHeader hdr;
+    std::vector<ParsedRecord> recs;
+    ASSERT_TRUE(parseCapture(path, hdr, recs));
+    ASSERT_EQ(recs.size(), 4u);
+    EXPECT_EQ(recs[1].rec.timestampNs, 1000u);
+    EXPECT_EQ(recs[1].rec.direction, CAPTURE_RX);
+    EXPECT_EQ(recs[1].data, std::vector<uint8_t>(rx1, rx1 + sizeof(rx1)));
+    EXPECT_EQ(recs[2].rec.timestampNs, 2000u);
+    EXPECT_EQ(recs[2].rec.direction, CAPTURE_TX);
+    EXPECT_EQ(recs[2].data, std::vector<uint8_t>(tx1, tx1 + sizeof(tx1)));
+    EXPECT_EQ(recs[3].rec.timestampNs, 3000u);
+    EXPECT_EQ(recs[3].data, std::vector<uint8_t>(rx2, rx2 + sizeof(rx2)));
+
+    CaptureStats s = cap.stats();
+    EXPECT_EQ(s.bytes[CAPTURE_RX], 5u);
+    EXPECT_EQ(s.bytes[CAPTURE_TX], 4u);
+    EXPECT_EQ(s.records, 4u);
+    EXPECT_EQ(s.writeErrors, 0u);
+}
+
+/**
+ * @test Порции через конец кольца и переполнение
+ *
+ * Кольцо 4 КБ, поток записи не успевает (период сброса 10 с): после заполнения
+ * порции отбрасываются, а при сбросе в файл уходит запись о потерянных байтах.
+ */
+TEST_F(CrsfCaptureTest, Record_RingOverflowReportsGap) {
+    CrsfCapture cap(4096, 10000);
+    ASSERT_TRUE(cap.open(path, 420000));
+    uint8_t chunk[100];
+    size_t accepted = 0;
+    for (int i = 0; i < 60; ++i) {
+        memset(chunk, i, sizeof(chunk));
+        cap.record(CAPTURE_RX, 100 + i, chunk, sizeof(chunk));
+    }
+    CaptureStats s = cap.stats();
+    accepted = s.bytes[CAPTURE_RX] / sizeof(chunk);
+    EXPECT_EQ(accepted, 4096 / (sizeof(CaptureRecord) + sizeof(chunk)));
+    EXPECT_EQ(s.droppedBytes[CAPTURE_RX], (60 - accepted) * sizeof(chunk));
+
+    // После сброса место освобождается, следующие порции идут через конец кольца
+    cap.flush();
+    for (int i = 60; i < 80; ++i) {
+        memset(chunk, i, sizeof(chunk));
+        cap.record(CAPTURE_RX, 100 + i, chunk, sizeof(chunk));
+    }
+    cap.close();
+
+    CaptureFileHeader hdr;
+    std::vector<ParsedRecord> recs;
+    ASSERT_TRUE(parseCapture(path, hdr, recs));
+    size_t gaps = 0;
+    size_t data = 0;
+    for (const auto& r : recs) {
+        if (r.rec.kind == CAPTURE_KIND_GAP) {
+            ++gaps;
+            uint64_t lost;
+            ASSERT_EQ(r.data.size(), sizeof(lost));
+            memcpy(&lost, r.data.data(), sizeof(lost));
+            EXPECT_EQ(lost, (60 - accepted) * sizeof(chunk));
+            EXPECT_EQ(r.rec.direction, CAPTURE_RX);
+        } else if (r.rec.kind == CAPTURE_KIND_DATA) {
+            // Содержимое порции соответствует её номеру
+            uint8_t n = static_cast<uint8_t>(r.rec.timestampNs - 100);
+            EXPECT_EQ(r.data, std::vector<uint8_t>(sizeof(chunk), n));
+            ++data;
+        }
+    }
+    EXPECT_EQ(gaps, 1u);
+    EXPECT_EQ(data, accepted + 20);
+}
+
+/**
+ * @test Дописывание в существующий файл: новый сеанс после старых данных
+ */
+TEST_F(CrsfCaptureTest, Open_AppendsToExistingCapture) {
+    const uint8_t b[] = {1, 2, 3};
+    {
+        CrsfCapture cap;
+        ASSERT_TRUE(cap.open(path, 420000));
+        cap.record(CAPTURE_RX, 10, b, sizeof(b));
+    }
+    {
+        CrsfCapture cap;
+        ASSERT_TRUE(cap.open(path, 416666));
+        cap.record(CAPTURE_TX, 20, b, sizeof(b));
+    }
+    CaptureFileHeader hdr;
+    std::vector<ParsedRecord> recs;
+    ASSERT_TRUE(parseCapture(path, hdr, recs));
+    ASSERT_EQ(recs.size(), 4u);
+    EXPECT_EQ(recs[0].rec.kind, CAPTURE_KIND_SESSION);
+    EXPECT_EQ(recs[1].rec.direction, CAPTURE_RX);
+    EXPECT_EQ(recs[2].rec.kind, CAPTURE_KIND_SESSION);
+    EXPECT_EQ(recs[3].rec.direction, CAPTURE_TX);
+}
+
+/**
+ * @test Чужой файл не дописывается
+ */
+TEST_F(CrsfCaptureTest, Open_RejectsForeignFile) {
+    {
+        std::ofstream f(path);
+        f << "not a capture file at all";
+    }
+    CrsfCapture cap;
+    EXPECT_FALSE(cap.open(path, 420000));
+    EXPECT_FALSE(cap.isOpen());
+    cap.record(CAPTURE_RX, 1, reinterpret_cast<const uint8_t*>("x"), 1); // без колец — ничего
+    EXPECT_EQ(cap.stats().bytes[CAPTURE_RX], 0u);
+}
+
+/**
+ * @test CrsfSerial пишет принятые порции и отправленные кадры
+ */
+TEST_F(CrsfCaptureTest, CrsfSerial_CapturesRxAndTx) {
+    MockSerialPort port;
+    CrsfSerial crsf(port, 420000);
+    CrsfCapture cap;
+    ASSERT_TRUE(cap.open(path, 420000));
+    crsf.setCapture(&cap);
+
+    // Кадр каналов: поднимает линк, иначе queuePacket ничего не отправит
+    uint8_t frame[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + 4] = {0};
+    frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    frame[1] = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + 2;
+    frame[2] = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
+    Crc8 crc(0xD5);
+    frame[sizeof(frame) - 1] = crc.calc(&frame[2], CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + 1);
+    size_t rxPos = 0;
+    EXPECT_CALL(port, readByte(_)).WillRepeatedly(Invoke([&](uint8_t& b) {
+        if (rxPos >= sizeof(frame)) {
+            return 0;
+        }
+        b = frame[rxPos++];
+        return 1;
+    }));
+    crsf.loop();
+    ASSERT_TRUE(crsf.isLinkUp());
+
+    uint8_t payload[4] = {1, 2, 3, 4};
+    EXPECT_CALL(port, write(_, 8)).WillOnce(Return(8));
+    crsf.queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_ATTITUDE, payload, sizeof(payload));
+
+    crsf.setCapture(nullptr);
+    cap.close();
+
+    CaptureFileHeader hdr;
+    std::vector<ParsedRecord> recs;
+    ASSERT_TRUE(parseCapture(path, hdr, recs));
+    ASSERT_EQ(recs.size(), 3u);
+    EXPECT_EQ(recs[1].rec.direction, CAPTURE_RX);
+    EXPECT_EQ(recs[1].data, std::vector<uint8_t>(frame, frame + sizeof(frame)));
+    EXPECT_EQ(recs[2].rec.direction, CAPTURE_TX);
+    ASSERT_EQ(recs[2].data.size(), 8u);
+    EXPECT_EQ(recs[2].data[2], CRSF_FRAMETYPE_ATTITUDE);
+    EXPECT_LE(recs[1].rec.timestampNs, recs[2].rec.timestampNs);
+}
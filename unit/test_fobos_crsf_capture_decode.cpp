@@ -0,0 +1,306 @@
+/**
+ * @file test_fobos_crsf_capture_decode.cpp
+ * @brief Unit тесты для пакетного разбора записей в таблицы (capture_decode)
+ *
+ * Тесты проверяют:
+ * - Значения столбцов совпадают с телеметрией CrsfSerial на том же потоке
+ * - Результат не зависит от числа потоков (кадры на границах частей, мусор, CRC)
+ * - Столбцы фиксированной ширины и CSV на диске
+ * - Общие функции разбора данных кадров (frame_decode.h)
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/capture.h"
+#include "../libs/crsf/capture_decode.h"
+#include "../libs/crsf/capture_replay.h"
+#include "../libs/crsf/channel_codec.h"
+#include "../libs/crsf/crc8.h"
+#include "../libs/crsf/frame_decode.h"
+
+namespace {
+
+std::vector<uint8_t> makeFrame(uint8_t type, const std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> f;
+    f.push_back(CRSF_ADDRESS_FLIGHT_CONTROLLER);
+    f.push_back(static_cast<uint8_t>(payload.size() + 2));
+    f.push_back(type);
+    f.insert(f.end(), payload.begin(), payload.end());
+    Crc8 crc(0xD5);
+    f.push_back(crc.calc(&f[2], static_cast<uint8_t>(payload.size() + 1)));
+    return f;
+}
+
+/**
+ * @brief Поток полётника с изменяющимися значениями: каналы, ориентация, батарея, GPS, статистика
+ */
+std::vector<uint8_t> flightFrame(int i)
+{
+    switch (i % 5) {
+    case 0: {
+        int us[CRSF_NUM_CHANNELS];
+        for (int ch = 0; ch < CRSF_NUM_CHANNELS; ++ch) {
+            us[ch] = 1000 + (i * 7 + ch * 61) % 1001;
+        }
+        std::vector<uint8_t> p(CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE);
+        crsf_channels_encode(us, p.data());
+        return makeFrame(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, p);
+    }
+    case 1: {
+        int16_t roll = static_cast<int16_t>(i * 3 - 5000);
+        return makeFrame(CRSF_FRAMETYPE_ATTITUDE, {0x01, 0x10, static_cast<uint8_t>(roll >> 8),
+                                                   static_cast<uint8_t>(roll), 0xFF, 0x00});
+    }
+    case 2:
+        return makeFrame(CRSF_FRAMETYPE_BATTERY_SENSOR, {0x06, static_cast<uint8_t>(i), 0x00, 0x0A, 0x00, 0x05,
+                                                         static_cast<uint8_t>(i >> 4), 80});
+    case 3:
+        return makeFrame(CRSF_FRAMETYPE_GPS, {0x21, 0x3A, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i),
+                                              0xF6, 0x6B, 0x8C, 0x20, 0x00, 0x7D, 0x46, 0x50, 0x04, 0x4C, 12});
+    default:
+        return makeFrame(CRSF_FRAMETYPE_LINK_STATISTICS, {50, 52, static_cast<uint8_t>(i % 101), 0xFB, 0, 4, 2,
+                                                          60, 98, 3});
+    }
+}
+
+} // namespace
+
+/**
+ * @class CaptureDecodeTest
+ * @brief Фикстура: временная запись и каталог вывода
+ */
+class CaptureDecodeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = "/tmp/test_fobos_decode_" + std::to_string(getpid()) + ".cap";
+        outDir = "/tmp/test_fobos_decode_" + std::to_string(getpid()) + ".out";
+        unlink(path.c_str());
+    }
+    void TearDown() override {
+        unlink(path.c_str());
+        std::string cmd = "rm -rf " + outDir;
+        (void)system(cmd.c_str());
+    }
+
+    /**
+     * @brief frames кадров порциями разного размера (кадры режутся между записями),
+     * каждые 97 кадров — мусор, каждые 131 — кадр с испорченным CRC, иногда кадр TX
+     */
+    void writeFlight(int frames) {
+        CrsfCapture cap(16u << 20, 1000);
+        ASSERT_TRUE(cap.open(path, CRSF_BAUDRATE));
+        std::vector<uint8_t> stream;
+        for (int i = 0; i < frames; ++i) {
+            if (i % 97 == 13) {
+                stream.insert(stream.end(), {0x00, 0xEE, 0xC8, 0x7F});
+            }
+            std::vector<uint8_t> f = flightFrame(i);
+            if (i % 131 == 7) {
+                f.back() ^= 0x33;
+                ++badFrames;
+            }
+            stream.insert(stream.end(), f.begin(), f.end());
+        }
+        uint64_t ts = 1000000000ull;
+        size_t chunk = 1;
+        for (size_t pos = 0; pos < stream.size(); pos += chunk, chunk = chunk % 37 + 3, ts += 100000) {
+            size_t n = std::min(chunk, stream.size() - pos);
+            cap.record(CAPTURE_RX, ts, &stream[pos], n);
+            if (pos % 7 == 0) {
+                std::vector<uint8_t> tx = flightFrame(0);
+                cap.record(CAPTURE_TX, ts + 1, tx.data(), tx.size());
+            }
+        }
+        cap.close();
+        ASSERT_EQ(cap.stats().droppedBytes[CAPTURE_RX], 0u);
+    }
+
+    std::string path;
+    std::string outDir;
+    int badFrames = 0;
+};
+
+/**
+ * @test Последние строки таблиц совпадают с телеметрией CrsfSerial после воспроизведения
+ */
+TEST_F(CaptureDecodeTest, Decode_MatchesCrsfSerial) {
+    writeFlight(1000);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureTables tables;
+    capture_decode(file, tables, 1);
+
+    CaptureReplayPort port(file);
+    CrsfSerial crsf(port);
+    while (!port.atEnd()) {
+        crsf.loop();
+    }
+    CrsfLinkCounters c = crsf.getLinkCounters();
+    EXPECT_EQ(tables.rows(), c.rxFrames);
+    EXPECT_EQ(tables.crcErrors, c.rxCrcErrors);
+    EXPECT_EQ(tables.crcErrors, static_cast<uint64_t>(badFrames));
+    EXPECT_EQ(tables.otherFrames, 0u);
+    EXPECT_EQ(tables[CAPTURE_TABLE_CHANNELS].rows, c.rxFramesByKind[CRSF_LINK_FRAME_CHANNELS]);
+    EXPECT_EQ(tables[CAPTURE_TABLE_ATTITUDE].rows, c.rxFramesByKind[CRSF_LINK_FRAME_ATTITUDE]);
+    EXPECT_EQ(tables[CAPTURE_TABLE_GPS].rows, c.rxFramesByKind[CRSF_LINK_FRAME_GPS]);
+
+    TelemetrySnapshot s = crsf.snapshot();
+    const CaptureTable& att = tables[CAPTURE_TABLE_ATTITUDE];
+    size_t last = att.rows - 1;
+    EXPECT_EQ(att.column("rawRoll")->at<int16_t>(last), s.rawAttitudeRoll);
+    EXPECT_DOUBLE_EQ(att.column("roll")->at<double>(last), s.attitudeRoll);
+    EXPECT_DOUBLE_EQ(att.column("yaw")->at<double>(last), s.attitudeYaw);
+
+    const CaptureTable& gps = tables[CAPTURE_TABLE_GPS];
+    EXPECT_EQ(gps.column("latitude")->at<int32_t>(gps.rows - 1), s.gps.latitude);
+    EXPECT_EQ(gps.column("satellites")->at<uint8_t>(gps.rows - 1), s.gps.satellites);
+
+    const CaptureTable& bat = tables[CAPTURE_TABLE_BATTERY];
+    EXPECT_DOUBLE_EQ(bat.column("voltage")->at<double>(bat.rows - 1), s.batteryVoltage);
+    EXPECT_EQ(bat.column("capacity")->at<uint32_t>(bat.rows - 1), static_cast<uint32_t>(s.batteryCapacity));
+
+    const CaptureTable& ch = tables[CAPTURE_TABLE_CHANNELS];
+    for (int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        EXPECT_EQ(ch.column("ch" + std::to_string(i + 1))->at<uint16_t>(ch.rows - 1), s.channels[i]);
+    }
+
+    const CaptureTable& link = tables[CAPTURE_TABLE_LINK_STATISTICS];
+    EXPECT_EQ(link.column("uplinkLinkQuality")->at<uint8_t>(link.rows - 1), s.linkStatistics.uplink_Link_quality);
+    EXPECT_EQ(link.column("uplinkSnr")->at<int8_t>(link.rows - 1), s.linkStatistics.uplink_SNR);
+
+    // Время строк не убывает
+    const CaptureColumn* time = att.column("timeNs");
+    for (size_t r = 1; r < att.rows; ++r) {
+        EXPECT_LE(time->at<uint64_t>(r - 1), time->at<uint64_t>(r));
+    }
+}
+
+/**
+ * @test Любое число потоков даёт те же таблицы, что и один поток
+ */
+TEST_F(CaptureDecodeTest, Decode_IndependentOfThreadCount) {
+    writeFlight(5000);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureTables single;
+    EXPECT_EQ(capture_decode(file, single, 1), 1u);
+    EXPECT_EQ(single.rows(), 5000u - badFrames);
+
+    for (unsigned int threads : {2u, 3u, 5u, 8u, 13u, 64u}) {
+        CaptureTables multi;
+        unsigned int used = capture_decode(file, multi, threads);
+        EXPECT_EQ(used, threads);
+        EXPECT_EQ(multi.crcErrors, single.crcErrors) << threads;
+        for (unsigned int id = 0; id < CAPTURE_TABLES; ++id) {
+            const CaptureTable& a = single.tables[id];
+            const CaptureTable& b = multi.tables[id];
+            ASSERT_EQ(a.rows, b.rows) << a.name << " threads " << threads;
+            for (size_t c = 0; c < a.columns.size(); ++c) {
+                EXPECT_EQ(a.columns[c].data, b.columns[c].data) << a.name << "." << a.columns[c].name;
+            }
+        }
+    }
+}
+
+/**
+ * @test Запись без кадров и пустая запись
+ */
+TEST_F(CaptureDecodeTest, Decode_EmptyCapture) {
+    {
+        CrsfCapture cap;
+        ASSERT_TRUE(cap.open(path, CRSF_BAUDRATE));
+        const uint8_t junk[] = {0xFF, 0xFF, 0x01};
+        cap.record(CAPTURE_RX, 10, junk, sizeof(junk));
+    }
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureTables tables;
+    capture_decode(file, tables, 4);
+    EXPECT_EQ(tables.rows(), 0u);
+    EXPECT_EQ(tables[CAPTURE_TABLE_GPS].columns.size(), 7u);
+}
+
+/**
+ * @test Столбцы на диске: по файлу на столбец, размер — строки × ширина; CSV с заголовком
+ */
+TEST_F(CaptureDecodeTest, Write_ColumnsAndCsv) {
+    writeFlight(500);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureTables tables;
+    capture_decode(file, tables, 2);
+    ASSERT_TRUE(capture_write_columns(tables, outDir));
+    ASSERT_TRUE(capture_write_csv(tables, outDir));
+
+    const CaptureTable& gps = tables[CAPTURE_TABLE_GPS];
+    std::ifstream lat(outDir + "/gps.latitude.i32", std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(lat)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(bytes.size(), gps.rows * 4);
+    int32_t first;
+    memcpy(&first, bytes.data(), sizeof(first));
+    EXPECT_EQ(first, gps.column("latitude")->at<int32_t>(0));
+
+    std::ifstream csv(outDir + "/battery.csv");
+    std::string header;
+    std::getline(csv, header);
+    EXPECT_EQ(header, "timeNs,voltage,current,capacity,remaining");
+    std::string line;
+    size_t lines = 0;
+    std::string firstRow;
+    while (std::getline(csv, line)) {
+        if (lines == 0) {
+            firstRow = line;
+        }
+        ++lines;
+    }
+    const CaptureTable& bat = tables[CAPTURE_TABLE_BATTERY];
+    EXPECT_EQ(lines, bat.rows);
+    std::ostringstream expected;
+    expected << bat.column("timeNs")->at<uint64_t>(0) << "," << bat.column("voltage")->at<double>(0) << ",10,"
+             << bat.column("capacity")->at<uint32_t>(0) << ",80";
+    EXPECT_EQ(firstRow, expected.str());
+}
+
+/**
+ * @test Общие функции разбора данных кадров
+ */
+TEST(CrsfFrameDecodeTest, DecodesBigEndianFields) {
+    const uint8_t gpsData[CRSF_FRAME_GPS_PAYLOAD_SIZE] = {0xFF, 0xFF, 0xFF, 0xFE, 0x01, 0x02, 0x03, 0x04,
+                                                         0x00, 0x7D, 0x46, 0x50, 0x04, 0x4C, 9};
+    crsf_sensor_gps_t gps;
+    crsf_decode_gps(gpsData, gps);
+    EXPECT_EQ(gps.latitude, -2);
+    EXPECT_EQ(gps.longitude, 0x01020304);
+    EXPECT_EQ(gps.groundspeed, 125);
+    EXPECT_EQ(gps.heading, 18000);
+    EXPECT_EQ(gps.altitude, 1100);
+    EXPECT_EQ(gps.satellites, 9);
+
+    const uint8_t attData[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0x00, 0xAF, 0xFF, 0x51, 0xFF, 0x51};
+    CrsfAttitude a;
+    crsf_decode_attitude(attData, a);
+    EXPECT_EQ(a.rawPitch, 175);
+    EXPECT_EQ(a.rawRoll, -175);
+    EXPECT_DOUBLE_EQ(a.pitch, 1.0);
+    EXPECT_DOUBLE_EQ(a.roll, -1.0);
+    EXPECT_DOUBLE_EQ(a.yaw, 359.0);
+
+    const uint8_t batData[CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE] = {0x06, 0x72, 0x00, 0x0A, 0x01, 0x00, 0x02, 55};
+    CrsfBattery b;
+    crsf_decode_battery(batData, b);
+    EXPECT_DOUBLE_EQ(b.voltage, 16.5);
+    EXPECT_DOUBLE_EQ(b.current, 10);
+    EXPECT_DOUBLE_EQ(b.capacity, 65538);
+    EXPECT_EQ(b.remaining, 55);
+}
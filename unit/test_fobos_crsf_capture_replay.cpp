@@ -0,0 +1,308 @@
+/**
+ * @file test_fobos_crsf_capture_replay.cpp
+ * @brief Unit тесты для воспроизведения записей сырого потока (CaptureFile, CaptureIndex, CaptureReplayPort)
+ *
+ * Тесты проверяют:
+ * - Индекс кадров: кадры, разрезанные между записями, мусор, CRC, кадры TX, потери при записи
+ * - Сохранение индекса рядом с записью и перестроение после дописывания
+ * - Поиск кадра по времени и по типу
+ * - Воспроизведение через CrsfSerial целиком и с произвольного кадра
+ * - Воспроизведение в темпе записи с множителем скорости
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/capture.h"
+#include "../libs/crsf/capture_replay.h"
+#include "../libs/crsf/crc8.h"
+#include "../libs/crsf/crsf_protocol.h"
+#include "../libs/rpi_hal.h"
+
+namespace {
+
+std::vector<uint8_t> makeFrame(uint8_t type, uint8_t payloadLen, uint8_t fill)
+{
+    std::vector<uint8_t> f(payloadLen + 4u, fill);
+    f[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    f[1] = static_cast<uint8_t>(payloadLen + 2);
+    f[2] = type;
+    Crc8 crc(0xD5);
+    f[payloadLen + 3u] = crc.calc(&f[2], static_cast<uint8_t>(payloadLen + 1));
+    return f;
+}
+
+std::vector<uint8_t> attitudeFrame(int16_t roll)
+{
+    std::vector<uint8_t> f = makeFrame(CRSF_FRAMETYPE_ATTITUDE, CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE, 0);
+    // Байты 2-3 данных — крен (см. CrsfSerial::packetAttitude)
+    f[5] = static_cast<uint8_t>(static_cast<uint16_t>(roll) >> 8);
+    f[6] = static_cast<uint8_t>(roll);
+    Crc8 crc(0xD5);
+    f[f.size() - 1] = crc.calc(&f[2], CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE + 1);
+    return f;
+}
+
+void record(CrsfCapture& cap, CaptureDirection dir, uint64_t ts, const std::vector<uint8_t>& bytes)
+{
+    cap.record(dir, ts, bytes.data(), bytes.size());
+}
+
+} // namespace
+
+/**
+ * @class CaptureReplayTest
+ * @brief Фикстура: временные файлы записи и индекса
+ */
+class CaptureReplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = "/tmp/test_fobos_replay_" + std::to_string(getpid()) + ".cap";
+        indexPath = path + ".idx";
+        unlink(path.c_str());
+        unlink(indexPath.c_str());
+    }
+    void TearDown() override {
+        unlink(path.c_str());
+        unlink(indexPath.c_str());
+    }
+
+    /**
+     * @brief Запись: 100 кадров ориентации (крен = номер) через 1 мс, каждый третий разрезан
+     * между двумя записями; перед кадрами мусор, после 50-го — кадр с испорченным CRC,
+     * на каждый десятый — ответный кадр TX
+     */
+    void writeFlight(uint64_t baseNs) {
+        CrsfCapture cap;
+        ASSERT_TRUE(cap.open(path, CRSF_BAUDRATE));
+        record(cap, CAPTURE_RX, baseNs, {0xFF, 0x00, 0xEE});
+        for (int i = 0; i < 100; ++i) {
+            uint64_t ts = baseNs + 1000000ull * (i + 1);
+            std::vector<uint8_t> f = attitudeFrame(static_cast<int16_t>(i));
+            if (i % 3 == 0) {
+                record(cap, CAPTURE_RX, ts, std::vector<uint8_t>(f.begin(), f.begin() + 5));
+                record(cap, CAPTURE_RX, ts + 1000, std::vector<uint8_t>(f.begin() + 5, f.end()));
+            } else {
+                record(cap, CAPTURE_RX, ts, f);
+            }
+            if (i % 10 == 0) {
+                record(cap, CAPTURE_TX, ts + 2000, makeFrame(CRSF_FRAMETYPE_RC_CHANNELS_PACKED,
+                                                             CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE, 0x11));
+            }
+            if (i == 50) {
+                std::vector<uint8_t> bad = makeFrame(CRSF_FRAMETYPE_BATTERY_SENSOR, CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE, 1);
+                bad.back() ^= 0x5A;
+                record(cap, CAPTURE_RX, ts + 3000, bad);
+            }
+        }
+        cap.close();
+    }
+
+    std::string path;
+    std::string indexPath;
+};
+
+/**
+ * @test Индекс: все кадры обоих направлений, разрезанные кадры начинаются в своей первой записи
+ */
+TEST_F(CaptureReplayTest, Index_FindsFramesAcrossRecords) {
+    writeFlight(1000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_EQ(file.firstTimestampNs(), 1000000000ull);
+
+    CaptureIndex index;
+    index.build(file);
+    EXPECT_EQ(index.frameCount(), 110u);
+    EXPECT_EQ(index.countOfType(CRSF_FRAMETYPE_ATTITUDE), 100u);
+    EXPECT_EQ(index.countOfType(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, CAPTURE_TX), 10u);
+    EXPECT_EQ(index.countOfType(CRSF_FRAMETYPE_BATTERY_SENSOR), 0u);
+    EXPECT_EQ(index.crcErrors(CAPTURE_RX), 1u);
+    EXPECT_EQ(index.crcErrors(CAPTURE_TX), 0u);
+    EXPECT_EQ(index.captureSize(), file.size());
+
+    // Каждый кадр ориентации начинается с адреса, время — время его первой записи
+    int attitude = 0;
+    for (const auto& e : index.frames()) {
+        CaptureRecord rec;
+        const uint8_t* payload;
+        ASSERT_TRUE(file.recordAt(e.recordOffset, rec, payload));
+        EXPECT_EQ(payload[e.offsetInRecord], CRSF_ADDRESS_FLIGHT_CONTROLLER);
+        EXPECT_EQ(rec.timestampNs, e.timestampNs);
+        if (e.type == CRSF_FRAMETYPE_ATTITUDE) {
+            EXPECT_EQ(e.timestampNs, 1000000000ull + 1000000ull * (attitude + 1));
+            EXPECT_EQ(e.length, CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE + 4);
+            ++attitude;
+        }
+    }
+}
+
+/**
+ * @test Потери при записи учитываются, поток после потери продолжает разбираться
+ */
+TEST_F(CaptureReplayTest, Index_CountsGapBytes) {
+    {
+        CrsfCapture cap(4096, 10000);
+        ASSERT_TRUE(cap.open(path, CRSF_BAUDRATE));
+        std::vector<uint8_t> f = attitudeFrame(1);
+        for (int i = 0; i < 400; ++i) {
+            record(cap, CAPTURE_RX, 1000 + i, f);
+        }
+    }
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureIndex index;
+    index.build(file);
+    EXPECT_GT(index.gapBytes(CAPTURE_RX), 0u);
+    EXPECT_EQ(index.gapBytes(CAPTURE_RX) % (CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE + 4), 0u);
+    EXPECT_EQ(index.frameCount() + index.gapBytes(CAPTURE_RX) / (CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE + 4), 400u);
+}
+
+/**
+ * @test Индекс сохраняется рядом с записью и перестраивается, если запись дописана
+ */
+TEST_F(CaptureReplayTest, Index_SaveLoadAndRebuildAfterAppend) {
+    writeFlight(1000000000ull);
+    {
+        CaptureFile file;
+        ASSERT_TRUE(file.open(path));
+        CaptureIndex index;
+        ASSERT_TRUE(index.load(file, indexPath));
+        EXPECT_EQ(index.frameCount(), 110u);
+        EXPECT_EQ(access(indexPath.c_str(), F_OK), 0);
+
+        CaptureIndex loaded;
+        ASSERT_TRUE(loaded.load(file, indexPath));
+        ASSERT_EQ(loaded.frameCount(), index.frameCount());
+        EXPECT_EQ(memcmp(loaded.frames().data(), index.frames().data(),
+                         index.frameCount() * sizeof(CaptureFrameEntry)), 0);
+        EXPECT_EQ(loaded.crcErrors(CAPTURE_RX), 1u);
+    }
+
+    // Второй сеанс в тот же файл: старый индекс не подходит по размеру
+    writeFlight(5000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureIndex index;
+    ASSERT_TRUE(index.load(file, indexPath));
+    EXPECT_EQ(index.frameCount(), 220u);
+    EXPECT_EQ(index.captureSize(), file.size());
+}
+
+/**
+ * @test Поиск кадра по времени и следующего кадра данного типа
+ */
+TEST_F(CaptureReplayTest, Index_FrameAtTimeAndNextOfType) {
+    writeFlight(1000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureIndex index;
+    index.build(file);
+
+    size_t i = index.frameAtTime(1000000000ull + 30500000ull);
+    ASSERT_LT(i, index.frameCount());
+    EXPECT_EQ(index.frame(i).timestampNs, 1000000000ull + 31000000ull);
+    EXPECT_EQ(index.frameAtTime(0), 0u);
+    EXPECT_EQ(index.frameAtTime(UINT64_MAX), index.frameCount());
+
+    size_t tx = index.nextOfType(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, 0, CAPTURE_TX);
+    ASSERT_LT(tx, index.frameCount());
+    EXPECT_EQ(index.frame(tx).direction, CAPTURE_TX);
+    EXPECT_EQ(index.nextOfType(CRSF_FRAMETYPE_GPS, 0), index.frameCount());
+}
+
+/**
+ * @test Воспроизведение целиком: парсер видит те же кадры, что и индекс; запись в порт отбрасывается
+ */
+TEST_F(CaptureReplayTest, Replay_FlatOutThroughCrsfSerial) {
+    writeFlight(1000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureReplayPort port(file);
+    CrsfSerial crsf(port);
+    while (!port.atEnd()) {
+        crsf.loop();
+    }
+    CrsfLinkCounters c = crsf.getLinkCounters();
+    EXPECT_EQ(c.rxFrames, 100u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_ATTITUDE], 100u);
+    EXPECT_EQ(c.rxCrcErrors, 1u);
+    EXPECT_EQ(crsf.snapshot().rawAttitudeRoll, 99);
+
+    EXPECT_EQ(port.write(reinterpret_cast<const uint8_t*>("abc"), 3), 3);
+    EXPECT_EQ(port.bytesWritten(), 3u);
+    uint8_t b;
+    EXPECT_EQ(port.read(&b, 1), 0);
+}
+
+/**
+ * @test Воспроизведение с кадра, найденного по времени (в том числе разрезанного между записями)
+ */
+TEST_F(CaptureReplayTest, Replay_SeekToFrame) {
+    writeFlight(1000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureIndex index;
+    index.build(file);
+
+    // Кадр 60 разрезан между записями (60 % 3 == 0)
+    size_t start = index.frameAtTime(1000000000ull + 61000000ull);
+    ASSERT_EQ(index.frame(start).type, CRSF_FRAMETYPE_ATTITUDE);
+    CaptureReplayPort port(file);
+    port.seekFrame(index, start);
+    std::vector<uint8_t> expected = attitudeFrame(60);
+    std::vector<uint8_t> head(expected.size());
+    ASSERT_EQ(port.read(head.data(), head.size()), static_cast<int>(head.size()));
+    EXPECT_EQ(head, expected);
+
+    port.seekFrame(index, start);
+    CrsfSerial crsf(port);
+    while (!port.atEnd()) {
+        crsf.loop();
+    }
+    EXPECT_EQ(crsf.getLinkCounters().rxFrames, 40u);
+    EXPECT_EQ(crsf.getLinkCounters().rxResyncBytes, 0u);
+
+    // Перемотка к началу и за конец
+    port.rewind();
+    EXPECT_FALSE(port.atEnd());
+    port.seekFrame(index, index.frameCount());
+    EXPECT_TRUE(port.atEnd());
+}
+
+/**
+ * @test В темпе записи: 100 мс записи при скорости x4 — около 25 мс, без пауз — сразу
+ */
+TEST_F(CaptureReplayTest, Replay_RealtimePacing) {
+    writeFlight(1000000000ull);
+    CaptureFile file;
+    ASSERT_TRUE(file.open(path));
+    CaptureReplayPort port(file);
+    port.setRealtime(true, 4.0);
+    CrsfSerial crsf(port);
+
+    auto start = std::chrono::steady_clock::now();
+    uint8_t buf[64];
+    EXPECT_GT(port.read(buf, sizeof(buf)), 0);
+    EXPECT_EQ(port.read(buf, sizeof(buf)), 0);  // следующая порция ещё не «пришла»
+    EXPECT_GT(port.nextDueNs(), 0u);
+    port.rewind();
+    while (!port.atEnd()) {
+        crsf.loop();
+        uint64_t due = port.nextDueNs();
+        while (due != 0 && rpi_monotonic_ns() < due) {
+            usleep(200);
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(ms, 24.0);
+    EXPECT_LT(ms, 500.0);
+    EXPECT_EQ(crsf.getLinkCounters().rxFrames, 100u);
+}
@@ -0,0 +1,184 @@
+/**
+ * @file test_fobos_crsf_channel_codec.cpp
+ * @brief Unit тесты для кодека каналов RC_CHANNELS_PACKED
+ * 
+ * Тесты проверяют, что каждая реализация (scalar, SSE2, AVX2, NEON):
+ * - Упаковывает и распаковывает 16 x 11 бит так же, как битовые поля crsf_channels_t
+ * - Преобразует все коды 0..2047 в мкс так же, как эталонная формула
+ * - Кодирует все мкс (включая значения вне диапазона) так же, как эталон с проверкой round-trip
+ * - В пакетном режиме даёт тот же результат, что и покадровый
+ * Отдельно проверяется, что таблицы channel_tables.h совпадают с исходными формулами
+ * 
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../libs/crsf/channel_codec.h"
+#include "../libs/crsf/channel_tables.h"
+#include "../libs/crsf/crsf_protocol.h"
+
+/**
+ * @test Табличное преобразование совпадает с формулами для любых входов, включая вне диапазона
+ */
+TEST(ChannelTablesTest, Lookup_MatchesFormula) {
+    for (int code = -100; code < 5000; code++) {
+        ASSERT_EQ(crsf_code_to_us(code), crsf_code_to_us_calc(code)) << "code=" << code;
+    }
+    for (int us = -100; us < 5000; us++) {
+        ASSERT_EQ(crsf_us_to_code(us), crsf_us_to_code_calc(us)) << "us=" << us;
+    }
+    // Крайние значения диапазона CRSF
+    EXPECT_EQ(crsf_code_to_us(CRSF_CHANNEL_VALUE_MIN), 1000);
+    EXPECT_EQ(crsf_code_to_us(CRSF_CHANNEL_VALUE_MAX), 2000);
+    EXPECT_EQ(crsf_us_to_code(1000), CRSF_CHANNEL_VALUE_1000);
+    EXPECT_EQ(crsf_us_to_code(2000), CRSF_CHANNEL_VALUE_2000);
+}
+
+/**
+ * @class ChannelCodecTest
+ * @brief Параметризованная фикстура: тест выполняется для каждой реализации
+ */
+class ChannelCodecTest : public ::testing::TestWithParam<ChannelCodecImpl> {
+protected:
+    void SetUp() override {
+        saved = channel_codec_get_impl();
+        if (!channel_codec_set_impl(GetParam())) {
+            GTEST_SKIP() << channel_codec_impl_name(GetParam()) << " не поддерживается";
+        }
+    }
+    void TearDown() override { channel_codec_set_impl(saved); }
+
+    ChannelCodecImpl saved;
+};
+
+// Эталонная упаковка через битовые поля протокола
+static void referencePack(const uint16_t codes[16], uint8_t payload[22]) {
+    crsf_channels_t ch;
+    ch.ch0 = codes[0];   ch.ch1 = codes[1];   ch.ch2 = codes[2];   ch.ch3 = codes[3];
+    ch.ch4 = codes[4];   ch.ch5 = codes[5];   ch.ch6 = codes[6];   ch.ch7 = codes[7];
+    ch.ch8 = codes[8];   ch.ch9 = codes[9];   ch.ch10 = codes[10]; ch.ch11 = codes[11];
+    ch.ch12 = codes[12]; ch.ch13 = codes[13]; ch.ch14 = codes[14]; ch.ch15 = codes[15];
+    memcpy(payload, &ch, 22);
+}
+
+/**
+ * @test Упаковка и распаковка совпадают с битовыми полями crsf_channels_t
+ */
+TEST_P(ChannelCodecTest, PackUnpack_MatchesBitfieldLayout) {
+    uint32_t seed = 1;
+    for (int iter = 0; iter < 1000; iter++) {
+        uint16_t codes[16];
+        for (auto& c : codes) {
+            seed = seed * 1103515245u + 12345u;
+            c = static_cast<uint16_t>((seed >> 8) & 0x7FF);
+        }
+        uint8_t expected[22], packed[22];
+        referencePack(codes, expected);
+        crsf_channels_pack(codes, packed);
+        ASSERT_EQ(memcmp(expected, packed, 22), 0) << "iter=" << iter;
+
+        uint16_t unpacked[16];
+        crsf_channels_unpack(expected, unpacked);
+        for (int i = 0; i < 16; i++) {
+            ASSERT_EQ(unpacked[i], codes[i]) << "iter=" << iter << " ch=" << i;
+        }
+    }
+}
+
+/**
+ * @test Декодирование всех 11-битных кодов совпадает с эталоном
+ */
+TEST_P(ChannelCodecTest, Decode_AllCodes_MatchReference) {
+    for (int base = 0; base < 2048; base += 16) {
+        uint16_t codes[16];
+        for (int i = 0; i < 16; i++) {
+            codes[i] = static_cast<uint16_t>(base + i);
+        }
+        uint8_t payload[22];
+        referencePack(codes, payload);
+
+        int us[16];
+        crsf_channels_decode(payload, us);
+        for (int i = 0; i < 16; i++) {
+            ASSERT_EQ(us[i], crsf_code_to_us(codes[i])) << "code=" << codes[i];
+        }
+    }
+}
+
+/**
+ * @test Кодирование всех значений мкс (с запасом за границы) совпадает с эталоном
+ */
+TEST_P(ChannelCodecTest, Encode_AllMicroseconds_MatchReference) {
+    for (int base = -64; base < 3100; base += 16) {
+        int us[16];
+        uint16_t expectedCodes[16];
+        for (int i = 0; i < 16; i++) {
+            us[i] = base + i;
+            expectedCodes[i] = static_cast<uint16_t>(crsf_us_to_code(us[i]));
+        }
+        uint8_t expected[22], payload[22];
+        referencePack(expectedCodes, expected);
+        crsf_channels_encode(us, payload);
+        ASSERT_EQ(memcmp(expected, payload, 22), 0) << "base=" << base;
+    }
+}
+
+/**
+ * @test Round-trip: decode(encode(us)) == us для всего диапазона 1000..2000
+ */
+TEST_P(ChannelCodecTest, RoundTrip_ExactForWholeRange) {
+    for (int base = 1000; base <= 2000; base += 16) {
+        int us[16], decoded[16];
+        for (int i = 0; i < 16; i++) {
+            us[i] = std::min(base + i, 2000);
+        }
+        uint8_t payload[22];
+        crsf_channels_encode(us, payload);
+        crsf_channels_decode(payload, decoded);
+        for (int i = 0; i < 16; i++) {
+            ASSERT_EQ(decoded[i], us[i]);
+        }
+    }
+}
+
+/**
+ * @test Пакетная обработка совпадает с покадровой (payload внутри полных кадров с шагом 26 байт)
+ */
+TEST_P(ChannelCodecTest, Batch_MatchesPerFrame) {
+    const size_t count = 37;
+    const size_t stride = 26; // адрес, длина, тип + 22 байта + CRC
+    std::vector<uint16_t> us(count * 16), decoded(count * 16);
+    for (size_t n = 0; n < us.size(); n++) {
+        us[n] = static_cast<uint16_t>(900 + (n * 37) % 1200);
+    }
+
+    std::vector<uint8_t> frames(count * stride, 0xAA);
+    crsf_channels_encode_batch(us.data(), count, frames.data() + 3, stride);
+    for (size_t n = 0; n < count; n++) {
+        int frameUs[16];
+        uint8_t payload[22];
+        for (int i = 0; i < 16; i++) frameUs[i] = us[n * 16 + i];
+        crsf_channels_encode(frameUs, payload);
+        ASSERT_EQ(memcmp(payload, frames.data() + n * stride + 3, 22), 0) << "frame=" << n;
+        // Байты вне payload не затронуты
+        EXPECT_EQ(frames[n * stride + 2], 0xAA);
+        EXPECT_EQ(frames[n * stride + 25], 0xAA);
+    }
+
+    crsf_channels_decode_batch(frames.data() + 3, stride, count, decoded.data());
+    for (size_t n = 0; n < us.size(); n++) {
+        int expected = us[n] < 1000 ? 1000 : (us[n] > 2000 ? 2000 : us[n]);
+        ASSERT_EQ(decoded[n], expected) << "n=" << n;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllImpls, ChannelCodecTest,
+                         ::testing::Values(CHANNEL_CODEC_SCALAR, CHANNEL_CODEC_SSE2,
+                                           CHANNEL_CODEC_AVX2, CHANNEL_CODEC_NEON),
+                         [](const ::testing::TestParamInfo<ChannelCodecImpl>& info) {
+                             return std::string(channel_codec_impl_name(info.param));
+                         });
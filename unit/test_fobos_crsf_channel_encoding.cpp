@@ -7,13 +7,17 @@
  * - Значения вне диапазона (clamping)
  * - Точность round-trip (encode → decode)
  * - Преобразование CRSF значений (172-1811 → 1000-2000 мкс)
+ * - Согласованный снимок всех каналов (getChannels) при конкурентной записи
  * 
  * @version 4.3
  */
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include "../libs/crsf/CrsfSerial.h"
 #include "../libs/crsf/crsf_protocol.h"
 #include "mocks/MockSerialPort.h"
@@ -231,3 +235,59 @@ TEST_F(CrsfChannelEncodingTest, SetChannel_MultipleChanges_EachChangeStored) {
     }
 }
 
+
+/**
+ * @test Проверка снимка всех каналов
+ *
+ * Тест проверяет, что getChannels возвращает те же значения,
+ * что и поканальный getChannel, в том числе после setChannels.
+ */
+TEST_F(CrsfChannelEncodingTest, GetChannels_MatchesGetChannel) {
+    std::array<int, CRSF_NUM_CHANNELS> values;
+    for (unsigned int i = 0; i < CRSF_NUM_CHANNELS; ++i) {
+        values[i] = 1000 + static_cast<int>(i) * 50;
+    }
+    crsf->setChannels(values);
+    crsf->setChannel(16, 1234);
+
+    std::array<int, CRSF_NUM_CHANNELS> snapshot;
+    crsf->getChannels(snapshot);
+    for (unsigned int ch = 1; ch <= CRSF_NUM_CHANNELS; ++ch) {
+        EXPECT_EQ(snapshot[ch - 1], crsf->getChannel(ch)) << "ch=" << ch;
+    }
+    EXPECT_EQ(snapshot[0], 1000);
+    EXPECT_EQ(snapshot[15], 1234);
+}
+
+/**
+ * @test Проверка отсутствия разорванных снимков
+ *
+ * Писатель в цикле устанавливает все 16 каналов в одно значение,
+ * читатель проверяет, что в каждом снимке все каналы совпадают.
+ */
+TEST_F(CrsfChannelEncodingTest, GetChannels_ConcurrentWriter_SnapshotNeverTorn) {
+    std::atomic<bool> stop{false};
+    std::thread writer([&]() {
+        std::array<int, CRSF_NUM_CHANNELS> values;
+        for (int v = 1000; !stop.load(std::memory_order_relaxed); v = (v == 2000) ? 1000 : v + 1) {
+            values.fill(v);
+            crsf->setChannels(values);
+        }
+    });
+
+    int torn = 0;
+    std::array<int, CRSF_NUM_CHANNELS> snapshot;
+    for (int iter = 0; iter < 200000; ++iter) {
+        crsf->getChannels(snapshot);
+        for (unsigned int i = 1; i < CRSF_NUM_CHANNELS; ++i) {
+            if (snapshot[i] != snapshot[0]) {
+                ++torn;
+                break;
+            }
+        }
+    }
+    stop = true;
+    writer.join();
+
+    EXPECT_EQ(torn, 0);
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_fobos_crsf_link_counters.cpp
+ * @brief Unit тесты для счётчиков протокола CrsfSerial
+ *
+ * Тесты проверяют:
+ * - Кадры с верным CRC по типам (в том числе неизвестные и для другого адреса)
+ * - Ошибки CRC, потери синхронизации и пропущенные байты
+ * - Сброс недоразобранных данных по таймауту
+ * - Отправку: кадры, байты, неполные записи, кадры при неактивном линке
+ * - Публикацию в JSON
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/crsf_protocol.h"
+#include "../libs/telemetry_json.h"
+#include "mocks/MockSerialPort.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+/**
+ * @class CrsfLinkCountersTest
+ * @brief Фикстура: входной поток порта собирается из кадров и мусора
+ */
+class CrsfLinkCountersTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mockSerial = std::make_unique<MockSerialPort>();
+        crsf = std::make_unique<CrsfSerial>(*mockSerial, 420000);
+        ON_CALL(*mockSerial, readByte(_)).WillByDefault(Invoke([this](uint8_t& b) {
+            if (rxPos >= rx.size()) {
+                return 0;
+            }
+            b = rx[rxPos++];
+            return 1;
+        }));
+        EXPECT_CALL(*mockSerial, readByte(_)).Times(::testing::AnyNumber());
+    }
+
+    void pushFrame(uint8_t type, const uint8_t* payload, uint8_t len,
+                   uint8_t addr = CRSF_ADDRESS_FLIGHT_CONTROLLER, bool badCrc = false) {
+        Crc8 crc(0xD5);
+        uint8_t frame[CRSF_MAX_PACKET_SIZE];
+        frame[0] = addr;
+        frame[1] = len + 2;
+        frame[2] = type;
+        memcpy(&frame[3], payload, len);
+        frame[3 + len] = crc.calc(&frame[2], len + 1) ^ (badCrc ? 0x5A : 0x00);
+        rx.insert(rx.end(), frame, frame + len + 4);
+    }
+
+    void pushChannels() {
+        uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = {0};
+        pushFrame(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+    }
+
+    std::unique_ptr<MockSerialPort> mockSerial;
+    std::unique_ptr<CrsfSerial> crsf;
+    std::vector<uint8_t> rx;
+    size_t rxPos = 0;
+};
+
+/**
+ * @test Кадры по типам
+ */
+TEST_F(CrsfLinkCountersTest, Rx_FramesCountedByKind) {
+    uint8_t attitude[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0, 10, 0, 20, 0, 30};
+    uint8_t battery[CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE] = {0, 168, 0, 10, 0, 0, 100, 80};
+    uint8_t unknown[4] = {1, 2, 3, 4};
+    pushChannels();
+    pushChannels();
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+    pushFrame(CRSF_FRAMETYPE_BATTERY_SENSOR, battery, sizeof(battery));
+    pushFrame(0x7F, unknown, sizeof(unknown));
+    // Другой адрес: кадр целый, но телеметрию не меняет
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude), CRSF_ADDRESS_CRSF_RECEIVER);
+    crsf->loop();
+
+    CrsfLinkCounters c = crsf->getLinkCounters();
+    EXPECT_EQ(c.rxFrames, 6u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_CHANNELS], 2u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_ATTITUDE], 2u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_BATTERY], 1u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_OTHER], 1u);
+    EXPECT_EQ(c.rxFramesByKind[CRSF_LINK_FRAME_GPS], 0u);
+    EXPECT_EQ(c.rxCrcErrors, 0u);
+    EXPECT_EQ(c.rxLengthRejects, 0u);
+    EXPECT_EQ(c.rxResyncBytes, 0u);
+    EXPECT_EQ(c.rxFrames, crsf->getRxFrameCount());
+}
+
+/**
+ * @test Ошибка CRC и ресинхронизация
+ *
+ * Подряд идущий мусор — одна потеря синхронизации, но каждый байт учтён.
+ * Кадр с неверным CRC отбрасывается целиком и ресинхронизацией не считается.
+ */
+TEST_F(CrsfLinkCountersTest, Rx_CrcErrorsAndResync) {
+    uint8_t attitude[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0, 10, 0, 20, 0, 30};
+    pushChannels();
+    // Три байта с недопустимой длиной (второй байт окна — 0 или 0xFF)
+    rx.push_back(0x00);
+    rx.push_back(0x00);
+    rx.push_back(0xFF);
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude), CRSF_ADDRESS_FLIGHT_CONTROLLER, true);
+    rx.push_back(0x00);
+    rx.push_back(0x01);
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+    crsf->loop();
+
+    CrsfLinkCounters c = crsf->getLinkCounters();
+    EXPECT_EQ(c.rxFrames, 2u);
+    EXPECT_EQ(c.rxCrcErrors, 1u);
+    EXPECT_EQ(c.rxLengthRejects, 2u);
+    EXPECT_EQ(c.rxResyncBytes, 5u);
+    EXPECT_EQ(c.rxBufferResets, 0u);
+}
+
+/**
+ * @test Сброс недоразобранного кадра по таймауту
+ */
+TEST_F(CrsfLinkCountersTest, Rx_BufferResetOnTimeout) {
+    uint8_t attitude[CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE] = {0, 10, 0, 20, 0, 30};
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+    rx.resize(5); // Кадр оборван
+    crsf->loop();
+    EXPECT_EQ(crsf->getLinkCounters().rxBufferResets, 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(CrsfSerial::CRSF_PACKET_TIMEOUT_MS + 20));
+    crsf->checkTimeouts();
+    crsf->checkTimeouts(); // Буфер уже пуст — второй раз не считается
+    EXPECT_EQ(crsf->getLinkCounters().rxBufferResets, 1u);
+}
+
+/**
+ * @test Отправка: кадры, байты, неполные записи и кадры при неактивном линке
+ */
+TEST_F(CrsfLinkCountersTest, Tx_FramesBytesShortWrites) {
+    uint8_t payload[4] = {1, 2, 3, 4};
+    // Линк не активен: кадр не уходит в порт
+    EXPECT_CALL(*mockSerial, write(_, _)).Times(0);
+    crsf->queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_ATTITUDE, payload, sizeof(payload));
+    EXPECT_EQ(crsf->getLinkCounters().txDropped, 1u);
+    ::testing::Mock::VerifyAndClearExpectations(mockSerial.get());
+
+    pushChannels();
+    crsf->loop();
+    ASSERT_TRUE(crsf->isLinkUp());
+
+    EXPECT_CALL(*mockSerial, write(_, 8))
+        .WillOnce(Return(8))
+        .WillOnce(Return(5))
+        .WillOnce(Return(-1));
+    for (int i = 0; i < 3; ++i) {
+        crsf->queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_ATTITUDE, payload, sizeof(payload));
+    }
+
+    CrsfLinkCounters c = crsf->getLinkCounters();
+    EXPECT_EQ(c.txFrames, 3u);
+    EXPECT_EQ(c.txBytes, 13u);
+    EXPECT_EQ(c.txShortWrites, 2u);
+    EXPECT_EQ(c.txDropped, 1u);
+}
+
+/**
+ * @test Счётчики в JSON телеметрии
+ */
+TEST(CrsfLinkCountersJsonTest, Json_LinkObject) {
+    SharedTelemetryData d = {};
+    d.link.rxFrames = 10;
+    d.link.rxFramesByKind[CRSF_LINK_FRAME_CHANNELS] = 7;
+    d.link.rxFramesByKind[CRSF_LINK_FRAME_OTHER] = 3;
+    d.link.rxCrcErrors = 2;
+    d.link.txBytes = 5000000000ull;
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = telemetry_json_encode(d, "00:00:00.000", buf, sizeof(buf));
+    ASSERT_GT(len, 0u);
+    std::string json(buf, len);
+    EXPECT_NE(json.find("\"link\":{\"rxFrames\":10,\"rxByType\":{\"channels\":7,\"linkStatistics\":0,"
+                        "\"gps\":0,\"battery\":0,\"attitude\":0,\"flightMode\":0,\"other\":3},"
+                        "\"crcErrors\":2,\"lengthRejects\":0,\"resyncBytes\":0,\"bufferResets\":0,"
+                        "\"txFrames\":0,\"txDropped\":0,\"txShortWrites\":0,\"txBytes\":5000000000}"),
+              std::string::npos)
+        << json;
+}
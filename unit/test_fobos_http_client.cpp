@@ -0,0 +1,238 @@
+/**
+ * @file test_fobos_http_client.cpp
+ * @brief Unit тесты для клиента HTTP с постоянными соединениями
+ *
+ * Тесты проверяют:
+ * - Переиспользование одного TCP-соединения для серии запросов (keep-alive)
+ * - Прозрачное переподключение, если сервер закрыл простаивающее соединение
+ * - Ошибку при недоступной цели и учёт задержек в гистограмме
+ * - Статистику в JSON и в формате Prometheus
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../libs/http_client.h"
+
+/**
+ * @class LoopbackHttpServer
+ * @brief Минимальный HTTP-сервер на 127.0.0.1 для тестов: отвечает 200 на каждый запрос
+ *
+ * closeAfter > 0 — сервер закрывает соединение после стольких ответов;
+ * announce = false — без заголовка "Connection: close" (имитация таймаута
+ * простоя на стороне интерпретатора: клиент узнаёт о закрытии только при следующем запросе).
+ */
+class LoopbackHttpServer {
+public:
+    explicit LoopbackHttpServer(int closeAfter = 0, bool announce = true) : _closeAfter(closeAfter), _announce(announce) {
+        _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(_listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        _port = ntohs(addr.sin_port);
+        listen(_listenFd, 8);
+        _thread = std::thread([this]() { run(); });
+    }
+
+    ~LoopbackHttpServer() {
+        _stop = true;
+        shutdown(_listenFd, SHUT_RDWR);
+        close(_listenFd);
+        _thread.join();
+    }
+
+    int port() const { return _port; }
+    int accepted() const { return _accepted.load(); }
+    int requests() const { return _requests.load(); }
+
+private:
+    void run() {
+        while (!_stop) {
+            int fd = accept(_listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                break;
+            }
+            ++_accepted;
+            serve(fd);
+            close(fd);
+        }
+    }
+
+    void serve(int fd) {
+        std::string pending;
+        char buf[4096];
+        int served = 0;
+        for (;;) {
+            size_t headerEnd;
+            while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                if (n <= 0) {
+                    return;
+                }
+                pending.append(buf, n);
+            }
+            size_t lenPos = pending.find("Content-Length:");
+            size_t bodyLen = (lenPos != std::string::npos && lenPos < headerEnd)
+                ? strtoul(pending.c_str() + lenPos + 15, nullptr, 10) : 0;
+            while (pending.size() < headerEnd + 4 + bodyLen) {
+                ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                if (n <= 0) {
+                    return;
+                }
+                pending.append(buf, n);
+            }
+            pending.erase(0, headerEnd + 4 + bodyLen);
+            ++_requests;
+            ++served;
+
+            bool closeNow = (_closeAfter > 0 && served >= _closeAfter);
+            std::string body = "{\"status\":\"ok\"}";
+            std::string resp = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                               std::to_string(body.size()) +
+                               (closeNow && _announce ? "\r\nConnection: close\r\n\r\n" : "\r\nConnection: keep-alive\r\n\r\n") + body;
+            send(fd, resp.data(), resp.size(), MSG_NOSIGNAL);
+            if (closeNow) {
+                return;
+            }
+        }
+    }
+
+    int _listenFd;
+    int _port;
+    int _closeAfter;
+    bool _announce;
+    std::atomic<bool> _stop{false};
+    std::atomic<int> _accepted{0};
+    std::atomic<int> _requests{0};
+    std::thread _thread;
+};
+
+/**
+ * @test Серия запросов по одному соединению
+ *
+ * 100 команд подряд должны уйти по одному TCP-соединению,
+ * а каждая — попасть в гистограмму задержек.
+ */
+TEST(HttpKeepAliveClientTest, SequentialPosts_ReuseSingleConnection) {
+    LoopbackHttpServer server;
+    HttpKeepAliveClient client("127.0.0.1", server.port());
+
+    for (int i = 0; i < 100; ++i) {
+        int status = 0;
+        ASSERT_TRUE(client.post("/api/command/setChannel", "{\"channel\":1,\"value\":1500}", &status)) << "i=" << i;
+        EXPECT_EQ(status, 200);
+    }
+
+    EXPECT_EQ(server.accepted(), 1);
+    EXPECT_EQ(server.requests(), 100);
+    EXPECT_EQ(client.connects(), 1u);
+    EXPECT_EQ(client.failures(), 0u);
+    EXPECT_EQ(client.latency().count(), 100u);
+    EXPECT_GT(client.latency().percentileNs(0.5), 0u);
+}
+
+/**
+ * @test Переподключение после закрытия соединения сервером
+ *
+ * Сервер закрывает соединение после каждых 3 ответов:
+ * клиент открывает новое без потери запросов.
+ */
+TEST(HttpKeepAliveClientTest, ServerClosesConnection_ClientReconnects) {
+    LoopbackHttpServer server(3);
+    HttpKeepAliveClient client("127.0.0.1", server.port());
+
+    for (int i = 0; i < 9; ++i) {
+        ASSERT_TRUE(client.post("/api/command/sendChannels", "{\"command\":\"sendChannels\"}")) << "i=" << i;
+    }
+
+    EXPECT_EQ(server.requests(), 9);
+    EXPECT_EQ(server.accepted(), 3);
+    EXPECT_EQ(client.connects(), 3u);
+    EXPECT_EQ(client.failures(), 0u);
+}
+
+/**
+ * @test Повтор запроса на устаревшем соединении
+ *
+ * Сервер молча закрывает соединение после каждого ответа: следующий запрос
+ * обнаруживает закрытие и один раз повторяется на новом соединении.
+ */
+TEST(HttpKeepAliveClientTest, StaleConnection_RequestRetriedOnce) {
+    LoopbackHttpServer server(1, false);
+    HttpKeepAliveClient client("127.0.0.1", server.port());
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(client.post("/api/command/setChannel", "{\"channel\":2,\"value\":1600}")) << "i=" << i;
+        // Даём серверу закрыть соединение до следующего запроса
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    EXPECT_EQ(server.requests(), 5);
+    EXPECT_EQ(client.failures(), 0u);
+    EXPECT_EQ(client.retries(), 4u);
+}
+
+/**
+ * @test Недоступная цель
+ *
+ * Без слушающего сервера запрос завершается ошибкой с кодом 0
+ * и учитывается как неудачный, не попадая в гистограмму.
+ */
+TEST(HttpKeepAliveClientTest, NoServer_PostFails) {
+    int port;
+    {
+        LoopbackHttpServer server;
+        port = server.port();
+    }
+    HttpKeepAliveClient client("127.0.0.1", port, 200);
+
+    int status = -1;
+    EXPECT_FALSE(client.post("/api/command/setMode", "{\"mode\":\"manual\"}", &status));
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(client.failures(), 1u);
+    EXPECT_EQ(client.latency().count(), 0u);
+}
+
+/**
+ * @test Статистика пересылки
+ *
+ * Задержки из HDR-гистограммы уходят и в JSON (/api/stats/forward), и в Prometheus (/metrics).
+ */
+TEST(HttpKeepAliveClientTest, Stats_JsonAndPrometheus) {
+    LoopbackHttpServer server;
+    HttpKeepAliveClient client("127.0.0.1", server.port());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(client.post("/api/command/sendChannels", "{\"command\":\"sendChannels\"}"));
+    }
+
+    std::string json = client.statsJson();
+    EXPECT_NE(json.find("\"requests\":10,"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"latency\":{\"count\":10,"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"p999Us\":"), std::string::npos) << json;
+    EXPECT_EQ(json.back(), '}');
+
+    std::string target = "target=\"127.0.0.1:" + std::to_string(server.port()) + "\"";
+    std::string metrics = client.prometheus("crsf_forward");
+    EXPECT_NE(metrics.find("# TYPE crsf_forward_latency_seconds summary\n"), std::string::npos);
+    EXPECT_NE(metrics.find("crsf_forward_latency_seconds{" + target + ",quantile=\"0.99\"} "), std::string::npos) << metrics;
+    EXPECT_NE(metrics.find("crsf_forward_latency_seconds_count{" + target + "} 10\n"), std::string::npos) << metrics;
+    EXPECT_NE(metrics.find("crsf_forward_requests_total{" + target + "} 10\n"), std::string::npos) << metrics;
+    EXPECT_NE(metrics.find("crsf_forward_failures_total{" + target + "} 0\n"), std::string::npos) << metrics;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file test_fobos_http_server.cpp
+ * @brief Unit тесты для HTTP-движка на epoll
+ *
+ * Тесты проверяют:
+ * - Обслуживание серии запросов по одному keep-alive соединению
+ * - Конвейер запросов (pipelining): ответы в порядке запросов
+ * - Закрытие соединения по "Connection: close"
+ * - Отказы 400 (неверный запрос) и 413 (слишком большое тело)
+ * - Отправку общего буфера тела (sharedBody) и совместную работу с HttpKeepAliveClient
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../libs/http_client.h"
+#include "../libs/http_server.h"
+
+/**
+ * @class RawHttpConnection
+ * @brief Клиентское TCP-соединение к 127.0.0.1 для тестов: отправка сырых байт и чтение ответов
+ */
+class RawHttpConnection {
+public:
+    explicit RawHttpConnection(int port) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct timeval timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_usec = 0;
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        _connected = connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    ~RawHttpConnection() {
+        close(_fd);
+    }
+
+    bool connected() const { return _connected; }
+
+    void sendRaw(const std::string& data) {
+        send(_fd, data.data(), data.size(), MSG_NOSIGNAL);
+    }
+
+    // Чтение одного ответа; status = 0, если соединение закрыто раньше
+    bool readResponse(int& status, std::string& body, std::string* headers = nullptr) {
+        status = 0;
+        size_t headerEnd;
+        while ((headerEnd = _pending.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        std::string head = _pending.substr(0, headerEnd);
+        status = atoi(head.c_str() + 9);
+        size_t lenPos = head.find("Content-Length:");
+        size_t bodyLen = lenPos != std::string::npos ? strtoul(head.c_str() + lenPos + 15, nullptr, 10) : 0;
+        while (_pending.size() < headerEnd + 4 + bodyLen) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        body = _pending.substr(headerEnd + 4, bodyLen);
+        if (headers) {
+            *headers = head;
+        }
+        _pending.erase(0, headerEnd + 4 + bodyLen);
+        return true;
+    }
+
+    // Всё, что пришло до закрытия соединения сервером
+    std::string readAll() {
+        while (fill()) {
+        }
+        std::string all;
+        all.swap(_pending);
+        return all;
+    }
+
+    // true, если сервер закрыл соединение (recv вернул 0)
+    bool peerClosed() {
+        return _pending.empty() && !fill();
+    }
+
+private:
+    bool fill() {
+        char buf[4096];
+        ssize_t n = recv(_fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        _pending.append(buf, n);
+        return true;
+    }
+
+    int _fd;
+    bool _connected = false;
+    std::string _pending;
+};
+
+// Обработчик для тестов: отвечает методом, путём и телом запроса
+static void echoHandler(const HttpRequest& req, HttpResponse& resp) {
+    resp.set(200, "text/plain", req.method + " " + req.path + " " + req.body);
+}
+
+/**
+ * @test Серия запросов по одному соединению
+ */
+TEST(HttpServerTest, KeepAlive_SequentialRequestsOnOneConnection) {
+    HttpServer server(echoHandler, 2);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    RawHttpConnection conn(server.port());
+    ASSERT_TRUE(conn.connected());
+    for (int i = 0; i < 10; ++i) {
+        std::string path = "/api/telemetry/" + std::to_string(i);
+        conn.sendRaw("GET " + path + " HTTP/1.1\r\nHost: test\r\n\r\n");
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(conn.readResponse(status, body)) << "i=" << i;
+        EXPECT_EQ(status, 200);
+        EXPECT_EQ(body, "GET " + path + " ");
+    }
+
+    EXPECT_EQ(server.connectionsAccepted(), 1u);
+    EXPECT_EQ(server.requests(), 10u);
+}
+
+/**
+ * @test Конвейер запросов
+ *
+ * Пять запросов (с телами) одним send: ответы приходят в порядке запросов.
+ */
+TEST(HttpServerTest, Pipelining_ResponsesInRequestOrder) {
+    HttpServer server(echoHandler, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    RawHttpConnection conn(server.port());
+    std::string batch;
+    for (int i = 0; i < 5; ++i) {
+        std::string body = "{\"n\":" + std::to_string(i) + "}";
+        batch += "POST /api/command/" + std::to_string(i) + " HTTP/1.1\r\nContent-Length: " +
+                 std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+    conn.sendRaw(batch);
+
+    for (int i = 0; i < 5; ++i) {
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(conn.readResponse(status, body)) << "i=" << i;
+        EXPECT_EQ(body, "POST /api/command/" + std::to_string(i) + " {\"n\":" + std::to_string(i) + "}");
+    }
+    EXPECT_EQ(server.connectionsAccepted(), 1u);
+}
+
+/**
+ * @test Connection: close и HTTP/1.0
+ *
+ * Сервер отвечает с "Connection: close" и закрывает соединение.
+ */
+TEST(HttpServerTest, ConnectionClose_ServerClosesAfterResponse) {
+    HttpServer server(echoHandler, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    {
+        RawHttpConnection conn(server.port());
+        conn.sendRaw("GET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+        int status = 0;
+        std::string body, headers;
+        ASSERT_TRUE(conn.readResponse(status, body, &headers));
+        EXPECT_NE(headers.find("Connection: close"), std::string::npos);
+        EXPECT_TRUE(conn.peerClosed());
+    }
+    {
+        RawHttpConnection conn(server.port());
+        conn.sendRaw("GET / HTTP/1.0\r\n\r\n");
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(conn.readResponse(status, body));
+        EXPECT_EQ(status, 200);
+        EXPECT_TRUE(conn.peerClosed());
+    }
+}
+
+/**
+ * @test Отказ неверным и слишком большим запросам
+ */
+TEST(HttpServerTest, BadRequests_Rejected) {
+    HttpServer server(echoHandler, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    {
+        RawHttpConnection conn(server.port());
+        conn.sendRaw("garbage\r\n\r\n");
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(conn.readResponse(status, body));
+        EXPECT_EQ(status, 400);
+        EXPECT_TRUE(conn.peerClosed());
+    }
+    {
+        RawHttpConnection conn(server.port());
+        conn.sendRaw("POST /api/telemetry HTTP/1.1\r\nContent-Length: " +
+                     std::to_string(HttpServer::MAX_BODY_BYTES + 1) + "\r\n\r\n");
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(conn.readResponse(status, body));
+        EXPECT_EQ(status, 413);
+        EXPECT_TRUE(conn.peerClosed());
+    }
+    EXPECT_EQ(server.requests(), 0u);
+}
+
+/**
+ * @test Общий буфер тела
+ *
+ * Ответ с sharedBody отдаёт содержимое буфера; буфер переживает обработчик,
+ * пока соединение его отправляет. HEAD получает Content-Length без тела.
+ */
+TEST(HttpServerTest, SharedBody_SentToEveryClient) {
+    auto shared = std::make_shared<const std::string>(std::string(100000, 'x') + "end");
+    HttpServer server([shared](const HttpRequest&, HttpResponse& resp) {
+        resp.sharedBody = shared;
+    }, 2);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    RawHttpConnection a(server.port());
+    RawHttpConnection b(server.port());
+    a.sendRaw("GET /api/telemetry HTTP/1.1\r\n\r\nGET /api/telemetry HTTP/1.1\r\n\r\n");
+    b.sendRaw("GET /api/telemetry HTTP/1.1\r\n\r\n");
+    for (int i = 0; i < 2; ++i) {
+        int status = 0;
+        std::string body;
+        ASSERT_TRUE(a.readResponse(status, body));
+        EXPECT_EQ(body, *shared);
+    }
+    int status = 0;
+    std::string body;
+    ASSERT_TRUE(b.readResponse(status, body));
+    EXPECT_EQ(body, *shared);
+
+    RawHttpConnection c(server.port());
+    c.sendRaw("HEAD /api/telemetry HTTP/1.1\r\nConnection: close\r\n\r\n");
+    std::string raw = c.readAll();
+    EXPECT_NE(raw.find("Content-Length: " + std::to_string(shared->size())), std::string::npos);
+    EXPECT_EQ(raw.size(), raw.find("\r\n\r\n") + 4);
+}
+
+/**
+ * @test HttpKeepAliveClient и HttpServer
+ *
+ * Клиент пересылки команд crsf_api_server против движка интерпретатора:
+ * все запросы по одному соединению.
+ */
+TEST(HttpServerTest, KeepAliveClient_UsesSingleConnection) {
+    HttpServer server([](const HttpRequest& req, HttpResponse& resp) {
+        resp.set(req.method == "POST" ? 200 : 405, "application/json", "{\"status\":\"ok\"}");
+    }, 2);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    HttpKeepAliveClient client("127.0.0.1", server.port());
+    for (int i = 0; i < 50; ++i) {
+        int status = 0;
+        ASSERT_TRUE(client.post("/api/command/setChannel", "{\"channel\":1,\"value\":1500}", &status)) << "i=" << i;
+        EXPECT_EQ(status, 200);
+    }
+
+    EXPECT_EQ(client.connects(), 1u);
+    EXPECT_EQ(server.connectionsAccepted(), 1u);
+    EXPECT_EQ(server.requests(), 50u);
+}
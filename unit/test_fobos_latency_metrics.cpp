@@ -0,0 +1,259 @@
+/**
+ * @file test_fobos_latency_metrics.cpp
+ * @brief Unit тесты для гистограмм задержек горячего пути
+ *
+ * Тесты проверяют:
+ * - Корзины HDR-гистограммы (точные малые значения, погрешность не больше 1/16)
+ * - Квантили и максимум
+ * - Этапы с началом и концом в разных местах кода (start/finish)
+ * - Вывод в формате Prometheus
+ * - Замеры CrsfSerial: rx_to_crc от первого байта кадра, tx_write и cmd_to_tx в queuePacket
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../libs/latency_metrics.h"
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/crsf_protocol.h"
+#include "mocks/MockSerialPort.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::Return;
+
+/**
+ * @test Корзины: значение попадает в корзину, границы идут подряд без пропусков
+ */
+TEST(LatencyMetricsTest, Buckets_ContiguousWithBoundedError) {
+    for (uint64_t v = 0; v < 16; ++v) {
+        EXPECT_EQ(HdrHistogram::bucketIndex(v), v);
+        EXPECT_EQ(HdrHistogram::bucketUpperNs(static_cast<unsigned int>(v)), v);
+    }
+    for (unsigned int i = 1; i < HdrHistogram::BUCKETS; ++i) {
+        uint64_t lower = HdrHistogram::bucketUpperNs(i - 1) + 1;
+        uint64_t upper = HdrHistogram::bucketUpperNs(i);
+        ASSERT_EQ(HdrHistogram::bucketIndex(lower), i);
+        ASSERT_EQ(HdrHistogram::bucketIndex(upper), i);
+        // Ширина корзины не больше 1/16 её нижней границы (до 16 нс корзины точные)
+        if (i >= 16) {
+            ASSERT_LE((upper - lower + 1) * 16, lower) << "bucket " << i;
+        }
+    }
+    EXPECT_EQ(HdrHistogram::bucketIndex(~0ull), HdrHistogram::BUCKETS - 1);
+}
+
+/**
+ * @test Квантили и максимум
+ */
+TEST(LatencyMetricsTest, Percentiles_WithinBucketError) {
+    HdrHistogram h;
+    EXPECT_EQ(h.percentileNs(0.5), 0u);
+    // 1..1000 мкс равномерно
+    for (uint64_t us = 1; us <= 1000; ++us) {
+        h.record(us * 1000);
+    }
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.maxNs(), 1000000u);
+    EXPECT_EQ(h.sumNs(), 500500u * 1000);
+    uint64_t p50 = h.percentileNs(0.5);
+    uint64_t p99 = h.percentileNs(0.99);
+    uint64_t p999 = h.percentileNs(0.999);
+    EXPECT_GE(p50, 500000u);
+    EXPECT_LE(p50, 500000u + 500000u / 16);
+    EXPECT_GE(p99, 990000u);
+    EXPECT_LE(p99, 1000000u);
+    EXPECT_LE(p999, h.maxNs());
+    EXPECT_EQ(h.percentileNs(1.0), 1000000u);
+
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.maxNs(), 0u);
+}
+
+/**
+ * @test Запись из нескольких потоков без потерь
+ */
+TEST(LatencyMetricsTest, Record_ConcurrentWriters_NoLostSamples) {
+    HdrHistogram h;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&h, t]() {
+            for (uint64_t i = 0; i < 100000; ++i) {
+                h.record(i * (t + 1));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    EXPECT_EQ(h.count(), 400000u);
+    EXPECT_EQ(h.maxNs(), 99999u * 4);
+}
+
+/**
+ * @test start/finish: самое раннее начало, замер только при наличии начала
+ */
+TEST(LatencyMetricsTest, StartFinish_KeepsEarliestStart) {
+    LatencyMetrics m;
+    m.finish(LATENCY_CMD_TO_TX, 5000);
+    EXPECT_EQ(m.histogram(LATENCY_CMD_TO_TX).count(), 0u);
+
+    m.start(LATENCY_CMD_TO_TX, 1000);
+    m.start(LATENCY_CMD_TO_TX, 3000);
+    m.finish(LATENCY_CMD_TO_TX, 5000);
+    EXPECT_EQ(m.histogram(LATENCY_CMD_TO_TX).count(), 1u);
+    EXPECT_EQ(m.histogram(LATENCY_CMD_TO_TX).maxNs(), 4000u);
+    m.finish(LATENCY_CMD_TO_TX, 9000);
+    EXPECT_EQ(m.histogram(LATENCY_CMD_TO_TX).count(), 1u);
+
+    // Нет начала (0) или конец раньше начала — замер пропускается
+    m.record(LATENCY_CMD_QUEUE, 0, 100);
+    m.record(LATENCY_CMD_QUEUE, 200, 100);
+    EXPECT_EQ(m.histogram(LATENCY_CMD_QUEUE).count(), 0u);
+}
+
+/**
+ * @test Формат Prometheus: summary с квантилями, _sum, _count и gauge максимума по каждому этапу
+ */
+TEST(LatencyMetricsTest, Prometheus_TextFormat) {
+    LatencyMetrics m;
+    m.record(LATENCY_RX_TO_CRC, 1000, 1000 + 12000);
+    std::string text = m.prometheus();
+
+    EXPECT_NE(text.find("# TYPE crsf_latency_seconds summary\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE crsf_latency_max_seconds gauge\n"), std::string::npos);
+    EXPECT_NE(text.find("crsf_latency_seconds{stage=\"rx_to_crc\",quantile=\"0.5\"} 0.000012000\n"), std::string::npos);
+    EXPECT_NE(text.find("crsf_latency_seconds{stage=\"rx_to_crc\",quantile=\"0.999\"} 0.000012000\n"), std::string::npos);
+    EXPECT_NE(text.find("crsf_latency_seconds_count{stage=\"rx_to_crc\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("crsf_latency_seconds_sum{stage=\"rx_to_crc\"} 0.000012000\n"), std::string::npos);
+    EXPECT_NE(text.find("crsf_latency_max_seconds{stage=\"rx_to_crc\"} 0.000012000\n"), std::string::npos);
+    for (unsigned int s = 0; s < LATENCY_STAGE_COUNT; ++s) {
+        std::string count = std::string("crsf_latency_seconds_count{stage=\"") +
+                            latency_stage_name(static_cast<LatencyStage>(s)) + "\"}";
+        EXPECT_NE(text.find(count), std::string::npos) << count;
+    }
+    // Каждая строка, кроме комментариев, — "имя{метки} значение"
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        ASSERT_NE(end, std::string::npos);
+        std::string line = text.substr(pos, end - pos);
+        if (line[0] != '#') {
+            EXPECT_EQ(line.compare(0, 5, "crsf_"), 0) << line;
+            EXPECT_NE(line.find("} "), std::string::npos) << line;
+        }
+        pos = end + 1;
+    }
+}
+
+#if USE_LATENCY_METRICS == true
+/**
+ * @class CrsfLatencyTest
+ * @brief Фикстура: CrsfSerial на мок-порту, общие метрики процесса сбрасываются
+ */
+class CrsfLatencyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        g_latency.reset();
+        mockSerial = std::make_unique<MockSerialPort>();
+        crsf = std::make_unique<CrsfSerial>(*mockSerial, 420000);
+        ON_CALL(*mockSerial, readByte(_)).WillByDefault(Invoke([this](uint8_t& b) {
+            if (rxPos >= rxLimit) {
+                return 0;
+            }
+            b = rx[rxPos++];
+            return 1;
+        }));
+        EXPECT_CALL(*mockSerial, readByte(_)).Times(::testing::AnyNumber());
+    }
+
+    void TearDown() override {
+        g_latency.reset();
+    }
+
+    void pushFrame(uint8_t type, const uint8_t* payload, uint8_t len) {
+        Crc8 crc(0xD5);
+        uint8_t frame[CRSF_MAX_PACKET_SIZE];
+        frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+        frame[1] = len + 2;
+        frame[2] = type;
+        memcpy(&frame[3], payload, len);
+        frame[3 + len] = crc.calc(&frame[2], len + 1);
+        rx.insert(rx.end(), frame, frame + len + 4);
+    }
+
+    std::unique_ptr<MockSerialPort> mockSerial;
+    std::unique_ptr<CrsfSerial> crsf;
+    std::vector<uint8_t> rx;
+    size_t rxPos = 0;
+    size_t rxLimit = 0;  // сколько байт из rx уже «пришло» в порт
+};
+
+/**
+ * @test rx_to_crc считается от чтения первого байта кадра
+ *
+ * Кадр приходит двумя порциями с паузой: задержка не меньше паузы.
+ * Следующий кадр целиком в одной порции — задержка мала.
+ */
+TEST_F(CrsfLatencyTest, RxToCrc_FromFirstByteOfFrame) {
+    uint8_t attitude[6] = {0, 10, 0, 20, 0, 30};
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+    pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+    size_t frameSize = rx.size() / 2;
+
+    rxLimit = 3;
+    crsf->loop();
+    EXPECT_EQ(g_latency.histogram(LATENCY_RX_TO_CRC).count(), 0u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    rxLimit = frameSize;
+    crsf->loop();
+    ASSERT_EQ(g_latency.histogram(LATENCY_RX_TO_CRC).count(), 1u);
+    EXPECT_GE(g_latency.histogram(LATENCY_RX_TO_CRC).maxNs(), 5000000u);
+    EXPECT_EQ(g_latency.histogram(LATENCY_CRC_TO_DISPATCH).count(), 1u);
+
+    g_latency.histogram(LATENCY_RX_TO_CRC).reset();
+    rxLimit = rx.size();
+    crsf->loop();
+    ASSERT_EQ(g_latency.histogram(LATENCY_RX_TO_CRC).count(), 1u);
+    EXPECT_LT(g_latency.histogram(LATENCY_RX_TO_CRC).maxNs(), 5000000u);
+
+    // rx_to_publish ждёт публикации снимка (main.cpp) от самого раннего кадра
+    g_latency.finish(LATENCY_RX_TO_PUBLISH, latency_now_ns());
+    ASSERT_EQ(g_latency.histogram(LATENCY_RX_TO_PUBLISH).count(), 1u);
+    EXPECT_GE(g_latency.histogram(LATENCY_RX_TO_PUBLISH).maxNs(), 5000000u);
+}
+
+/**
+ * @test queuePacket: tx_write на каждую запись, cmd_to_tx только для пакета каналов после команды
+ */
+TEST_F(CrsfLatencyTest, QueuePacket_TxWriteAndCommandToTx) {
+    EXPECT_CALL(*mockSerial, write(_, _)).WillRepeatedly(Return(26));
+    // Отправка идёт только при активном линке: его поднимает кадр каналов
+    uint8_t channels[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = {0};
+    pushFrame(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, channels, sizeof(channels));
+    rxLimit = rx.size();
+    crsf->loop();
+    ASSERT_TRUE(crsf->isLinkUp());
+    g_latency.reset();
+
+    crsf->processSend();
+    EXPECT_EQ(g_latency.histogram(LATENCY_TX_WRITE).count(), 1u);
+    EXPECT_EQ(g_latency.histogram(LATENCY_CMD_TO_TX).count(), 0u);
+
+    g_latency.start(LATENCY_CMD_TO_TX, latency_now_ns());
+    uint8_t payload[4] = {0};
+    crsf->queuePacket(CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAMETYPE_BATTERY_SENSOR, payload, sizeof(payload));
+    EXPECT_EQ(g_latency.histogram(LATENCY_CMD_TO_TX).count(), 0u);
+    crsf->processSend();
+    EXPECT_EQ(g_latency.histogram(LATENCY_TX_WRITE).count(), 3u);
+    EXPECT_EQ(g_latency.histogram(LATENCY_CMD_TO_TX).count(), 1u);
+}
+#endif
@@ -0,0 +1,242 @@
+/**
+ * @file test_fobos_telemetry_json.cpp
+ * @brief Unit тесты для кодировщика JSON телеметрии на std::to_chars
+ *
+ * Тесты проверяют:
+ * - Побайтное совпадение с прежним форматированием через std::stringstream
+ *   (формат crsf_api_interpreter: std::fixed, std::setprecision(6) начиная с широты)
+ * - Объект "link" со счётчиками протокола
+ * - Совпадение JsonWriter::general/fixed с потоком по умолчанию и std::fixed
+ * - Формат времени "HH:MM:SS.mmm" и отказ при нехватке буфера
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include "../libs/telemetry_json.h"
+
+// Эталон: прежний код sendTelemetryToApiServer из api_interpreter.cpp
+static std::string referenceJson(const SharedTelemetryData& data, const std::string& timestamp) {
+    std::stringstream json;
+    json << "{";
+    json << "\"linkUp\":" << (data.linkUp ? "true" : "false") << ",";
+    json << "\"lastReceive\":" << data.lastReceive << ",";
+    json << "\"channels\":[";
+    for (int i = 0; i < 16; i++) {
+        if (i > 0) json << ",";
+        json << data.channels[i];
+    }
+    json << "],";
+    json << "\"packetsReceived\":" << data.packetsReceived << ",";
+    json << "\"packetsSent\":" << data.packetsSent << ",";
+    json << "\"packetsLost\":" << data.packetsLost << ",";
+    json << "\"gps\":{";
+    json << "\"latitude\":" << std::fixed << std::setprecision(6) << data.latitude << ",";
+    json << "\"longitude\":" << data.longitude << ",";
+    json << "\"altitude\":" << data.altitude << ",";
+    json << "\"speed\":" << data.speed;
+    json << "},";
+    json << "\"battery\":{";
+    json << "\"voltage\":" << data.voltage << ",";
+    json << "\"current\":" << data.current << ",";
+    json << "\"capacity\":" << data.capacity << ",";
+    json << "\"remaining\":" << static_cast<int>(data.remaining);
+    json << "},";
+    json << "\"attitude\":{";
+    json << "\"roll\":" << data.roll << ",";
+    json << "\"pitch\":" << data.pitch << ",";
+    json << "\"yaw\":" << data.yaw;
+    json << "},";
+    json << "\"attitudeRaw\":{";
+    json << "\"roll\":" << data.rollRaw << ",";
+    json << "\"pitch\":" << data.pitchRaw << ",";
+    json << "\"yaw\":" << data.yawRaw;
+    json << "},";
+    // Счётчики линка (добавлены вместе с CrsfLinkCounters)
+    json << "\"link\":{";
+    json << "\"rxFrames\":" << data.link.rxFrames << ",";
+    json << "\"rxByType\":{";
+    for (unsigned int i = 0; i < CRSF_LINK_FRAME_KINDS; i++) {
+        if (i > 0) json << ",";
+        json << "\"" << crsf_link_frame_kind_name(i) << "\":" << data.link.rxFramesByKind[i];
+    }
+    json << "},";
+    json << "\"crcErrors\":" << data.link.rxCrcErrors << ",";
+    json << "\"lengthRejects\":" << data.link.rxLengthRejects << ",";
+    json << "\"resyncBytes\":" << data.link.rxResyncBytes << ",";
+    json << "\"bufferResets\":" << data.link.rxBufferResets << ",";
+    json << "\"txFrames\":" << data.link.txFrames << ",";
+    json << "\"txDropped\":" << data.link.txDropped << ",";
+    json << "\"txShortWrites\":" << data.link.txShortWrites << ",";
+    json << "\"txBytes\":" << data.link.txBytes;
+    json << "},";
+    json << "\"timestamp\":\"" << timestamp << "\",";
+    json << "\"activePort\":\"UART Active\"";
+    json << "}";
+    return json.str();
+}
+
+static SharedTelemetryData randomTelemetry(std::mt19937& rng) {
+    std::uniform_int_distribution<int> ch(-5000, 5000);
+    std::uniform_real_distribution<double> wide(-1e6, 1e6);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    SharedTelemetryData d = {};
+    d.linkUp = rng() & 1;
+    d.lastReceive = static_cast<uint32_t>(rng());
+    for (int i = 0; i < 16; ++i) {
+        d.channels[i] = ch(rng);
+    }
+    d.packetsReceived = static_cast<uint32_t>(rng());
+    d.packetsSent = static_cast<uint32_t>(rng() % 100);
+    d.packetsLost = static_cast<uint32_t>(rng() % 101);
+    d.latitude = unit(rng) * 90.0;
+    d.longitude = unit(rng) * 180.0;
+    d.altitude = wide(rng);
+    d.speed = unit(rng) * 1e-7;            // мельче последнего знака
+    d.voltage = std::round(unit(rng) * 1e4) / 10.0;
+    d.current = unit(rng) * 0.0000005;     // граница округления к 0.000000/-0.000000
+    d.capacity = wide(rng) * 1e6;
+    d.remaining = static_cast<uint8_t>(rng());
+    d.roll = unit(rng) * 3.141592653589793;
+    d.pitch = -0.0;
+    d.yaw = unit(rng) * 1e-300;
+    d.rollRaw = static_cast<int16_t>(rng());
+    d.pitchRaw = static_cast<int16_t>(rng());
+    d.yawRaw = static_cast<int16_t>(rng());
+    d.link.rxFrames = static_cast<uint32_t>(rng());
+    for (unsigned int i = 0; i < CRSF_LINK_FRAME_KINDS; ++i) {
+        d.link.rxFramesByKind[i] = static_cast<uint32_t>(rng());
+    }
+    d.link.rxCrcErrors = static_cast<uint32_t>(rng());
+    d.link.rxResyncBytes = static_cast<uint32_t>(rng() % 1000);
+    d.link.txFrames = static_cast<uint32_t>(rng());
+    d.link.txBytes = (static_cast<uint64_t>(rng()) << 32) | rng();
+    return d;
+}
+
+/**
+ * @test Совпадение с прежним форматом на случайных снимках
+ */
+TEST(TelemetryJsonTest, Encode_MatchesStringstreamByteForByte) {
+    std::mt19937 rng(12345);
+    char buf[TELEMETRY_JSON_MAX];
+    for (int iter = 0; iter < 2000; ++iter) {
+        SharedTelemetryData d = randomTelemetry(rng);
+        size_t len = telemetry_json_encode(d, "12:34:56.789", buf, sizeof(buf));
+        ASSERT_GT(len, 0u);
+        ASSERT_EQ(std::string(buf, len), referenceJson(d, "12:34:56.789")) << "iter=" << iter;
+    }
+}
+
+/**
+ * @test Крайние значения double
+ *
+ * Наибольшие по модулю double в %.6f помещаются в TELEMETRY_JSON_MAX;
+ * бесконечности и NaN выводятся так же, как потоком.
+ */
+TEST(TelemetryJsonTest, Encode_ExtremeValues) {
+    SharedTelemetryData d = {};
+    const double extremes[] = {std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+    for (double v : extremes) {
+        d.latitude = d.longitude = d.altitude = d.speed = v;
+        d.voltage = d.current = d.capacity = v;
+        d.roll = d.pitch = d.yaw = v;
+        d.lastReceive = UINT32_MAX;
+        d.packetsReceived = d.packetsSent = d.packetsLost = UINT32_MAX;
+        memset(&d.link, 0xFF, sizeof(d.link));
+        for (int i = 0; i < 16; ++i) {
+            d.channels[i] = INT32_MIN;
+        }
+        char buf[TELEMETRY_JSON_MAX];
+        size_t len = telemetry_json_encode(d, "23:59:59.999", buf, sizeof(buf));
+        ASSERT_GT(len, 0u);
+        EXPECT_EQ(std::string(buf, len), referenceJson(d, "23:59:59.999"));
+    }
+
+    d.latitude = std::numeric_limits<double>::infinity();
+    d.longitude = -std::numeric_limits<double>::infinity();
+    d.altitude = std::numeric_limits<double>::quiet_NaN();
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = telemetry_json_encode(d, "00:00:00.000", buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, len), referenceJson(d, "00:00:00.000"));
+}
+
+/**
+ * @test %g как у потока по умолчанию
+ */
+TEST(TelemetryJsonTest, General_MatchesDefaultStream) {
+    std::mt19937 rng(777);
+    std::uniform_real_distribution<double> mantissa(-10.0, 10.0);
+    std::uniform_int_distribution<int> exponent(-12, 12);
+    char buf[64];
+    for (int i = 0; i < 20000; ++i) {
+        double v = mantissa(rng) * std::pow(10.0, exponent(rng));
+        JsonWriter w(buf, sizeof(buf));
+        w.general(v);
+        std::ostringstream ref;
+        ref << v;
+        ASSERT_EQ(std::string(buf, w.size()), ref.str()) << v;
+    }
+    const double special[] = {0.0, -0.0, 1e-5, 1e-4, 123456.0, 1234567.0, 55.7512345, 0.1 + 0.2};
+    for (double v : special) {
+        JsonWriter w(buf, sizeof(buf));
+        w.general(v);
+        std::ostringstream ref;
+        ref << v;
+        EXPECT_EQ(std::string(buf, w.size()), ref.str()) << v;
+    }
+}
+
+/**
+ * @test Нехватка буфера
+ *
+ * Кодировщик не пишет за пределы буфера и возвращает 0.
+ */
+TEST(TelemetryJsonTest, Encode_SmallBuffer_ReturnsZero) {
+    SharedTelemetryData d = {};
+    char buf[64];
+    memset(buf, 0x5A, sizeof(buf));
+    EXPECT_EQ(telemetry_json_encode(d, "12:00:00.000", buf, 32), 0u);
+    for (size_t i = 32; i < sizeof(buf); ++i) {
+        ASSERT_EQ(static_cast<unsigned char>(buf[i]), 0x5A) << "i=" << i;
+    }
+}
+
+/**
+ * @test Формат времени
+ */
+TEST(TelemetryJsonTest, Timestamp_Format) {
+    char ts[TELEMETRY_TIMESTAMP_MAX];
+    ASSERT_EQ(telemetry_json_timestamp(ts, sizeof(ts)), 12u);
+    std::string s(ts);
+    ASSERT_EQ(s.size(), 12u);
+    EXPECT_EQ(s[2], ':');
+    EXPECT_EQ(s[5], ':');
+    EXPECT_EQ(s[8], '.');
+    for (size_t i : {0u, 1u, 3u, 4u, 6u, 7u, 9u, 10u, 11u}) {
+        EXPECT_TRUE(isdigit(static_cast<unsigned char>(s[i]))) << s;
+    }
+    EXPECT_EQ(telemetry_json_timestamp(ts, 8), 0u);
+}
+
+/**
+ * @test Время из миллисекунд от полуночи (метка бинарного кадра)
+ */
+TEST(TelemetryJsonTest, FormatTime_FromTimeOfDay) {
+    char ts[TELEMETRY_TIMESTAMP_MAX];
+    ASSERT_EQ(telemetry_json_format_time(0, ts, sizeof(ts)), 12u);
+    EXPECT_STREQ(ts, "00:00:00.000");
+    ASSERT_EQ(telemetry_json_format_time(45296789, ts, sizeof(ts)), 12u);
+    EXPECT_STREQ(ts, "12:34:56.789");
+    ASSERT_EQ(telemetry_json_format_time(86399999, ts, sizeof(ts)), 12u);
+    EXPECT_STREQ(ts, "23:59:59.999");
+    EXPECT_LT(telemetry_json_time_of_day_ms(), 86400000u);
+}
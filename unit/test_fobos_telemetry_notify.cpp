@@ -0,0 +1,291 @@
+/**
+ * @file test_fobos_telemetry_notify.cpp
+ * @brief Unit тесты для ожидания новой телеметрии на futex
+ *
+ * Тесты проверяют:
+ * - Немедленный возврат, если публикация уже была, и таймаут без публикаций
+ * - Пробуждение ждущего потока публикацией из другого потока
+ * - Фильтр по группам кадров: ждущий ориентацию не просыпается на GPS
+ * - Ожидание через разделяемую память (SharedTelemetry) и из потока приёма CrsfSerial
+ * - Публикацию без пробуждения, если изменились только счётчики передачи
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../libs/telemetry_notify.h"
+#include "../libs/shared_telemetry.h"
+#include "../libs/crsf/CrsfSerial.h"
+#include "../libs/crsf/crsf_protocol.h"
+#include "mocks/MockSerialPort.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+
+// Отдельное имя, чтобы не мешать запущенному crsf_io_rpi
+static const char* TEST_SHM_NAME = "/crsf_telemetry_notify_unit_test";
+static const char* TEST_NOTIFY_NAME = "/crsf_telemetry_notify_unit_test" SHARED_TELEMETRY_NOTIFY_SUFFIX;
+
+static const uint32_t ATTITUDE = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_ATTITUDE);
+static const uint32_t GPS = TELEMETRY_NOTIFY_KIND(CRSF_LINK_FRAME_GPS);
+
+/**
+ * @class TelemetryNotifyTest
+ * @brief Фикстура: состояние уведомлений в памяти процесса
+ */
+class TelemetryNotifyTest : public ::testing::Test {
+protected:
+    TelemetryNotifyState state{};
+    TelemetryNotify notify{&state, TELEMETRY_NOTIFY_PROCESS};
+};
+
+/**
+ * @test Публикация после взятия курсора видна сразу, повторное ожидание — таймаут
+ */
+TEST_F(TelemetryNotifyTest, Wait_AfterPost_ReturnsImmediately) {
+    TelemetryNotifyCursor cursor = notify.cursor();
+    notify.post(ATTITUDE);
+
+    EXPECT_TRUE(notify.wait(cursor, TELEMETRY_NOTIFY_ANY, 0));
+    EXPECT_EQ(cursor.any, 1u);
+    EXPECT_EQ(cursor.kinds[CRSF_LINK_FRAME_ATTITUDE], 1u);
+    EXPECT_FALSE(notify.wait(cursor, TELEMETRY_NOTIFY_ANY, 0));
+}
+
+/**
+ * @test Без публикаций ожидание завершается по таймауту, не раньше срока
+ */
+TEST_F(TelemetryNotifyTest, Wait_NoPost_TimesOut) {
+    TelemetryNotifyCursor cursor = notify.cursor();
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(notify.wait(cursor, TELEMETRY_NOTIFY_ANY, 30));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+    EXPECT_EQ(state.waiters.load(), 0u);
+}
+
+/**
+ * @test Публикация из другого потока будит ждущего без ограничения по времени
+ */
+TEST_F(TelemetryNotifyTest, Wait_PostFromOtherThread_WakesWaiter) {
+    TelemetryNotifyCursor cursor = notify.cursor();
+    std::thread writer([this]() {
+        // Даём ждущему уснуть в futex
+        while (state.waiters.load() == 0) {
+            std::this_thread::yield();
+        }
+        notify.post(TELEMETRY_NOTIFY_ANY);
+    });
+    EXPECT_TRUE(notify.wait(cursor, TELEMETRY_NOTIFY_ANY, -1));
+    writer.join();
+    EXPECT_EQ(state.waiters.load(), 0u);
+}
+
+/**
+ * @test Ждущий одну группу не просыпается на кадры других групп
+ */
+TEST_F(TelemetryNotifyTest, Wait_KindMask_IgnoresOtherKinds) {
+    TelemetryNotifyCursor cursor = notify.cursor();
+    notify.post(GPS);
+    notify.post(TELEMETRY_NOTIFY_ANY);
+    EXPECT_FALSE(notify.wait(cursor, ATTITUDE, 10));
+
+    // Маска из нескольких групп срабатывает на любую из них
+    EXPECT_TRUE(notify.wait(cursor, ATTITUDE | GPS, 0));
+
+    std::thread writer([this]() {
+        notify.post(GPS);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        notify.post(ATTITUDE);
+    });
+    EXPECT_TRUE(notify.wait(cursor, ATTITUDE, 1000));
+    writer.join();
+    EXPECT_EQ(cursor.kinds[CRSF_LINK_FRAME_ATTITUDE], 1u);
+}
+
+/**
+ * @class SharedTelemetryNotifyTest
+ * @brief Фикстура: удаляет тестовый объект shm до и после теста
+ */
+class SharedTelemetryNotifyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        shm_unlink(TEST_SHM_NAME);
+        shm_unlink(TEST_NOTIFY_NAME);
+    }
+    void TearDown() override {
+        if (notifyState) munmap(notifyState, sizeof(TelemetryNotifyState));
+        shm_unlink(TEST_SHM_NAME);
+        shm_unlink(TEST_NOTIFY_NAME);
+    }
+
+    // Состояние уведомлений, как его видят все процессы (после create() писателя)
+    const TelemetryNotifyState* notify() {
+        if (!notifyState) {
+            int fd = shm_open(TEST_NOTIFY_NAME, O_RDONLY, 0);
+            if (fd < 0) return nullptr;
+            void* p = mmap(nullptr, sizeof(TelemetryNotifyState), PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p != MAP_FAILED) notifyState = static_cast<TelemetryNotifyState*>(p);
+        }
+        return notifyState;
+    }
+
+    TelemetryNotifyState* notifyState = nullptr;
+};
+
+/**
+ * @test Читатель (только чтение) просыпается на публикацию писателя; группы — по счётчикам кадров
+ */
+TEST_F(SharedTelemetryNotifyTest, Wait_ReaderWokenByPublish) {
+    SharedTelemetry writer(TEST_SHM_NAME);
+    ASSERT_TRUE(writer.create());
+    SharedTelemetry reader(TEST_SHM_NAME);
+    ASSERT_TRUE(reader.open());
+
+    SharedTelemetryData data;
+    memset(&data, 0, sizeof(data));
+    TelemetryNotifyCursor cursor = reader.cursor();
+    const TelemetryNotifyState* state = notify();
+    ASSERT_NE(state, nullptr);
+
+    std::thread publisher([&]() {
+        // Читатель отмечается ждущим в общей памяти — только тогда писатель делает FUTEX_WAKE
+        while (state->waiters.load() == 0) {
+            std::this_thread::yield();
+        }
+        data.link.rxFramesByKind[CRSF_LINK_FRAME_GPS] = 1;
+        writer.publish(data);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        data.link.rxFramesByKind[CRSF_LINK_FRAME_ATTITUDE] = 1;
+        writer.publish(data);
+    });
+    EXPECT_TRUE(reader.wait(cursor, ATTITUDE, 1000));
+    publisher.join();
+    EXPECT_EQ(state->waiters.load(), 0u);
+
+    EXPECT_EQ(reader.sequence(), 4u);
+    EXPECT_EQ(cursor.any, 2u);
+    EXPECT_EQ(cursor.kinds[CRSF_LINK_FRAME_GPS], 1u);
+    EXPECT_EQ(cursor.kinds[CRSF_LINK_FRAME_ATTITUDE], 1u);
+
+    // Публикация без новых кадров (изменились каналы) будит только ждущих любую
+    data.channels[0] = 1500;
+    writer.publish(data);
+    EXPECT_FALSE(reader.wait(cursor, GPS | ATTITUDE, 0));
+    EXPECT_TRUE(reader.wait(cursor, TELEMETRY_NOTIFY_ANY, 0));
+}
+
+/**
+ * @test Изменение одних счётчиков передачи публикуется, но ждущих не будит
+ */
+TEST_F(SharedTelemetryNotifyTest, Publish_TxCountersOnly_DoesNotNotify) {
+    SharedTelemetry writer(TEST_SHM_NAME);
+    ASSERT_TRUE(writer.create());
+    SharedTelemetry reader(TEST_SHM_NAME);
+    ASSERT_TRUE(reader.open());
+
+    SharedTelemetryData data;
+    memset(&data, 0, sizeof(data));
+    writer.publish(data);
+    TelemetryNotifyCursor cursor = reader.cursor();
+
+    data.link.txFrames = 100;
+    data.link.txBytes = 2600;
+    data.link.txDropped = 3;
+    data.packetsSent = 100;
+    writer.publish(data);
+    EXPECT_EQ(reader.sequence(), 4u);
+    EXPECT_FALSE(reader.wait(cursor, TELEMETRY_NOTIFY_ANY, 0));
+
+    data.channels[0] = 1500;
+    writer.publish(data);
+    EXPECT_TRUE(reader.wait(cursor, TELEMETRY_NOTIFY_ANY, 0));
+}
+
+/**
+ * @test Без открытой области ожидание сразу возвращает false
+ */
+TEST_F(SharedTelemetryNotifyTest, Wait_NotOpen_ReturnsFalse) {
+    SharedTelemetry reader(TEST_SHM_NAME);
+    TelemetryNotifyCursor cursor = reader.cursor();
+    EXPECT_FALSE(reader.wait(cursor, TELEMETRY_NOTIFY_ANY, 1000));
+}
+
+/**
+ * @class CrsfTelemetryNotifyTest
+ * @brief Фикстура: входной поток порта задаётся вектором байт
+ */
+class CrsfTelemetryNotifyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mockSerial = std::make_unique<MockSerialPort>();
+        crsf = std::make_unique<CrsfSerial>(*mockSerial, 420000);
+        ON_CALL(*mockSerial, readByte(_)).WillByDefault(Invoke([this](uint8_t& b) {
+            if (rxPos >= rx.size()) {
+                return 0;
+            }
+            b = rx[rxPos++];
+            return 1;
+        }));
+        EXPECT_CALL(*mockSerial, readByte(_)).Times(::testing::AnyNumber());
+    }
+
+    // Добавить кадр для FC с верным CRC во входной поток
+    void pushFrame(uint8_t type, const uint8_t* payload, uint8_t len) {
+        Crc8 crc(0xD5);
+        uint8_t frame[CRSF_MAX_PACKET_SIZE];
+        frame[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+        frame[1] = len + 2;
+        frame[2] = type;
+        memcpy(&frame[3], payload, len);
+        frame[3 + len] = crc.calc(&frame[2], len + 1);
+        rx.insert(rx.end(), frame, frame + len + 4);
+    }
+
+    std::unique_ptr<MockSerialPort> mockSerial;
+    std::unique_ptr<CrsfSerial> crsf;
+    std::vector<uint8_t> rx;
+    size_t rxPos = 0;
+};
+
+/**
+ * @test Поток приёма будит ждущего кадр ориентации; кадр GPS его не будит
+ */
+TEST_F(CrsfTelemetryNotifyTest, WaitTelemetry_WokenByAttitudeFrame) {
+    TelemetryNotifyCursor cursor = crsf->telemetryCursor();
+
+    uint8_t gps[15] = {};
+    pushFrame(CRSF_FRAMETYPE_GPS, gps, sizeof(gps));
+    crsf->loop();
+    EXPECT_FALSE(crsf->waitTelemetry(cursor, ATTITUDE, 0));
+
+    std::thread receiver([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        uint8_t attitude[6] = {0x00, 0x10, 0x00, 0x20, 0x00, 0x30};
+        pushFrame(CRSF_FRAMETYPE_ATTITUDE, attitude, sizeof(attitude));
+        crsf->loop();
+    });
+    EXPECT_TRUE(crsf->waitTelemetry(cursor, ATTITUDE, 1000));
+    receiver.join();
+
+    EXPECT_NE(crsf->snapshot().attitudeTimeNs, 0u);
+}
+
+/**
+ * @test Запись каналов будит ждущих любое изменение снимка
+ */
+TEST_F(CrsfTelemetryNotifyTest, WaitTelemetry_WokenBySetChannel) {
+    TelemetryNotifyCursor cursor = crsf->telemetryCursor();
+    crsf->setChannel(1, 1700);
+    EXPECT_TRUE(crsf->waitTelemetry(cursor, TELEMETRY_NOTIFY_ANY, 0));
+    EXPECT_FALSE(crsf->waitTelemetry(cursor, TELEMETRY_NOTIFY_ANY, 0));
+}
@@ -0,0 +1,295 @@
+/**
+ * @file test_fobos_telemetry_publisher.cpp
+ * @brief Unit тесты для публикации телеметрии с грязными битами полей
+ *
+ * Тесты проверяют:
+ * - Первый кадр ключевой, дальше разностные только с изменившимися полями
+ * - Пороги для плавающей точки (дрожание не отправляется, накопленный дрейф — да)
+ * - Изменение одних счётчиков передачи кадр не вызывает, но уходит со следующим
+ * - Окно объединения: несколько изменений уходят одним кадром с последними значениями
+ * - Ключевой кадр по времени и после ошибки отправки, номера кадров полей
+ * - Снимок приёмника, собранный из кадров, совпадает с копией у отправителя
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include "../libs/telemetry_json.h"
+#include "../libs/telemetry_publisher.h"
+#include "../libs/telemetry_wire.h"
+
+static SharedTelemetryData sampleTelemetry() {
+    SharedTelemetryData d;
+    memset(&d, 0, sizeof(d));
+    d.linkUp = true;
+    d.lastReceive = 1000;
+    for (int i = 0; i < 16; ++i) {
+        d.channels[i] = 1500;
+    }
+    d.latitude = 55.75;
+    d.longitude = 37.61;
+    d.altitude = 150.0;
+    d.voltage = 16.8;
+    d.roll = 1.0;
+    d.pitch = 2.0;
+    d.yaw = 3.0;
+    return d;
+}
+
+static std::string toJson(const SharedTelemetryData& d) {
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = telemetry_json_encode(d, "00:00:00.000", buf, sizeof(buf));
+    return std::string(buf, len);
+}
+
+/**
+ * @class TelemetryPublisherTest
+ * @brief Отправитель и приёмник: каждый кадр publisher декодируется поверх снимка приёмника
+ */
+class TelemetryPublisherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        memset(&receiver, 0, sizeof(receiver));
+        publisher.setKeyframeMs(0);
+    }
+
+    // Кадр от publisher доставлен приёмнику; длина кадра
+    size_t deliver(uint64_t nowMs, bool success = true) {
+        uint8_t buf[TELEMETRY_WIRE_MAX];
+        size_t len = publisher.encode(static_cast<uint32_t>(nowMs), buf, sizeof(buf));
+        EXPECT_GT(len, 0u);
+        if (success) {
+            EXPECT_EQ(telemetry_wire_decode(buf, len, receiver), TELEMETRY_WIRE_OK);
+        }
+        publisher.sent(success, nowMs);
+        return len;
+    }
+
+    bool isDelta(uint64_t nowMs) {
+        uint8_t buf[TELEMETRY_WIRE_MAX];
+        publisher.encode(static_cast<uint32_t>(nowMs), buf, sizeof(buf));
+        return (buf[3] & TELEMETRY_WIRE_FLAG_DELTA) != 0;
+    }
+
+    TelemetryPublisher publisher;
+    TelemetryWireFrame receiver;
+};
+
+/**
+ * @test Первый кадр ключевой, следующий — только изменившийся канал
+ */
+TEST_F(TelemetryPublisherTest, FirstKeyframe_ThenSingleChannelDelta) {
+    SharedTelemetryData d = sampleTelemetry();
+    ASSERT_TRUE(publisher.update(d, 0));
+    EXPECT_TRUE(publisher.keyframeDue());
+    EXPECT_FALSE(isDelta(0));
+    EXPECT_EQ(deliver(0), TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE);
+    EXPECT_EQ(publisher.keyframesSent(), 1u);
+
+    // Без изменений отправлять нечего
+    EXPECT_FALSE(publisher.update(d, 20));
+
+    d.channels[5] = 1700;
+    ASSERT_TRUE(publisher.update(d, 40));
+    EXPECT_EQ(publisher.dirtyFields(), 1ull << (TELEMETRY_WIRE_CHANNEL_0 + 5));
+    EXPECT_TRUE(isDelta(40));
+    EXPECT_EQ(deliver(40), TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_DELTA_HEADER_SIZE + 4);
+    EXPECT_EQ(toJson(receiver.data), toJson(d));
+    EXPECT_EQ(publisher.framesSent(), 2u);
+    EXPECT_EQ(publisher.fieldSequence(TELEMETRY_WIRE_CHANNEL_0 + 5), 2u);
+    EXPECT_EQ(publisher.fieldSequence(TELEMETRY_WIRE_CHANNEL_0 + 4), 1u);
+}
+
+/**
+ * @test Пороги плавающей точки
+ *
+ * Дрожание меньше порога не отправляется; дрейф считается от значения у приёмника,
+ * поэтому накопленное изменение всё равно уходит.
+ */
+TEST_F(TelemetryPublisherTest, Tolerance_JitterSuppressed_DriftSent) {
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    deliver(0);
+
+    d.roll += 0.004;
+    EXPECT_FALSE(publisher.update(d, 20));
+    d.roll += 0.004;
+    EXPECT_FALSE(publisher.update(d, 40));
+    d.roll += 0.004;
+    ASSERT_TRUE(publisher.update(d, 60));
+    EXPECT_EQ(publisher.dirtyFields(), 1ull << TELEMETRY_WIRE_ROLL);
+    deliver(60);
+    EXPECT_DOUBLE_EQ(receiver.data.roll, d.roll);
+
+    // Целые поля — любое изменение
+    d.rollRaw += 1;
+    EXPECT_TRUE(publisher.update(d, 80));
+}
+
+/**
+ * @test Счётчики передачи
+ *
+ * Растут на каждом такте отправки даже при молчащем полётнике — сами по себе кадр
+ * не вызывают, но уходят вместе со следующим настоящим изменением.
+ */
+TEST_F(TelemetryPublisherTest, TxCountersOnly_NotDue_RideAlong) {
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    deliver(0);
+
+    d.packetsSent += 2;
+    d.link.txFrames += 2;
+    d.link.txBytes += 52;
+    EXPECT_FALSE(publisher.update(d, 20));
+    d.packetsSent += 2;
+    d.link.txFrames += 2;
+    d.link.txBytes += 52;
+    d.link.txDropped += 1;
+    EXPECT_FALSE(publisher.update(d, 40));
+    EXPECT_EQ(publisher.framesSent(), 1u);
+
+    d.channels[3] = 1600;
+    ASSERT_TRUE(publisher.update(d, 60));
+    EXPECT_TRUE(publisher.dirtyFields() & (1ull << TELEMETRY_WIRE_LINK_TX_BYTES));
+    deliver(60);
+    EXPECT_EQ(toJson(receiver.data), toJson(d));
+}
+
+/**
+ * @test Окно объединения
+ *
+ * Изменения за окно уходят одним кадром с последними значениями.
+ */
+TEST_F(TelemetryPublisherTest, CoalesceWindow_MergesUpdates) {
+    publisher.setCoalesceMs(50);
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    deliver(0);
+
+    d.channels[0] = 1600;
+    EXPECT_FALSE(publisher.update(d, 100));
+    d.channels[0] = 1650;
+    d.yaw = 90.0;
+    EXPECT_FALSE(publisher.update(d, 120));
+    d.channels[1] = 1400;
+    EXPECT_TRUE(publisher.update(d, 150));
+    EXPECT_EQ(publisher.coalesced(), 2u);
+    EXPECT_EQ(publisher.dirtyFields(),
+              (1ull << TELEMETRY_WIRE_CHANNEL_0) | (1ull << (TELEMETRY_WIRE_CHANNEL_0 + 1)) | (1ull << TELEMETRY_WIRE_YAW));
+    deliver(150);
+    EXPECT_EQ(toJson(receiver.data), toJson(d));
+    EXPECT_EQ(publisher.framesSent(), 2u);
+
+    // Значение вернулось к отправленному до конца окна — кадра нет
+    d.channels[0] = 1500;
+    EXPECT_FALSE(publisher.update(d, 200));
+    d.channels[0] = 1650;
+    EXPECT_FALSE(publisher.update(d, 230));
+    EXPECT_EQ(publisher.dirtyFields(), 0u);
+    EXPECT_FALSE(publisher.update(d, 300));
+}
+
+/**
+ * @test Ключевой кадр по времени и по счётчику кадров
+ */
+TEST_F(TelemetryPublisherTest, Keyframe_PeriodicByTimeAndCount) {
+    publisher.setKeyframeMs(1000);
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    deliver(0);
+
+    // Тишина: ключевой кадр как пульс
+    EXPECT_FALSE(publisher.update(d, 980));
+    ASSERT_TRUE(publisher.update(d, 1000));
+    EXPECT_FALSE(isDelta(1000));
+    deliver(1000);
+    EXPECT_EQ(publisher.keyframesSent(), 2u);
+
+    publisher.setKeyframeMs(0);
+    uint64_t now = 1000;
+    for (uint32_t i = 1; i < TELEMETRY_WIRE_KEYFRAME_INTERVAL; ++i) {
+        d.lastReceive += 20;
+        now += 20;
+        ASSERT_TRUE(publisher.update(d, now));
+        EXPECT_TRUE(isDelta(now));
+        deliver(now);
+    }
+    d.lastReceive += 20;
+    now += 20;
+    ASSERT_TRUE(publisher.update(d, now));
+    EXPECT_FALSE(isDelta(now));
+}
+
+/**
+ * @test Ошибка отправки: следующий кадр ключевой, но не раньше паузы повтора
+ */
+TEST_F(TelemetryPublisherTest, SendFailure_ForcesKeyframe) {
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    deliver(0);
+
+    d.channels[2] = 1234;
+    ASSERT_TRUE(publisher.update(d, 20));
+    deliver(20, false);
+    EXPECT_TRUE(publisher.keyframeDue());
+    EXPECT_FALSE(publisher.update(d, 40));
+    ASSERT_TRUE(publisher.update(d, 300));
+    EXPECT_FALSE(isDelta(300));
+    deliver(300);
+    EXPECT_EQ(toJson(receiver.data), toJson(d));
+    EXPECT_EQ(publisher.sequence(), 3u);
+    EXPECT_EQ(receiver.seq, 3u);
+}
+
+/**
+ * @test Без разностных кадров (JSON): каждый отправленный кадр полный
+ */
+TEST_F(TelemetryPublisherTest, FullFrames_CountAsKeyframes) {
+    publisher.setDeltaFrames(false);
+    SharedTelemetryData d = sampleTelemetry();
+    publisher.update(d, 0);
+    publisher.sent(true, 0);
+    EXPECT_FALSE(publisher.update(d, 20));
+    d.voltage = 15.0;
+    ASSERT_TRUE(publisher.update(d, 40));
+    EXPECT_FALSE(isDelta(40));
+    publisher.sent(true, 40);
+    EXPECT_EQ(publisher.keyframesSent(), 2u);
+}
+
+/**
+ * @test Случайная последовательность: приёмник всегда в пределах порогов от отправителя
+ */
+TEST_F(TelemetryPublisherTest, RandomUpdates_ReceiverTracksSender) {
+    std::mt19937 rng(15);
+    publisher.setCoalesceMs(40);
+    SharedTelemetryData d = sampleTelemetry();
+    uint64_t now = 0;
+    size_t bytes = 0;
+    for (int step = 0; step < 2000; ++step) {
+        // Обычно движется один стик и ориентация
+        d.channels[rng() % 4] = 1000 + static_cast<int>(rng() % 1001);
+        d.roll += (static_cast<int>(rng() % 200) - 100) * 0.0001;
+        if (rng() % 50 == 0) {
+            d.voltage -= 0.05;
+        }
+        now += 20;
+        if (publisher.update(d, now)) {
+            bytes += deliver(now);
+        }
+    }
+    // Сходимость: последнее изменение уходит по окончании окна
+    now += 100;
+    if (publisher.update(d, now)) {
+        bytes += deliver(now);
+    }
+    SharedTelemetryData expected = d;
+    expected.roll = receiver.data.roll;
+    EXPECT_NEAR(receiver.data.roll, d.roll, 0.01);
+    EXPECT_EQ(toJson(receiver.data), toJson(expected));
+    // Гораздо меньше, чем полный кадр на каждое обновление
+    EXPECT_LT(bytes, 2000u * (TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE) / 4);
+}
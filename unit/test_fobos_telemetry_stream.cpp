@@ -0,0 +1,261 @@
+/**
+ * @file test_fobos_telemetry_stream.cpp
+ * @brief Unit тесты для потоковой раздачи телеметрии (Server-Sent Events)
+ *
+ * Тесты проверяют:
+ * - Разбор JSON телеметрии на поля верхнего уровня
+ * - Одну сериализацию снимка на всех подписчиков
+ * - Подписку на отдельные поля и предел частоты со схлопыванием до последнего снимка
+ * - Удаление отключившихся подписчиков
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../libs/http_server.h"
+#include "../libs/telemetry_stream.h"
+
+static const char* SAMPLE_JSON =
+    "{\"linkUp\":true,\"activePort\":\"UART, Active\",\"channels\":[1500,1600],"
+    "\"gps\":{\"latitude\":55.75,\"nested\":{\"a\":[1,2]}},\"workMode\":\"manual\"}";
+
+/**
+ * @class SseClient
+ * @brief Подписчик потока на 127.0.0.1: отправляет GET и читает события по одному
+ */
+class SseClient {
+public:
+    SseClient(int port, const std::string& target) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct timeval timeout;
+        timeout.tv_sec = 2;
+        timeout.tv_usec = 0;
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        std::string req = "GET " + target + " HTTP/1.1\r\nAccept: text/event-stream\r\n\r\n";
+        send(_fd, req.data(), req.size(), MSG_NOSIGNAL);
+    }
+
+    ~SseClient() {
+        disconnect();
+    }
+
+    void disconnect() {
+        if (_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+    }
+
+    // Заголовки ответа
+    std::string headers() {
+        size_t end;
+        while ((end = _pending.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return "";
+            }
+        }
+        std::string head = _pending.substr(0, end);
+        _pending.erase(0, end + 4);
+        return head;
+    }
+
+    // Следующее событие telemetry (без комментариев и "retry:"); пусто по таймауту
+    std::string nextEvent() {
+        for (;;) {
+            size_t end = _pending.find("\n\n");
+            if (end == std::string::npos) {
+                if (!fill()) {
+                    return "";
+                }
+                continue;
+            }
+            std::string block = _pending.substr(0, end);
+            _pending.erase(0, end + 2);
+            if (block.compare(0, 4, "id: ") == 0) {
+                return block;
+            }
+        }
+    }
+
+    static std::string data(const std::string& event) {
+        size_t pos = event.find("data: ");
+        return pos == std::string::npos ? "" : event.substr(pos + 6);
+    }
+
+private:
+    bool fill() {
+        char buf[4096];
+        ssize_t n = recv(_fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        _pending.append(buf, n);
+        return true;
+    }
+
+    int _fd;
+    std::string _pending;
+};
+
+// Ожидание условия (подписка регистрируется асинхронно, в рабочем потоке сервера)
+template <typename Pred>
+static bool waitFor(Pred pred) {
+    for (int i = 0; i < 200; ++i) {
+        if (pred()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return pred();
+}
+
+/**
+ * @test Разбор на поля верхнего уровня
+ *
+ * Запятые внутри строк и вложенных объектов/массивов не разделяют поля.
+ */
+TEST(TelemetryStreamTest, SplitJson_TopLevelFields) {
+    TelemetryFields fields;
+    ASSERT_TRUE(telemetry_split_json(SAMPLE_JSON, fields));
+    ASSERT_EQ(fields.size(), 5u);
+    EXPECT_EQ(fields[0].first, "linkUp");
+    EXPECT_EQ(fields[0].second, "true");
+    EXPECT_EQ(fields[1].second, "\"UART, Active\"");
+    EXPECT_EQ(fields[2].second, "[1500,1600]");
+    EXPECT_EQ(fields[3].first, "gps");
+    EXPECT_EQ(fields[3].second, "{\"latitude\":55.75,\"nested\":{\"a\":[1,2]}}");
+    EXPECT_EQ(fields[4].second, "\"manual\"");
+
+    EXPECT_FALSE(telemetry_split_json("[1,2]", fields));
+    EXPECT_FALSE(telemetry_split_json("{\"a\":", fields));
+}
+
+/**
+ * @test Одна сериализация на всех подписчиков
+ */
+TEST(TelemetryStreamTest, Publish_OneSerializationForAllSubscribers) {
+    TelemetryStreamHub hub;
+    HttpServer server([&hub](const HttpRequest& req, HttpResponse& resp) { hub.subscribe(req, resp); }, 2);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    std::vector<std::unique_ptr<SseClient>> clients;
+    for (int i = 0; i < 4; ++i) {
+        clients.emplace_back(new SseClient(server.port(), "/api/telemetry/stream"));
+        EXPECT_NE(clients.back()->headers().find("Content-Type: text/event-stream"), std::string::npos);
+    }
+    ASSERT_TRUE(waitFor([&]() { return hub.subscribers() == 4; }));
+
+    hub.publish(SAMPLE_JSON);
+    for (auto& c : clients) {
+        std::string event = c->nextEvent();
+        EXPECT_NE(event.find("event: telemetry"), std::string::npos);
+        EXPECT_EQ(SseClient::data(event), SAMPLE_JSON);
+    }
+    EXPECT_EQ(hub.serializations(), 1u);
+    EXPECT_EQ(hub.eventsSent(), 4u);
+    EXPECT_EQ(server.streamsOpen(), 4u);
+}
+
+/**
+ * @test Подписка на поля
+ *
+ * Клиент получает только запрошенные поля в порядке снимка;
+ * клиенты с одинаковым набором делят одну сериализацию.
+ */
+TEST(TelemetryStreamTest, Fields_OnlyRequestedFieldsSent) {
+    TelemetryStreamHub hub;
+    HttpServer server([&hub](const HttpRequest& req, HttpResponse& resp) { hub.subscribe(req, resp); }, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    SseClient a(server.port(), "/api/telemetry/stream?fields=channels,linkUp");
+    SseClient b(server.port(), "/api/telemetry/stream?fields=linkUp%2Cchannels");
+    SseClient full(server.port(), "/api/telemetry/stream");
+    ASSERT_TRUE(waitFor([&]() { return hub.subscribers() == 3; }));
+
+    hub.publish(SAMPLE_JSON);
+    EXPECT_EQ(SseClient::data(a.nextEvent()), "{\"linkUp\":true,\"channels\":[1500,1600]}");
+    EXPECT_EQ(SseClient::data(b.nextEvent()), "{\"linkUp\":true,\"channels\":[1500,1600]}");
+    EXPECT_EQ(SseClient::data(full.nextEvent()), SAMPLE_JSON);
+    EXPECT_EQ(hub.serializations(), 2u);
+}
+
+/**
+ * @test Предел частоты
+ *
+ * При rate=5 серия из 20 снимков схлопывается: клиент получает первый
+ * и последний снимок, а не все 20.
+ */
+TEST(TelemetryStreamTest, RateLimit_CoalescesToLatestSnapshot) {
+    TelemetryStreamHub hub;
+    HttpServer server([&hub](const HttpRequest& req, HttpResponse& resp) { hub.subscribe(req, resp); }, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    SseClient client(server.port(), "/api/telemetry/stream?rate=5");
+    ASSERT_TRUE(waitFor([&]() { return hub.subscribers() == 1; }));
+
+    for (int i = 1; i <= 20; ++i) {
+        hub.publish("{\"n\":" + std::to_string(i) + "}");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    std::string first = client.nextEvent();
+    ASSERT_FALSE(first.empty());
+    // Следующее событие — не раньше чем через 200 мс и уже с последним снимком
+    auto start = std::chrono::steady_clock::now();
+    std::string second = client.nextEvent();
+    auto waited = std::chrono::steady_clock::now() - start;
+    ASSERT_FALSE(second.empty());
+    EXPECT_EQ(SseClient::data(second), "{\"n\":20}");
+    EXPECT_GT(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count(), 100);
+    EXPECT_LE(hub.eventsSent(), 3u);
+}
+
+/**
+ * @test Отключение подписчика
+ */
+TEST(TelemetryStreamTest, Disconnect_SubscriberRemoved) {
+    TelemetryStreamHub hub;
+    HttpServer server([&hub](const HttpRequest& req, HttpResponse& resp) { hub.subscribe(req, resp); }, 1);
+    ASSERT_TRUE(server.listen(0));
+    ASSERT_TRUE(server.start());
+
+    SseClient client(server.port(), "/api/telemetry/stream");
+    ASSERT_TRUE(waitFor([&]() { return hub.subscribers() == 1; }));
+    client.disconnect();
+    ASSERT_TRUE(waitFor([&]() { return server.streamsOpen() == 0; }));
+
+    hub.publish(SAMPLE_JSON);
+    EXPECT_TRUE(waitFor([&]() { return hub.subscribers() == 0; }));
+}
+
+/**
+ * @test Неверный предел частоты
+ */
+TEST(TelemetryStreamTest, InvalidRate_Rejected) {
+    TelemetryStreamHub hub;
+    HttpRequest req;
+    req.query = "rate=0";
+    HttpResponse resp;
+    hub.subscribe(req, resp);
+    EXPECT_EQ(resp.status, 400);
+    EXPECT_FALSE(resp.onStream);
+}
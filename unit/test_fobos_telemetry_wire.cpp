@@ -0,0 +1,248 @@
+/**
+ * @file test_fobos_telemetry_wire.cpp
+ * @brief Unit тесты для бинарного кадра телеметрии
+ *
+ * Тесты проверяют:
+ * - Ключевой кадр без потерь (тот же JSON после декодирования, включая NaN и -0.0)
+ * - Раскладку little-endian заголовка и первых полей
+ * - Разностный кадр: только изменившиеся поля, сборка поверх базы, отказ при чужой базе
+ * - Отказ на коротких, лишних и повреждённых кадрах
+ *
+ * @version 4.3
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "../libs/telemetry_json.h"
+#include "../libs/telemetry_wire.h"
+
+static SharedTelemetryData sampleTelemetry() {
+    SharedTelemetryData d;
+    memset(&d, 0, sizeof(d));
+    d.linkUp = true;
+    d.lastReceive = 0x01020304;
+    for (int i = 0; i < 16; ++i) {
+        d.channels[i] = 1000 + i * 60;
+    }
+    d.channels[15] = -7;
+    d.packetsReceived = 987654;
+    d.packetsSent = 12;
+    d.packetsLost = 3;
+    d.latitude = 55.7512345;
+    d.longitude = 37.6184321;
+    d.altitude = std::numeric_limits<double>::quiet_NaN();
+    d.speed = -0.0;
+    d.voltage = 16.8;
+    d.current = 23.4;
+    d.capacity = 1350.0;
+    d.remaining = 76;
+    d.roll = -3.25;
+    d.pitch = 1.5;
+    d.yaw = std::numeric_limits<double>::infinity();
+    d.rollRaw = -5672;
+    d.pitchRaw = 2618;
+    d.yawRaw = INT16_MIN;
+    d.link.rxFrames = 987654;
+    d.link.rxFramesByKind[CRSF_LINK_FRAME_CHANNELS] = 900000;
+    d.link.rxFramesByKind[CRSF_LINK_FRAME_ATTITUDE] = 87654;
+    d.link.rxCrcErrors = 3;
+    d.link.rxResyncBytes = 41;
+    d.link.txFrames = 12;
+    d.link.txBytes = 0x0102030405060708ull;
+    return d;
+}
+
+// Сравнение по JSON: кадр переносит ровно поля JSON-схемы
+static std::string toJson(const SharedTelemetryData& d) {
+    char buf[TELEMETRY_JSON_MAX];
+    size_t len = telemetry_json_encode(d, "00:00:00.000", buf, sizeof(buf));
+    return std::string(buf, len);
+}
+
+/**
+ * @test Ключевой кадр без потерь
+ */
+TEST(TelemetryWireTest, Keyframe_RoundTrip) {
+    SharedTelemetryData d = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    size_t len = telemetry_wire_encode(d, 42, 45296789, nullptr, 0, buf, sizeof(buf));
+    ASSERT_EQ(len, TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE);
+
+    TelemetryWireFrame frame = {};
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+    EXPECT_TRUE(frame.valid);
+    EXPECT_EQ(frame.seq, 42u);
+    EXPECT_EQ(frame.timeOfDayMs, 45296789u);
+    EXPECT_EQ(toJson(frame.data), toJson(d));
+    EXPECT_TRUE(std::isnan(frame.data.altitude));
+    EXPECT_TRUE(std::signbit(frame.data.speed));
+    EXPECT_EQ(frame.data.yawRaw, INT16_MIN);
+    EXPECT_EQ(frame.data.channels[15], -7);
+}
+
+/**
+ * @test Раскладка little-endian
+ */
+TEST(TelemetryWireTest, Keyframe_LittleEndianLayout) {
+    SharedTelemetryData d = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    ASSERT_GT(telemetry_wire_encode(d, 0xA1B2C3D4, 0x00112233, nullptr, 0, buf, sizeof(buf)), 0u);
+
+    const uint8_t header[] = {0x43, 0x57, TELEMETRY_WIRE_VERSION, 0x00, 0xD4, 0xC3, 0xB2, 0xA1, 0x33, 0x22, 0x11, 0x00};
+    EXPECT_EQ(memcmp(buf, header, sizeof(header)), 0);
+    EXPECT_EQ(buf[12], 1);                                  // linkUp
+    const uint8_t lastReceive[] = {0x04, 0x03, 0x02, 0x01};
+    EXPECT_EQ(memcmp(buf + 13, lastReceive, 4), 0);
+    const uint8_t channel0[] = {0xE8, 0x03, 0x00, 0x00};    // 1000
+    EXPECT_EQ(memcmp(buf + 17, channel0, 4), 0);
+    const uint8_t yawRaw[] = {0x00, 0x80};                  // INT16_MIN — последнее поле версии 1
+    EXPECT_EQ(memcmp(buf + TELEMETRY_WIRE_HEADER_SIZE + 168 - 2, yawRaw, 2), 0);
+    const uint8_t txBytes[] = {0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01};  // u64 — последнее поле
+    EXPECT_EQ(memcmp(buf + TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE - 8, txBytes, 8), 0);
+}
+
+/**
+ * @test Разностный кадр
+ *
+ * В кадре только изменившиеся поля; после применения к базе снимок совпадает с исходным.
+ */
+TEST(TelemetryWireTest, Delta_OnlyChangedFields) {
+    SharedTelemetryData base = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    TelemetryWireFrame frame = {};
+    size_t len = telemetry_wire_encode(base, 1, 1000, nullptr, 0, buf, sizeof(buf));
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+
+    SharedTelemetryData next = base;
+    next.channels[3] = 1999;
+    next.roll = -3.5;
+    len = telemetry_wire_encode(next, 2, 1020, &base, 1, buf, sizeof(buf));
+    EXPECT_EQ(len, TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_DELTA_HEADER_SIZE + 4 + 8);
+    EXPECT_EQ(buf[3], TELEMETRY_WIRE_FLAG_DELTA);
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+    EXPECT_EQ(frame.seq, 2u);
+    EXPECT_EQ(frame.timeOfDayMs, 1020u);
+    EXPECT_EQ(toJson(frame.data), toJson(next));
+
+    // Без изменений — только заголовки
+    len = telemetry_wire_encode(next, 3, 1040, &next, 2, buf, sizeof(buf));
+    EXPECT_EQ(len, TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_DELTA_HEADER_SIZE);
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+    EXPECT_EQ(toJson(frame.data), toJson(next));
+}
+
+/**
+ * @test Цепочка случайных разностных кадров
+ */
+TEST(TelemetryWireTest, Delta_RandomChain) {
+    std::mt19937 rng(2024);
+    SharedTelemetryData sender = sampleTelemetry();
+    sender.altitude = 100.0;
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    TelemetryWireFrame frame = {};
+    size_t len = telemetry_wire_encode(sender, 1, 0, nullptr, 0, buf, sizeof(buf));
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+
+    for (uint32_t seq = 2; seq < 500; ++seq) {
+        SharedTelemetryData next = sender;
+        if (rng() % 2) next.channels[rng() % 16] = static_cast<int>(rng() % 2000);
+        if (rng() % 3 == 0) next.roll = static_cast<double>(rng()) / 1e6;
+        if (rng() % 5 == 0) next.linkUp = !next.linkUp;
+        if (rng() % 7 == 0) next.remaining = static_cast<uint8_t>(rng());
+        if (rng() % 11 == 0) next.pitchRaw = static_cast<int16_t>(rng());
+        len = telemetry_wire_encode(next, seq, seq * 20, &sender, seq - 1, buf, sizeof(buf));
+        ASSERT_GT(len, 0u);
+        ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK) << "seq=" << seq;
+        ASSERT_EQ(toJson(frame.data), toJson(next)) << "seq=" << seq;
+        sender = next;
+    }
+}
+
+/**
+ * @test Разностный кадр к другой базе
+ *
+ * Приёмник отказывает и не меняет собранный снимок.
+ */
+TEST(TelemetryWireTest, Delta_BaseMismatch_FrameUnchanged) {
+    SharedTelemetryData base = sampleTelemetry();
+    SharedTelemetryData next = base;
+    next.channels[0] = 1500;
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+
+    TelemetryWireFrame empty = {};
+    size_t len = telemetry_wire_encode(next, 6, 0, &base, 5, buf, sizeof(buf));
+    EXPECT_EQ(telemetry_wire_decode(buf, len, empty), TELEMETRY_WIRE_BASE_MISMATCH);
+    EXPECT_FALSE(empty.valid);
+
+    TelemetryWireFrame frame = {};
+    size_t keyLen = telemetry_wire_encode(base, 4, 0, nullptr, 0, buf, sizeof(buf));
+    ASSERT_EQ(telemetry_wire_decode(buf, keyLen, frame), TELEMETRY_WIRE_OK);
+    len = telemetry_wire_encode(next, 6, 0, &base, 5, buf, sizeof(buf));
+    EXPECT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_BASE_MISMATCH);
+    EXPECT_EQ(frame.seq, 4u);
+    EXPECT_EQ(frame.data.channels[0], base.channels[0]);
+}
+
+/**
+ * @test Повреждённые кадры
+ */
+TEST(TelemetryWireTest, Decode_RejectsMalformed) {
+    SharedTelemetryData d = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX + 1];
+    size_t len = telemetry_wire_encode(d, 1, 0, nullptr, 0, buf, sizeof(buf));
+    TelemetryWireFrame frame = {};
+
+    // Любое усечение
+    for (size_t n = 0; n < len; ++n) {
+        ASSERT_NE(telemetry_wire_decode(buf, n, frame), TELEMETRY_WIRE_OK) << "n=" << n;
+    }
+    EXPECT_FALSE(frame.valid);
+    // Лишний байт
+    EXPECT_EQ(telemetry_wire_decode(buf, len + 1, frame), TELEMETRY_WIRE_MALFORMED);
+
+    std::vector<uint8_t> bad(buf, buf + len);
+    bad[0] ^= 0xFF;
+    EXPECT_EQ(telemetry_wire_decode(bad.data(), bad.size(), frame), TELEMETRY_WIRE_MALFORMED);
+    bad.assign(buf, buf + len);
+    bad[2] = TELEMETRY_WIRE_VERSION + 1;
+    EXPECT_EQ(telemetry_wire_decode(bad.data(), bad.size(), frame), TELEMETRY_WIRE_BAD_VERSION);
+    bad.assign(buf, buf + len);
+    bad[3] = 0x80;
+    EXPECT_EQ(telemetry_wire_decode(bad.data(), bad.size(), frame), TELEMETRY_WIRE_MALFORMED);
+
+    // Разностный кадр с битом несуществующего поля
+    ASSERT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_OK);
+    len = telemetry_wire_encode(d, 2, 0, &d, 1, buf, sizeof(buf));
+    buf[TELEMETRY_WIRE_HEADER_SIZE + 4 + 7] = 0x80;
+    EXPECT_EQ(telemetry_wire_decode(buf, len, frame), TELEMETRY_WIRE_MALFORMED);
+
+    // Случайные байты после верного заголовка не приводят к выходу за буфер
+    std::mt19937 rng(99);
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<uint8_t> noise(rng() % (TELEMETRY_WIRE_MAX + 8));
+        for (auto& b : noise) {
+            b = static_cast<uint8_t>(rng());
+        }
+        if (noise.size() >= 4) {
+            noise[0] = 0x43;
+            noise[1] = 0x57;
+            noise[2] = TELEMETRY_WIRE_VERSION;
+            noise[3] &= TELEMETRY_WIRE_FLAG_DELTA;
+        }
+        telemetry_wire_decode(noise.data(), noise.size(), frame);
+    }
+}
+
+/**
+ * @test Нехватка буфера при кодировании
+ */
+TEST(TelemetryWireTest, Encode_SmallBuffer_ReturnsZero) {
+    SharedTelemetryData d = sampleTelemetry();
+    uint8_t buf[TELEMETRY_WIRE_MAX];
+    EXPECT_EQ(telemetry_wire_encode(d, 1, 0, nullptr, 0, buf, TELEMETRY_WIRE_HEADER_SIZE + TELEMETRY_WIRE_PAYLOAD_SIZE - 1), 0u);
+}